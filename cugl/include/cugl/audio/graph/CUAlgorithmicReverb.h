@@ -49,7 +49,6 @@
 #ifndef __CU_ALGORITHMIC_REVERB_H__
 #define __CU_ALGORITHMIC_REVERB_H__
 #include <cugl/audio/graph/CUAudioNode.h>
-#include <mutex>
 #include <SDL_atk.h>
 
 namespace cugl {
@@ -79,8 +78,9 @@ protected:
     /** The audio input node */
     std::shared_ptr<AudioNode> _input;
 
-    /** This class needs a proper lock guard; too many race conditions */
-    std::mutex _mutex;
+    // Requests: posted by the main thread, applied by the audio thread
+    /** The requests not yet applied by the audio thread (a bitmask) */
+    std::atomic<Uint32> _pending;
 
     /** internal gain for producing wet mix */
     std::atomic<float> _ingain;
@@ -107,11 +107,13 @@ protected:
     ATK_AlgoReverb* _reverb;
 
     /** The number of frames to fade-out; -1 if no active fade-out */
-    Sint64 _outmark;
+    std::atomic<Sint64> _outmark;
+    /** The fade-out length used by the audio thread (AUDIO THREAD ONLY) */
+    Sint64 _outsize;
     /** The amount of fade-out remaining */
     Uint64 _fadeout;
     /** Whether we have completed this node due to a fadeout */
-    bool   _outdone;
+    std::atomic<bool> _outdone;
     
     /**
      * Initializes the reverb filter from the default settings.
@@ -312,6 +314,9 @@ public:
      * The buffer should have enough room to store frames * channels elements.
      * The channels are interleaved into the output buffer.
      *
+     * This method never waits on the main thread. Changes to the tail or
+     * the reverb settings are applied at the start of the next call.
+     *
      * This method will always forward the read position after reading. Reading
      * again may return different data.
      *
@@ -640,6 +645,15 @@ private:
      */
     void updateReverb();
 
+    /**
+     * Applies the pending tail and clear requests.
+     *
+     * This method is called by {@link read} before it processes any audio.
+     *
+     * AUDIO THREAD ONLY: Users should never access this method directly.
+     */
+    void applyRequests();
+
 };
     }
 }
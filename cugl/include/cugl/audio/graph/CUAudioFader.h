@@ -50,7 +50,7 @@
 #define __CU_AUDIO_FADER_H__
 #include <cugl/audio/graph/CUAudioNode.h>
 #include <SDL.h>
-#include <mutex>
+#include <atomic>
 
 namespace cugl {
 
@@ -81,6 +81,10 @@ namespace cugl {
  * The audio graph should only be accessed in the main thread.  In addition,
  * no methods marked as AUDIO THREAD ONLY should ever be accessed by the user.
  *
+ * The fade methods never block the audio thread. They post a request that the
+ * audio thread applies at the start of its next {@link read}, so a fade (or
+ * the cancellation of one) takes effect on the next audio block.
+ *
  * This audio node supports the callback functions in {@link AudioNode#setCallback}.
  * This function function is called whenever a fade-in or fade-out has completed
  * successfully (without interruption).
@@ -90,36 +94,77 @@ protected:
     /** The audio input node */
     std::shared_ptr<AudioNode> _input;
 
-    /** This class needs a proper lock guard; too many race conditions */
-    std::mutex _mutex;
+    // Fade requests: posted by the main thread, applied by the audio thread
+    /** The fade requests not yet applied by the audio thread (a bitmask) */
+    std::atomic<Uint32> _pending;
+    /** The requested fade-in length in frames; -1 to cancel the fade-in */
+    std::atomic<Sint64> _reqin;
+    /** The requested fade-out length in frames; -1 to complete immediately */
+    std::atomic<Sint64> _reqout;
+    /** The requested fade-dip; fade-out frames in the high word, fade-in in the low */
+    std::atomic<Uint64> _reqdip;
     
     // Fade-in: For softer starts
     /** The final frame of the current fade-in; -1 if no active fade-in */
-    Sint64 _inmark;
+    std::atomic<Sint64> _inmark;
     /** The current fade-in in frames; 0 if no active fade-in */
     Uint64 _fadein;
     
     // Fade-out: For smooth stopping
     /** The final frame of the current fade-out; -1 if no active fade-out */
-    Sint64 _outmark;
+    std::atomic<Sint64> _outmark;
     /** The current fade-out in frames; 0 if no active fade-out */
-    Uint64 _fadeout;
+    std::atomic<Uint64> _fadeout;
     /** Whether we have completed this node due to a fadeout */
-    bool   _outdone;
+    std::atomic<bool> _outdone;
     /** Whether to persist fade-out on a reset */
-    bool   _outkeep;
+    std::atomic<bool> _outkeep;
     
     // Fade-dip: For smooth pausing
     /** The current fade-dip in frames; 0 if no active fade-dip */
     Uint64 _fadedip;
     /** The middle (pause) frame of the fade-dip; -1 if no active fade-dip */
-    Sint64 _dipmark;
+    std::atomic<Sint64> _dipmark;
     /** The final (resume) frame of the fade-dip; 0 if no active fade-dip */
     Uint64 _dipstop;
     /** Whether we have completed the first half of a fade-dip */
-    bool   _diphalf;
-    /** To prevent a race condition on pausing */
-    bool   _dipstart;
+    std::atomic<bool> _diphalf;
+
+    /**
+     * Posts a fade request for the audio thread.
+     *
+     * The requests in drop are withdrawn before the requests in add are
+     * posted. This is how a later request (such as a change of position)
+     * cancels an earlier one that the audio thread has not yet seen. The
+     * parameters of a request must be stored before it is posted.
+     *
+     * @param drop  The pending requests to withdraw
+     * @param add   The requests to post
+     */
+    void request(Uint32 drop, Uint32 add);
+
+    /**
+     * Applies the pending fade requests.
+     *
+     * This method is called by {@link read} before it processes any audio.
+     * Cancellations are applied before new fades, so a request posted after
+     * a cancellation survives it.
+     *
+     * AUDIO THREAD ONLY: Users should never access this method directly.
+     * The only exception is when the user needs to create a custom subclass
+     * of this AudioNode.
+     */
+    void applyRequests();
+
+    /**
+     * Returns true if this node is in the first half of a fade-pause.
+     *
+     * This includes a fade-pause that has been requested but that the audio
+     * thread has not yet started.
+     *
+     * @return true if this node is in the first half of a fade-pause.
+     */
+    bool isDipping() const;
 
     /**
      * Performs a fade-in.
@@ -47,7 +47,9 @@
 #ifndef __CU_AUDIO_MIXER_H__
 #define __CU_AUDIO_MIXER_H__
 #include <cugl/audio/graph/CUAudioNode.h>
+#include <atomic>
 #include <mutex>
+#include <vector>
 
 namespace cugl {
 
@@ -78,14 +80,42 @@ namespace cugl {
  * The audio graph should only be accessed in the main thread.  In addition,
  * no methods marked as AUDIO THREAD ONLY should ever be accessed by the user.
  *
+ * The audio thread never blocks on this mixer. Changes to the inputs (via
+ * {@link #attach}, {@link #detach} or {@link #setWidth}) build a new input
+ * list, which the audio thread picks up at the start of its next read. Old
+ * lists, and any inputs they held, are released on the main thread once no
+ * reader can still see them. As a consequence, the delegated methods (such as
+ * {@link #reset}) are applied to each input in turn, and a read may happen
+ * in between two of the inputs.
+ *
  * This class does not support any actions for the {@link AudioNode#setCallback}.
  */
 class AudioMixer : public AudioNode {
 private:
-    /** The input nodes to be mixed */
+    /**
+     * An immutable snapshot of the mixer inputs
+     *
+     * The audio thread only ever reads the raw pointers of these nodes, so it
+     * never touches a reference count or destroys a node.
+     */
+    class InputList {
+    public:
+        /** The input nodes, one per slot */
+        std::vector<std::shared_ptr<AudioNode>> nodes;
+    };
+    
+    /** The input nodes to be mixed (main thread copy) */
     std::shared_ptr<AudioNode>* _inputs;
     /** The number of input nodes supported by this mixer */
     Uint8 _width;
+    /** The input list of an uninitialized mixer (never released) */
+    InputList _empty;
+    /** The input list visible to readers */
+    std::atomic<InputList*> _active;
+    /** The number of readers currently using an input list */
+    mutable std::atomic<Uint32> _readers;
+    /** The replaced input lists waiting to be released */
+    std::vector<InputList*> _retired;
 
     /** The intermediate buffer for the mixed result. Its size is determined by _readsize. */
     float* _buffer;
@@ -93,7 +123,7 @@ private:
     /** The knee value for clamping */
     std::atomic<float>  _knee;
 
-    /** This class needs a proper lock guard; too many race conditions */
+    /** Serializes changes to the inputs (never taken by the audio thread) */
     std::mutex _mutex;
     /** The current read position */
     std::atomic<Uint64> _offset;
@@ -105,6 +135,36 @@ private:
      */
     void allocateBuffer();
     
+    /**
+     * Publishes the current inputs as a new input list for the readers.
+     *
+     * The previous list is retired, and released once there are no readers.
+     * This method must be called while holding the mutex.
+     */
+    void publish();
+    
+    /**
+     * Releases any retired input lists if there are no active readers.
+     *
+     * This method must be called while holding the mutex.
+     */
+    void reclaim();
+    
+    /**
+     * Returns the current input list, registering this caller as a reader.
+     *
+     * This method never blocks, and may be called from any thread. Every
+     * call must be balanced by a call to {@link #release}.
+     *
+     * @return the current input list
+     */
+    InputList* acquire() const;
+    
+    /**
+     * Unregisters a reader previously registered by {@link #acquire}.
+     */
+    void release() const;
+    
 public:
 #pragma mark Constructors
     /** The default number of inputs supported (typically 8) */
@@ -309,13 +369,16 @@ public:
     /**
      * Sets the width of this mixer.
      *
-     * The width is the number of supported input slots. This method will only
-     * succeed if the mixer is paused.  Otherwise, it will fail.
+     * The width is the number of supported input slots. This method is safe
+     * to call while the mixer is playing, as the audio thread picks up the
+     * new width at the start of its next read.
      *
      * Once the width is adjusted, the children will be reassigned in order.
      * If the new width is less than the old width, children at the end of
      * the mixer will be dropped.
      *
+     * @param width The number of input slots
+     *
      * @return true if the mixer width was reset
      */
     bool setWidth(Uint8 width);
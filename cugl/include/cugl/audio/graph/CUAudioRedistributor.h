@@ -51,7 +51,6 @@
 #define __CU_AUDIO_REDISTRIBUTOR_H__
 #include <SDL.h>
 #include <cugl/audio/graph/CUAudioNode.h>
-#include <mutex>
 
 namespace cugl {
 
@@ -86,14 +85,34 @@ namespace cugl {
  */
 class AudioRedistributor : public AudioNode {
 private:
-    /** Mutex to protect more sophisticated synchronization */
-    mutable std::mutex _buffmtex;
+    /**
+     * A change of input channels, posted by the main thread
+     *
+     * The matrix is paired with its number of input channels, so that the
+     * audio thread never applies a matrix with the wrong dimensions.
+     */
+    struct Request {
+        /** The number of input channels */
+        Uint8 conduits;
+        /** The redistribution matrix (nullptr for the default algorithm) */
+        float* matrix;
+    };
 
     /** The audio input node */
     std::shared_ptr<AudioNode> _input;
     /** The currently supported input channels size */
     std::atomic<Uint8> _conduits;
 
+    // Requests: posted by the main thread, applied by the audio thread
+    /** The change of input channels not yet applied (may be nullptr) */
+    std::atomic<Request*> _request;
+    /** Whether the intermediate buffer must be resized */
+    std::atomic<bool> _resize;
+    /** The matrix of the most recent request (may be nullptr) */
+    float* _posted;
+    /** The input channels of the active distribution (AUDIO THREAD ONLY) */
+    Uint8 _columns;
+
     /** The distribution function for default behavior */
     std::function<void(const float*, float*, size_t)> _director;
     
@@ -151,6 +170,27 @@ private:
      * Allocates the intermediate buffer for downscaling
      */
     void allocateBuffer();
+
+    /**
+     * Posts a change of input channels for the audio thread.
+     *
+     * If matrix is nullptr, the redistributor will use the default algorithm
+     * for the given number of channels. Otherwise, the matrix is copied. Any
+     * earlier request that the audio thread has not yet applied is discarded.
+     *
+     * @param number    The number of input channels
+     * @param matrix    The redistribution matrix (or nullptr)
+     */
+    void post(Uint8 number, const float* matrix);
+
+    /**
+     * Applies the pending change of input channels.
+     *
+     * This method is called by {@link read} before it processes any audio.
+     *
+     * AUDIO THREAD ONLY: Users should never access this method directly.
+     */
+    void applyRequests();
     
 public:
 #pragma mark -
@@ -487,6 +527,9 @@ public:
      * The buffer should have enough room to store frames * channels elements.
      * The channels are interleaved into the output buffer.
      *
+     * This method never waits on the main thread. Changes to the input
+     * channels or the matrix are applied at the start of the next call.
+     *
      * This method will always forward the read position after reading. Reading
      * again may return different data.
      *
@@ -43,7 +43,6 @@
 #define __CU_AUDIO_RESAMPLER_H__
 #include <cugl/audio/graph/CUAudioNode.h>
 #include <SDL.h>
-#include <mutex>
 #include <atomic>
 
 namespace cugl {
@@ -87,8 +86,9 @@ namespace cugl {
  */
 class AudioResampler : public AudioNode {
 private:
-    /** Mutex to protect more sophisticated synchronization */
-    mutable std::mutex _buffmtex;
+    // Requests: posted by the main thread, applied by the audio thread
+    /** The requests not yet applied by the audio thread (a bitmask) */
+    std::atomic<Uint32> _pending;
 
     /** The input node to resample from */
     std::shared_ptr<AudioNode> _input;
@@ -103,6 +103,8 @@ private:
     std::atomic<float> _stopband;
     /** The number of samples per zero crossing */
     Uint32 _per_crossing;
+    /** The zero crossings of the current filter table (the buffer padding) */
+    Uint32 _padding;
 
     /** The filter (table) size */
     size_t _filter_size;
@@ -135,8 +137,6 @@ private:
     Uint32 _pagesize;
     /** The current input time */
     double _intime;
-    /** The marked input time */
-    double _mktime;
     
 public:
 #pragma mark -
@@ -473,6 +473,9 @@ public:
      * The buffer should have enough room to store frames * channels elements.
      * The channels are interleaved into the output buffer.
      *
+     * This method never waits on the main thread. Changes to the filter or
+     * the read position are applied at the start of the next call.
+     *
      * This method will always forward the read position.
      *
      * @param buffer    The read buffer to store the results
@@ -659,6 +662,30 @@ public:
     virtual double setRemaining(double time) override;
     
 private:
+#pragma mark -
+#pragma mark Filter Requests
+    /**
+     * Posts a request for the audio thread.
+     *
+     * The audio thread applies all pending requests at the start of its
+     * next {@link read}. The parameters of a request must be stored before
+     * it is posted.
+     *
+     * @param add   The requests to post
+     */
+    void request(Uint32 add);
+
+    /**
+     * Applies the pending requests.
+     *
+     * This method is called by {@link read} before it processes any audio.
+     * A new filter or buffer discards any buffered input, as does a change
+     * of position in the input node.
+     *
+     * AUDIO THREAD ONLY: Users should never access this method directly.
+     */
+    void applyRequests();
+
 #pragma mark -
 #pragma mark Filter Algorithm
     /**
@@ -79,7 +79,7 @@ private:
     /** The audio input node */
     std::shared_ptr<AudioNode> _input;
     
-    /** This class needs a proper lock guard; too many race conditions */
+    /** Serializes the main thread changes to the input (never locked by read) */
     std::mutex _mutex;
     
     /** The (projected) overhead of reading the audio graph */
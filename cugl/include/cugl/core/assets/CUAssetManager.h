@@ -94,6 +94,8 @@ protected:
     std::unordered_map<std::string,Uint32> _priority;
     /** The central thread for managing all of the loaders */
     std::shared_ptr<ThreadPool> _workers;
+    /** The threads for decoding assets in parallel (may be null) */
+    std::shared_ptr<ThreadPool> _decoders;
 
     /** State variable to manage reading JSON directories */
     bool _preload;
@@ -218,9 +220,37 @@ public:
      * This initializer does not attach any loaders.  It simply creates an 
      * object that is ready to accept loader objects.
      *
+     * Loaders with a thread-safe decode stage (such as textures) may also
+     * decode assets in parallel on a separate pool of decoder threads. This
+     * initializer leaves one core for the main thread, and creates at most
+     * 4 decoders. A single core device has no decoder pool.
+     *
      * @return true if the asset manager was initialized successfully
      */
     bool init();
+    
+    /**
+     * Initializes a new asset manager with the given number of decoders.
+     *
+     * The asset manager has a single thread, as some of the asset loading
+     * operations (particularly fonts) cannot be run in multiple threads
+     * simultaneously. However, it will run in a distinct thread from the
+     * main application.
+     *
+     * Loaders with a thread-safe decode stage (such as textures) may also
+     * decode assets in parallel on a separate pool of decoder threads. The
+     * results are still finished (e.g. uploaded to OpenGL) on the main
+     * thread. If decoders is 0, there is no decoder pool and all decoding
+     * happens on the single loader thread.
+     *
+     * This initializer does not attach any loaders.  It simply creates an
+     * object that is ready to accept loader objects.
+     *
+     * @param decoders  The number of decoder threads
+     *
+     * @return true if the asset manager was initialized successfully
+     */
+    bool init(Uint32 decoders);
 
     
 #pragma mark -
@@ -243,6 +273,44 @@ public:
         std::shared_ptr<AssetManager> result = std::make_shared<AssetManager>();
         return (result->init() ? result : nullptr);
     }
+    
+    /**
+     * Returns a newly allocated asset manager with the given number of decoders.
+     *
+     * The asset manager has a single thread, as some of the asset loading
+     * operations (particularly fonts) cannot be run in multiple threads
+     * simultaneously. However, it will run in a distinct thread from the
+     * main application. In addition, confining to one thread allows us to
+     * handle dependencies between loaders.
+     *
+     * Loaders with a thread-safe decode stage (such as textures) may also
+     * decode assets in parallel on a separate pool of decoder threads. The
+     * results are still finished (e.g. uploaded to OpenGL) on the main
+     * thread. If decoders is 0, there is no decoder pool and all decoding
+     * happens on the single loader thread.
+     *
+     * This constructor does not attach any loaders.  It simply creates an
+     * object that is ready to accept loader objects.
+     *
+     * @param decoders  The number of decoder threads
+     *
+     * @return a newly allocated asset manager.
+     */
+    static std::shared_ptr<AssetManager> alloc(Uint32 decoders) {
+        std::shared_ptr<AssetManager> result = std::make_shared<AssetManager>();
+        return (result->init(decoders) ? result : nullptr);
+    }
+    
+    /**
+     * Returns the number of threads for decoding assets in parallel.
+     *
+     * If this value is 0, all decoding happens on the single loader thread.
+     *
+     * @return the number of threads for decoding assets in parallel.
+     */
+    Uint32 getDecoderCount() const {
+        return _decoders == nullptr ? 0 : (Uint32)_decoders->getThreadCount();
+    }
 
 #pragma mark -
 #pragma mark Loader Management
@@ -274,6 +342,7 @@ public:
         }
         
         loader->setThreadPool(_workers);
+        loader->setDecoderPool(_decoders);
         _handlers[hash] = loader;
         
         // Do not allow key collisions
@@ -322,6 +391,7 @@ public:
             return false;
         }
         it->second->setThreadPool(nullptr);
+        it->second->setDecoderPool(nullptr);
         
         std::string key = it->second->getJsonKey();
         it->second = nullptr;
@@ -341,6 +411,8 @@ public:
      */
     void detachAll() {
         for(auto it = _handlers.begin(); it != _handlers.end(); ++it) {
+            it->second->setThreadPool(nullptr);
+            it->second->setDecoderPool(nullptr);
             it->second = nullptr;
         }
         _handlers.clear();
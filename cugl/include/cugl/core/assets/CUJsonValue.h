@@ -4,8 +4,12 @@
 //
 //  This module a modern C++ alternative to the CUJSON interface for reading
 //  JSON files.  In particular, this gives us better type-checking and memory
-//  management.  With that said, it still uses CUJSON as the underlying parsing
-//  engine.
+//  management.  Parsing is done in a single pass directly into the JsonValue
+//  tree, with the nodes allocated from an arena. CUJSON is only used to
+//  serialize the tree back to a string.
+//
+//  Trees may also be encoded as compiled JSON, a compact binary format that
+//  can be decoded without any string parsing.
 //
 //  This class uses our standard shared-pointer architecture.
 //
@@ -47,6 +51,8 @@
 #include <cugl/core/assets/CUJSON.h>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <cstddef>
 
 namespace cugl {
 
@@ -62,9 +68,18 @@ namespace cugl {
  * if the node is an object type.  Hence the main usage of this feature is to
  * "cast" object nodes to arrays.
  *
- * This class uses CUJSON as the underlying parsing engine.  However, it manages
- * memory automatically so that the user does not need to worry about deleting
- * or allocating memory beyond the initial node itself.
+ * Objects with many children keep an index of their keys (sorted by hash).
+ * So looking up a child by key is logarithmic instead of linear in the number
+ * of children. The lookup methods take a std::string_view, so that keys do
+ * not need to be copied.
+ *
+ * This class has its own single-pass parser, and uses CUJSON only to convert
+ * a tree back to a string.  It manages memory automatically so that the user
+ * does not need to worry about deleting or allocating memory beyond the
+ * initial node itself.
+ *
+ * Trees may also be converted to and from compiled JSON, a compact binary
+ * encoding that is much faster to load than text. See {@link #toBinary}.
  */
 class JsonValue {
 public:
@@ -108,6 +123,8 @@ public:
     
     /** The children of this node (only non-empty if array or object) */
     std::vector<std::shared_ptr<JsonValue>> _children;
+    /** The (key hash, child position) pairs sorted by hash (only for large objects) */
+    std::vector<std::pair<size_t,Uint32>> _index;
 
 #pragma mark -
 #pragma mark CUJSON Conversions
@@ -152,7 +169,43 @@ public:
      * @param value The JsonValue to convert
      */
     static CUJSON* toCUJSON(const JsonValue* value);
-    
+
+#pragma mark -
+#pragma mark Key Index
+    /**
+     * Rebuilds the key index of this node.
+     *
+     * Objects with many children keep a table of key hashes sorted by hash,
+     * so that lookup by key does not need to compare every key. This method
+     * rebuilds that table, or clears it if this node is not a large object.
+     * It must be called whenever the children or their keys change, including
+     * a key change of a child that has since moved to another parent.
+     *
+     * The index is maintained on change (and not built lazily on lookup) so
+     * that it is safe for multiple threads to read the same tree. As the
+     * children are public, lookups still check each index entry against the
+     * children, and fall back to a linear search if the index is out of date.
+     */
+    void reindex();
+
+    /**
+     * Adds the last child of this node to the key index.
+     *
+     * This is an optimization of {@link #reindex} for appending a child.
+     */
+    void reindexLast();
+
+    /**
+     * Returns the position of the first child with the given key.
+     *
+     * If there is no child with that key, this method returns -1.
+     *
+     * @param key   The key identifying the child
+     *
+     * @return the position of the first child with the given key.
+     */
+    int search(std::string_view key) const;
+
 #pragma mark -
 #pragma mark Constructors
 public:
@@ -264,6 +317,10 @@ public:
      * node will be deleted when this node is deleted (provided there are
      * no other references).
      *
+     * The descendants of this node are allocated together from a memory
+     * arena. The arena is not released until all of them are deleted. So
+     * keeping a small subtree of a large file keeps the whole tree in memory.
+     *
      * If there is a parsing error, this  method will return false.  Detailed 
      * information about the parsing error will be passed to an assert.  Hence
      * error messages are suppressed if asserts are turned off.
@@ -274,6 +331,29 @@ public:
      */
     bool initWithJson(const std::string json);
 
+    /**
+     * Initializes a new JsonValue from the given compiled JSON.
+     *
+     * Compiled JSON is a compact binary encoding of a JSON tree, produced by
+     * {@link #toBinary}. Decoding it requires no string parsing. Strings and
+     * keys are copied by length and numbers are read directly, so this is much
+     * faster than {@link #initWithJson} for large files (such as scene graphs).
+     *
+     * As with {@link #initWithJson}, the descendants of this node are allocated
+     * together from a memory arena.
+     *
+     * If the data is not valid compiled JSON, this method will return false.
+     * This includes any data after the root value. Detailed information about
+     * the error will be passed to an assert. Hence error messages are
+     * suppressed if asserts are turned off.
+     *
+     * @param data  The compiled JSON
+     * @param size  The number of bytes of compiled JSON
+     *
+     * @return  true if the JSON node is initialized properly, false otherwise.
+     */
+    bool initWithBinary(const std::byte* data, size_t size);
+
     
 #pragma mark -
 #pragma mark Static Constructors
@@ -393,6 +473,10 @@ public:
      * node will be deleted when this node is deleted (provided there are
      * no other references).
      *
+     * The descendants of this node are allocated together from a memory
+     * arena. The arena is not released until all of them are deleted. So
+     * keeping a small subtree of a large file keeps the whole tree in memory.
+     *
      * If there is a parsing error, this  method will return nullptr.  Detailed
      * information about the parsing error will be passed to an assert.  Hence
      * error messages are suppressed if asserts are turned off.
@@ -406,6 +490,32 @@ public:
         return (result->initWithJson(json) ? result : nullptr);
     }
 
+    /**
+     * Returns a newly allocated JsonValue from the given compiled JSON.
+     *
+     * Compiled JSON is a compact binary encoding of a JSON tree, produced by
+     * {@link #toBinary}. Decoding it requires no string parsing. Strings and
+     * keys are copied by length and numbers are read directly, so this is much
+     * faster than {@link #allocWithJson} for large files (such as scene graphs).
+     *
+     * As with {@link #allocWithJson}, the descendants of this node are
+     * allocated together from a memory arena.
+     *
+     * If the data is not valid compiled JSON, this method will return nullptr.
+     * This includes any data after the root value. Detailed information about
+     * the error will be passed to an assert. Hence error messages are
+     * suppressed if asserts are turned off.
+     *
+     * @param data  The compiled JSON
+     * @param size  The number of bytes of compiled JSON
+     *
+     * @return a newly allocated JsonValue from the given compiled JSON.
+     */
+    static std::shared_ptr<JsonValue> allocWithBinary(const std::byte* data, size_t size) {
+        std::shared_ptr<JsonValue> result = std::make_shared<JsonValue>();
+        return (result->initWithBinary(data,size) ? result : nullptr);
+    }
+
     
 #pragma mark -
 #pragma mark Type
@@ -733,7 +843,7 @@ public:
      *
      * @return true if a child with the specified name exists.
      */
-    bool has(const std::string name) const;
+    bool has(std::string_view name) const;
 
     /**
      * Returns the child at the specified index. 
@@ -771,7 +881,7 @@ public:
      *
      * @return the child with the specified key.
      */
-    std::shared_ptr<JsonValue> get(const std::string name);
+    std::shared_ptr<JsonValue> get(std::string_view name);
     
     /**
      * Returns the child with the specified key.
@@ -785,7 +895,7 @@ public:
      *
      * @return the child with the specified key.
      */
-    const std::shared_ptr<JsonValue> get(const std::string name) const;
+    const std::shared_ptr<JsonValue> get(std::string_view name) const;
     
     
 #pragma mark -
@@ -804,7 +914,7 @@ public:
      *
      * @return the string value of the child with the specified key.
      */
-    const std::string getString (const std::string key, const std::string defaultValue="") const;
+    const std::string getString (std::string_view key, const std::string defaultValue="") const;
     
     /**
      * Returns the float value of the child with the specified key.
@@ -820,7 +930,7 @@ public:
      *
      * @return the float value of the child with the specified key.
      */
-    float getFloat(const std::string key, float defaultValue=0.0f) const;
+    float getFloat(std::string_view key, float defaultValue=0.0f) const;
     
     /**
      * Returns the double value of the child with the specified key.
@@ -836,7 +946,7 @@ public:
      *
      * @return the double value of the child with the specified key.
      */
-    double getDouble(const std::string key, double defaultValue=0.0) const;
+    double getDouble(std::string_view key, double defaultValue=0.0) const;
     
     /**
      * Returns the long value of the child with the specified key.
@@ -852,7 +962,7 @@ public:
      *
      * @return the long value of the child with the specified key.
      */
-    long getLong(const std::string key, long defaultValue=0L) const;
+    long getLong(std::string_view key, long defaultValue=0L) const;
     
     /**
      * Returns the int value of the child with the specified key.
@@ -868,7 +978,7 @@ public:
      *
      * @return the int value of the child with the specified key.
      */
-    int getInt(const std::string key, int defaultValue=0) const;
+    int getInt(std::string_view key, int defaultValue=0) const;
     
     /**
      * Returns the boolean value of the child with the specified key.
@@ -884,7 +994,7 @@ public:
      *
      * @return the boolean value of the child with the specified key.
      */
-    bool getBool(const std::string key, bool defaultValue=false) const;
+    bool getBool(std::string_view key, bool defaultValue=false) const;
     
 #pragma mark -
 #pragma mark Child Deletion
@@ -914,7 +1024,7 @@ public:
      *
      * Returns the child with the specified key and removes it from this node.
      */
-    std::shared_ptr<JsonValue> removeChild(const std::string name);
+    std::shared_ptr<JsonValue> removeChild(std::string_view name);
     
         
 #pragma mark -
@@ -1471,6 +1581,22 @@ public:
      */
     std::string toString(bool format=true) const;
 
+    /**
+     * Returns the compiled JSON encoding of this JSON.
+     *
+     * Compiled JSON is a compact binary encoding of a JSON tree. It is a four
+     * byte magic number "CUBJ" and a version byte, followed by the root value.
+     * Each value is a one byte tag followed by its contents. Lengths, counts,
+     * and integers are variable length (LEB128), while other numbers are stored
+     * as doubles in network order. Object keys precede each child.
+     *
+     * Providing this encoding to the {@link allocWithBinary} constructor is
+     * guaranteed to make a duplicate of this JSON tree.
+     *
+     * @return the compiled JSON encoding of this JSON.
+     */
+    std::vector<std::byte> toBinary() const;
+
 };
 
 }
@@ -111,6 +111,16 @@ protected:
      */
     std::shared_ptr<ThreadPool> _loader;
     
+    /**
+     * The thread pool for decoding assets in parallel (may be null)
+     *
+     * Unlike the loader thread, these threads carry no ordering guarantees.
+     * Only loaders whose decode stage is thread-safe (e.g. images) should
+     * use them. If this value is nullptr, decoding happens on the loader
+     * thread.
+     */
+    std::shared_ptr<ThreadPool> _decoders;
+    
     /**
      * The parent asset manager for this loader (may be null)
      *
@@ -332,6 +342,35 @@ public:
         _loader = threads;
     }
     
+    /**
+     * Returns the thread pool for decoding assets in parallel
+     *
+     * Unlike the loader thread pool, these threads carry no ordering
+     * guarantees. Loaders whose decode stage is thread-safe (e.g. images)
+     * use them to decode several assets at once, before finishing each
+     * asset on the main thread. Other loaders ignore this value.
+     *
+     * @return the thread pool for decoding assets in parallel
+     */
+    std::shared_ptr<ThreadPool> getDecoderPool() const { return _decoders; }
+    
+    /**
+     * Sets the thread pool for decoding assets in parallel
+     *
+     * Unlike the loader thread pool, these threads carry no ordering
+     * guarantees. Loaders whose decode stage is thread-safe (e.g. images)
+     * use them to decode several assets at once, before finishing each
+     * asset on the main thread. Other loaders ignore this value.
+     *
+     * If this value is nullptr, all decoding happens in the loader thread
+     * (for asynchronous loads) or the calling thread (for synchronous loads).
+     *
+     * @param threads   The thread pool for decoding assets in parallel
+     */
+    void setDecoderPool(const std::shared_ptr<ThreadPool>& threads) {
+        _decoders = threads;
+    }
+    
     /**
      * Sets the asset manager for this loader.
      *
@@ -469,6 +508,30 @@ public:
         return read(json,nullptr,false);
     }
     
+    /**
+     * Synchronously loads all of the assets in the given JSON category.
+     *
+     * The JSON value should be the child of an asset directory for the
+     * JSON key of this loader. Each child of that value is loaded as
+     * with {@link #load}. The main CUGL thread will block until loading
+     * is complete.
+     *
+     * By default, this method loads the assets one at a time. Loaders with
+     * a thread-safe decode stage may override this method to decode the
+     * assets in parallel with the decoder pool.
+     *
+     * @param json      The asset directory entries for this loader
+     *
+     * @return true if all of the assets were successfully loaded
+     */
+    virtual bool loadCategory(const std::shared_ptr<JsonValue>& json) {
+        bool success = true;
+        for(size_t ii = 0; ii < json->size(); ii++) {
+            success = load(json->get((int)ii)) && success;
+        }
+        return success;
+    }
+    
     /**
      * Asynchronously loads the given asset with the specified key.
      *
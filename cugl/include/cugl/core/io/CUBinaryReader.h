@@ -17,6 +17,10 @@
 //  have proper file systems.  You should confine all files to either the asset
 //  or the save directory.
 //
+//  A reader may optionally memory map its file instead of reading it in chunks.
+//  In that case all reads are simple pointer arithmetic on the mapped file.
+//  Files that cannot be mapped (such as Android assets) fall back to chunks.
+//
 //  This class uses our standard shared-pointer architecture.
 //
 //  1. The constructor does not perform any initialization; it just sets all
@@ -57,6 +61,9 @@
 
 namespace cugl {
 
+/** Forward reference to a JSON tree */
+class JsonValue;
+
 /**
  * Simple cross-platform reader for binary files.
  *
@@ -94,6 +101,8 @@ protected:
     Uint32      _bufsize;
     /** The current offset in the read buffer */
     Sint32      _bufoff;
+    /** Whether the buffer is a memory mapping of the entire file */
+    bool        _mapped;
     
 #pragma mark -
 #pragma mark Internal Methods
@@ -106,7 +115,34 @@ protected:
      * @param bytes The minimum number of bytes to ensure in the stream
      */
     void fill(unsigned int bytes=1);
-    
+
+    /**
+     * Maps the file for this reader into memory.
+     *
+     * On success, the buffer is the mapped file and there is no SDL stream.
+     * This method fails if the file cannot be mapped, or if it is too large
+     * to be indexed by the buffer offset.
+     *
+     * @return true if the file was successfully mapped
+     */
+    bool map();
+
+    /**
+     * Reads a sequence of marshalled values from the stream.
+     *
+     * This is the shared implementation of the typed array reads. Elements are
+     * copied and marshalled in a single pass over each buffered chunk, which
+     * allows the compiler to vectorize the byte swaps. When the file is memory
+     * mapped, the entire read is one such pass.
+     *
+     * @param buffer    The array to store the data when read
+     * @param maximum   The maximum number of elements to read from the stream
+     * @param offset    The offset to start in the buffer array
+     *
+     * @return the number of elements read from the stream
+     */
+    template <typename T>
+    size_t readArray(T* buffer, size_t maximum, size_t offset);
     
 #pragma mark -
 #pragma mark Constructors
@@ -118,7 +154,8 @@ public:
      * the heap, use one of the static constructors instead.
      */
     BinaryReader() : _name(""), _stream(nullptr), _ssize(-1), _scursor(-1),
-                     _buffer(nullptr), _capacity(0), _bufoff(-1), _bufsize(0) {}
+                     _buffer(nullptr), _capacity(0), _bufoff(-1), _bufsize(0),
+                     _mapped(false) {}
     
     /**
      * Deletes this reader and all of its resources.
@@ -188,7 +225,45 @@ public:
      * @return true if the reader is initialized properly, false otherwise.
      */
     bool initWithAsset(const std::string file, unsigned int capacity);
-    
+
+    /**
+     * Initializes a reader that memory maps the given file.
+     *
+     * Mapping the file removes the chunked reads from the file. All reads are
+     * performed directly on the mapped memory. If the file cannot be mapped,
+     * this reader falls back to reading the file in chunks with the default
+     * buffer capacity. Use {@link #isMapped} to distinguish the two cases.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initWithMapping(const std::string file);
+
+    /**
+     * Initializes a reader that memory maps the given asset file.
+     *
+     * Mapping the file removes the chunked reads from the file. All reads are
+     * performed directly on the mapped memory. If the file cannot be mapped
+     * (which is always the case for Android assets), this reader falls back
+     * to reading the file in chunks with the default buffer capacity. Use
+     * {@link #isMapped} to distinguish the two cases.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initWithMappedAsset(const std::string file);
+
     
 #pragma mark -
 #pragma mark Static Constructors
@@ -266,6 +341,50 @@ public:
         std::shared_ptr<BinaryReader> result = std::make_shared<BinaryReader>();
         return (result->initWithAsset(file,capacity) ? result : nullptr);
     }
+
+    /**
+     * Returns a newly allocated reader that memory maps the given file.
+     *
+     * Mapping the file removes the chunked reads from the file. All reads are
+     * performed directly on the mapped memory. If the file cannot be mapped,
+     * this reader falls back to reading the file in chunks with the default
+     * buffer capacity. Use {@link #isMapped} to distinguish the two cases.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated reader that memory maps the given file.
+     */
+    static std::shared_ptr<BinaryReader> allocWithMapping(const std::string file) {
+        std::shared_ptr<BinaryReader> result = std::make_shared<BinaryReader>();
+        return (result->initWithMapping(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated reader that memory maps the given asset file.
+     *
+     * Mapping the file removes the chunked reads from the file. All reads are
+     * performed directly on the mapped memory. If the file cannot be mapped
+     * (which is always the case for Android assets), this reader falls back
+     * to reading the file in chunks with the default buffer capacity. Use
+     * {@link #isMapped} to distinguish the two cases.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return a newly allocated reader that memory maps the given asset file.
+     */
+    static std::shared_ptr<BinaryReader> allocWithMappedAsset(const std::string file) {
+        std::shared_ptr<BinaryReader> result = std::make_shared<BinaryReader>();
+        return (result->initWithMappedAsset(file) ? result : nullptr);
+    }
     
     
 #pragma mark -
@@ -297,6 +416,16 @@ public:
      * @return true if there is enough data left to read
      */
     bool ready(unsigned int bytes=1) const;
+
+    /**
+     * Returns true if this reader memory maps its file.
+     *
+     * A reader created with {@link #initWithMapping} may still read its file
+     * in chunks if the file could not be mapped.
+     *
+     * @return true if this reader memory maps its file.
+     */
+    bool isMapped() const { return _mapped; }
     
     
 #pragma mark -
@@ -561,6 +690,24 @@ public:
      * @return the number of doubles read from the stream
      */
     size_t read(double* buffer, size_t maximum, size_t offset=0);
+
+#pragma mark -
+#pragma mark JSON Reads
+    /**
+     * Returns a JSON tree decoded from the rest of the stream.
+     *
+     * The stream must contain compiled JSON, as produced by either
+     * {@link JsonValue#toBinary} or {@link BinaryWriter#writeJson}. This method
+     * consumes the remainder of the stream, so the compiled JSON must come last.
+     *
+     * When the file is memory mapped, the JSON is decoded directly from the
+     * mapped file without any intermediate copies. Either way, no string parsing
+     * is required. This method returns nullptr if the data is not valid.
+     *
+     * @return a JSON tree decoded from the rest of the stream.
+     */
+    std::shared_ptr<JsonValue> readJson();
+
 };
 
 }
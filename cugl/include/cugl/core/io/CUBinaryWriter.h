@@ -17,6 +17,10 @@
 //  have proper file systems.  You should confine all files to either the asset
 //  or the save directory.
 //
+//  Array writes marshall directly into the write buffer, and the buffer may
+//  optionally be flushed by a background thread. For large dumps, a capacity
+//  much larger than the default is recommended.
+//
 //  This class uses our standard shared-pointer architecture.
 //
 //  1. The constructor does not perform any initialization; it just sets all
@@ -56,7 +60,12 @@
 #include <string>
 
 namespace cugl {
-    
+
+/** Forward reference to the background flushing thread */
+class BinaryFlusher;
+/** Forward reference to a JSON tree */
+class JsonValue;
+
 /**
  * Simple cross-platform writer for binary files.
  *
@@ -88,6 +97,33 @@ protected:
     Uint32      _capacity;
     /** The current offset in the writer buffer */
     Sint32      _bufoff;
+    /** The background flushing thread (nullptr if synchronous) */
+    BinaryFlusher* _flusher;
+
+#pragma mark -
+#pragma mark Internal Methods
+    /**
+     * Empties the write buffer so that it can receive more data.
+     *
+     * In synchronous mode this is the same as {@link #flush}. In asynchronous
+     * mode the full buffer is handed to the background thread, and writing
+     * continues in a second buffer while the first is written to the file.
+     */
+    void spill();
+
+    /**
+     * Writes an array of marshalled values to the binary file.
+     *
+     * This is the shared implementation of the typed array writes. Values are
+     * marshalled straight into the write buffer in a single pass per buffer,
+     * which allows the compiler to vectorize the byte swaps.
+     *
+     * @param array  the array of values to write
+     * @param length the number of values to write
+     * @param offset the initial offset into the array
+     */
+    template <typename T>
+    void writeArray(const T* array, size_t length, size_t offset);
 
     
 #pragma mark -
@@ -99,7 +135,8 @@ public:
      * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
      * the heap, use one of the static constructors instead.
      */
-    BinaryWriter() : _name(""), _stream(nullptr), _cbuffer(nullptr), _bufoff(-1) {}
+    BinaryWriter() : _name(""), _stream(nullptr), _cbuffer(nullptr), _bufoff(-1),
+                     _flusher(nullptr) {}
     
     /**
      * Deletes this writer and all of its resources.
@@ -192,10 +229,11 @@ public:
      * Flushes the contents of the write buffer to the file.
      *
      * It is usually unnecessary to call this method. It is called automatically
-     * when the buffer fills, or just before the file is closed.
+     * when the buffer fills, or just before the file is closed. In asynchronous
+     * mode, this method waits for the background thread to finish as well.
      */
     void flush();
-    
+
     /**
      * Closes the stream, releasing all resources
      *
@@ -205,6 +243,34 @@ public:
      */
     void close();
 
+    /**
+     * Returns true if this writer flushes in a background thread.
+     *
+     * In asynchronous mode, a full buffer is written to the file by a background
+     * thread while this writer fills a second buffer. This is useful for large
+     * dumps (such as simulation traces) where the file system would otherwise
+     * stall the writing thread.
+     *
+     * @return true if this writer flushes in a background thread.
+     */
+    bool isAsync() const { return _flusher != nullptr; }
+
+    /**
+     * Sets whether this writer flushes in a background thread.
+     *
+     * In asynchronous mode, a full buffer is written to the file by a background
+     * thread while this writer fills a second buffer. This is useful for large
+     * dumps (such as simulation traces) where the file system would otherwise
+     * stall the writing thread. Asynchronous mode doubles the buffer memory.
+     *
+     * The writer itself is still not thread-safe. Only the flushing happens in
+     * another thread. Disabling asynchronous mode waits for any pending buffer
+     * to be written. This method has no effect on a closed stream.
+     *
+     * @param value Whether to flush in a background thread
+     */
+    void setAsync(bool value);
+
 
 #pragma mark -
 #pragma mark Single Element Writes
@@ -498,7 +564,25 @@ public:
      * @param offset the initial offset into the array
      */
     void write(const double* array, size_t length, size_t offset=0);
-    
+
+#pragma mark -
+#pragma mark JSON Writes
+    /**
+     * Writes the given JSON tree to the binary file as compiled JSON.
+     *
+     * Compiled JSON is a compact binary encoding that can be decoded without any
+     * string parsing. It can be read back with {@link BinaryReader#readJson} or
+     * {@link JsonValue#allocWithBinary}. As {@link BinaryReader#readJson} reads
+     * the remainder of a file, the JSON should be the last thing written.
+     *
+     * The data is written to the internal buffer, but is not necessarily
+     * flushed automatically.  It will be written when the buffer reaches
+     * capacity or the file is closed.
+     *
+     * @param json  the JSON tree to write
+     */
+    void writeJson(const std::shared_ptr<JsonValue>& json);
+
 };
 
 }
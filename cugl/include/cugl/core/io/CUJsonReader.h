@@ -6,6 +6,11 @@
 //  It does not require that the entire file conform to JSON standards; it can
 //  read a JSON string embedded in a larger text file.
 //
+//  In addition to reading a complete JSON tree, this module can stream a JSON
+//  value as a sequence of events (start/end of objects and arrays, keys, and
+//  values). Streaming reads the file in chunks, so its memory usage depends
+//  on the nesting depth, not the file size.
+//
 //  By default, this module (and every module in the io package) accesses the
 //  application save directory.  If you want to access another directory, you
 //  will need to specify an absolute path for the file name.  Keep in mind that
@@ -50,6 +55,8 @@
 #define __CU_JSON_READER_H__
 #include <cugl/core/io/CUTextReader.h>
 #include <cugl/core/assets/CUJsonValue.h>
+#include <functional>
+#include <vector>
 
 namespace  cugl {
 
@@ -60,6 +67,12 @@ namespace  cugl {
  * can read a JSON string embedded in a larger text file.  This allows for
  * maximum flexibility in encoding/decoding JSON data.
  *
+ * Large files (such as replays) should not be read with {@link #readJson},
+ * as that constructs the entire tree in memory. Instead, they can be streamed
+ * with {@link #readEvent} or {@link #streamJson}. These methods report the
+ * JSON value as a sequence of {@link Event} values, and only ever store a
+ * single key or value at a time.
+ *
  * By default, this class (and every class in the io package) accesses the
  * application save directory {@see Application#getSaveDirectory()}.  If you
  * want to access another directory, you will need to specify an absolute path
@@ -68,10 +81,164 @@ namespace  cugl {
  * confine all files to either the asset or the save directory.
  */
 class JsonReader : public TextReader {
+public:
+    /**
+     * This enum represents an event when streaming a JSON value.
+     *
+     * The events of a value are reported in document order. For example,
+     * the JSON {"a":[1,2]} is the sequence BEGIN_OBJECT, KEY, BEGIN_ARRAY,
+     * VALUE, VALUE, END_ARRAY, END_OBJECT, END.
+     */
+    enum class Event : int {
+        /** The current JSON value is complete (or there is no more input) */
+        END          = 0,
+        /** The start of an object; its members follow */
+        BEGIN_OBJECT = 1,
+        /** The end of the current object */
+        END_OBJECT   = 2,
+        /** The start of an array; its elements follow */
+        BEGIN_ARRAY  = 3,
+        /** The end of the current array */
+        END_ARRAY    = 4,
+        /** The key of an object member (see {@link #getEventKey}) */
+        KEY          = 5,
+        /** A string, number, boolean or null (see {@link #getEventValue}) */
+        VALUE        = 6,
+        /** The JSON is malformed; no further events are possible */
+        ERROR        = 7
+    };
+    
+    /**
+     * This type represents a handler for streamed JSON events.
+     *
+     * The handler is called once for each event of a JSON value (except
+     * the final END event). It may use the accessors of the reader to get
+     * the key or value of the event. The handler should return false to
+     * stop streaming early.
+     *
+     * The function type is equivalent to
+     *
+     *      std::function<bool(Event event)>
+     */
+    typedef std::function<bool(Event event)> EventHandler;
+    
+protected:
+    /** The state of the event stream */
+    enum class State : int {
+        /** Expecting the start of a JSON value */
+        START,
+        /** Expecting a value (after a colon or a comma in an array) */
+        VALUE,
+        /** Expecting the first element of an array, or its end */
+        FIRST_ITEM,
+        /** Expecting the first key of an object, or its end */
+        FIRST_KEY,
+        /** Expecting a key (after a comma in an object) */
+        KEY,
+        /** Expecting a comma, or the end of the enclosing array/object */
+        NEXT,
+        /** The JSON value is complete */
+        DONE,
+        /** The JSON value is malformed */
+        FAILED
+    };
+    
+    /** The state of the event stream */
+    State _state;
+    /** The enclosing arrays/objects of the current event ('[' or '{') */
+    std::vector<char> _scopes;
+    /** The key of the most recent KEY event */
+    std::string _eventKey;
+    /** The value of the most recent VALUE event */
+    JsonValue _eventValue;
+    /** A buffer for reading tokens */
+    std::string _token;
     
 #pragma mark -
-#pragma mark Static Constructors
+#pragma mark Event Parsing
+    /**
+     * Returns the next character of the stream without consuming it.
+     *
+     * This method refills the buffer as necessary. It returns -1 if there
+     * are no more characters in the stream.
+     *
+     * @return the next character of the stream without consuming it.
+     */
+    int peekChar();
+    
+    /**
+     * Returns the next non-whitespace character without consuming it.
+     *
+     * All whitespace before that character is consumed. This method returns
+     * -1 if there are no more characters in the stream.
+     *
+     * @return the next non-whitespace character without consuming it.
+     */
+    int peekToken();
+    
+    /**
+     * Returns the event for the value starting with the given character.
+     *
+     * @param c     The first character of the value
+     *
+     * @return the event for the value starting with the given character.
+     */
+    Event readValueEvent(int c);
+    
+    /**
+     * Returns the event for the key starting with the given character.
+     *
+     * This method consumes the colon after the key.
+     *
+     * @param c     The first character of the key
+     *
+     * @return the event for the key starting with the given character.
+     */
+    Event readKeyEvent(int c);
+    
+    /**
+     * Returns the event closing the current array or object.
+     *
+     * @param event The event to return (END_ARRAY or END_OBJECT)
+     *
+     * @return the event closing the current array or object.
+     */
+    Event closeScope(Event event);
+    
+    /**
+     * Returns the ERROR event, recording the given message.
+     *
+     * @param message   The error message
+     *
+     * @return the ERROR event
+     */
+    Event fail(const char* message);
+    
+    /**
+     * Reads a quoted JSON string into the given buffer.
+     *
+     * The stream must be positioned at the opening quote. All escape
+     * sequences are decoded.
+     *
+     * @param out   The buffer to store the string
+     *
+     * @return true if the string was read successfully
+     */
+    bool readQuoted(std::string& out);
+    
+#pragma mark -
+#pragma mark Constructors
 public:
+    /**
+     * Creates a JSON reader with no assigned file.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    JsonReader() : TextReader(), _state(State::START) {}
+    
+#pragma mark -
+#pragma mark Static Constructors
     /**
      * Returns a newly allocated reader for the given file.
      *
@@ -146,7 +313,51 @@ public:
         std::shared_ptr<JsonReader> result = std::make_shared<JsonReader>();
         return (result->initWithAsset(file,capacity) ? result : nullptr);
     }
-    
+
+    /**
+     * Returns a newly allocated reader that memory maps the given file.
+     *
+     * Mapping the file removes the chunked reads from the file. All reads are
+     * performed directly on the mapped memory. If the file cannot be mapped,
+     * this reader falls back to reading the file in chunks with the default
+     * buffer capacity. Use {@link #isMapped} to distinguish the two cases.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated reader that memory maps the given file.
+     */
+    static std::shared_ptr<JsonReader> allocWithMapping(const std::string file) {
+        std::shared_ptr<JsonReader> result = std::make_shared<JsonReader>();
+        return (result->initWithMapping(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated reader that memory maps the given asset file.
+     *
+     * Mapping the file removes the chunked reads from the file. All reads are
+     * performed directly on the mapped memory. If the file cannot be mapped
+     * (which is always the case for Android assets), this reader falls back
+     * to reading the file in chunks with the default buffer capacity. Use
+     * {@link #isMapped} to distinguish the two cases.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return a newly allocated reader that memory maps the given asset file.
+     */
+    static std::shared_ptr<JsonReader> allocWithMappedAsset(const std::string file) {
+        std::shared_ptr<JsonReader> result = std::make_shared<JsonReader>();
+        return (result->initWithMappedAsset(file) ? result : nullptr);
+    }
+
     
 #pragma mark -
 #pragma mark Read Methods
@@ -179,6 +390,79 @@ public:
      */
     std::shared_ptr<JsonValue> readJson();
     
+#pragma mark -
+#pragma mark Streaming
+    /**
+     * Returns the next event of the streamed JSON value.
+     *
+     * The first call starts a new JSON value at the current position. The
+     * value may be any JSON type, not just an object. Subsequent calls
+     * report the contents of that value in order. Once the value is complete,
+     * this method returns END, and the next call will start a new value. It
+     * also returns END if there is no more input.
+     *
+     * For KEY events, the key is available with {@link #getEventKey}. For
+     * VALUE events, the value is available with {@link #getEventValue}. Only
+     * the most recent key and value are stored, so memory usage is bounded
+     * by the nesting depth, not the file size.
+     *
+     * If the JSON is malformed, this method returns ERROR, and it will
+     * continue to do so until the reader is reset. Detailed information
+     * about the parsing error will be passed to an assert.  Hence error
+     * messages are suppressed if asserts are turned off.
+     *
+     * It is safe to mix this method with the other read methods, but only
+     * between JSON values (e.g. after an END event).
+     *
+     * @return the next event of the streamed JSON value.
+     */
+    Event readEvent();
+    
+    /**
+     * Streams the next JSON value to the given handler.
+     *
+     * This method calls {@link #readEvent} until the JSON value is complete,
+     * passing each event to the handler. The handler is not called for the
+     * final END event. Streaming stops early if the handler returns false.
+     *
+     * @param handler   The handler for each event
+     *
+     * @return true if the entire value was streamed without error
+     */
+    bool streamJson(EventHandler handler);
+    
+    /**
+     * Returns the key of the most recent KEY event.
+     *
+     * The key remains available until the next KEY event. So this method
+     * may also be used to get the key of a VALUE or BEGIN event.
+     *
+     * @return the key of the most recent KEY event.
+     */
+    const std::string& getEventKey() const { return _eventKey; }
+    
+    /**
+     * Returns the value of the most recent VALUE event.
+     *
+     * The value is a leaf {@link JsonValue}, and so it supports all of the
+     * usual conversions (e.g. {@link JsonValue#asFloat}). It is reused for
+     * each event, and so it should be copied if it must be kept.
+     *
+     * @return the value of the most recent VALUE event.
+     */
+    const JsonValue& getEventValue() const { return _eventValue; }
+    
+    /**
+     * Returns the nesting depth of the current event.
+     *
+     * The depth is the number of enclosing arrays and objects. So the depth
+     * of a BEGIN event is the depth of the new array or object, while the
+     * depth of its END event is the depth of its parent.
+     *
+     * @return the nesting depth of the current event.
+     */
+    size_t getEventDepth() const { return _scopes.size(); }
+    
 };
 
 }
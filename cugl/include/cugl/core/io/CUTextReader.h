@@ -13,6 +13,10 @@
 //  have proper file systems.  You should confine all files to either the asset
 //  or the save directory.
 //
+//  A reader may optionally memory map its file instead of reading it in chunks.
+//  In that case all reads are performed directly on the mapped file. Files that
+//  cannot be mapped (such as Android assets) fall back to chunks.
+//
 //  This class uses our standard shared-pointer architecture.
 //
 //  1. The constructor does not perform any initialization; it just sets all
@@ -50,6 +54,7 @@
 #define __CU_TEXT_READER_H__
 #include <cugl/core/CUBase.h>
 #include <string>
+#include <string_view>
 
 namespace  cugl {
 
@@ -83,12 +88,16 @@ protected:
     
     /** The buffer for storing data read from the stream */
     std::string _sbuffer;
+    /** The readable data (either the string buffer or the mapped file) */
+    std::string_view _view;
     /** The temporary transfer buffer */
     char*       _cbuffer;
     /** The buffer capacity */
     Uint32      _capacity;
     /** The current offset in the read buffer */
     Sint32      _bufoff;
+    /** Whether the view is a memory mapping of the entire file */
+    bool        _mapped;
 
 #pragma mark -
 #pragma mark Internal Methods
@@ -99,7 +108,18 @@ protected:
      * to read from the file in predefined chunks.
      */
     void fill();
-    
+
+    /**
+     * Maps the file for this reader into memory.
+     *
+     * On success, the read buffer views the mapped file and there is no SDL
+     * stream. This method fails if the file cannot be mapped, or if it is too
+     * large to be indexed by the buffer offset.
+     *
+     * @return true if the file was successfully mapped
+     */
+    bool map();
+
 #pragma mark -
 #pragma mark Constructors
 public:
@@ -110,7 +130,8 @@ public:
      * the heap, use one of the static constructors instead.
      */
     TextReader() : _name(""), _stream(nullptr), _ssize(-1), _scursor(-1),
-                   _sbuffer(""), _cbuffer(nullptr), _capacity(0), _bufoff(-1) {}
+                   _sbuffer(""), _cbuffer(nullptr), _capacity(0), _bufoff(-1),
+                   _mapped(false) {}
     
     /**
      * Deletes this reader and all of its resources.
@@ -181,7 +202,45 @@ public:
      * @return true if the reader is initialized properly, false otherwise.
      */
     bool initWithAsset(const std::string file, unsigned int capacity);
-    
+
+    /**
+     * Initializes a reader that memory maps the given file.
+     *
+     * Mapping the file removes the chunked reads from the file. All reads are
+     * performed directly on the mapped memory. If the file cannot be mapped,
+     * this reader falls back to reading the file in chunks with the default
+     * buffer capacity. Use {@link #isMapped} to distinguish the two cases.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initWithMapping(const std::string file);
+
+    /**
+     * Initializes a reader that memory maps the given asset file.
+     *
+     * Mapping the file removes the chunked reads from the file. All reads are
+     * performed directly on the mapped memory. If the file cannot be mapped
+     * (which is always the case for Android assets), this reader falls back
+     * to reading the file in chunks with the default buffer capacity. Use
+     * {@link #isMapped} to distinguish the two cases.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initWithMappedAsset(const std::string file);
+
     
 #pragma mark -
 #pragma mark Static Constructors
@@ -260,6 +319,50 @@ public:
         return (result->initWithAsset(file,capacity) ? result : nullptr);
     }
 
+    /**
+     * Returns a newly allocated reader that memory maps the given file.
+     *
+     * Mapping the file removes the chunked reads from the file. All reads are
+     * performed directly on the mapped memory. If the file cannot be mapped,
+     * this reader falls back to reading the file in chunks with the default
+     * buffer capacity. Use {@link #isMapped} to distinguish the two cases.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated reader that memory maps the given file.
+     */
+    static std::shared_ptr<TextReader> allocWithMapping(const std::string file) {
+        std::shared_ptr<TextReader> result = std::make_shared<TextReader>();
+        return (result->initWithMapping(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated reader that memory maps the given asset file.
+     *
+     * Mapping the file removes the chunked reads from the file. All reads are
+     * performed directly on the mapped memory. If the file cannot be mapped
+     * (which is always the case for Android assets), this reader falls back
+     * to reading the file in chunks with the default buffer capacity. Use
+     * {@link #isMapped} to distinguish the two cases.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return a newly allocated reader that memory maps the given asset file.
+     */
+    static std::shared_ptr<TextReader> allocWithMappedAsset(const std::string file) {
+        std::shared_ptr<TextReader> result = std::make_shared<TextReader>();
+        return (result->initWithMappedAsset(file) ? result : nullptr);
+    }
+
     
 #pragma mark -
 #pragma mark Stream Management
@@ -286,8 +389,18 @@ public:
      *
      * @return true if there is still data to read
      */
-    bool ready() const { return _bufoff < _sbuffer.size() || _scursor < _ssize; }
-    
+    bool ready() const { return (size_t)_bufoff < _view.size() || _scursor < _ssize; }
+
+    /**
+     * Returns true if this reader memory maps its file.
+     *
+     * A reader created with {@link #initWithMapping} may still read its file
+     * in chunks if the file could not be mapped.
+     *
+     * @return true if this reader memory maps its file.
+     */
+    bool isMapped() const { return _mapped; }
+
     
 #pragma mark -
 #pragma mark Read Methods
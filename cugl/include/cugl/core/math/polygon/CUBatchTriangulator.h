@@ -0,0 +1,501 @@
+//
+//  CUBatchTriangulator.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module is a factory for triangulating many polygons at once. The
+//  triangulators EarclipTriangulator and DelaunayTriangulator process a single
+//  polygon on the calling thread. That is too slow for tessellating a large
+//  collection of shapes, such as the vector art of a level. This factory
+//  packs all of the shapes into a single vertex buffer, and triangulates them
+//  in parallel on a thread pool. The results are packed into a single index
+//  buffer, so that the entire batch may be drawn as one mesh.
+//
+//  Because math objects are intended to be on the stack, we do not provide
+//  any shared pointer support in this class.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty. In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+//
+#ifndef __CU_BATCH_TRIANGULATOR_H__
+#define __CU_BATCH_TRIANGULATOR_H__
+
+#include <cugl/core/math/CUVec2.h>
+#include <vector>
+#include <memory>
+
+namespace cugl {
+
+// Forward declarations
+class Path2;
+class Poly2;
+class ThreadPool;
+class EarclipTriangulator;
+class DelaunayTriangulator;
+
+/**
+ * This class is a factory for triangulating many polygons at once.
+ *
+ * Each polygon in the batch is a counter-clockwise exterior hull together
+ * with any number of clockwise holes, exactly as in {@link EarclipTriangulator}.
+ * The polygons are added with the methods {@link addPath} and {@link addHole}.
+ * All of the vertices are copied into a single packed vertex buffer, in the
+ * order that they were added. So the vertices of a polygon are its exterior
+ * hull followed by its holes, and the vertices of each polygon follow those of
+ * the polygon before it.
+ *
+ * When the calculation is performed, the polygons are triangulated with
+ * either {@link EarclipTriangulator} (the default) or {@link DelaunayTriangulator}.
+ * If this factory has a {@link ThreadPool}, this work is shared between the
+ * workers of the pool and the calling thread. The polygons are divided into
+ * blocks of roughly equal vertex count, and each worker reuses the buffers of
+ * a single triangulator for all of the polygons it processes. So the
+ * throughput scales with the number of threads, provided that there are many
+ * more polygons than threads. Without a thread pool, the polygons are all
+ * triangulated on the calling thread.
+ *
+ * The results are stored in a single packed index buffer. These indices refer
+ * to positions in the packed vertex buffer, so the entire batch may be drawn
+ * as a single mesh. The triangles of each polygon are contiguous in this
+ * buffer, in the order that the polygons were added. The range of any one
+ * polygon is given by {@link getIndexOffset} and {@link getIndexCount}.
+ *
+ * As with all factories, the methods are broken up into three phases:
+ * initialization, calculation, and materialization. This factory is not
+ * thread safe in that you cannot add polygons or access data while it is
+ * still in mid-calculation.
+ */
+class BatchTriangulator {
+public:
+    /**
+     * The triangulation algorithm for the polygons in a batch
+     */
+    enum class Method {
+        /** Triangulate with {@link EarclipTriangulator} (DEFAULT) */
+        EARCLIP,
+        /** Triangulate with {@link DelaunayTriangulator} */
+        DELAUNAY
+    };
+
+#pragma mark Values
+private:
+    /** The location of a single polygon in the packed buffers */
+    typedef struct {
+        /** The position of the first vertex in the packed vertex buffer */
+        size_t vertstart;
+        /** The number of vertices in the exterior hull */
+        size_t hullsize;
+        /** The position of the first hole in the hole list */
+        size_t holestart;
+        /** The number of holes */
+        size_t holesize;
+    } Shape;
+
+    /** The packed vertices of all the polygons */
+    std::vector<Vec2> _input;
+    /** The polygons in the batch */
+    std::vector<Shape> _shapes;
+    /** The size of each hole, in order (positions follow from the shapes) */
+    std::vector<size_t> _holes;
+    /** The packed triangle indices of all the polygons */
+    std::vector<Uint32> _output;
+    /** The offset of each polygon in the output (with a final sentinel) */
+    std::vector<size_t> _ranges;
+    /** The first polygon of each work block (with a final sentinel) */
+    std::vector<size_t> _blocks;
+    /** The intermediate triangle indices for each work block */
+    std::vector<std::vector<Uint32>> _scratch;
+    /** The ear clipping triangulators, reused by each work block */
+    std::vector<std::unique_ptr<EarclipTriangulator>> _earclip;
+    /** The Delaunay triangulators, reused by each work block */
+    std::vector<std::unique_ptr<DelaunayTriangulator>> _delaunay;
+
+    /** The thread pool for the calculation (may be null) */
+    std::shared_ptr<ThreadPool> _pool;
+    /** The triangulation algorithm */
+    Method _method;
+    /** Whether or not the calculation has been run */
+    bool _calculated;
+
+#pragma mark -
+#pragma mark Constructors
+public:
+    /**
+     * Creates a batch triangulator with no polygons.
+     *
+     * The triangulator has no thread pool, so all calculation is performed
+     * on the calling thread.
+     */
+    BatchTriangulator();
+
+    /**
+     * Creates a batch triangulator with no polygons, using the given pool.
+     *
+     * The calculation will be shared between the workers of the thread pool
+     * and the calling thread. The pool may be shared with other systems, but
+     * calculate must not be called from a task of this same pool.
+     *
+     * @param pool  The thread pool for the calculation
+     */
+    BatchTriangulator(const std::shared_ptr<ThreadPool>& pool);
+
+    /**
+     * Deletes this triangulator, releasing all resources.
+     */
+    ~BatchTriangulator();
+
+#pragma mark -
+#pragma mark Attributes
+    /**
+     * Returns the thread pool for the calculation
+     *
+     * If this value is null, all calculation is performed on the calling
+     * thread.
+     *
+     * @return the thread pool for the calculation
+     */
+    const std::shared_ptr<ThreadPool>& getThreadPool() const { return _pool; }
+
+    /**
+     * Sets the thread pool for the calculation
+     *
+     * If this value is null, all calculation is performed on the calling
+     * thread. The pool may be shared with other systems, but calculate must
+     * not be called from a task of this same pool.
+     *
+     * @param pool  The thread pool for the calculation
+     */
+    void setThreadPool(const std::shared_ptr<ThreadPool>& pool) { _pool = pool; }
+
+    /**
+     * Returns the triangulation algorithm
+     *
+     * @return the triangulation algorithm
+     */
+    Method getMethod() const { return _method; }
+
+    /**
+     * Sets the triangulation algorithm
+     *
+     * The ear clipping algorithm is the default. It has much less overhead
+     * than the Delaunay algorithm, but may produce thinner triangles.
+     *
+     * @param method    The triangulation algorithm
+     */
+    void setMethod(Method method) { _method = method; }
+
+    /**
+     * Returns the number of polygons in this batch
+     *
+     * @return the number of polygons in this batch
+     */
+    size_t size() const { return _shapes.size(); }
+
+#pragma mark -
+#pragma mark Initialization
+    /**
+     * Adds a polygon with the given exterior hull to the batch.
+     *
+     * The vertices should define the hull in a counter-clockwise traversal.
+     * Holes for this polygon may be added afterwards with {@link addHole}.
+     * The vertex data is copied. The triangulator does not retain any
+     * references to the original data.
+     *
+     * @param points    The exterior hull vertices
+     * @param size      The number of vertices
+     *
+     * @return the index of the new polygon in the batch
+     */
+    size_t addPath(const Vec2* points, size_t size);
+
+    /**
+     * Adds a polygon with the given exterior hull to the batch.
+     *
+     * The vertices should define the hull in a counter-clockwise traversal.
+     * Holes for this polygon may be added afterwards with {@link addHole}.
+     * The vertex data is copied. The triangulator does not retain any
+     * references to the original data.
+     *
+     * @param points    The exterior hull vertices
+     *
+     * @return the index of the new polygon in the batch
+     */
+    size_t addPath(const std::vector<Vec2>& points) {
+        return addPath(points.data(), points.size());
+    }
+
+    /**
+     * Adds a polygon with the given exterior hull to the batch.
+     *
+     * The path should be closed, and define the hull in a counter-clockwise
+     * traversal. Holes for this polygon may be added afterwards with
+     * {@link addHole}. The vertex data is copied. The triangulator does not
+     * retain any references to the original data.
+     *
+     * @param path      The exterior hull
+     *
+     * @return the index of the new polygon in the batch
+     */
+    size_t addPath(const Path2& path);
+
+    /**
+     * Adds a polygon for each of the given exterior hulls to the batch.
+     *
+     * Each path should be closed, and define a hull in a counter-clockwise
+     * traversal. The polygons are added in order, and so their indices are
+     * consecutive. This method reserves space for all of the vertices at once,
+     * so it is faster than adding the paths individually.
+     *
+     * @param paths     The exterior hulls
+     * @param size      The number of hulls
+     */
+    void addPaths(const Path2* paths, size_t size);
+
+    /**
+     * Adds a polygon for each of the given exterior hulls to the batch.
+     *
+     * Each path should be closed, and define a hull in a counter-clockwise
+     * traversal. The polygons are added in order, and so their indices are
+     * consecutive. This method reserves space for all of the vertices at once,
+     * so it is faster than adding the paths individually.
+     *
+     * @param paths     The exterior hulls
+     */
+    void addPaths(const std::vector<Path2>& paths) {
+        addPaths(paths.data(), paths.size());
+    }
+
+    /**
+     * Adds the given hole to the most recently added polygon.
+     *
+     * The hole is assumed to be a closed path with no self-crossings. In
+     * addition, it is assumed to be inside the polygon hull, with vertices
+     * ordered in clockwise traversal. If any of these is not true, the results
+     * are undefined. The vertex data is copied.
+     *
+     * @param points    The hole vertices
+     * @param size      The number of vertices
+     */
+    void addHole(const Vec2* points, size_t size);
+
+    /**
+     * Adds the given hole to the most recently added polygon.
+     *
+     * The hole is assumed to be a closed path with no self-crossings. In
+     * addition, it is assumed to be inside the polygon hull, with vertices
+     * ordered in clockwise traversal. If any of these is not true, the results
+     * are undefined. The vertex data is copied.
+     *
+     * @param points    The hole vertices
+     */
+    void addHole(const std::vector<Vec2>& points) {
+        addHole(points.data(), points.size());
+    }
+
+    /**
+     * Adds the given hole to the most recently added polygon.
+     *
+     * The hole path should be closed, with no self-crossings. In addition, it
+     * is assumed to be inside the polygon hull, with vertices ordered in
+     * clockwise traversal. If any of these is not true, the results are
+     * undefined. The vertex data is copied.
+     *
+     * @param path      The hole path
+     */
+    void addHole(const Path2& path);
+
+    /**
+     * Reserves space for the given number of polygons and vertices
+     *
+     * This method is an optimization to avoid reallocation when the size of
+     * the batch is known ahead of time.
+     *
+     * @param shapes    The number of polygons
+     * @param vertices  The total number of vertices (including holes)
+     */
+    void reserve(size_t shapes, size_t vertices);
+
+#pragma mark -
+#pragma mark Calculation
+    /**
+     * Clears the triangulation results, but still maintains the polygons.
+     */
+    void reset();
+
+    /**
+     * Clears all internal data, including the polygons.
+     *
+     * The buffers are retained for reuse by the next batch.
+     */
+    void clear();
+
+    /**
+     * Performs a triangulation of all of the polygons in the batch.
+     *
+     * If this triangulator has a thread pool, the work is shared between the
+     * pool workers and the calling thread. In either case, this method blocks
+     * until all polygons are triangulated.
+     */
+    void calculate();
+
+#pragma mark -
+#pragma mark Materialization
+    /**
+     * Returns the packed vertices of all polygons in the batch.
+     *
+     * The vertices of each polygon are its exterior hull followed by its holes,
+     * and the polygons are in the order they were added.
+     *
+     * @return the packed vertices of all polygons in the batch.
+     */
+    const std::vector<Vec2>& getVertices() const { return _input; }
+
+    /**
+     * Returns the packed triangle indices of all polygons in the batch.
+     *
+     * The indices refer to positions in {@link getVertices}, and the
+     * triangles of each polygon are contiguous. If the calculation is not yet
+     * performed, this method will return the empty list.
+     *
+     * @return the packed triangle indices of all polygons in the batch.
+     */
+    const std::vector<Uint32>& getIndices() const { return _output; }
+
+    /**
+     * Returns the position of the first vertex of the given polygon
+     *
+     * This is a position in the packed vertex buffer {@link getVertices}.
+     *
+     * @param shape The polygon index
+     *
+     * @return the position of the first vertex of the given polygon
+     */
+    size_t getVertexOffset(size_t shape) const;
+
+    /**
+     * Returns the number of vertices of the given polygon (including holes)
+     *
+     * @param shape The polygon index
+     *
+     * @return the number of vertices of the given polygon (including holes)
+     */
+    size_t getVertexCount(size_t shape) const;
+
+    /**
+     * Returns the position of the first index of the given polygon
+     *
+     * This is a position in the packed index buffer {@link getIndices}. If
+     * the calculation is not yet performed, this method returns 0.
+     *
+     * @param shape The polygon index
+     *
+     * @return the position of the first index of the given polygon
+     */
+    size_t getIndexOffset(size_t shape) const;
+
+    /**
+     * Returns the number of triangle indices of the given polygon
+     *
+     * This value is three times the number of triangles. If the calculation
+     * is not yet performed, this method returns 0.
+     *
+     * @param shape The polygon index
+     *
+     * @return the number of triangle indices of the given polygon
+     */
+    size_t getIndexCount(size_t shape) const;
+
+    /**
+     * Returns a polygon representing the triangulation of the given shape.
+     *
+     * The polygon contains the vertices of the exterior hull and any holes,
+     * and its indices are relative to these vertices (not the packed buffer).
+     * If the calculation is not yet performed, this method will return the
+     * empty polygon.
+     *
+     * @param shape The polygon index
+     *
+     * @return a polygon representing the triangulation of the given shape.
+     */
+    Poly2 getPolygon(size_t shape) const;
+
+    /**
+     * Stores the triangulation of the given shape in the buffer.
+     *
+     * The polygon contains the vertices of the exterior hull and any holes.
+     * This data is appended to the buffer, with indices adjusted for the
+     * existing vertices. You should clear the buffer first if you do not
+     * want to preserve the original data. If the calculation is not yet
+     * performed, this method will do nothing.
+     *
+     * @param shape     The polygon index
+     * @param buffer    The buffer to store the triangulated polygon
+     *
+     * @return a reference to the buffer for chaining.
+     */
+    Poly2* getPolygon(size_t shape, Poly2* buffer) const;
+
+    /**
+     * Stores the triangulation of the entire batch in the buffer.
+     *
+     * The result is a single polygon with the packed vertices and indices.
+     * This data is appended to the buffer, with indices adjusted for the
+     * existing vertices. You should clear the buffer first if you do not
+     * want to preserve the original data. If the calculation is not yet
+     * performed, this method will do nothing.
+     *
+     * @param buffer    The buffer to store the triangulated polygons
+     *
+     * @return a reference to the buffer for chaining.
+     */
+    Poly2* getPolygon(Poly2* buffer) const;
+
+#pragma mark -
+#pragma mark Internal Computation
+private:
+    /**
+     * Divides the polygons into blocks of roughly equal vertex count
+     *
+     * The blocks are the units of work shared between the threads, with one
+     * block for each thread (including the calling thread). Balancing the
+     * vertex counts keeps any thread from being left idle when the polygons
+     * vary in size.
+     */
+    void partition();
+
+    /**
+     * Triangulates the polygons in the given range of blocks
+     *
+     * The results of each block are stored in its scratch buffer, and the
+     * index count of each polygon is stored in the range list. All of the
+     * blocks in the range share the triangulator of the first block. These
+     * triangulators persist between calculations, so their buffers are only
+     * allocated once.
+     *
+     * @param begin The first block to process
+     * @param end   The block after the last block to process
+     */
+    void triangulate(size_t begin, size_t end);
+};
+
+}
+
+#endif /* __CU_BATCH_TRIANGULATOR_H__ */
@@ -39,6 +39,7 @@
 
 #include <cugl/core/math/polygon/clipper.hpp>
 #include <cugl/core/math/polygon/CUPolyEnums.h>
+#include <cugl/core/math/polygon/CUDelaunayTriangulator.h>
 #include <cugl/core/math/CUVec2.h>
 #include <cugl/core/math/CUPoly2.h>
 #include <cugl/core/math/CUPath2.h>
@@ -73,6 +74,10 @@ namespace cugl {
  * This division allows us to support multithreaded calculation if the data
  * generation takes too long. However, note that this factory is not thread
  * safe in that you cannot access data while it is still in mid-calculation.
+ *
+ * The Clipper state (including its memory pools) is kept between calculations.
+ * Hence it is much faster to reuse a single extruder for many strokes than to
+ * create a new extruder for each one.
  */
 class ComplexExtruder {
 #pragma mark Values
@@ -97,6 +102,15 @@ private:
     /** Whether or not the calculation has been run */
     bool _calculated;
     
+    /** The input path in Clipper coordinates (reused between calculations) */
+    ClipperLib::Path _inverts;
+    /** The Clipper offset context (reused between calculations) */
+    ClipperLib::ClipperOffset _worker;
+    /** The Clipper solution (reused between calculations) */
+    ClipperLib::PolyTree _solution;
+    /** The triangulator for the solution (reused between calculations) */
+    DelaunayTriangulator _triangulator;
+    
 #pragma mark -
 #pragma mark Constructors
 public:
@@ -4,8 +4,10 @@
 //
 //  This module is a factory for a lightweight earclipping triangulator. While
 //  we do have access to the very powerful Pol2Tri, that API has a lot of overhead
-//  with it. While earclipping is an O(n^2) algorithm, the lower overhead of this
-//  class makes it more performant in smaller applications.
+//  with it. Earclipping is naively an O(n^2) algorithm. However, we keep the
+//  candidate ears in a priority queue, and only test ears against the reflex
+//  vertices near them (using a z-order spatial hash). This makes the expected
+//  running time O(n log n), even for large outlines.
 //
 //  Because math objects are intended to be on the stack, we do not provide
 //  any shared pointer support in this class.
@@ -57,11 +59,13 @@ class Poly2;
  * (but not self-crossings). All triangles produced are guaranteed to be
  * counter-clockwise.
  *
- * The running time of this algorithm is O(n^2), making it one of the slower
- * triangulation methods available. However, it has very low overhead, making
- * it better than {@link DelaunayTriangulator} in some cases. In addition, it
- * is guaranteed to make better (e.g. not thin) triangles than
- * {@link MonotoneTriangulator}
+ * This algorithm always clips the sharpest available ear. The ears are kept in
+ * a priority queue, and each ear is only tested against the reflex vertices
+ * inside its bounding box. These vertices are found with a z-order (Morton)
+ * spatial hash. So while the worst case running time is O(n^2), the expected
+ * running time is O(n log n). It has very low overhead, making it better than
+ * {@link DelaunayTriangulator} in many cases. In addition, it is guaranteed to
+ * make better (e.g. not thin) triangles than {@link MonotoneTriangulator}
  *
  * As with all factories, the methods are broken up into three phases:
  * initialization, calculation, and materialization. To use the factory, you
@@ -364,6 +368,10 @@ private:
 
     /**
      * Slices out holes, merging vertices into one doubly-linked list
+     *
+     * Holes are processed from right to left. Each hole is joined to the
+     * exterior by casting a ray to the right from its rightmost vertex. The
+     * bridge is the nearest visible vertex at the smallest angle to that ray.
      */
     void removeHoles();
 
@@ -92,6 +92,16 @@ class Color4;
  * generation takes too long. However, note that this factory is not thread
  * safe in that you cannot access data while it is still in mid-calculation.
  *
+ * This factory also supports incremental extrusion for paths that change a
+ * few points at a time (such as ropes or graphs). Once the extrusion is
+ * calculated, points may be moved with {@link setPoint}. The next call to
+ * {@link calculate} only re-extrudes the joints next to the modified points,
+ * patching the existing mesh in place. The vertex and index layout of the
+ * mesh is unchanged by a patch, and the modified ranges are reported by
+ * {@link getDirtyVertexOffset} and {@link getDirtyIndexOffset} (and their
+ * counts). If a modified point changes the layout of the mesh (such as a
+ * joint that now needs a bevel), the extruder falls back to a full extrusion.
+ *
  * CREDITS: This code heavily inspired by NanoVG by Mikko Mononen
  * (memon@inside.org), and the bulk of the algorithm is taken from that code.
  * However it is has been altered and optimized according to extensive profiling.
@@ -101,6 +111,8 @@ class SimpleExtruder {
 protected:
     /** Internal class for processing the path */
     class Point;
+    /** Internal class for recording the state of the extrusion */
+    class Stage;
 
     /** The extrusion joint settings */
     poly2::Joint  _joint;
@@ -154,6 +166,33 @@ protected:
     Uint32 _iback2;
     /** The seconnd vertex for the next triangle to produce */
     Uint32 _iback1;
+    /** The number of left turns in the path */
+    size_t _nleft;
+
+    /** The extrusion state at the start of each joint or cap */
+    Stage* _stages;
+    /** The capacity of the stage buffer */
+    size_t _slimit;
+    /** The left width of the current extrusion */
+    float  _lwidth;
+    /** The right width of the current extrusion */
+    float  _rwidth;
+    /** The number of segments in a rounded joint or cap */
+    Uint32 _ncap;
+    /** Whether the extrusion settings are unchanged since the calculation */
+    bool   _patchable;
+    /** The first path point modified since the last calculation */
+    size_t _dirtymin;
+    /** The last path point modified since the last calculation */
+    size_t _dirtymax;
+    /** The first vertex modified by the last calculation */
+    size_t _vbegin;
+    /** The vertex after the last vertex modified by the last calculation */
+    size_t _vend;
+    /** The first index modified by the last calculation */
+    size_t _ibegin;
+    /** The index after the last index modified by the last calculation */
+    size_t _iend;
     
 #pragma mark -
 #pragma mark Constructors
@@ -202,6 +241,7 @@ public:
      */
     void setJoint(poly2::Joint joint) {
         _joint = joint;
+        _patchable = false;
     }
     
     /**
@@ -228,6 +268,7 @@ public:
      */
     void setEndCap(poly2::EndCap endcap) {
         _endcap = endcap;
+        _patchable = false;
     }
     
     /**
@@ -253,6 +294,7 @@ public:
      */
     void setTolerance(float tolerance) {
          _tolerance = tolerance;
+        _patchable = false;
     }
     
     /**
@@ -284,6 +326,7 @@ public:
      */
     void setMitreLimit(float limit) {
          _mitrelimit = limit;
+        _patchable = false;
     }
     
     /**
@@ -351,6 +394,44 @@ public:
      */
     void set(const Path2& path);
     
+    /**
+     * Returns the number of points in the path
+     *
+     * @return the number of points in the path
+     */
+    size_t size() const {
+        return _psize;
+    }
+
+    /**
+     * Returns the path point at the given index
+     *
+     * @param index The point index
+     *
+     * @return the path point at the given index
+     */
+    Vec2 getPoint(size_t index) const;
+
+    /**
+     * Moves the path point at the given index
+     *
+     * This method does not reset the extrusion. Instead, the next call to
+     * {@link calculate} will re-extrude only the joints adjacent to the
+     * modified points, and patch the existing extrusion in place. This is
+     * much faster than a full extrusion when only a few points change each
+     * animation frame.
+     *
+     * A patch is only possible if the extrusion widths are the same as the
+     * previous calculation, and the joint, cap, tolerance, and mitre limit
+     * settings are unchanged. In addition, the vertex and index layout of
+     * the extrusion must be unchanged (e.g. a mitre joint cannot become a
+     * bevel). Otherwise, the next calculation performs a full extrusion.
+     *
+     * @param index The point index
+     * @param point The new point position
+     */
+    void setPoint(size_t index, const Vec2& point);
+
 #pragma mark -
 #pragma mark Calculation
     /**
@@ -402,6 +483,10 @@ public:
      * widths independently. In particular, this allows us to define an "half
      * extrusion" that starts from the center line.
      *
+     * If the extrusion has already been calculated, and points have been
+     * moved with {@link setPoint}, this method will patch the extrusion in
+     * place when possible. See {@link setPoint} for the restrictions.
+     *
      * @param lwidth    The width of the left side of the extrusion
      * @param rwidth    The width of the right side of the extrusion
      */
@@ -497,6 +582,72 @@ public:
      */
     Vec2 getSide(Uint32 index) const;
     
+    /**
+     * Returns true if the last calculation patched the previous extrusion
+     *
+     * A patched extrusion has the same number of vertices and indices as
+     * before. Only the vertices and indices in the dirty ranges changed. If
+     * this method returns false, the last calculation was a full extrusion.
+     *
+     * @return true if the last calculation patched the previous extrusion
+     */
+    bool isPatched() const {
+        return _calculated && (_vbegin > 0 || _vend < _vsize ||
+                               _ibegin > 0 || _iend < _isize);
+    }
+
+    /**
+     * Returns the first vertex modified by the last calculation
+     *
+     * Together with {@link getDirtyVertexCount}, this defines the range of
+     * vertices that must be reloaded after a patch. After a full extrusion,
+     * the range is all of the vertices.
+     *
+     * @return the first vertex modified by the last calculation
+     */
+    size_t getDirtyVertexOffset() const {
+        return _vbegin;
+    }
+
+    /**
+     * Returns the number of vertices modified by the last calculation
+     *
+     * Together with {@link getDirtyVertexOffset}, this defines the range of
+     * vertices that must be reloaded after a patch. After a full extrusion,
+     * the range is all of the vertices.
+     *
+     * @return the number of vertices modified by the last calculation
+     */
+    size_t getDirtyVertexCount() const {
+        return _vend-_vbegin;
+    }
+
+    /**
+     * Returns the first index modified by the last calculation
+     *
+     * Together with {@link getDirtyIndexCount}, this defines the range of
+     * indices that must be reloaded after a patch. After a full extrusion,
+     * the range is all of the indices.
+     *
+     * @return the first index modified by the last calculation
+     */
+    size_t getDirtyIndexOffset() const {
+        return _ibegin;
+    }
+
+    /**
+     * Returns the number of indices modified by the last calculation
+     *
+     * Together with {@link getDirtyIndexOffset}, this defines the range of
+     * indices that must be reloaded after a patch. After a full extrusion,
+     * the range is all of the indices.
+     *
+     * @return the number of indices modified by the last calculation
+     */
+    size_t getDirtyIndexCount() const {
+        return _iend-_ibegin;
+    }
+
 #pragma mark -
 #pragma mark Internal Data Generation
 private:
@@ -614,12 +765,65 @@ private:
      * @return the estimated number of vertices in the extrusion
      */
     Uint32 analyze(float width);
+
+    /**
+     * Annotates the path point at the given index
+     *
+     * This method computes the extrusion direction at the point, as well as
+     * the flags determining the joint type. It is the per-point step of
+     * {@link analyze}.
+     *
+     * @param index     The point index
+     * @param iwidth    The inverse of the stroke width
+     */
+    void annotate(size_t index, float iwidth);
+
+    /**
+     * Computes the direction and distance from a path point to the next one
+     *
+     * The path is treated as closed for this computation, so the last point
+     * is measured against the first.
+     *
+     * @param index     The point index
+     */
+    void measure(size_t index);
+
+    /**
+     * Produces the extrusion for the given range of stages
+     *
+     * A stage is either an end cap or the joint at a single path point. For
+     * an open path, stage 0 is the head cap, the last stage is the tail cap,
+     * and the stages in between are the joints at the corresponding points.
+     * For a closed path, stage i is the joint at point i, and a final stage
+     * closes the loop. The state of the extrusion at the start of each stage
+     * is recorded, so that the extrusion may be resumed from that stage.
+     *
+     * @param begin     The first stage to produce
+     * @param end       The stage after the last stage to produce
+     */
+    void extrude(size_t begin, size_t end);
+
+    /**
+     * Returns true if the modified points were patched into the extrusion
+     *
+     * This method re-extrudes the stages adjacent to the modified points,
+     * starting from the recorded state of the first stage. The patch only
+     * succeeds if the new stages rejoin the previous extrusion exactly. If
+     * this method returns false, the extrusion must be recalculated.
+     *
+     * @param lwidth    The width of the left side of the extrusion
+     * @param rwidth    The width of the right side of the extrusion
+     *
+     * @return true if the modified points were patched into the extrusion
+     */
+    bool patch(float lwidth, float rwidth);
     
     /**
      * Allocates space for the extrusion vertices and indices
      *
      * This method guarantees that the output buffers will have enough capacity
-     * for the algorithm.
+     * for the algorithm. It also allocates a stage record for each joint and
+     * cap in the current path.
      *
      * @param size      The estimated number of vertices in the extrusion
      */
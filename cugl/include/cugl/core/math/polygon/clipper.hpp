@@ -58,6 +58,7 @@
 #include <ostream>
 #include <functional>
 #include <queue>
+#include <new>
 
 namespace ClipperLib {
 
@@ -155,19 +156,23 @@ private:
     void AddChild(PolyNode& child);
     friend class Clipper; //to access Index
     friend class ClipperOffset; 
+    friend class PolyTree; //to recycle nodes
 };
 
 class PolyTree: public PolyNode
 { 
 public:
-    ~PolyTree(){ Clear(); };
+    ~PolyTree();
     PolyNode* GetFirst() const;
     void Clear();
     int Total() const;
 private:
   //PolyTree& operator =(PolyTree& other);
   PolyNodes AllNodes;
+  PolyNodes FreeNodes; //cleared nodes kept for reuse
+  PolyNode* NewNode();
     friend class Clipper; //to access AllNodes
+    friend class ClipperOffset; //to access NewNode
 };
 
 bool Orientation(const Path &poly);
@@ -214,6 +219,35 @@ typedef std::vector < IntersectNode* > IntersectList;
 
 //------------------------------------------------------------------------------
 
+//Arena is a block allocator for the records (edges, output points, joins and
+//intersections) that are created while clipping. Records are never freed
+//individually. Instead, Reset() recycles all of the blocks at once, so a
+//clipper that is reused from one call to the next stops allocating once its
+//blocks are large enough for the work.
+class Arena
+{
+public:
+  Arena(size_t blockSize = 0x4000);
+  ~Arena();
+  void* Alloc(size_t size);
+  template <typename T> T* New(size_t count = 1)
+  {
+    T* result = static_cast<T*>(Alloc(sizeof(T) * count));
+    for (size_t i = 0; i < count; ++i) new (result + i) T;
+    return result;
+  }
+  void Reset();
+private:
+  Arena(const Arena&);
+  Arena& operator =(const Arena&);
+  std::vector< char* > m_Blocks;
+  std::vector< size_t > m_Sizes;
+  size_t m_BlockSize;
+  size_t m_Current;
+  size_t m_Offset;
+};
+//------------------------------------------------------------------------------
+
 //ClipperBase is the ancestor to the Clipper class. It should not be
 //instantiated directly. This class simply abstracts the conversion of sets of
 //polygon coordinates into edge objects that are stored in a LocalMinima list.
@@ -254,8 +288,10 @@ protected:
   bool              m_HasOpenPaths;
   PolyOutList       m_PolyOuts;
   TEdge           *m_ActiveEdges;
+  Arena             m_EdgeArena; //edges, reset by Clear()
+  Arena             m_Arena;     //output records, reset after each Execute()
 
-  typedef std::priority_queue<cInt> ScanbeamList;
+  typedef std::vector<cInt> ScanbeamList; //a max-heap
   ScanbeamList     m_Scanbeam;
 };
 //------------------------------------------------------------------------------
@@ -293,7 +329,7 @@ private:
   JoinList         m_GhostJoins;
   IntersectList    m_IntersectList;
   ClipType         m_ClipType;
-  typedef std::list<cInt> MaximaList;
+  typedef std::vector<cInt> MaximaList;
   MaximaList       m_Maxima;
   TEdge           *m_SortedEdges;
   bool             m_ExecuteLocked;
@@ -370,15 +406,21 @@ public:
   double MiterLimit;
   double ArcTolerance;
 private:
-  Paths m_destPolys;
+  Paths m_destPolys; //only the first m_destCount are in use
+  Paths::size_type m_destCount;
   Path m_srcPoly;
   Path m_destPoly;
+  Path m_outer;
   std::vector<DoublePoint> m_normals;
   double m_delta, m_sinA, m_sin, m_cos;
   double m_miterLim, m_StepsPerRad;
   IntPoint m_lowest;
   PolyNode m_polyNodes;
+  PolyNodes m_freeNodes; //cleared nodes kept for reuse
+  Clipper m_clipper;     //reused by each call to Execute()
 
+  void AddDestPoly(const Path& poly);
+  void Prepare(double delta);
   void FixOrientations();
   void DoOffset(double delta);
   void OffsetPoint(int j, int& k, JoinType jointype);
@@ -38,6 +38,7 @@
 #include "CUComplexExtruder.h"
 #include "CUEarclipTriangulator.h"
 #include "CUDelaunayTriangulator.h"
+#include "CUBatchTriangulator.h"
 #include "CUPathSmoother.h"
 
 // Because we are exposing this internally for how
@@ -668,7 +668,42 @@ namespace cugl {
      * @return true if the file permissions where successfully changed.
      */
     bool set_writable(const std::string path, bool writable, bool ownerOnly);
-    
+
+    /**
+     * Returns a read-only memory mapping of the file for this path name.
+     *
+     * The contents of the file are mapped into the address space of this
+     * application, so they can be read without system calls or copies. The
+     * size of the file (and the mapping) is stored in size. The mapping must
+     * be released with {@link #file_unmap}.
+     *
+     * This function returns nullptr if there is no file at the given path, if
+     * the file is empty, or if the file cannot be mapped. In particular, the
+     * asset directory on Android is inside the APK and cannot be mapped. The
+     * caller should fall back to reading the file with SDL in that case. If
+     * the path is a relative path, this function will use the asset directory
+     * as the working directory.
+     *
+     * @param path  The file path name
+     * @param size  Pointer to store the size of the file
+     *
+     * @return a read-only memory mapping of the file for this path name.
+     */
+    const char* file_map(const std::string path, size_t* size);
+
+    /**
+     * Releases a memory mapping created by {@link #file_map}.
+     *
+     * The size must be the one returned by {@link #file_map}. The data may not
+     * be accessed after this function is called.
+     *
+     * @param data  The mapped file contents
+     * @param size  The size of the mapping
+     *
+     * @return true if the mapping was successfully released.
+     */
+    bool file_unmap(const char* data, size_t size);
+
 #pragma mark -
 #pragma mark File Volumes
     /**
@@ -0,0 +1,411 @@
+//
+//  CUHasher.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides fast, non-cryptographic hashing of memory and files.
+//  It is intended for content-addressed caches, asset deduplication, and
+//  change detection, where a hash must be computed over a lot of data very
+//  quickly. These hashes are NOT secure, and should never be used to protect
+//  against deliberate tampering.
+//
+//  The algorithm is XXH3 (both the 64 and 128 bit variants) from the xxHash
+//  library by Yann Collet. Our implementation produces exactly the same values
+//  as the reference implementation, so hashes may be computed ahead of time by
+//  other tools (such as the Python xxhash package). Long inputs are processed
+//  with vectorized kernels (SSE2 or AVX2) when the CPU supports them.
+//
+//  This class is meant to be created on the stack. Therefore there is no
+//  support for shared pointers or initialization like in our other, more
+//  heavy-weight classes.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+//
+#ifndef __CU_HASHER_H__
+#define __CU_HASHER_H__
+#include <cugl/core/CUBase.h>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark Hash128
+/**
+ * A 128 bit hash value
+ *
+ * This is the result of a 128 bit hash in {@link Hasher}. It is a simple
+ * pair of 64 bit words. The canonical (string) representation puts the high
+ * word first, which agrees with the hexadecimal digest of other xxHash tools.
+ */
+struct Hash128 {
+    /** The low 64 bits of the hash */
+    Uint64 low;
+    /** The high 64 bits of the hash */
+    Uint64 high;
+
+    /**
+     * Creates a zero hash value
+     */
+    Hash128() : low(0), high(0) {}
+
+    /**
+     * Creates a hash value with the given words
+     *
+     * @param low   The low 64 bits of the hash
+     * @param high  The high 64 bits of the hash
+     */
+    Hash128(Uint64 low, Uint64 high) : low(low), high(high) {}
+
+    /**
+     * Returns true if this hash is equal to the given hash.
+     *
+     * @param other The hash to compare against
+     *
+     * @return true if this hash is equal to the given hash.
+     */
+    bool operator==(const Hash128& other) const {
+        return low == other.low && high == other.high;
+    }
+
+    /**
+     * Returns true if this hash is not equal to the given hash.
+     *
+     * @param other The hash to compare against
+     *
+     * @return true if this hash is not equal to the given hash.
+     */
+    bool operator!=(const Hash128& other) const {
+        return low != other.low || high != other.high;
+    }
+
+    /**
+     * Returns true if this hash is less than the given hash.
+     *
+     * This comparison allows hashes to be used as keys in ordered containers.
+     * It compares the high words first.
+     *
+     * @param other The hash to compare against
+     *
+     * @return true if this hash is less than the given hash.
+     */
+    bool operator<(const Hash128& other) const {
+        return high < other.high || (high == other.high && low < other.low);
+    }
+
+    /**
+     * Returns a string representation of this hash
+     *
+     * The string is 32 lower-case hexadecimal digits, with the high word first.
+     *
+     * @return a string representation of this hash
+     */
+    std::string toString() const;
+};
+
+#pragma mark -
+#pragma mark Hasher Class
+/**
+ * A class to compute fast, non-cryptographic hashes.
+ *
+ * This class implements the XXH3 hash from the xxHash library. It supports
+ * both 64 bit and 128 bit hashes. The 64 bit hash is sufficient for hash
+ * tables and change detection. The 128 bit hash should be used when the hash
+ * stands in for the data itself, such as the key of a content-addressed cache,
+ * as collisions are then vanishingly unlikely. These hashes are not secure,
+ * and should not be used where an adversary may choose the data.
+ *
+ * There are two ways to use this class. The static methods {@link hash64} and
+ * {@link hash128} compute the hash of a single block of memory (and are the
+ * fastest option for small inputs). Alternatively, a Hasher object may be
+ * created on the stack to hash data in pieces. Data is added with the method
+ * {@link update}, and the hash is read with {@link digest64} or
+ * {@link digest128}. Reading the hash does not change the state, so more data
+ * may be added afterwards. Hashing in pieces produces the same result as
+ * hashing all of the data at once, no matter how the data is divided. Files
+ * may be hashed with either {@link updateWithFile} or {@link hashFile64} and
+ * {@link hashFile128}.
+ *
+ * Both the 64 and 128 bit hashes may be read from the same Hasher. However,
+ * they are not related to each other; the 64 bit hash is not the low word of
+ * the 128 bit hash.
+ *
+ * All of the hashes accept an optional seed. Different seeds produce unrelated
+ * hashes for the same data. The results for any seed agree with the reference
+ * xxHash implementation (as XXH3_64bits_withSeed and XXH3_128bits_withSeed),
+ * and are the same on all platforms.
+ *
+ * Inputs of more than 240 bytes are processed in 64 byte stripes. Where
+ * supported, this uses vectorized kernels (SSE2 or AVX2, chosen when the
+ * first long input is hashed). The throughput on a modern desktop CPU is
+ * several gigabytes per second.
+ */
+class Hasher {
+private:
+    /** The accumulators for the data hashed so far (long inputs only) */
+    alignas(64) Uint64 _acc[8];
+    /** The secret for the current seed */
+    alignas(64) Uint8 _secret[192];
+    /** The data not yet accumulated */
+    alignas(64) Uint8 _buffer[256];
+    /** The number of bytes in the buffer */
+    size_t _buffsize;
+    /** The number of stripes accumulated in the current block */
+    size_t _stripes;
+    /** The total number of bytes hashed */
+    Uint64 _length;
+    /** The hash seed */
+    Uint64 _seed;
+
+    /**
+     * Stores the final accumulators for the data added so far in acc
+     *
+     * This method is only valid if more than 240 bytes have been added. It
+     * accumulates the buffered data without changing the state of the hasher.
+     *
+     * @param acc   The array to store the accumulators
+     */
+    void digestLong(Uint64* acc) const;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a new hasher with the given seed.
+     *
+     * The hasher is ready to accept data. Its initial digests are the hashes
+     * of an empty input.
+     *
+     * @param seed  The hash seed
+     */
+    Hasher(Uint64 seed=0) { reset(seed); }
+
+    /**
+     * Resets this hasher to its initial state with the given seed.
+     *
+     * All data previously added to this hasher is forgotten.
+     *
+     * @param seed  The hash seed
+     */
+    void reset(Uint64 seed=0);
+
+#pragma mark Streaming
+    /**
+     * Adds the given data to this hasher.
+     *
+     * Data is hashed in the order it is added. Adding data in several pieces
+     * produces the same hash as adding it all at once.
+     *
+     * @param data  The data to hash
+     * @param size  The number of bytes of data
+     */
+    void update(const void* data, size_t size);
+
+    /**
+     * Adds the given string to this hasher.
+     *
+     * Only the characters of the string are hashed; the null terminator is
+     * not included.
+     *
+     * @param data  The string to hash
+     */
+    void update(const std::string& data) {
+        update(data.data(), data.size());
+    }
+
+    /**
+     * Adds the given bytes to this hasher.
+     *
+     * @param data  The bytes to hash
+     */
+    void update(const std::vector<std::byte>& data) {
+        update(data.data(), data.size());
+    }
+
+    /**
+     * Adds the contents of the given file to this hasher.
+     *
+     * The file is memory mapped if possible, and otherwise read in chunks
+     * (such as for assets on Android). If the path is a relative path, it is
+     * relative to the asset directory.
+     *
+     * If the file cannot be read, this method returns false. In that case
+     * some prefix of the file may have been added to this hasher, so it should
+     * be reset before it is used again.
+     *
+     * @param path  The path to the file
+     *
+     * @return true if the entire file was added to this hasher
+     */
+    bool updateWithFile(const std::string path);
+
+    /**
+     * Returns the 64 bit hash of the data added so far.
+     *
+     * This method does not change the state of the hasher. More data may be
+     * added afterwards.
+     *
+     * @return the 64 bit hash of the data added so far.
+     */
+    Uint64 digest64() const;
+
+    /**
+     * Returns the 128 bit hash of the data added so far.
+     *
+     * This method does not change the state of the hasher. More data may be
+     * added afterwards.
+     *
+     * @return the 128 bit hash of the data added so far.
+     */
+    Hash128 digest128() const;
+
+#pragma mark Attributes
+    /**
+     * Returns the seed of this hasher
+     *
+     * @return the seed of this hasher
+     */
+    Uint64 getSeed() const { return _seed; }
+
+    /**
+     * Returns the number of bytes added to this hasher
+     *
+     * @return the number of bytes added to this hasher
+     */
+    Uint64 getLength() const { return _length; }
+
+#pragma mark One-Shot Hashing
+    /**
+     * Returns the 64 bit hash of the given data
+     *
+     * This is the same as the digest of a Hasher with the same seed, after
+     * the data has been added. However, it is faster for small inputs.
+     *
+     * @param data  The data to hash
+     * @param size  The number of bytes of data
+     * @param seed  The hash seed
+     *
+     * @return the 64 bit hash of the given data
+     */
+    static Uint64 hash64(const void* data, size_t size, Uint64 seed=0);
+
+    /**
+     * Returns the 64 bit hash of the given string
+     *
+     * Only the characters of the string are hashed; the null terminator is
+     * not included.
+     *
+     * @param data  The string to hash
+     * @param seed  The hash seed
+     *
+     * @return the 64 bit hash of the given string
+     */
+    static Uint64 hash64(const std::string& data, Uint64 seed=0) {
+        return hash64(data.data(), data.size(), seed);
+    }
+
+    /**
+     * Returns the 128 bit hash of the given data
+     *
+     * This is the same as the digest of a Hasher with the same seed, after
+     * the data has been added. However, it is faster for small inputs.
+     *
+     * @param data  The data to hash
+     * @param size  The number of bytes of data
+     * @param seed  The hash seed
+     *
+     * @return the 128 bit hash of the given data
+     */
+    static Hash128 hash128(const void* data, size_t size, Uint64 seed=0);
+
+    /**
+     * Returns the 128 bit hash of the given string
+     *
+     * Only the characters of the string are hashed; the null terminator is
+     * not included.
+     *
+     * @param data  The string to hash
+     * @param seed  The hash seed
+     *
+     * @return the 128 bit hash of the given string
+     */
+    static Hash128 hash128(const std::string& data, Uint64 seed=0) {
+        return hash128(data.data(), data.size(), seed);
+    }
+
+    /**
+     * Computes the 64 bit hash of the given file, storing it in result
+     *
+     * The file is memory mapped if possible, and otherwise read in chunks. If
+     * the path is a relative path, it is relative to the asset directory. If
+     * the file cannot be read, this method returns false and result is not
+     * modified.
+     *
+     * @param path      The path to the file
+     * @param result    Pointer to store the hash
+     * @param seed      The hash seed
+     *
+     * @return true if the file was successfully hashed
+     */
+    static bool hashFile64(const std::string path, Uint64* result, Uint64 seed=0);
+
+    /**
+     * Computes the 128 bit hash of the given file, storing it in result
+     *
+     * The file is memory mapped if possible, and otherwise read in chunks. If
+     * the path is a relative path, it is relative to the asset directory. If
+     * the file cannot be read, this method returns false and result is not
+     * modified.
+     *
+     * @param path      The path to the file
+     * @param result    Pointer to store the hash
+     * @param seed      The hash seed
+     *
+     * @return true if the file was successfully hashed
+     */
+    static bool hashFile128(const std::string path, Hash128* result, Uint64 seed=0);
+};
+
+}
+
+namespace std {
+    /**
+     * Hash support for 128 bit hashes, so they may be used as unordered keys
+     */
+    template <>
+    struct hash<cugl::Hash128> {
+        /**
+         * Returns the hash of the given 128 bit hash
+         *
+         * The bits are already uniformly distributed, so this is just a fold.
+         *
+         * @param value The hash value
+         *
+         * @return the hash of the given 128 bit hash
+         */
+        size_t operator()(const cugl::Hash128& value) const noexcept {
+            return (size_t)(value.low ^ value.high);
+        }
+    };
+}
+
+#endif /* __CU_HASHER_H__ */
@@ -6,6 +6,9 @@
 //  user-defined hash functions in CUGL. Most of these ideas have been
 //  adapted from existing online tools like the BOOST library.
 //
+//  The Base 64 functions use vectorized kernels (SSE4.1 or AVX2) when the
+//  CPU supports them, and can write to caller-provided buffers.
+//
 //  CUGL MIT License:
 //      This software is provided 'as-is', without any express or implied
 //      warranty.  In no event will the authors be held liable for any damages
@@ -149,6 +152,70 @@ std::vector<std::byte> b64_decode(const std::string data);
  */
 std::string b64_tostring(const std::string data);
 
+/**
+ * Returns the number of Base 64 characters needed to encode the data
+ *
+ * This value includes any padding characters.
+ *
+ * @param size  The number of bytes to encode
+ *
+ * @return the number of Base 64 characters needed to encode the data
+ */
+size_t b64_encode_size(size_t size);
+
+/**
+ * Returns the maximum number of bytes decoded from the Base 64 data
+ *
+ * The actual number of bytes may be less if the data has padding or any
+ * characters outside of the Base 64 alphabet.
+ *
+ * @param size  The number of Base 64 characters
+ *
+ * @return the maximum number of bytes decoded from the Base 64 data
+ */
+size_t b64_decode_size(size_t size);
+
+/**
+ * Encodes the given binary data in Base 64, storing it in dst
+ *
+ * This function is an alternative to the string versions of b64_encode that
+ * performs no allocation. The buffer dst must have room for at least
+ * {@link b64_encode_size} characters. The result is not null-terminated.
+ *
+ * Where supported (SSE4.1 or AVX2), this function uses vectorized kernels.
+ * Otherwise, it converts three bytes at a time. See
+ *
+ * https://en.wikipedia.org/wiki/Base64
+ *
+ * @param data  The data to convert
+ * @param size  The number of bytes of data
+ * @param dst   The buffer to store the Base 64 characters
+ *
+ * @return the number of characters written to dst
+ */
+size_t b64_encode(const std::byte* data, size_t size, char* dst);
+
+/**
+ * Decodes the given Base 64 data, storing the result in dst
+ *
+ * This function is an alternative to {@link b64_decode} and
+ * {@link b64_tostring} that performs no allocation. The buffer dst must have
+ * room for at least {@link b64_decode_size} bytes. Decoding stops at the
+ * first character outside of the Base 64 alphabet (such as padding).
+ *
+ * Where supported (SSE4.1 or AVX2), this function uses vectorized kernels.
+ * Otherwise, it converts four characters at a time. See
+ *
+ * https://en.wikipedia.org/wiki/Base64
+ *
+ * @param data  The data to convert
+ * @param size  The number of characters of data
+ * @param dst   The buffer to store the decoded bytes
+ *
+ * @return the number of bytes written to dst
+ */
+size_t b64_decode(const char* data, size_t size, std::byte* dst);
+
 /**
  * Returns a new randomly generated UUID
  *
@@ -37,11 +37,14 @@
 #include <unordered_map>
 #include <string>
 #include <memory>
+#include <atomic>
+#include <cstdarg>
 
 namespace cugl {
 
-// Forward declaration
+// Forward declarations
 class TextWriter;
+class LogBackend;
 
 /**
  * This class provides an interface for fine-grained logging.
@@ -62,6 +65,16 @@ class TextWriter;
  * (defined as {@link #getConsoleLevel}) and will process messages accordingly.
  * Note that the console uses its own timestamps, and so there will be a few
  * microseconds difference between the log file and the console.
+ *
+ * By default, messages are written on the thread that logs them. That is
+ * not safe if multiple threads share a logger, and a thread that logs a lot
+ * will spend much of its time waiting on the file. A logger may instead be
+ * made asynchronous with {@link #setAsync}. An asynchronous logger formats
+ * each message into a lock-free queue owned by the calling thread. A single
+ * background thread empties these queues and writes the messages in batches.
+ * Logging threads never wait on the disk. If a thread logs faster than the
+ * messages can be written, its queue fills and further messages are dropped
+ * (the log file records how many).
  */
 class Logger {
 public:
@@ -128,9 +141,17 @@ protected:
     /** Whether auto flush is active */
     bool _autof;
     
-    /** Whether this channel is still open. */
-    bool _open;
-    
+    /** Whether this channel is still open (read by the background log thread) */
+    std::atomic<bool> _open;
+
+    /** Whether messages are written by the background log thread */
+    std::atomic<bool> _async;
+    /** The number of messages dropped since the last batch was written */
+    std::atomic<size_t> _dropped;
+
+    // The background log thread writes to the file directly
+    friend class LogBackend;
+
 #pragma mark Constructors
 public:
     /**
@@ -175,7 +196,22 @@ private:
      * @return size The new size requested.
      */
     void expand(size_t size);
-    
+
+    /**
+     * Sends a message to the background log thread.
+     *
+     * The message is formatted immediately, on the calling thread, but it
+     * is timestamped and written by the background log thread. This method
+     * never blocks. If the queue for this thread is full, the message is
+     * dropped.
+     *
+     * @param file      The log level for the file (NO_MSG to skip the file)
+     * @param console   The log level for the console (NO_MSG to skip it)
+     * @param format    The formatting string
+     * @param args      The printf-style subsitution arguments
+     */
+    void post(Level file, Level console, const char* format, va_list args);
+
 #pragma mark Static Accessors
 public:
     /**
@@ -332,7 +368,44 @@ public:
      * @param value whether this logger should autoflush
      */
     void setAutoFlush(bool value);
-    
+
+    /**
+     * Returns true if this logger writes messages on a background thread.
+     *
+     * An asynchronous logger only formats messages on the calling thread.
+     * The messages are written by a background thread shared by all loggers,
+     * in batches. Hence the file (and console) can lag a few milliseconds
+     * behind the calls to {@link #log}. It is safe for multiple threads to
+     * log to an asynchronous logger at the same time.
+     *
+     * Asynchronous loggers ignore {@link #doesAutoFlush}, as every batch is
+     * flushed once written. Calling {@link #flush} waits until all messages
+     * logged before the call are written to the file.
+     *
+     * @return true if this logger writes messages on a background thread.
+     */
+    bool isAsync() const { return _async.load(std::memory_order_relaxed); }
+
+    /**
+     * Sets whether this logger writes messages on a background thread.
+     *
+     * An asynchronous logger only formats messages on the calling thread.
+     * The messages are written by a background thread shared by all loggers,
+     * in batches. Hence the file (and console) can lag a few milliseconds
+     * behind the calls to {@link #log}. It is safe for multiple threads to
+     * log to an asynchronous logger at the same time.
+     *
+     * Asynchronous loggers ignore {@link #doesAutoFlush}, as every batch is
+     * flushed once written. Calling {@link #flush} waits until all messages
+     * logged before the call are written to the file.
+     *
+     * Changing the value always flushes any pending messages to the file.
+     * It should not be changed while other threads are logging.
+     *
+     * @param value whether this logger writes messages on a background thread
+     */
+    void setAsync(bool value);
+
 #pragma mark Message Logging
     /**
      * Sends a message to this logger.
@@ -408,6 +481,9 @@ public:
      * Otherwise, the file is written after every message. To improve
      * performance, you may wish to disable auto flush if you are writting a
      * large number of messages per animation frame.
+     *
+     * If this logger is asynchronous, this method blocks until the background
+     * thread has written every message logged before this call.
      */
     void flush();
 
@@ -191,6 +191,32 @@ public:
      */
     void addTask(const std::function<void()> &task);
     
+    /**
+     * Executes the given task over a range of indices, blocking until done.
+     *
+     * The range [0,size) is split into chunks of at least grain indices,
+     * and each chunk is passed to task as a half-open range [begin,end).
+     * The chunks are shared between the worker threads and the calling
+     * thread. As the calling thread also processes chunks, this method
+     * completes even if all of the workers are busy with other tasks.
+     *
+     * The task must be safe to execute concurrently on disjoint ranges.
+     * This method must not be called from a task of this same pool.
+     *
+     * @param size  The number of indices to process
+     * @param task  The function to process a range of indices
+     * @param grain The minimum number of indices per chunk
+     */
+    void parallelFor(size_t size, const std::function<void(size_t,size_t)>& task,
+                     size_t grain=1);
+    
+    /**
+     * Returns the number of worker threads in this pool.
+     *
+     * @return the number of worker threads in this pool.
+     */
+    size_t getThreadCount() const { return _workers.size(); }
+    
     /**
      * Stops the thread pool, marking it for shut down.
      *
@@ -39,6 +39,7 @@
 #include "CULogger.h"
 #include "CUThreadPool.h"
 #include "CUHashtools.h"
+#include "CUHasher.h"
 #include "CURandom.h"
 
 #endif /* __CU_UTIL_PKG_H__ */
@@ -70,6 +70,9 @@
 
 namespace cugl {
 
+/** Forward reference to a thread pool */
+class ThreadPool;
+
     /**
      * The classes and functions needed to construct a graphics pipeline.
      *
@@ -412,6 +415,136 @@ typedef std::function<void(Particle3* part)> ParticleDeallocator;
  */
 typedef std::function<bool(float delta, Particle3* part, ParticleInstance* inst)> ParticleUpdater;
 
+#pragma mark -
+#pragma mark Particle Batch
+/**
+ * This class is a structure-of-arrays view of the particles in a system.
+ *
+ * Calling a {@link ParticleUpdater} once per particle is expensive when the
+ * simulation itself is simple, as the cost of the indirect call dominates.
+ * A {@link ParticleBatchUpdater} instead receives this class, which exposes
+ * the particle attributes as parallel arrays of length {@link #count}. This
+ * layout allows the simulation to process many particles at once with vector
+ * instructions. This class provides several such vectorized kernels for the
+ * most common motion. They use AVX2 when the CPU supports it, and fall back
+ * to scalar code otherwise.
+ *
+ * A batch is only a view. It does not own its arrays, and is safe to copy.
+ * The method {@link #slice} returns a view of a subrange of the particles,
+ * which is how a {@link ParticleSystem} shares the work with a thread pool.
+ *
+ * Like {@link ParticleEmitter}, we treat this class like a math class that
+ * goes on the stack.
+ */
+class ParticleBatch {
+public:
+    /** The x-coordinate of each particle position */
+    float* px;
+    /** The y-coordinate of each particle position */
+    float* py;
+    /** The z-coordinate of each particle position */
+    float* pz;
+    /** The x-coordinate of each particle velocity */
+    float* vx;
+    /** The y-coordinate of each particle velocity */
+    float* vy;
+    /** The z-coordinate of each particle velocity */
+    float* vz;
+    /** The size of each particle (scale to apply to template) */
+    float* size;
+    /** The remaining life of each particle. If <= 0 the particle is dead. */
+    float* life;
+    /** The time step of each particle this frame (adjusted for emission delay) */
+    float* step;
+    /** The color of each particle */
+    Color4* color;
+    /** The texture offset of each particle (for animation) */
+    Vec2* texOffset;
+    /** The number of particles in this batch */
+    size_t count;
+    
+    /**
+     * Creates an empty particle batch
+     */
+    ParticleBatch() : px(nullptr), py(nullptr), pz(nullptr),
+    vx(nullptr), vy(nullptr), vz(nullptr), size(nullptr), life(nullptr),
+    step(nullptr), color(nullptr), texOffset(nullptr), count(0) {}
+    
+    /**
+     * Returns a view of the particles in the range [begin,end)
+     *
+     * @param begin The first particle of the view
+     * @param end   The particle after the last one in the view
+     *
+     * @return a view of the particles in the range [begin,end)
+     */
+    ParticleBatch slice(size_t begin, size_t end) const;
+    
+    /**
+     * Applies gravity and drag to the particles, and moves them.
+     *
+     * Each particle velocity is first scaled by (1-drag*step), clamped at 0,
+     * and then accelerated by gravity*step. The position then moves by the
+     * new velocity times the time step.
+     *
+     * @param gravity   The gravitational acceleration
+     * @param drag      The drag coefficient (per second)
+     */
+    void integrate(const Vec3 gravity, float drag) const;
+    
+    /**
+     * Sets the size of each particle to interpolate over its life.
+     *
+     * The particle age is 1-life/lifespan, clamped to [0,1]. A particle of
+     * age 0 has size start, while a particle of age 1 has size end. If the
+     * lifespan is not positive, all particles are treated as age 1.
+     *
+     * @param start     The size of a newly emitted particle
+     * @param end       The size of an expiring particle
+     * @param lifespan  The particle lifespan in seconds
+     */
+    void scaleSize(float start, float end, float lifespan) const;
+    
+    /**
+     * Sets the color of each particle to interpolate over its life.
+     *
+     * The particle age is 1-life/lifespan, clamped to [0,1]. A particle of
+     * age 0 has color start, while a particle of age 1 has color end. If the
+     * lifespan is not positive, all particles are treated as age 1.
+     *
+     * @param start     The color of a newly emitted particle
+     * @param end       The color of an expiring particle
+     * @param lifespan  The particle lifespan in seconds
+     */
+    void fadeColor(Color4 start, Color4 end, float lifespan) const;
+};
+
+/**
+ * @typedef ParticleBatchUpdater
+ *
+ * This type represents a function to update all particles at once.
+ *
+ * This function is an alternative to {@link ParticleUpdater} for simulations
+ * that can be written over a {@link ParticleBatch}. When it is set, the
+ * particle system stores the particles as a structure of arrays and creates
+ * the instance data itself, from the position, size, color and texture
+ * offset of each particle.
+ *
+ * As with {@link ParticleUpdater}, the `life` attribute is managed by the
+ * system, and has already been reduced by `step` when this function is
+ * called. Any particle with non-positive life (including one killed by this
+ * function) is deleted after the update. If the system has a thread pool,
+ * this function may be called on several disjoint slices at once, so it
+ * must be safe to run in parallel with itself.
+ *
+ * This function type is equivalent to
+ *
+ *      std::function<void(const ParticleBatch& batch)>
+ *
+ * @param batch The particles to simulate
+ */
+typedef std::function<void(const ParticleBatch& batch)> ParticleBatchUpdater;
+
 
 #pragma mark -
 #pragma mark Particle System
@@ -426,6 +559,11 @@ typedef std::function<bool(float delta, Particle3* part, ParticleInstance* inst)
  * function. Without this function, no instance data will be created for the
  * particles, so nothing can be rendered to the screen.
  *
+ * For simple motion, the per-particle function call can cost more than the
+ * simulation itself. In that case, use a {@link ParticleBatchUpdater}
+ * instead. It updates all of the particles at once over a {@link ParticleBatch},
+ * and may share the work with a {@link ThreadPool}.
+ *
  * While we do not support user-defined particles, it is possible to add user
  * data to a particle object with the function types {@link ParticleAllocator}
  * and {@link ParticleDeallocator}. In fact, {@link ParticleAllocator} is
@@ -454,6 +592,8 @@ private:
     ParticleInstance* _instances;
     /** The user defined particles */
     Particle3* _particles;
+    /** Scratch keys for depth sorting and recycling (twice the capacity) */
+    Uint64* _ordering;
     /** The particle mesh template */
     Mesh<ParticleVertex> _mesh;
     /** The number of supported particles */
@@ -464,7 +604,7 @@ private:
     double _duration;
     /** Whether we need to greedily recycle particles */
     bool _greedy;
-    /** The oldest, non-recycled particle */
+    /** The number of particles left in the recycling heap */
     int  _oldest;
     /** Whether to optimize this particle system for 2d */
     bool _is2d;
@@ -478,6 +618,17 @@ private:
     /** Function pointer for updating particles */
     ParticleUpdater _updater;
     
+    /** Function pointer for updating particles in batches */
+    ParticleBatchUpdater _batchUpdater;
+    /** The structure-of-arrays storage when using a batch updater */
+    ParticleBatch _batch;
+    /** The squared camera distances for the batch (capacity length) */
+    float* _distances;
+    /** Whether the particle state currently lives in the batch */
+    bool _batched;
+    /** The thread pool for batch updates (may be null) */
+    std::shared_ptr<ThreadPool> _pool;
+    
 public:
 #pragma mark Constructors
     /**
@@ -922,12 +1073,83 @@ public:
         _updater = func;
     }
     
+    /**
+     * Returns the batch update function associated with this system.
+     *
+     * If this function is not null, it replaces the {@link #getUpdater}
+     * function. See {@link ParticleBatchUpdater} for the details.
+     *
+     * @return the batch update function associated with this system.
+     */
+    ParticleBatchUpdater getBatchUpdater() const { return _batchUpdater; }
+    
+    /**
+     * Sets the batch update function associated with this system.
+     *
+     * If this function is not null, it replaces the {@link #getUpdater}
+     * function. See {@link ParticleBatchUpdater} for the details. It is safe
+     * to change this function mid-simulation, as the live particles will be
+     * converted on the next call to {@link #update}.
+     *
+     * While a batch updater is in use, only the `userdata` of the particles
+     * in {@link #getParticles} is kept current. The simulation state should
+     * be read from {@link #getBatch} instead.
+     *
+     * @param func  The batch update function associated with this system.
+     */
+    void setBatchUpdater(ParticleBatchUpdater func) {
+        _batchUpdater = func;
+    }
+    
+    /**
+     * Returns the structure-of-arrays view of the live particles.
+     *
+     * This view is only valid while a batch updater is in use, and only
+     * until the next call to {@link #update}. Otherwise it is empty.
+     *
+     * @return the structure-of-arrays view of the live particles.
+     */
+    const ParticleBatch& getBatch() const { return _batch; }
+    
+    /**
+     * Returns the thread pool for batch updates.
+     *
+     * If this value is not null, {@link #update} splits the particles into
+     * slices and calls the {@link ParticleBatchUpdater} on them in parallel.
+     * It has no effect on a per-particle {@link ParticleUpdater}.
+     *
+     * @return the thread pool for batch updates.
+     */
+    const std::shared_ptr<ThreadPool>& getThreadPool() const { return _pool; }
+    
+    /**
+     * Sets the thread pool for batch updates.
+     *
+     * If this value is not null, {@link #update} splits the particles into
+     * slices and calls the {@link ParticleBatchUpdater} on them in parallel.
+     * It has no effect on a per-particle {@link ParticleUpdater}.
+     *
+     * @param pool  The thread pool for batch updates.
+     */
+    void setThreadPool(const std::shared_ptr<ThreadPool>& pool) { _pool = pool; }
+    
     /**
      * Updates the simulation by the given amount of time.
      *
      * Most of the work of this method is implemented by the particle class.
      * This method manages particle emission (with delay) and camera distance.
      *
+     * Dead particles are removed with a stable, linear-time compaction, so
+     * the surviving particles keep their relative order from frame to frame.
+     * Unless this system is {@link #is2d}, the particles (and their instances)
+     * are then sorted back-to-front with a radix sort on the camera distance.
+     * This sort is skipped entirely if the particles are still in order from
+     * the previous frame.
+     *
+     * If this system has a {@link ParticleBatchUpdater}, it replaces the
+     * per-particle {@link ParticleUpdater}. The system then creates the
+     * instance data itself from the structure-of-arrays batch.
+     *
      * @param delta     The time passed in the simulation
      * @param camera    The camera position in world space
      */
@@ -957,13 +1179,52 @@ private:
      *
      * Particles are allocated from internal memory. If the maximum number of
      * particles has been reached, this will recycle the oldest particle.
-     * However, behavior is undefined if more than {@link #getCapacity}
-     * particles must be recycled.
+     * The oldest particles are tracked with a min-heap on the remaining life,
+     * which is built the first time a frame needs to recycle. However,
+     * behavior is undefined if more than {@link #getCapacity} particles must
+     * be recycled.
      *
      * @return a reference to a newly allocated particle.
      */
     Particle3& allocate();
     
+    /**
+     * Sorts the first size particles and instances back-to-front.
+     *
+     * The particles and instances must be in correspondence, with instance i
+     * belonging to particle i. This method uses a stable radix sort on the
+     * camera distance, and permutes both arrays in place. If the arrays are
+     * already in order (which is common when the camera is still), this
+     * method does nothing.
+     *
+     * @param size  The number of particles to sort
+     */
+    void depthSort(size_t size);
+    
+    /**
+     * Updates the simulation using the batch updater.
+     *
+     * This is the structure-of-arrays version of {@link #update}. It compacts
+     * the live particles in the batch, and then writes the instance data in
+     * back-to-front order (unless this system is {@link #is2d}).
+     *
+     * @param delta     The time passed in the simulation
+     * @param camera    The camera position in world space
+     */
+    void updateBatch(float delta, const Vec3 camera);
+    
+    /**
+     * Converts the live particles to or from the batch storage.
+     *
+     * This method allocates the batch storage if necessary. It is called
+     * whenever a batch updater is added to or removed from this system.
+     *
+     * @param batched   Whether to convert the particles to the batch
+     *
+     * @return true if the conversion was successful
+     */
+    bool convertBatch(bool batched);
+    
     /**
      * Allocates the instance buffer for this particle system
      *
@@ -199,6 +199,26 @@ private:
     unsigned int _vertTotal;
     /** The number of OpenGL calls in this pass (so far) */
     unsigned int _callTotal;
+    /** The number of bytes uploaded to the vertex buffer in this pass (so far) */
+    size_t _byteTotal;
+    /** The number of redundant uniform updates skipped in this pass (so far) */
+    unsigned int _skipTotal;
+    
+    // Cached shader state
+    /** The location of the drawing type uniform in the shader */
+    GLint _typeLocale;
+    /** The location of the perspective uniform in the shader */
+    GLint _perspLocale;
+    /** The location of the blur uniform in the shader */
+    GLint _blurLocale;
+    /** The uniforms (as dirty bits) whose cached values below match the shader */
+    GLuint _stateKnown;
+    /** The drawing type last sent to the shader */
+    GLint _stateType;
+    /** The perspective matrix last sent to the shader */
+    Mat4 _statePersp;
+    /** The blur offset last sent to the shader */
+    GLfloat _stateBlur[2];
     
     
 #pragma mark -
@@ -463,6 +483,55 @@ public:
      */
     unsigned int getCallsMade() const { return _callTotal; }
     
+    /**
+     * Returns the number of bytes uploaded to the graphics card in the latest pass (so far).
+     *
+     * This value includes both vertex and index data, but does not include
+     * the uniform blocks for gradients and scissors. It will be reset to 0
+     * whenever begin() is called.
+     *
+     * @return the number of bytes uploaded in the latest pass (so far).
+     */
+    size_t getBytesUploaded() const { return _byteTotal; }
+    
+    /**
+     * Returns the number of redundant uniform updates skipped in the latest pass (so far).
+     *
+     * A uniform update is redundant if the shader already has that value.
+     * This sprite batch tracks the drawing type, perspective and blur
+     * uniforms to avoid sending them twice. This value will be reset to 0
+     * whenever begin() is called.
+     *
+     * @return the number of redundant uniform updates skipped in the latest pass (so far).
+     */
+    unsigned int getStateChangesSkipped() const { return _skipTotal; }
+    
+    /**
+     * Sets the number of ring segments for streaming vertex data.
+     *
+     * By default, the sprite batch reloads its vertex buffer with buffer
+     * orphaning on each flush. With more than one segment, each flush instead
+     * writes to the next segment of a fenced ring (see
+     * {@link VertexBuffer#setStreamSegments}), so that the CPU never writes to
+     * data that the GPU is still reading. This is useful for sprite batches
+     * that flush many times per frame. A value of 1 restores the default.
+     *
+     * This value may NOT be changed during a drawing pass.
+     *
+     * @param segments  The number of ring segments
+     */
+    void setStreamSegments(unsigned int segments);
+    
+    /**
+     * Returns the number of ring segments for streaming vertex data.
+     *
+     * A value of 1 means that the sprite batch reloads its vertex buffer
+     * with buffer orphaning on each flush.
+     *
+     * @return the number of ring segments for streaming vertex data.
+     */
+    unsigned int getStreamSegments() const;
+    
     /**
      * Sets the shader for this sprite batch
      *
@@ -2022,6 +2091,14 @@ private:
      */
     void blurTexture(const std::shared_ptr<Texture>& texture, GLfloat step);
     
+    /**
+     * Caches the uniform locations of the active shader.
+     *
+     * This method also invalidates the cached uniform values, as they
+     * may not agree with the new shader.
+     */
+    void cacheLocations();
+    
     /**
      * Returns the number of vertices added to the drawing buffer.
      *
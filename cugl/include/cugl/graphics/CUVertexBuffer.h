@@ -50,6 +50,7 @@
 #ifndef __CU_VERTEX_BUFFER_H__
 #define __CU_VERTEX_BUFFER_H__
 #include <string>
+#include <vector>
 #include <unordered_map>
 #include <cugl/graphics/CUGraphicsBase.h>
 #include <cugl/core/math/CUMathBase.h>
@@ -126,6 +127,17 @@ protected:
     /** The index buffer for drawing a shape */
     GLuint _indxBuffer;
     
+    /** The number of ring segments for streaming (1 if not streaming) */
+    GLsizei _segments;
+    /** The ring segment currently holding the streamed data (-1 if none) */
+    GLint _segment;
+    /** The fences guarding each ring segment against GPU reads */
+    std::vector<GLsync> _fences;
+    /** The byte offset of the active vertex data in the vertex buffer */
+    GLsizeiptr _vertBase;
+    /** The index offset of the active index data in the index buffer */
+    GLsizei _indxBase;
+    
     /** The shader currently attached to this vertex buffer */
     std::shared_ptr<Shader> _shader;
     
@@ -133,6 +145,8 @@ protected:
     std::unordered_map<std::string, bool> _enabled;
     /** The settings for each attribute */
     std::unordered_map<std::string, AttribData> _attributes;
+    /** The shader locations for each attribute (cached on attachment) */
+    std::unordered_map<std::string, GLint> _locations;
     
 public:
 #pragma mark Constructors
@@ -347,6 +361,58 @@ public:
      */
     void loadIndexData(const void * data, GLsizei size, GLenum usage=GL_STREAM_DRAW);
     
+    /**
+     * Sets the number of ring segments used by {@link #streamData}.
+     *
+     * A streaming vertex buffer allocates its storage as a ring of segments,
+     * each of which has the full capacity of this buffer. Every call to
+     * {@link #streamData} writes to the next segment in the ring, so that the
+     * CPU never writes to memory that the GPU may still be reading. Each
+     * segment is guarded by a fence. If the GPU has not yet released the next
+     * segment, the buffer is orphaned instead of waiting on the fence.
+     *
+     * A value of 1 disables the ring. In that case {@link #streamData} is the
+     * same as a call to {@link #loadVertexData} and {@link #loadIndexData}.
+     *
+     * This method reallocates the graphics card storage, discarding any data
+     * previously loaded. It will bind this vertex buffer.
+     *
+     * @param segments  The number of ring segments
+     */
+    void setStreamSegments(GLsizei segments);
+    
+    /**
+     * Returns the number of ring segments used by {@link #streamData}.
+     *
+     * A value of 1 means that streaming is disabled, and data is loaded with
+     * buffer orphaning instead.
+     *
+     * @return the number of ring segments used by {@link #streamData}.
+     */
+    GLsizei getStreamSegments() const { return _segments; }
+    
+    /**
+     * Streams the given vertices and indices to the next ring segment.
+     *
+     * This method is an alternative to {@link #loadVertexData} and
+     * {@link #loadIndexData} for data that changes every frame. The data is
+     * written to the next segment in the ring (see {@link #setStreamSegments})
+     * with an unsynchronized map. All subsequent calls to {@link #draw} and
+     * {@link #drawDirect} will refer to this segment, so draw offsets remain
+     * relative to the start of the data streamed.
+     *
+     * The indices should be relative to the vertices in this call, exactly
+     * as they would be for {@link #loadIndexData}.
+     *
+     * This method will only succeed if this buffer is actively bound.
+     *
+     * @param verts The vertices to load
+     * @param vsize The number of vertices to load
+     * @param indx  The indices to load
+     * @param isize The number of indices to load
+     */
+    void streamData(const void* verts, GLsizei vsize, const void* indx, GLsizei isize);
+    
     /**
      * Draws to the active framebuffer using this vertex buffer
      *
@@ -457,6 +523,33 @@ public:
      */
     void disableAttribute(const std::string name);
     
+#pragma mark -
+#pragma mark Internal Helpers
+protected:
+    /**
+     * Repositions all enabled attributes to start at the given byte offset.
+     *
+     * This method is used to point the shader at the active ring segment
+     * without having to rewrite the indices. It assumes that the vertex
+     * buffer is bound.
+     *
+     * @param base  The byte offset of the vertex data
+     */
+    void rebaseAttributes(GLsizeiptr base);
+    
+    /**
+     * Writes the data to the given range of the currently bound buffer.
+     *
+     * The range is mapped without synchronization, as the ring fences
+     * guarantee that the GPU is no longer reading from it. If the map
+     * fails, this method falls back to a standard buffer update.
+     *
+     * @param target    The buffer binding target
+     * @param offset    The byte offset of the range
+     * @param length    The byte length of the range
+     * @param data      The data to write
+     */
+    void writeRange(GLenum target, GLintptr offset, GLsizeiptr length, const void* data);
     
 };
 
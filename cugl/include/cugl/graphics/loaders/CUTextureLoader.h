@@ -47,6 +47,7 @@
 #define __CU_TEXTURE_LOADER_H__
 #include <cugl/core/assets/CULoader.h>
 #include <cugl/graphics/CUTexture.h>
+#include <atomic>
 
 namespace cugl {
 
@@ -81,6 +82,12 @@ namespace scene3 {
  * remainder of asset loading using {@link Application#schedule}.  This is a
  * good template for asset loaders in general.
  *
+ * Decoding image files is the most expensive part of loading a texture. To
+ * speed up startup, this loader supports an optional on-disk cache of
+ * decoded images (see {@link #setCacheDirectory}). Each cache entry stores
+ * the raw pixels in the format used by OpenGL, and is keyed by the source
+ * path, its modification time, and a hash of its contents.
+ *
  * As with all of our loaders, this loader is designed to be attached to an
  * asset manager. Use the method {@link getHook()} to get the appropriate
  * pointer for attaching the loader.
@@ -101,6 +108,50 @@ protected:
     GLuint _wrapt;
     /** The default support for mipmaps */
     bool _mipmaps;
+    /** The directory for cached decoded images (empty if caching is off) */
+    std::string _cacheDir;
+    /** The number of images read from the cache */
+    std::atomic<Uint32> _cacheHits;
+    /** The number of images that were not found in the cache */
+    std::atomic<Uint32> _cacheMisses;
+    
+#pragma mark Image Cache
+    /**
+     * Returns the cache file for the given source image
+     *
+     * @param source    The pathname to the asset
+     *
+     * @return the cache file for the given source image
+     */
+    std::string getCachePath(const std::string source) const;
+    
+    /**
+     * Returns the decoded image for the given source, if it is cached.
+     *
+     * The cache entry is only used if it matches the source file. It must
+     * have the same size and either the same modification time or the same
+     * content hash. Otherwise this method returns nullptr.
+     *
+     * @param source    The pathname to the asset
+     * @param path      The full path to the source image
+     *
+     * @return the decoded image for the given source, if it is cached.
+     */
+    SDL_Surface* readCache(const std::string source, const std::string path);
+    
+    /**
+     * Writes the decoded image for the given source to the cache.
+     *
+     * This method is safe to call from any thread. The entry is written to
+     * a temporary file first, so other threads never read a partial entry.
+     *
+     * @param source    The pathname to the asset
+     * @param path      The full path to the source image
+     * @param surface   The decoded image
+     *
+     * @return true if the image was successfully cached
+     */
+    bool writeCache(const std::string source, const std::string path, SDL_Surface* surface);
     
 #pragma mark Asset Loading
     /**
@@ -314,6 +365,26 @@ public:
         return (result->init(threads) ? result : nullptr);
     }
     
+#pragma mark -
+#pragma mark Bulk Loading
+    /**
+     * Synchronously loads all of the assets in the given JSON category.
+     *
+     * The JSON value should be the child of an asset directory for the
+     * JSON key of this loader. Each child of that value is loaded as
+     * with {@link #load}. The main CUGL thread will block until loading
+     * is complete.
+     *
+     * If there is a decoder pool, the images are decoded in parallel by the
+     * decoder threads (with this thread participating). The OpenGL textures
+     * are then created on this thread, in directory order.
+     *
+     * @param json      The asset directory entries for this loader
+     *
+     * @return true if all of the assets were successfully loaded
+     */
+    virtual bool loadCategory(const std::shared_ptr<JsonValue>& json) override;
+    
 #pragma mark -
 #pragma mark Properties
     
@@ -423,6 +494,56 @@ public:
      */
     void setMipMaps(bool flag) { _mipmaps = flag; }
     
+    /**
+     * Returns the directory for cached decoded images.
+     *
+     * If this value is empty, there is no cache and every texture is decoded
+     * from its image file.
+     *
+     * @return the directory for cached decoded images.
+     */
+    const std::string getCacheDirectory() const { return _cacheDir; }
+    
+    /**
+     * Sets the directory for cached decoded images.
+     *
+     * When this value is not empty, every decoded image is written to this
+     * directory as raw pixels. Later loads of the same image read the pixels
+     * directly, skipping both image decoding and format conversion. An entry
+     * is invalidated if the image file changes size, or if it changes both
+     * modification time and contents. The directory should be writable, so
+     * the save directory ({@link Application#getSaveDirectory}) is a good
+     * choice. It is created if it does not exist.
+     *
+     * Cache entries are uncompressed, so they use more disk space than
+     * the original images. Setting this value to the empty string disables
+     * the cache. It is not safe to change this value while loading assets.
+     *
+     * @param path  The directory for cached decoded images.
+     */
+    void setCacheDirectory(const std::string path);
+    
+    /**
+     * Returns the number of images read from the cache.
+     *
+     * This value is useful for comparing cold and warm startup times.
+     *
+     * @return the number of images read from the cache.
+     */
+    Uint32 getCacheHits() const { return _cacheHits.load(); }
+    
+    /**
+     * Returns the number of images that were not found in the cache.
+     *
+     * A miss is any cache lookup that fails, either because there is no cache
+     * entry or because the entry is out of date. These images are decoded
+     * from their source file instead. This value is useful for comparing cold
+     * and warm startup times.
+     *
+     * @return the number of images that were not found in the cache.
+     */
+    Uint32 getCacheMisses() const { return _cacheMisses.load(); }
+    
 };
 
     }
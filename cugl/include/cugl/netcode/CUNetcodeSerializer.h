@@ -49,6 +49,7 @@
 #include <variant>
 #include <string>
 #include <vector>
+#include <span>
 #include <cstdint>
 #include <cstddef>
 
@@ -143,8 +144,13 @@ enum NetcodeType : std::uint8_t {
  *
  * You should deserialize all of these with the {@link NetcodeDeserializer}.
  * 
- * Note that if a char* (not a C++ string) is written, it will be deserialized as a 
+ * Note that if a char* (not a C++ string) is written, it will be deserialized as a
  * std::string. The same applies to vectors of char*.
+ *
+ * The buffer is reused between messages. Calling {@link #reset} does not
+ * release its memory, so a serializer that is kept around (instead of being
+ * allocated for each message) does not allocate once it reaches the size
+ * of the largest message. Use {@link #reserve} to skip the initial growth.
  */
 class NetcodeSerializer {
 private:
@@ -171,8 +177,20 @@ public:
     static std::shared_ptr<NetcodeSerializer> alloc() {
         return std::make_shared<NetcodeSerializer>();
     }
-    
+
     /**
+     * Reserves space in the buffer for a message of the given size.
+     *
+     * This method is an optimization only. It prevents the buffer from
+     * reallocating as values are written, provided that the message is no
+     * larger than the given number of bytes. The buffer never shrinks, even
+     * when {@link #reset} is called.
+     *
+     * @param size  The expected size of a message in bytes
+     */
+    void reserve(size_t size) { _data.reserve(size); }
+
+/**
      * Writes a single boolean value.
      *
      * Values will be deserialized on other machines in the same order they were
@@ -258,7 +276,7 @@ public:
      *
      * @param s The value to write
      */
-    void writeString(std::string s);
+    void writeString(const std::string& s);
 
     /**
      * Writes a single string value.
@@ -294,7 +312,7 @@ public:
      *
      * @param v The vector to write
      */
-    void writeBoolVector(std::vector<bool> v);
+    void writeBoolVector(const std::vector<bool>& v);
 
     /**
      * Writes a vector of float values.
@@ -303,9 +321,24 @@ public:
      * written in. You should pass the result of {@link #serialize} to the
      * {@link NetcodeConnection} to send all values buffered up to this point.
      *
+     * Any contiguous sequence (such as a vector or an array) may be passed
+     * to this method without copying it.
+     *
+     * @param v The vector to write
+     */
+    void writeFloatVector(std::span<const float> v);
+
+    /**
+     * Writes a vector of float values.
+     *
+     * This method is the same as the span version. It exists so that an
+     * initializer list may be passed as the argument.
+     *
      * @param v The vector to write
      */
-    void writeFloatVector(std::vector<float> v);
+    void writeFloatVector(const std::vector<float>& v) {
+        writeFloatVector(std::span<const float>(v));
+    }
 
     /**
      * Writes a vector of double values.
@@ -314,9 +347,24 @@ public:
      * written in. You should pass the result of {@link #serialize} to the
      * {@link NetcodeConnection} to send all values buffered up to this point.
      *
+     * Any contiguous sequence (such as a vector or an array) may be passed
+     * to this method without copying it.
+     *
      * @param v The vector to write
      */
-    void writeDoubleVector(std::vector<double> v);
+    void writeDoubleVector(std::span<const double> v);
+
+    /**
+     * Writes a vector of double values.
+     *
+     * This method is the same as the span version. It exists so that an
+     * initializer list may be passed as the argument.
+     *
+     * @param v The vector to write
+     */
+    void writeDoubleVector(const std::vector<double>& v) {
+        writeDoubleVector(std::span<const double>(v));
+    }
 
     /**
      * Writes a vector of unsigned (32 bit) int values.
@@ -325,9 +373,24 @@ public:
      * written in. You should pass the result of {@link #serialize} to the
      * {@link NetcodeConnection} to send all values buffered up to this point.
      *
+     * Any contiguous sequence (such as a vector or an array) may be passed
+     * to this method without copying it.
+     *
      * @param v The vector to write
      */
-    void writeUint32Vector(std::vector<Uint32> v);
+    void writeUint32Vector(std::span<const Uint32> v);
+
+    /**
+     * Writes a vector of unsigned (32 bit) int values.
+     *
+     * This method is the same as the span version. It exists so that an
+     * initializer list may be passed as the argument.
+     *
+     * @param v The vector to write
+     */
+    void writeUint32Vector(const std::vector<Uint32>& v) {
+        writeUint32Vector(std::span<const Uint32>(v));
+    }
 
     /**
      * Writes a vector of unsigned (64 bit) int values.
@@ -336,9 +399,24 @@ public:
      * written in. You should pass the result of {@link #serialize} to the
      * {@link NetcodeConnection} to send all values buffered up to this point.
      *
+     * Any contiguous sequence (such as a vector or an array) may be passed
+     * to this method without copying it.
+     *
+     * @param v The vector to write
+     */
+    void writeUint64Vector(std::span<const Uint64> v);
+
+    /**
+     * Writes a vector of unsigned (64 bit) int values.
+     *
+     * This method is the same as the span version. It exists so that an
+     * initializer list may be passed as the argument.
+     *
      * @param v The vector to write
      */
-    void writeUint64Vector(std::vector<Uint64> v);
+    void writeUint64Vector(const std::vector<Uint64>& v) {
+        writeUint64Vector(std::span<const Uint64>(v));
+    }
 
     /**
      * Writes a vector of signed (32 bit) int values.
@@ -347,9 +425,24 @@ public:
      * written in. You should pass the result of {@link #serialize} to the
      * {@link NetcodeConnection} to send all values buffered up to this point.
      *
+     * Any contiguous sequence (such as a vector or an array) may be passed
+     * to this method without copying it.
+     *
+     * @param v The vector to write
+     */
+    void writeSint32Vector(std::span<const Sint32> v);
+
+    /**
+     * Writes a vector of signed (32 bit) int values.
+     *
+     * This method is the same as the span version. It exists so that an
+     * initializer list may be passed as the argument.
+     *
      * @param v The vector to write
      */
-    void writeSint32Vector(std::vector<Sint32> v);
+    void writeSint32Vector(const std::vector<Sint32>& v) {
+        writeSint32Vector(std::span<const Sint32>(v));
+    }
 
     /**
      * Writes a vector of signed (64 bit) int values.
@@ -358,9 +451,24 @@ public:
      * written in. You should pass the result of {@link #serialize} to the
      * {@link NetcodeConnection} to send all values buffered up to this point.
      *
+     * Any contiguous sequence (such as a vector or an array) may be passed
+     * to this method without copying it.
+     *
      * @param v The vector to write
      */
-    void writeSint64Vector(std::vector<Sint64> v);
+    void writeSint64Vector(std::span<const Sint64> v);
+
+    /**
+     * Writes a vector of signed (64 bit) int values.
+     *
+     * This method is the same as the span version. It exists so that an
+     * initializer list may be passed as the argument.
+     *
+     * @param v The vector to write
+     */
+    void writeSint64Vector(const std::vector<Sint64>& v) {
+        writeSint64Vector(std::span<const Sint64>(v));
+    }
     
     /**
      * Writes a vector of string values.
@@ -371,7 +479,7 @@ public:
      *
      * @param v The vector to write
      */
-    void writeStringVector(std::vector<std::string> v);
+    void writeStringVector(const std::vector<std::string>& v);
 
     /**
      * Writes a vector of string values.
@@ -385,7 +493,7 @@ public:
      * 
      * @param v The vector to write
      */
-    void writeCharsVector(std::vector<char*> v);
+    void writeCharsVector(const std::vector<char*>& v);
 
     /**
      * Write a vector of {@link JsonValue} objects.
@@ -396,7 +504,7 @@ public:
      *
      * @param v The vector to write
      */
-    void writeJsonVector(std::vector<std::shared_ptr<JsonValue>> v);
+    void writeJsonVector(const std::vector<std::shared_ptr<JsonValue>>& v);
 
     /**
      * Returns a byte vector of all written values suitable for network transit.
@@ -440,9 +548,11 @@ public:
     
     /**
      * Clears the input buffer.
+     *
+     * The memory of the buffer is retained for the next message.
      */
     void reset();
-    
+
 };
 
 
@@ -456,8 +566,12 @@ public:
  */
 class NetcodeDeserializer {
 private:
-    /** Currently loaded data */
+    /** Storage for messages that are copied on load */
     std::vector<std::byte> _data;
+    /** Currently loaded data (either _data or a caller-owned buffer) */
+    const std::byte* _buffer;
+    /** The number of bytes in the currently loaded data */
+    size_t _size;
     /** Position in the data of next byte to read */
     size_t _pos;
 
@@ -501,7 +615,7 @@ public:
      * to use an init method. However, we do include a static {@link #alloc} method
      * for creating shared pointers.
      */
-    NetcodeDeserializer() : _pos(0) {}
+    NetcodeDeserializer() : _buffer(nullptr), _size(0), _pos(0) {}
 
     /**
      * Returns a newly created Netcode ,l Deserializer.
@@ -533,7 +647,31 @@ public:
      * @param msg The byte vector serialized by {@link NetcodeSerializer}
      */
     void receive(const std::vector<std::byte>& msg);
-    
+
+    /**
+     * Loads a new message to be read, taking ownership of it.
+     *
+     * This method is identical to {@link #receive}, except that the message
+     * is moved into this deserializer instead of copied.
+     *
+     * @param msg The byte vector serialized by {@link NetcodeSerializer}
+     */
+    void receive(std::vector<std::byte>&& msg);
+
+    /**
+     * Loads a new message to be read in place.
+     *
+     * This method is identical to {@link #receive}, except that the message
+     * is not copied. Values are read directly from the given buffer, which
+     * is owned by the caller. The buffer must remain valid (and unchanged)
+     * until the next message is loaded or this deserializer is reset. This
+     * is typically the case for the message in a {@link NetcodeConnection}
+     * callback, provided all values are read within the callback.
+     *
+     * @param msg The bytes serialized by {@link NetcodeSerializer}
+     */
+    void receiveView(std::span<const std::byte> msg);
+
     /**
      * Loads a new Base 64 message to be read.
      *
@@ -579,7 +717,7 @@ public:
      *
      * @return true if there is any data left to be read
      */
-    bool available() const { return _pos < _data.size(); }
+    bool available() const { return _pos < _size; }
     
     /**
      * Returns the type of the next data value to be read.
@@ -0,0 +1,442 @@
+//
+//  CUCachedNode.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a scene graph node that caches the rendering of its
+//  children in a texture. It is designed for static scenery, like terrain
+//  and buildings, that is made of many nodes but seldom changes. Instead of
+//  traversing, transforming and submitting every node each frame, the
+//  subtree is drawn to a render target once. Afterwards the subtree is a
+//  single textured quad, no matter how complex it is.
+//
+//  The cache is invalidated automatically whenever a descendant changes (see
+//  SceneNode#markChanged), and is rebuilt the next time the node is drawn.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+//
+#ifndef __CU_CACHED_NODE_H__
+#define __CU_CACHED_NODE_H__
+#include <cugl/scene2/CUSceneNode2.h>
+#include <cugl/graphics/CURenderTarget.h>
+
+namespace cugl {
+
+    /**
+     * The classes to construct a 2-d scene graph.
+     *
+     * Even though this is an optional package, this is one of the core features
+     * of CUGL. These classes provide basic UI support (including limited Figma)
+     * support. Any 2-d game will make extensive use of these classes. And
+     * even 3-d games may use these classes for the HUD overlay.
+     */
+    namespace scene2 {
+/**
+ * This is a scene graph node that caches its children in a texture.
+ *
+ * Static scenery is often composed of many nodes that never move. A normal
+ * scene graph still traverses, transforms and submits all of these nodes
+ * every animation frame. This node instead renders its descendants once to
+ * a {@link graphics::RenderTarget}, and then draws that texture as a single
+ * quad. Hence the cost of drawing the subtree is independent of its size.
+ *
+ * The cache is rebuilt whenever it is out of date. The cache becomes out of
+ * date whenever {@link SceneNode#markChanged} is called on a descendant. This
+ * happens automatically for changes to the transform, color, visibility,
+ * scissor or children of any descendant, as well as for changes to textures,
+ * meshes and text of the built-in node types. Custom nodes that change what
+ * they draw should call {@link SceneNode#markChanged}, or you can force a
+ * rebuild with {@link #invalidate}. Changes to this node itself (such as its
+ * position) do not invalidate the cache.
+ *
+ * Only the content bounds of this node are cached. Any descendant (or part
+ * of a descendant) outside of the content bounds is not drawn. In addition,
+ * the descendants are cached with a white tint, and the cached texture is
+ * tinted by the color of this node. This is the same as the normal render
+ * for descendants with relative color (the default).
+ *
+ * The cache may be rebuilt while drawing to any framebuffer, including a
+ * {@link Scene2Texture} or another user render target. The previously
+ * bound framebuffer is restored afterwards. This node will render its
+ * children normally if it is a descendant of another CachedNode (in which
+ * case it is part of that cache), or if caching is disabled with
+ * {@link #setCaching}.
+ *
+ * This node is a render barrier for {@link OrderedNode}, as its descendants
+ * are drawn as a single unit.
+ */
+class CachedNode : public SceneNode {
+protected:
+    /** The render target storing the cached children */
+    std::shared_ptr<graphics::RenderTarget> _target;
+    /** Whether to cache the children of this node */
+    bool _caching;
+    /** Whether the cached render target is out of date */
+    bool _stale;
+    /** The number of texture pixels per unit of content size */
+    float _density;
+    /** The number of times the children have been cached */
+    Uint32 _bakeTotal;
+
+#pragma mark -
+#pragma mark Constructors
+public:
+    /**
+     * Creates an uninitialized cached node.
+     *
+     * You must initialize this CachedNode before use.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a CachedNode
+     * on the heap, use one of the static constructors instead.
+     */
+    CachedNode();
+
+    /**
+     * Deletes this node, disposing all resources
+     */
+    ~CachedNode() { dispose(); }
+
+    /**
+     * Disposes all of the resources used by this node.
+     *
+     * A disposed CachedNode can be safely reinitialized. Any children owned by
+     * this node will be released. They will be deleted if no other object owns
+     * them.
+     *
+     * It is unsafe to call this on a CachedNode that is still currently inside
+     * of a scene graph.
+     */
+    virtual void dispose() override;
+
+    /**
+     * Initializes a node with the given JSON specificaton.
+     *
+     * This initializer is designed to receive the "data" object from the
+     * JSON passed to {@link Scene2Loader}. This JSON format supports all
+     * of the attribute values of its parent class. In addition, it supports
+     * the following additional attributes:
+     *
+     *      "caching":  A boolean indicating whether to cache the children
+     *      "density":  The number of texture pixels per unit of content size
+     *
+     * All attributes are optional. There are no required attributes. By
+     * default, caching is enabled and the density is the pixel density of
+     * the display.
+     *
+     * @param manager   The asset manager handling this asset
+     * @param data      The JSON object specifying the node
+     *
+     * @return true if initialization was successful.
+     */
+    virtual bool initWithData(const AssetManager* manager,
+                              const std::shared_ptr<JsonValue>& data) override;
+
+#pragma mark -
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated cached node at the world origin.
+     *
+     * The node has both position and size (0,0). As nothing outside of the
+     * content bounds is cached, you should resize this node before use.
+     *
+     * @return a newly allocated cached node at the world origin.
+     */
+    static std::shared_ptr<CachedNode> alloc() {
+        std::shared_ptr<CachedNode> result = std::make_shared<CachedNode>();
+        return (result->init() ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated cached node with the given size.
+     *
+     * The size defines the content size. The bounding box of the node is
+     * (0,0,width,height) and is anchored in the bottom left corner (0,0).
+     * The node is positioned at the origin in parent space.
+     *
+     * @param size  The size of the node in parent space
+     *
+     * @return a newly allocated cached node with the given size.
+     */
+    static std::shared_ptr<CachedNode> allocWithBounds(const Size size) {
+        std::shared_ptr<CachedNode> result = std::make_shared<CachedNode>();
+        return (result->initWithBounds(size) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated cached node with the given size.
+     *
+     * The size defines the content size. The bounding box of the node is
+     * (0,0,width,height) and is anchored in the bottom left corner (0,0).
+     * The node is positioned at the origin in parent space.
+     *
+     * @param width     The width of the node in parent space
+     * @param height    The height of the node in parent space
+     *
+     * @return a newly allocated cached node with the given size.
+     */
+    static std::shared_ptr<CachedNode> allocWithBounds(float width, float height) {
+        std::shared_ptr<CachedNode> result = std::make_shared<CachedNode>();
+        return (result->initWithBounds(width,height) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated cached node with the given bounds.
+     *
+     * The rectangle origin is the bottom left corner of the node in parent
+     * space, and corresponds to the origin of the Node space. The size
+     * defines its content width and height in node space. The node anchor
+     * is placed in the bottom left corner.
+     *
+     * Because the bounding box is explicit, this is the preferred constructor
+     * for this class.
+     *
+     * @param rect  The bounds of the node in parent space
+     *
+     * @return a newly allocated cached node with the given bounds.
+     */
+    static std::shared_ptr<CachedNode> allocWithBounds(const Rect rect) {
+        std::shared_ptr<CachedNode> result = std::make_shared<CachedNode>();
+        return (result->initWithBounds(rect) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated cached node with the given bounds.
+     *
+     * The rectangle origin is the bottom left corner of the node in parent
+     * space, and corresponds to the origin of the Node space. The size
+     * defines its content width and height in node space. The node anchor
+     * is placed in the bottom left corner.
+     *
+     * Because the bounding box is explicit, this is the preferred constructor
+     * for this class.
+     *
+     * @param x         The x-coordinate of the node origin in parent space
+     * @param y         The y-coordinate of the node origin in parent space
+     * @param width     The width of the node in parent space
+     * @param height    The height of the node in parent space
+     *
+     * @return a newly allocated cached node with the given bounds.
+     */
+    static std::shared_ptr<CachedNode> allocWithBounds(float x, float y, float width, float height) {
+        std::shared_ptr<CachedNode> result = std::make_shared<CachedNode>();
+        return (result->initWithBounds(x,y,width,height) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated node with the given JSON specificaton.
+     *
+     * This initializer is designed to receive the "data" object from the
+     * JSON passed to {@link Scene2Loader}. This JSON format supports all
+     * of the attribute values of its parent class. In addition, it supports
+     * the following additional attributes:
+     *
+     *      "caching":  A boolean indicating whether to cache the children
+     *      "density":  The number of texture pixels per unit of content size
+     *
+     * All attributes are optional. There are no required attributes. By
+     * default, caching is enabled and the density is the pixel density of
+     * the display.
+     *
+     * @param manager   The asset manager handling this asset
+     * @param data      The JSON object specifying the node
+     *
+     * @return a newly allocated node with the given JSON specificaton.
+     */
+    static std::shared_ptr<SceneNode> allocWithData(const AssetManager* manager,
+                                                    const std::shared_ptr<JsonValue>& data) {
+        std::shared_ptr<CachedNode> result = std::make_shared<CachedNode>();
+        return (result->initWithData(manager,data) ? result : nullptr);
+    }
+
+#pragma mark -
+#pragma mark Attributes
+    /**
+     * Returns true if this node caches its children.
+     *
+     * If this value is false, this node renders like a normal {@link SceneNode}.
+     * The default value is true.
+     *
+     * @return true if this node caches its children.
+     */
+    bool isCaching() const { return _caching; }
+
+    /**
+     * Sets whether this node caches its children.
+     *
+     * If this value is false, this node renders like a normal {@link SceneNode}.
+     * Disabling the cache releases the render target. The default value is
+     * true.
+     *
+     * @param value Whether this node caches its children.
+     */
+    void setCaching(bool value);
+
+    /**
+     * Returns true if the cache is out of date.
+     *
+     * An out of date cache is rebuilt the next time this node is rendered.
+     *
+     * @return true if the cache is out of date.
+     */
+    bool isStale() const { return _stale; }
+
+    /**
+     * Marks the cache as out of date.
+     *
+     * This is only necessary when a descendant changes what it draws without
+     * calling {@link SceneNode#markChanged}.
+     */
+    void invalidate() { _stale = true; }
+
+    /**
+     * Returns the number of texture pixels per unit of content size.
+     *
+     * This value determines the resolution of the cache. If this node is
+     * scaled up (either directly or by the camera), the density should be
+     * increased to prevent blurring. The default value is the pixel density
+     * of the display.
+     *
+     * @return the number of texture pixels per unit of content size.
+     */
+    float getDensity() const { return _density; }
+
+    /**
+     * Sets the number of texture pixels per unit of content size.
+     *
+     * This value determines the resolution of the cache. If this node is
+     * scaled up (either directly or by the camera), the density should be
+     * increased to prevent blurring. The default value is the pixel density
+     * of the display.
+     *
+     * @param density   The number of texture pixels per unit of content size.
+     */
+    void setDensity(float density);
+
+    /**
+     * Returns the number of times the children have been cached.
+     *
+     * This value is useful for verifying that a subtree is truly static.
+     * It is reset when the node is disposed.
+     *
+     * @return the number of times the children have been cached.
+     */
+    Uint32 getBakeCount() const { return _bakeTotal; }
+
+    /**
+     * Returns the texture storing the cached children.
+     *
+     * This value is nullptr if the children have not been cached yet.
+     *
+     * @return the texture storing the cached children.
+     */
+    std::shared_ptr<graphics::Texture> getTexture() const {
+        return _target == nullptr ? nullptr : _target->getTexture();
+    }
+
+    /**
+     * Sets the untransformed size of the node.
+     *
+     * The content size remains the same no matter how the node is scaled or
+     * rotated. All nodes must have a size, though it may be degenerate (0,0).
+     *
+     * As only the content bounds are cached, this will invalidate the cache.
+     *
+     * @param size  The untransformed size of the node.
+     */
+    virtual void setContentSize(const Size size) override;
+
+    /**
+     * Sets the untransformed size of the node.
+     *
+     * The content size remains the same no matter how the node is scaled or
+     * rotated. All nodes must have a size, though it may be degenerate (0,0).
+     *
+     * As only the content bounds are cached, this will invalidate the cache.
+     *
+     * @param width     The untransformed width of the node.
+     * @param height    The untransformed height of the node.
+     */
+    virtual void setContentSize(float width, float height) override {
+        setContentSize(Size(width, height));
+    }
+
+#pragma mark -
+#pragma mark Rendering
+    /**
+     * Draws this node and all of its children with the given SpriteBatch.
+     *
+     * If caching is enabled, this draws the cached texture of the children,
+     * rebuilding the cache first if it is out of date. The cache is rebuilt
+     * within the current pass of the sprite batch. The framebuffer that is
+     * active when this method is called (the screen or another render target)
+     * is restored afterwards, as are the perspective, blending, scissor,
+     * stencil and blur state of the sprite batch and its counters.
+     *
+     * @param batch     The SpriteBatch to draw with.
+     * @param transform The global transformation matrix.
+     * @param tint      The tint to blend with the Node color.
+     */
+    virtual void render(const std::shared_ptr<graphics::SpriteBatch>& batch,
+                        const Affine2& transform, Color4 tint) override;
+
+    /**
+     * Returns false, as this node must be drawn with render().
+     *
+     * @return false, as this node must be drawn with render().
+     */
+    virtual bool isFlattenable() const override { return false; }
+
+protected:
+    /**
+     * Marks the cache as out of date when a descendant changes.
+     */
+    virtual void descendantChanged() override { _stale = true; }
+
+    /**
+     * Renders the children of this node to the cache render target.
+     *
+     * The sprite batch must be actively drawing. It will be actively drawing
+     * with the same state when this method returns. The pass is not ended, so
+     * the counters of the sprite batch are preserved. The framebuffer that was
+     * bound when this method is called is bound again when it returns.
+     *
+     * @param batch     The SpriteBatch to draw with.
+     *
+     * @return true if the children were successfully cached
+     */
+    bool bake(const std::shared_ptr<graphics::SpriteBatch>& batch);
+};
+    }
+}
+
+#endif /* __CU_CACHED_NODE_H__ */
@@ -600,6 +600,40 @@ public:
      * @param order The render order of this node
      */
     void setOrder(Order order) { _order = order; }
+    
+    /**
+     * Returns true if this node uses a post-order traversal for ties.
+     *
+     * This is true for {@link Order#POST_ORDER}, {@link Order#POST_ASCEND},
+     * and {@link Order#POST_DESCEND}. In that case, the canonical positions
+     * passed to {@link #precedes} should come from a post-order traversal.
+     *
+     * @return true if this node uses a post-order traversal for ties.
+     */
+    bool isPostOrder() const {
+        return (_order == Order::POST_ORDER || _order == Order::POST_ASCEND ||
+                _order == Order::POST_DESCEND);
+    }
+    
+    /**
+     * Returns true if node a should be drawn before node b.
+     *
+     * This method implements the render order of this node. The canonical
+     * positions are the positions of each node in a pre-order traversal
+     * (or a post-order traversal if {@link #isPostOrder} is true). They are
+     * used to break ties between nodes of the same priority.
+     *
+     * This method is used by {@link Scene2} to apply this render order
+     * when the scene graph has been flattened.
+     *
+     * @param a         The first node to compare
+     * @param acanon    The canonical position of the first node
+     * @param b         The second node to compare
+     * @param bcanon    The canonical position of the second node
+     *
+     * @return true if node a should be drawn before node b.
+     */
+    bool precedes(const SceneNode* a, Uint32 acanon, const SceneNode* b, Uint32 bcanon) const;
 
     /**
      * Draws this node and all of its children with the given SpriteBatch.
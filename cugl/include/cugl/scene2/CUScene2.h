@@ -44,6 +44,7 @@
 #define __CU_SCENE_2_H__
 #include <cugl/core/math/cu_math.h>
 #include <cugl/core/CUScene.h>
+#include <cugl/core/util/CUThreadPool.h>
 #include <cugl/scene2/CUSceneNode2.h>
 #include <cugl/graphics/CUSpriteBatch.h>
 
@@ -93,6 +94,58 @@ protected:
     /** The destination factor for the blend function */
     GLenum _dstFactor;
     
+    /**
+     * A node in the flattened scene graph.
+     *
+     * Two-phase rendering replaces the recursive calls to render() with a
+     * linear array of these entries in pre-order. Each entry stores the state
+     * that would otherwise be on the call stack: the global transform, the
+     * tint, and the scissor. The descendants of an entry are exactly the
+     * entries after it, up to and including last.
+     */
+    class RenderEntry {
+    public:
+        /** The node for this entry */
+        SceneNode* node;
+        /** The index of the parent entry (-1 for children of the scene) */
+        Sint32 parent;
+        /** The index of the last descendant of this entry */
+        Uint32 last;
+        /** The depth of this node in the scene graph */
+        Uint32 depth;
+        /** The position of this node in a post-order traversal */
+        Uint32 postorder;
+        /** The global transform of this node */
+        Affine2 transform;
+        /** The tint of this node */
+        Color4 tint;
+        /** The scissor value (possibly nullptr) */
+        std::shared_ptr<graphics::Scissor> scissor;
+        /** Whether this node is outside of the camera viewport */
+        bool culled;
+        /** Whether this node is an OrderedNode (and so a render boundary) */
+        bool ordered;
+        /** Whether this node must be drawn with render() instead of draw() */
+        bool opaque;
+    };
+    
+    /** Whether to skip nodes outside of the camera viewport */
+    bool _culling;
+    /** The thread pool for computing transforms (nullptr to use this thread) */
+    std::shared_ptr<ThreadPool> _workers;
+    /** The flattened scene graph */
+    std::vector<RenderEntry> _entries;
+    /** The entry indices, sorted by depth */
+    std::vector<Uint32> _levels;
+    /** The start of each depth in the _levels array */
+    std::vector<Uint32> _levelStart;
+    /** The viewport of the camera in world coordinates */
+    Rect _viewport;
+    /** The scissor most recently applied by the two-phase renderer */
+    std::shared_ptr<graphics::Scissor> _activeScissor;
+    /** The number of nodes culled in the latest render pass */
+    Uint32 _culledTotal;
+    
 #pragma mark -
 #pragma mark Constructors
 public:
@@ -565,9 +618,142 @@ public:
      */
     virtual void render() override;
     
+    /**
+     * Returns true if this scene skips nodes outside of the camera viewport.
+     *
+     * When culling is active, any node whose content bounds do not intersect
+     * the camera viewport will not be drawn. Its children are still checked
+     * separately, as they need not be inside their parent. Nodes with empty
+     * content bounds are never culled. Culling relies on the content bounds,
+     * so it should not be used with nodes that draw outside of them.
+     *
+     * Culling is performed by the two-phase renderer. Activating culling
+     * will switch to two-phase rendering.
+     *
+     * @return true if this scene skips nodes outside of the camera viewport.
+     */
+    bool isCulling() const { return _culling; }
+    
+    /**
+     * Sets whether this scene skips nodes outside of the camera viewport.
+     *
+     * When culling is active, any node whose content bounds do not intersect
+     * the camera viewport will not be drawn. Its children are still checked
+     * separately, as they need not be inside their parent. Nodes with empty
+     * content bounds are never culled. Culling relies on the content bounds,
+     * so it should not be used with nodes that draw outside of them.
+     *
+     * Culling is performed by the two-phase renderer. Activating culling
+     * will switch to two-phase rendering.
+     *
+     * @param value Whether this scene skips nodes outside of the camera viewport.
+     */
+    void setCulling(bool value) { _culling = value; }
+    
+    /**
+     * Returns the thread pool for computing node transforms.
+     *
+     * If this value is not nullptr, the scene renders in two phases. The
+     * first phase flattens the scene graph, and computes the global transform
+     * of each node (and culls it) in parallel, one depth level at a time. The
+     * second phase submits the nodes to the sprite batch on the calling
+     * thread. Nodes must not be modified by other threads during rendering.
+     *
+     * @return the thread pool for computing node transforms.
+     */
+    const std::shared_ptr<ThreadPool>& getThreadPool() const { return _workers; }
+    
+    /**
+     * Sets the thread pool for computing node transforms.
+     *
+     * If this value is not nullptr, the scene renders in two phases. The
+     * first phase flattens the scene graph, and computes the global transform
+     * of each node (and culls it) in parallel, one depth level at a time. The
+     * second phase submits the nodes to the sprite batch on the calling
+     * thread. Nodes must not be modified by other threads during rendering.
+     *
+     * The thread pool may be shared with other tasks, as the rendering
+     * thread also participates in the computation.
+     *
+     * @param pool  The thread pool for computing node transforms.
+     */
+    void setThreadPool(const std::shared_ptr<ThreadPool>& pool) { _workers = pool; }
+    
+    /**
+     * Returns the number of nodes culled in the latest render pass.
+     *
+     * This value is always 0 if culling is not active.
+     *
+     * @return the number of nodes culled in the latest render pass.
+     */
+    Uint32 getNodesCulled() const { return _culledTotal; }
+    
+protected:
+    /**
+     * Draws all of the children of this scene with the active sprite batch.
+     *
+     * This method assumes that the sprite batch is actively drawing. It uses
+     * the two-phase renderer if either culling or a thread pool is active.
+     * Otherwise it calls {@link SceneNode#render} on each child.
+     */
+    void renderChildren();
+    
 private:
 #pragma mark -
 #pragma mark Internal Helpers
+    /**
+     * Appends the given node and its descendants to the flattened scene graph.
+     *
+     * Invisible nodes (and their descendants) are skipped.
+     *
+     * @param node      The node to flatten
+     * @param parent    The index of the parent entry
+     * @param depth     The depth of the node
+     * @param counter   The post-order counter
+     */
+    void flatten(SceneNode* node, Sint32 parent, Uint32 depth, Uint32& counter);
+    
+    /**
+     * Computes the transform, tint and culling state of the given entries.
+     *
+     * All of the parents of these entries must already be computed. This
+     * method is safe to call concurrently on disjoint ranges of the same depth.
+     *
+     * @param begin The first position in _levels to compute
+     * @param end   The position after the last in _levels to compute
+     */
+    void computeRange(size_t begin, size_t end);
+    
+    /**
+     * Submits the given range of flattened entries in pre-order.
+     *
+     * The range must consist of complete subtrees.
+     *
+     * @param begin The first entry to submit
+     * @param end   The entry after the last to submit
+     */
+    void submitRange(Uint32 begin, Uint32 end);
+    
+    /**
+     * Submits the descendants of an OrderedNode in its render order.
+     *
+     * Other ordered nodes among the descendants are render boundaries.
+     * They are sorted as a single unit, with their own descendants
+     * submitted according to their own render order.
+     *
+     * @param index The entry for the OrderedNode
+     */
+    void submitOrdered(Uint32 index);
+    
+    /**
+     * Submits a single entry (and its subtree if it is a boundary).
+     *
+     * This method is used by {@link #submitOrdered}.
+     *
+     * @param index The entry to submit
+     */
+    void submitEntry(Uint32 index);
+
     // Tightly couple with Node
     friend class SceneNode;
 };
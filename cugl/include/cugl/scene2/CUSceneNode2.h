@@ -1051,7 +1051,12 @@ public:
      *
      * @param color the color tinting this node.
      */
-    virtual void setColor(Color4 color) { _tintColor = color; }
+    virtual void setColor(Color4 color) {
+        if (_tintColor != color) {
+            _tintColor = color;
+            markChanged();
+        }
+    }
 
     /**
      * Returns the absolute color tinting this node.
@@ -1084,7 +1089,12 @@ public:
      *
      * @param visible   true if the node is visible.
      */
-    void setVisible(bool visible) { _isVisible = visible; }
+    void setVisible(bool visible) {
+        if (_isVisible != visible) {
+            _isVisible = visible;
+            markChanged();
+        }
+    }
     
     /**
      * Returns true if this node is tinted by its parent.
@@ -1106,7 +1116,7 @@ public:
      *
      * @param flag  Whether this node is tinted by its parent.
      */
-    void setRelativeColor(bool flag) { _hasParentColor = flag; }
+    void setRelativeColor(bool flag) { _hasParentColor = flag; markChanged(); }
     
     /**
      * Returns the scissor associated with this node.
@@ -1164,6 +1174,7 @@ public:
      */
     void setScissor(const std::shared_ptr<graphics::Scissor>& scissor) {
         _scissor = scissor;
+        markChanged();
     }
 
     /**
@@ -1188,7 +1199,10 @@ public:
      * of the same orientation. The rule for this intersection will
      * be the same as {@link graphics::Scissor#intersect}.
      */
-    void setScissor() { _scissor = graphics::Scissor::alloc(getContentSize());}
+    void setScissor() {
+        _scissor = graphics::Scissor::alloc(getContentSize());
+        markChanged();
+    }
 
     
 #pragma mark -
@@ -1860,6 +1874,7 @@ public:
      */
     void setPriority(float priority) {
         _priority = priority;
+        markChanged();
     }
 
     /**
@@ -1879,7 +1894,7 @@ public:
      *
      * @return the render priority of this node
      */
-    float getPriority() {
+    float getPriority() const {
         return _priority;
     }
     
@@ -1911,6 +1926,35 @@ public:
     virtual void render(const std::shared_ptr<graphics::SpriteBatch>& batch) {
         render(batch,Affine2::IDENTITY,Color4::WHITE);
     }
+    
+    /**
+     * Returns true if this node may be drawn by a flattened render pass.
+     *
+     * A {@link Scene2} can render in two phases, computing the transform of
+     * every node up front and then calling draw() directly. That pass never
+     * calls render(). Any subclass that overrides render() to change how its
+     * children are transformed or drawn should return false. The scene will
+     * then call render() on this node instead, and skip its descendants.
+     *
+     * @return true if this node may be drawn by a flattened render pass.
+     */
+    virtual bool isFlattenable() const { return true; }
+    
+    /**
+     * Notifies the ancestors of this node that its appearance has changed.
+     *
+     * This method is necessary for ancestors that cache their rendered
+     * descendants, such as {@link CachedNode}. It is called automatically
+     * whenever the transform, color, visibility, scissor or children of this
+     * node change, as well as when the render data of the built-in textured
+     * nodes and labels change. Custom subclasses should call this method
+     * whenever they change what they draw.
+     */
+    void markChanged() {
+        for(SceneNode* node = _parent; node != nullptr; node = node->_parent) {
+            node->descendantChanged();
+        }
+    }
 
     /**
      * Draws this Node via the given SpriteBatch.
@@ -1978,6 +2022,16 @@ public:
      * before we can apply a layout manager to the children.
      */
     virtual void doLayout();
+    
+protected:
+    /**
+     * Responds to a change in the appearance of a descendant of this node.
+     *
+     * This method is called by {@link #markChanged} on every ancestor of the
+     * changed node. By default it does nothing. Nodes that cache their
+     * rendered descendants should override it to invalidate that cache.
+     */
+    virtual void descendantChanged() {}
 
 private:
 #pragma mark -
@@ -2016,7 +2070,9 @@ private:
      * Updates the node to parent transform.
      *
      * This transform is defined by scaling, rotation, the post-rotation
-     * transform, and positional translation, in that order.
+     * transform, and positional translation, in that order. The ancestors
+     * are only notified (see {@link #markChanged}) if the transform is
+     * actually different.
      */
     void updateTransform();
     
@@ -924,6 +924,16 @@ public:
     virtual void render(const std::shared_ptr<graphics::SpriteBatch>& batch) override {
         render(batch,Affine2::IDENTITY,Color4::WHITE);
     }
+    
+    /**
+     * Returns false, as this node must be drawn with {@link #render}.
+     *
+     * A scroll pane applies its pane transform and mask in render(), so it
+     * cannot be drawn by a flattened render pass.
+     *
+     * @return false, as this node must be drawn with {@link #render}.
+     */
+    virtual bool isFlattenable() const override { return false; }
 };
     }
 }
@@ -0,0 +1,293 @@
+"""
+Script to compile CUGL JSON files
+
+Large JSON files, such as scene graphs and widgets, can take a noticeable amount of time to
+parse at load time. This script converts them ahead of time into compiled JSON, a compact
+binary encoding that CUGL decodes without any string parsing (see JsonValue::toBinary).
+The scene and widget loaders recognize compiled JSON by the extension .cubj, and memory
+map the file when loading it.
+
+Compiled JSON starts with the magic number "CUBJ" and a version byte. This is followed by
+the root value. Each value is a one byte tag followed by its contents. Lengths, counts, and
+integers are variable length (LEB128, with integers zigzag encoded), while all other numbers
+are doubles in network order. Object keys precede each child.
+
+Numbers are converted exactly as the CUGL JSON parser converts them, so that the compiled
+file decodes to the same tree as the original text. The output of this script is identical
+to that of JsonValue::toBinary.
+
+Author: agent
+Date: October 19, 2026
+"""
+import os, os.path
+import math
+import json
+import struct
+import argparse
+
+
+#mark CONSTANTS
+
+# The magic number at the start of compiled JSON
+BINARY_MAGIC   = b'CUBJ'
+# The current version of compiled JSON
+BINARY_VERSION = 1
+
+# The value tags
+BINARY_NULL   = 0
+BINARY_FALSE  = 1
+BINARY_TRUE   = 2
+BINARY_INT    = 3
+BINARY_REAL   = 4
+BINARY_STRING = 5
+BINARY_ARRAY  = 6
+BINARY_OBJECT = 7
+
+# The range of a (64 bit) long
+LONG_MAX =  (1 << 63)-1
+LONG_MIN = -(1 << 63)
+
+
+#mark -
+#mark NUMBER PARSING
+
+class Number(object):
+    """
+    A JSON number as parsed by CUGL
+
+    CUGL stores every number as both a double and a (clamped) long. This class mirrors
+    that representation so that numbers are encoded exactly as JsonValue::toBinary
+    would encode them.
+    """
+
+    def __init__(self,text):
+        """
+        Initializes a number from its JSON text
+
+        This follows the arithmetic of the CUGL JSON parser, which accumulates the digits
+        as a double and then scales by a power of ten. This can differ from the Python
+        float parser in the last bit.
+
+        :param text: The JSON text for the number
+        :type text:  ``str``
+        """
+        n = 0.0
+        sign = 1.0
+        scale = 0
+        subscale = 0
+        signsubscale = 1
+        pos = 0
+
+        if text[pos:pos+1] == '-':
+            sign = -1.0
+            pos += 1
+        while pos < len(text) and text[pos].isdigit():
+            n = n*10.0 + (ord(text[pos])-48)
+            pos += 1
+        if text[pos:pos+1] == '.':
+            pos += 1
+            while pos < len(text) and text[pos].isdigit():
+                n = n*10.0 + (ord(text[pos])-48)
+                scale -= 1
+                pos += 1
+        if text[pos:pos+1] in ('e','E'):
+            pos += 1
+            if text[pos:pos+1] == '+':
+                pos += 1
+            elif text[pos:pos+1] == '-':
+                signsubscale = -1
+                pos += 1
+            while pos < len(text) and text[pos].isdigit():
+                subscale = subscale*10 + (ord(text[pos])-48)
+                pos += 1
+
+        try:
+            self.real = sign*n*math.pow(10.0,scale+subscale*signsubscale)
+        except OverflowError:
+            self.real = sign*n*math.inf
+        if math.isnan(self.real):
+            self.long = 0
+        elif self.real >= float(LONG_MAX):
+            self.long = LONG_MAX
+        elif self.real <= float(LONG_MIN):
+            self.long = LONG_MIN
+        else:
+            self.long = int(self.real)
+
+    def is_integral(self):
+        """
+        Returns True if this number is encoded as an integer
+
+        A number is an integer if its double and long values agree. Negative zero is
+        always encoded as a double.
+
+        :return: True if this number is encoded as an integer
+        :rtype:  ``bool``
+        """
+        if float(self.long) != self.real:
+            return False
+        return self.long != 0 or math.copysign(1.0,self.real) > 0
+
+
+#mark -
+#mark ENCODING
+
+class ObjectPairs(list):
+    """
+    The key-value pairs of a JSON object, in file order
+    """
+    pass
+
+
+def encode_size(out,value):
+    """
+    Appends the LEB128 encoding of value to out
+
+    :param out:   The byte buffer to append to
+    :type out:    ``bytearray``
+    :param value: The (non-negative) value to encode
+    :type value:  ``int``
+    """
+    while value >= 0x80:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+
+
+def encode_string(out,value):
+    """
+    Appends the length and UTF-8 bytes of the string to out
+
+    :param out:   The byte buffer to append to
+    :type out:    ``bytearray``
+    :param value: The string to encode
+    :type value:  ``str``
+    """
+    data = value.encode('utf-8','surrogatepass')
+    encode_size(out,len(data))
+    out.extend(data)
+
+
+def encode_value(out,value):
+    """
+    Appends the compiled JSON encoding of value (and its descendants) to out
+
+    Objects must be represented as lists of key-value pairs, as produced by
+    :func:`parse_json`. This preserves both the order and any duplicate keys.
+
+    :param out:   The byte buffer to append to
+    :type out:    ``bytearray``
+    :param value: The value to encode
+    :type value:  JSON value from :func:`parse_json`
+    """
+    if value is None:
+        out.append(BINARY_NULL)
+    elif value is True:
+        out.append(BINARY_TRUE)
+    elif value is False:
+        out.append(BINARY_FALSE)
+    elif isinstance(value,Number):
+        if value.is_integral():
+            out.append(BINARY_INT)
+            encode_size(out,((value.long << 1) ^ (value.long >> 63)) & 0xFFFFFFFFFFFFFFFF)
+        else:
+            out.append(BINARY_REAL)
+            out.extend(struct.pack('>d',value.real))
+    elif isinstance(value,str):
+        out.append(BINARY_STRING)
+        encode_string(out,value)
+    elif isinstance(value,ObjectPairs):
+        out.append(BINARY_OBJECT)
+        encode_size(out,len(value))
+        for (key,child) in value:
+            encode_string(out,key)
+            encode_value(out,child)
+    else:
+        out.append(BINARY_ARRAY)
+        encode_size(out,len(value))
+        for child in value:
+            encode_value(out,child)
+
+
+def reject_constant(text):
+    """
+    Raises an error for the non-standard constants NaN and Infinity
+
+    :param text: The constant text
+    :type text:  ``str``
+    """
+    raise ValueError('Unsupported JSON constant %s' % text)
+
+
+def parse_json(text):
+    """
+    Returns the JSON value for the given text
+
+    Objects are returned as :class:`ObjectPairs` and numbers as :class:`Number`, so
+    that the value can be compiled exactly as CUGL would parse it.
+
+    :param text: The JSON text
+    :type text:  ``str``
+
+    :return: the JSON value for the given text
+    :rtype:  JSON value
+    """
+    return json.loads(text,object_pairs_hook=ObjectPairs,
+                      parse_int=Number,parse_float=Number,parse_constant=reject_constant)
+
+
+def compile_json(text):
+    """
+    Returns the compiled JSON for the given text
+
+    :param text: The JSON text
+    :type text:  ``str``
+
+    :return: the compiled JSON for the given text
+    :rtype:  ``bytes``
+    """
+    out = bytearray(BINARY_MAGIC)
+    out.append(BINARY_VERSION)
+    encode_value(out,parse_json(text))
+    return bytes(out)
+
+
+def compile_file(source,target=None):
+    """
+    Compiles the given JSON file
+
+    If target is None, the compiled file is written beside the source, with the
+    extension replaced by .cubj.
+
+    :param source: The path to the JSON file
+    :type source:  ``str``
+    :param target: The path to the compiled file
+    :type target:  ``str``
+
+    :return: the path to the compiled file
+    :rtype:  ``str``
+    """
+    if target is None:
+        target = os.path.splitext(source)[0]+'.cubj'
+    with open(source,encoding='utf-8') as file:
+        data = compile_json(file.read())
+    with open(target,'wb') as file:
+        file.write(data)
+    return target
+
+
+#mark -
+#mark MAIN
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Compile CUGL JSON files (such as scenes) to .cubj files.')
+    parser.add_argument('files', nargs='+', help='the JSON files to compile')
+    parser.add_argument('-o', '--output', help='the output file (only with a single input)')
+    args = parser.parse_args()
+
+    if args.output and len(args.files) > 1:
+        parser.error('--output requires a single input file')
+    for file in args.files:
+        target = compile_file(file,args.output)
+        print('Compiled %s to %s (%d bytes to %d bytes)' %
+              (file,target,os.path.getsize(file),os.path.getsize(target)))
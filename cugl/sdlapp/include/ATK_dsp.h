@@ -956,6 +956,121 @@ extern DECLSPEC void SDLCALL ATK_ApplyIIRFilter_stride(ATK_IIRFilter* filter,
                                                        const float* input,  size_t istride,
                                                        float* output, size_t ostride, size_t len);
 
+/**
+ * A multichannel cascade of second-order sections
+ *
+ * This filter processes interleaved audio, running a cascade of biquads for
+ * each channel. Every channel may have its own coefficients. The channels
+ * are processed in the lanes of vector registers where available, so the
+ * cost per frame does not grow with the number of channels (up to the
+ * vector width). Filters are stateful and should be reset whenever they are
+ * applied to a new audio signal.
+ */
+typedef struct ATK_SOSFilter ATK_SOSFilter;
+
+/**
+ * Returns a newly allocated multichannel filter of cascaded second-order sections
+ *
+ * The filter processes interleaved audio with the given number of channels.
+ * Each channel runs through the same number of second-order sections (biquads),
+ * but every channel may have its own coefficients. On x86, the channels are
+ * processed in the lanes of SSE2 or AVX2 registers, so the cost per frame is
+ * nearly flat up to 4 or 8 channels, respectively.
+ *
+ * All sections are initially identity sections. Use the functions
+ * {@link ATK_SetSOSFilterSection} and {@link ATK_SetSOSFilterCoefficients} to
+ * define each section.
+ *
+ * @param channels  The number of interleaved channels
+ * @param sections  The number of second-order sections
+ *
+ * @return a newly allocated multichannel filter of cascaded second-order sections
+ */
+extern DECLSPEC ATK_SOSFilter* SDLCALL ATK_AllocSOSFilter(size_t channels, size_t sections);
+
+/**
+ * Frees a previously allocated multichannel filter
+ *
+ * @param filter    The multichannel filter
+ */
+extern DECLSPEC void SDLCALL ATK_FreeSOSFilter(ATK_SOSFilter* filter);
+
+/**
+ * Resets the state of a multichannel filter
+ *
+ * Multichannel filters have to keep state of the inputs they have received so
+ * far. Reseting a filter zeroes the state so that it is the same as if the
+ * filter were just allocated. The coefficients are unaffected.
+ *
+ * @param filter    The multichannel filter
+ */
+extern DECLSPEC void SDLCALL ATK_ResetSOSFilter(ATK_SOSFilter* filter);
+
+/**
+ * Sets the coefficients of a section of a multichannel filter
+ *
+ * The coefficients define the standard biquad difference equation:
+ *
+ *   a[0]*y[n] = b[0]*x[n]+b[1]*x[n-1]+b[2]*x[n-2]-a[1]*y[n-1]-a[2]*y[n-2]
+ *
+ * Both a and b must have three elements. If a[0] is not equal to 1, the
+ * coefficients are normalized by a[0]. If channel is negative, the
+ * coefficients are applied to all channels.
+ *
+ * Changing the coefficients does not reset the filter state, so it is safe
+ * to update a filter while it is applied to a stream.
+ *
+ * @param filter    The multichannel filter
+ * @param section   The section to set
+ * @param channel   The channel to set (or negative for all channels)
+ * @param a         The a (feedback) coefficients
+ * @param b         The b (feedforward) coefficients
+ *
+ * @return 0 if the coefficients were set, -1 otherwise
+ */
+extern DECLSPEC int SDLCALL ATK_SetSOSFilterCoefficients(ATK_SOSFilter* filter, size_t section, int channel,
+                                                         const float* a, const float* b);
+
+/**
+ * Sets a section of a multichannel filter to a common second-order filter.
+ *
+ * The filter types and parameters are the same as {@link ATK_AllocSOFilter}.
+ * If channel is negative, the section is set for all channels.
+ *
+ * Changing a section does not reset the filter state, so it is safe to
+ * update a filter while it is applied to a stream.
+ *
+ * @param filter    The multichannel filter
+ * @param section   The section to set
+ * @param channel   The channel to set (or negative for all channels)
+ * @param type      The filter type
+ * @param frequency The normalized frequency (frequence / sample rate)
+ * @param gain      The filter input gain (in decibels)
+ * @param qfactor   The biquad quality factor
+ *
+ * @return 0 if the section was set, -1 otherwise
+ */
+extern DECLSPEC int SDLCALL ATK_SetSOSFilterSection(ATK_SOSFilter* filter, size_t section, int channel,
+                                                    ATK_SOFilter type, float frequency, float gain,
+                                                    float qfactor);
+
+/**
+ * Applies the multichannel filter to an interleaved buffer, storing the result in output
+ *
+ * Both input and output should have frames*channels elements, where channels
+ * is the number of channels of the filter. It is safe for these buffers to be
+ * the same. Multichannel filters have to keep state of the inputs they have
+ * received so far. This makes it not safe to use a filter on multiple streams
+ * simultaneously.
+ *
+ * @param filter    The multichannel filter
+ * @param input     The interleaved input buffer
+ * @param output    The interleaved output buffer
+ * @param frames    The number of audio frames to process
+ */
+extern DECLSPEC void SDLCALL ATK_ApplySOSFilter(ATK_SOSFilter* filter, const float* input,
+                                                float* output, size_t frames);
+
 /**
  * A long-running integral delay filter
  *
@@ -1780,6 +1895,11 @@ extern DECLSPEC void SDLCALL ATK_FillKaiserWindow(float* buffer, size_t size, fl
  * will be the same in each case. The choice of filter depends on the size
  * of the kernel and/or signal. For optimized code, the break-over point
  * for these buffers can be as high as 512 samples, depending on hardware.
+ *
+ * For long kernels, such as the impulse responses of convolutional reverb,
+ * use a partitioned convolution (see {@link ATK_AllocPartitionedConvolution}).
+ * Partitioned convolutions keep their own state, and should not be mixed
+ * with the other algorithms without reseting the filter.
  */
 typedef struct ATK_Convolution ATK_Convolution;
 
@@ -1806,6 +1926,42 @@ typedef struct ATK_Convolution ATK_Convolution;
  */
 extern DECLSPEC ATK_Convolution* SDLCALL ATK_AllocConvolution(float* kernel, size_t size, size_t block);
 
+/**
+ * Returns a newly allocated partitioned convolution filter for the given kernel.
+ *
+ * A partitioned convolution is designed for streaming long kernels, such as
+ * the impulse responses used in convolutional reverb. The kernel is split into
+ * a direct-form head, followed by partitions whose spectra are computed once,
+ * at allocation. Input is combined with these partitions using overlap-save
+ * and a frequency-domain delay line. The convolution has no latency, and the
+ * cost per sample grows with the number of partitions, not with the size of
+ * the buffers passed to {@link ATK_ApplyPartitionedConvolution}.
+ *
+ * The block size is the size of the uniform partitions, and is rounded up to
+ * a power of two. If it is zero, the block size is 1024. The head size is the
+ * number of taps computed directly, and is also rounded up to a power of two.
+ * If it is zero, the head size is 64. If the head is smaller than the block
+ * size, the taps between them are covered by partitions of doubling size
+ * (a non-uniform partition). Otherwise, the kernel is uniformly partitioned,
+ * but the direct-form head is an entire block.
+ *
+ * The filter returned may also be used with the other convolution functions.
+ * However, partitioned convolutions keep their own state, so the filter must
+ * be reset when switching between partitioned and other convolutions.
+ *
+ * This function will copy the kernel, and not try to acquire ownership of it.
+ * Future changes to the kernel will leave this filter unaffected.
+ *
+ * @param kernel    The convolution kernel
+ * @param size      The kernel size
+ * @param block     The partition block size
+ * @param head      The direct-form head size
+ *
+ * @return a newly allocated partitioned convolution filter for the given kernel.
+ */
+extern DECLSPEC ATK_Convolution* SDLCALL ATK_AllocPartitionedConvolution(float* kernel, size_t size,
+                                                                         size_t block, size_t head);
+
 /**
  * Frees a previously allocated convolution filter.
  *
@@ -1973,6 +2129,65 @@ extern DECLSPEC void SDLCALL ATK_ApplyFFTConvolution_stride(ATK_Convolution* fil
                                                             const float* input, size_t istride,
                                                             float* output, size_t ostride, size_t len);
 
+/**
+ * Applies a partitioned convolution on the given input, storing it in output
+ *
+ * This function is intended for real-time streaming, as it performs no
+ * allocations and accepts buffers of any size. Each call costs at most one
+ * forward and one inverse FFT per partition size for every completed block,
+ * plus a direct-form head. If the filter was not allocated with
+ * {@link ATK_AllocPartitionedConvolution}, this function is the same as
+ * {@link ATK_ApplyFFTConvolution}.
+ *
+ * The input and output should both have size len. It is safe for these
+ * to be the same buffer.
+ *
+ * Note that the restriction on size means this function does not place the
+ * tail (e.g. the last {@link ATK_GetConvolutionSize}-1 elemetns) of the
+ * convolution in output. Instead, it keeps it internally as the input history
+ * of the partitions. That way, calling this function twice on two-halves of an
+ * array is the same as calling it once on the entire array. To access the
+ * final tail of the convolution, call {@link ATK_FinishConvolution}.
+ *
+ * @param filter    The convolution filter
+ * @param input     The input values
+ * @param output    The buffer to store len output values
+ * @param len       The number of elements to process
+ */
+extern DECLSPEC void SDLCALL ATK_ApplyPartitionedConvolution(ATK_Convolution* filter, const float* input,
+                                                             float* output, size_t len);
+
+/**
+ * Applies a partitioned convolution on the given input, storing it in output
+ *
+ * This function is intended for real-time streaming, as it performs no
+ * allocations and accepts buffers of any size. Each call costs at most one
+ * forward and one inverse FFT per partition size for every completed block,
+ * plus a direct-form head. If the filter was not allocated with
+ * {@link ATK_AllocPartitionedConvolution}, this function is the same as
+ * {@link ATK_ApplyFFTConvolution_stride}.
+ *
+ * The input and output should both have size len. It is safe for these
+ * to be the same buffer, provided that the strides align.
+ *
+ * Note that the restriction on size means this function does not place the
+ * tail (e.g. the last {@link ATK_GetConvolutionSize}-1 elemetns) of the
+ * convolution in output. Instead, it keeps it internally as the input history
+ * of the partitions. That way, calling this function twice on two-halves of an
+ * array is the same as calling it once on the entire array. To access the
+ * final tail of the convolution, call {@link ATK_FinishConvolution}.
+ *
+ * @param filter    The convolution filter
+ * @param input     The input values
+ * @param istride   The data stride of the input buffer
+ * @param output    The buffer to store len output values
+ * @param ostride   The data stride of the output buffer
+ * @param len       The number of elements to process
+ */
+extern DECLSPEC void SDLCALL ATK_ApplyPartitionedConvolution_stride(ATK_Convolution* filter,
+                                                                    const float* input, size_t istride,
+                                                                    float* output, size_t ostride, size_t len);
+
 /**
  * Completes the convolution, storing the final elements in buffer.
  *
@@ -64,6 +64,13 @@
  * are unchanged for FFTs but drop to 200 microsec for the naive version. This
  * justifies our decision (in some cases) to separate adjacent from stride-aware
  * code.
+ *
+ * Neither of these scales to the multi-second kernels of convolutional reverb.
+ * The FFT convolution transforms every kernel block on every call. For these
+ * kernels we provide a partitioned convolution. It transforms the kernel once,
+ * and combines each input block with the kernel partitions using overlap-save
+ * and a frequency-domain delay line. A short direct-form head, followed by
+ * partitions of doubling size, keeps the latency at zero.
  */
 //https://dsp.stackexchange.com/questions/736/how-do-i-implement-cross-correlation-to-prove-two-audio-files-are-similar
 
@@ -575,10 +582,13 @@ static void convolve_block(ATK_FFTBlock* block, float* kernel) {
     memset(block->outpt,0,sizeof(float)*(block->bsize+block->ksize));
     kiss_fftr(block->fft, block->left, (kiss_fft_cpx*)block->left);
 
+    // The last kernel block may be partial, and must not overrun outpt
+    size_t total = block->bsize+block->ksize;
     size_t kpos = 0;
     while (kpos < block->ksize) {
-        memcpy(block->right,kernel+kpos,sizeof(float)*block->bsize);
-        memset(block->right+block->bsize,0,sizeof(float)*block->bsize);
+        size_t amt = block->ksize-kpos < block->bsize ? block->ksize-kpos : block->bsize;
+        memcpy(block->right,kernel+kpos,sizeof(float)*amt);
+        memset(block->right+amt,0,sizeof(float)*(2*block->bsize-amt));
 
         kiss_fftr(block->fft, block->right, (kiss_fft_cpx*)block->right);
         ATK_ComplexMult(block->left, block->right, block->right, block->bsize+1);
@@ -586,15 +596,445 @@ static void convolve_block(ATK_FFTBlock* block, float* kernel) {
         ATK_VecScale(block->right, (float)(1.0/(2*block->bsize)), block->right, 2*block->bsize);
 
         if (kpos == 0) {
-            memcpy(block->outpt,block->right,2*sizeof(float)*block->bsize);
+            amt = total < 2*block->bsize ? total : 2*block->bsize;
+            memcpy(block->outpt,block->right,sizeof(float)*amt);
         } else {
             ATK_VecAdd(block->outpt+kpos, block->right, block->outpt+kpos, block->bsize);
-            memcpy(block->outpt+kpos+block->bsize,block->right+block->bsize,sizeof(float)*block->bsize);
+            amt = total-kpos-block->bsize;
+            amt = amt < block->bsize ? amt : block->bsize;
+            memcpy(block->outpt+kpos+block->bsize,block->right+block->bsize,sizeof(float)*amt);
         }
         kpos += block->bsize;
     }
 }
 
+#pragma mark -
+#pragma mark Partitioned Blocks
+/** The default size of the direct-form head of a partitioned convolution */
+#define DEFAULT_HEAD    64
+/** The default partition size of a partitioned convolution */
+#define DEFAULT_BLOCK   1024
+
+/**
+ * A uniformly partitioned overlap-save convolution stage.
+ *
+ * A stage is responsible for the kernel taps [bsize,bsize+count*bsize). These
+ * taps are split into count partitions of size bsize, and the spectrum of each
+ * partition is computed once, when the stage is allocated. Input is gathered
+ * into blocks of size bsize. When a block is complete, its spectrum is pushed
+ * onto a frequency-domain delay line (FDL). The output of the stage for the
+ * next block is then the inverse transform of the sum of the delayed spectra
+ * multiplied by the partition spectra. That is one forward and one inverse
+ * FFT per block, no matter how many partitions there are.
+ *
+ * Because the first tap of the stage is bsize, the output of a block only
+ * depends on input blocks that are already complete. Therefore a stage adds
+ * no latency to the convolution.
+ */
+typedef struct ATK_FFTStage {
+    /** The partition (and block) size */
+    size_t bsize;
+    /** The number of kernel partitions */
+    size_t count;
+    /** The number of input samples in the current block */
+    size_t fill;
+    /** The delay line slot of the most recent input spectrum */
+    size_t front;
+    /** The FFT of size 2*bsize */
+    kiss_fftr_cfg fft;
+    /** The inverse FFT of size 2*bsize */
+    kiss_fftr_cfg inv;
+    /** The input window (previous block followed by current block) of size 2*bsize */
+    kiss_fft_scalar* window;
+    /** The partition spectra, as count consecutive spectra of size 2*bsize+2 */
+    kiss_fft_scalar* kernel;
+    /** The frequency-domain delay line, as count spectra of size 2*bsize+2 */
+    kiss_fft_scalar* delay;
+    /** The spectrum accumulator of size 2*bsize+2 */
+    kiss_fft_scalar* accum;
+    /** The inverse transform of size 2*bsize; the second half is the block output */
+    kiss_fft_scalar* result;
+} ATK_FFTStage;
+
+/**
+ * The state for a partitioned convolution.
+ *
+ * A partitioned convolution splits the kernel into a direct-form head and a
+ * sequence of FFT stages. The head is computed with a nested loop, so that
+ * the convolution has no latency. If the head is smaller than the partition
+ * size, the taps between the head and the partition size are covered by
+ * stages whose size doubles each time (a non-uniform partition). The rest of
+ * the kernel is covered by a single uniformly partitioned stage.
+ *
+ * All stage sizes are powers of two multiples of the head size. Hence every
+ * stage boundary falls on a head boundary, and the input can be processed in
+ * pieces that never cross a block boundary of any stage.
+ */
+typedef struct ATK_FFTPartition {
+    /** The size of the head (and smallest block) */
+    size_t head;
+    /** The number of taps computed directly (min of head and kernel size) */
+    size_t taps;
+    /** The number of input samples in the current head block */
+    size_t fill;
+    /** The direct-form taps, reversed */
+    float* reverse;
+    /** The direct-form input (previous block followed by current block) of size 2*head */
+    float* line;
+    /** The output of the current piece, of size head */
+    float* scratch;
+    /** The number of FFT stages */
+    size_t count;
+    /** The FFT stages, ordered by size */
+    ATK_FFTStage* stages;
+} ATK_FFTPartition;
+
+/**
+ * Returns the smallest power of two greater than or equal to value
+ *
+ * @param value The value to round
+ *
+ * @return the smallest power of two greater than or equal to value
+ */
+static size_t next_power_two(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+/**
+ * Computes the partition spectra of an FFT stage.
+ *
+ * The stage covers the taps [bsize,end) of the given kernel. The spectra are
+ * prescaled by the inverse FFT normalization factor, so that the stage does
+ * not need to scale its output.
+ *
+ * @param stage     The FFT stage
+ * @param kernel    The convolution kernel
+ * @param end       The end of the taps covered by the stage
+ */
+static void prepare_fft_stage(ATK_FFTStage* stage, const float* kernel, size_t end) {
+    size_t bsize = stage->bsize;
+    size_t span  = 2*bsize+2;
+    float factor = (float)(1.0/(2*bsize));
+    for(size_t ii = 0; ii < stage->count; ii++) {
+        size_t kpos = bsize*(ii+1);
+        size_t amt  = end-kpos < bsize ? end-kpos : bsize;
+        memset(stage->result,0,sizeof(kiss_fft_scalar)*2*bsize);
+        ATK_VecScale(kernel+kpos, factor, stage->result, amt);
+        kiss_fftr(stage->fft, stage->result, (kiss_fft_cpx*)(stage->kernel+ii*span));
+    }
+    memset(stage->result,0,sizeof(kiss_fft_scalar)*2*bsize);
+}
+
+/**
+ * Initializes an FFT stage for the taps [bsize,end) of the given kernel.
+ *
+ * @param stage     The FFT stage to initialize
+ * @param kernel    The convolution kernel
+ * @param bsize     The partition size
+ * @param end       The end of the taps covered by the stage
+ *
+ * @return 1 if the stage was successfully initialized, 0 otherwise
+ */
+static int init_fft_stage(ATK_FFTStage* stage, const float* kernel, size_t bsize, size_t end) {
+    memset(stage, 0, sizeof(ATK_FFTStage));
+    size_t span = 2*bsize+2;
+    stage->bsize = bsize;
+    stage->count = (end-bsize+bsize-1)/bsize;
+
+    stage->fft = kiss_fftr_alloc((int)(2*bsize),0,NULL,NULL);
+    stage->inv = kiss_fftr_alloc((int)(2*bsize),1,NULL,NULL);
+    stage->window = ATK_malloc(sizeof(kiss_fft_scalar)*2*bsize);
+    stage->result = ATK_malloc(sizeof(kiss_fft_scalar)*2*bsize);
+    stage->accum  = ATK_malloc(sizeof(kiss_fft_scalar)*span);
+    stage->kernel = ATK_malloc(sizeof(kiss_fft_scalar)*span*stage->count);
+    stage->delay  = ATK_malloc(sizeof(kiss_fft_scalar)*span*stage->count);
+    if (stage->fft == NULL || stage->inv == NULL || stage->window == NULL ||
+        stage->result == NULL || stage->accum == NULL || stage->kernel == NULL ||
+        stage->delay == NULL) {
+        return 0;
+    }
+
+    memset(stage->window, 0, sizeof(kiss_fft_scalar)*2*bsize);
+    memset(stage->delay,  0, sizeof(kiss_fft_scalar)*span*stage->count);
+    prepare_fft_stage(stage, kernel, end);
+    return 1;
+}
+
+/**
+ * Releases the resources of an FFT stage (but not the stage itself).
+ *
+ * @param stage The FFT stage
+ */
+static void dispose_fft_stage(ATK_FFTStage* stage) {
+    if (stage->fft != NULL) {
+        kiss_fft_free(stage->fft);
+    }
+    if (stage->inv != NULL) {
+        kiss_fft_free(stage->inv);
+    }
+    ATK_free(stage->window);
+    ATK_free(stage->result);
+    ATK_free(stage->accum);
+    ATK_free(stage->kernel);
+    ATK_free(stage->delay);
+    memset(stage, 0, sizeof(ATK_FFTStage));
+}
+
+/**
+ * Accumulates the product of two complex buffers into output
+ *
+ * The buffers consist of complex numbers represented by (interleaved) float
+ * pairs, and len is the number of complex numbers.
+ *
+ * @param input1    The first complex buffer
+ * @param input2    The second complex buffer
+ * @param output    The complex accumulator
+ * @param len       The number of complex numbers
+ */
+static void complex_mult_add(const float* input1, const float* input2,
+                             float* output, size_t len) {
+    const float* src1 = input1;
+    const float* src2 = input2;
+    float* dst = output;
+    float real1, real2, imag1, imag2;
+    while(len--) {
+        real1 = *src1++;
+        imag1 = *src1++;
+        real2 = *src2++;
+        imag2 = *src2++;
+        *dst++ += real1*real2-imag1*imag2;
+        *dst++ += imag1*real2+real1*imag2;
+    }
+}
+
+/**
+ * Processes a completed input block of an FFT stage.
+ *
+ * This pushes the spectrum of the input window onto the delay line, and
+ * computes the stage output for the next block.
+ *
+ * @param stage The FFT stage
+ */
+static void convolve_fft_stage(ATK_FFTStage* stage) {
+    size_t bsize = stage->bsize;
+    size_t span  = 2*bsize+2;
+    size_t count = stage->count;
+
+    stage->front = stage->front+1 < count ? stage->front+1 : 0;
+    kiss_fftr(stage->fft, stage->window, (kiss_fft_cpx*)(stage->delay+stage->front*span));
+
+    memset(stage->accum, 0, sizeof(kiss_fft_scalar)*span);
+    size_t slot = stage->front;
+    for(size_t ii = 0; ii < count; ii++) {
+        complex_mult_add(stage->delay+slot*span, stage->kernel+ii*span, stage->accum, bsize+1);
+        slot = slot ? slot-1 : count-1;
+    }
+    kiss_fftri(stage->inv, (const kiss_fft_cpx*)stage->accum, stage->result);
+
+    memcpy(stage->window, stage->window+bsize, sizeof(kiss_fft_scalar)*bsize);
+    stage->fill = 0;
+}
+
+/**
+ * Frees a previously allocated partitioned convolution state
+ *
+ * @param part  The partitioned convolution state
+ */
+static void free_fft_partition(ATK_FFTPartition* part) {
+    if (part == NULL) {
+        return;
+    }
+    if (part->stages != NULL) {
+        for(size_t ii = 0; ii < part->count; ii++) {
+            dispose_fft_stage(part->stages+ii);
+        }
+        ATK_free(part->stages);
+        part->stages = NULL;
+    }
+    ATK_free(part->reverse);
+    part->reverse = NULL;
+    ATK_free(part->line);
+    part->line = NULL;
+    ATK_free(part->scratch);
+    part->scratch = NULL;
+    ATK_free(part);
+}
+
+/**
+ * Returns a newly allocated partitioned convolution state
+ *
+ * The partition size and head size are rounded up to powers of two. If the
+ * head is not smaller than the partition size, the kernel is uniformly
+ * partitioned after a direct-form head of one partition.
+ *
+ * @param kernel    The convolution kernel
+ * @param ksize     The kernel size
+ * @param bsize     The partition size
+ * @param head      The head size
+ *
+ * @return a newly allocated partitioned convolution state
+ */
+static ATK_FFTPartition* alloc_fft_partition(const float* kernel, size_t ksize,
+                                              size_t bsize, size_t head) {
+    bsize = next_power_two(bsize ? bsize : DEFAULT_BLOCK);
+    head  = next_power_two(head ? head : DEFAULT_HEAD);
+    head  = head < bsize ? head : bsize;
+
+    ATK_FFTPartition* result = ATK_malloc(sizeof(ATK_FFTPartition));
+    if (result == NULL) {
+        ATK_OutOfMemory();
+        return NULL;
+    }
+    memset(result, 0, sizeof(ATK_FFTPartition));
+
+    result->head = head;
+    result->taps = ksize < head ? ksize : head;
+    result->reverse = ATK_malloc(sizeof(float)*result->taps);
+    result->line    = ATK_malloc(sizeof(float)*2*head);
+    result->scratch = ATK_malloc(sizeof(float)*head);
+    if (result->reverse == NULL || result->line == NULL || result->scratch == NULL) {
+        goto out;
+    }
+    for(size_t ii = 0; ii < result->taps; ii++) {
+        result->reverse[ii] = kernel[result->taps-ii-1];
+    }
+    memset(result->line, 0, sizeof(float)*2*head);
+
+    // Doubling stages up to the partition size, then the uniform stage
+    size_t count = 0;
+    for(size_t size = head; size < ksize; size *= 2) {
+        count++;
+        if (size >= bsize) {
+            break;
+        }
+    }
+
+    if (count) {
+        result->stages = ATK_malloc(sizeof(ATK_FFTStage)*count);
+        if (result->stages == NULL) {
+            goto out;
+        }
+        memset(result->stages, 0, sizeof(ATK_FFTStage)*count);
+        size_t size = head;
+        for(size_t ii = 0; ii < count; ii++) {
+            size_t end = size < bsize ? 2*size : ksize;
+            end = end < ksize ? end : ksize;
+            result->count++;
+            if (!init_fft_stage(result->stages+ii, kernel, size, end)) {
+                goto out;
+            }
+            size *= 2;
+        }
+    }
+    return result;
+
+out:
+    ATK_OutOfMemory();
+    free_fft_partition(result);
+    return NULL;
+}
+
+/**
+ * Resets a partitioned convolution state, zeroing all input history
+ *
+ * @param part  The partitioned convolution state
+ */
+static void reset_fft_partition(ATK_FFTPartition* part) {
+    part->fill = 0;
+    memset(part->line, 0, sizeof(float)*2*part->head);
+    for(size_t ii = 0; ii < part->count; ii++) {
+        ATK_FFTStage* stage = part->stages+ii;
+        size_t bsize = stage->bsize;
+        stage->fill  = 0;
+        stage->front = 0;
+        memset(stage->window, 0, sizeof(kiss_fft_scalar)*2*bsize);
+        memset(stage->result, 0, sizeof(kiss_fft_scalar)*2*bsize);
+        memset(stage->delay, 0, sizeof(kiss_fft_scalar)*(2*bsize+2)*stage->count);
+    }
+}
+
+/**
+ * Scales the kernel of a partitioned convolution state
+ *
+ * @param part      The partitioned convolution state
+ * @param scalar    The amount to scale the kernel
+ */
+static void scale_fft_partition(ATK_FFTPartition* part, float scalar) {
+    ATK_VecScale(part->reverse, scalar, part->reverse, part->taps);
+    for(size_t ii = 0; ii < part->count; ii++) {
+        ATK_FFTStage* stage = part->stages+ii;
+        size_t size = (2*stage->bsize+2)*stage->count;
+        ATK_VecScale(stage->kernel, scalar, stage->kernel, size);
+    }
+}
+
+/**
+ * Convolves a piece of input that does not cross a head block boundary.
+ *
+ * The piece size len must be at most head-fill, where fill is the current
+ * position in the head block. As every stage size is a multiple of the head
+ * size, this piece does not cross the block boundary of any stage either.
+ *
+ * The input and output may be the same buffer, provided the strides align.
+ *
+ * @param part      The partitioned convolution state
+ * @param input     The input values
+ * @param istride   The data stride of the input buffer
+ * @param output    The buffer to store len output values
+ * @param ostride   The data stride of the output buffer
+ * @param len       The number of elements to process
+ */
+static void convolve_fft_piece(ATK_FFTPartition* part,
+                               const float* input, size_t istride,
+                               float* output, size_t ostride, size_t len) {
+    float* line = part->line+part->head+part->fill;
+    if (istride == 1) {
+        memcpy(line, input, sizeof(float)*len);
+    } else {
+        ATK_VecCopy_sstride(input, istride, line, len);
+    }
+
+    // Direct-form head
+    size_t taps = part->taps;
+    const float* krn = part->reverse;
+    for(size_t ii = 0; ii < len; ii++) {
+        const float* src = line+ii+1-taps;
+        float sum = 0;
+        for(size_t jj = 0; jj < taps; jj++) {
+            sum += krn[jj]*src[jj];
+        }
+        part->scratch[ii] = sum;
+    }
+
+    // Stage outputs (computed when the previous block completed)
+    for(size_t ii = 0; ii < part->count; ii++) {
+        ATK_FFTStage* stage = part->stages+ii;
+        size_t bsize = stage->bsize;
+        memcpy(stage->window+bsize+stage->fill, line, sizeof(float)*len);
+        ATK_VecAdd(part->scratch, stage->result+bsize+stage->fill, part->scratch, len);
+        stage->fill += len;
+        if (stage->fill == bsize) {
+            convolve_fft_stage(stage);
+        }
+    }
+
+    if (ostride == 1) {
+        memcpy(output, part->scratch, sizeof(float)*len);
+    } else {
+        ATK_VecCopy_dstride(part->scratch, output, ostride, len);
+    }
+
+    part->fill += len;
+    if (part->fill == part->head) {
+        memcpy(part->line, part->line+part->head, sizeof(float)*part->head);
+        part->fill = 0;
+    }
+}
+
 #pragma mark -
 #pragma mark Convolutions
 /**
@@ -611,6 +1051,11 @@ static void convolve_block(ATK_FFTBlock* block, float* kernel) {
  * will be the same in each case. The choice of filter depends on the size
  * of the kernel and/or signal. For optimized code, the break-over point
  * for these buffers can be as high as 512 samples, depending on hardware.
+ *
+ * For long kernels, such as the impulse responses of convolutional reverb,
+ * use a partitioned convolution (see {@link ATK_AllocPartitionedConvolution}).
+ * Partitioned convolutions keep their own state, and should not be mixed
+ * with the other algorithms without reseting the filter.
  */
 typedef struct ATK_Convolution {
     /** The kernel size */
@@ -623,6 +1068,8 @@ typedef struct ATK_Convolution {
     float* tail;
     /** Inlining for now */
     ATK_FFTBlock* fft;
+    /** The partitioned convolution state (NULL if not partitioned) */
+    ATK_FFTPartition* part;
 } ATK_Convolution;
 
 
@@ -682,6 +1129,7 @@ ATK_Convolution* ATK_AllocConvolution(float* kernel, size_t len, size_t block) {
     result->tail  = tail;
     result->kernel = kern;
     result->fft = fft;
+    result->part = NULL;
     return result;
 
 out:
@@ -713,6 +1161,8 @@ void ATK_FreeConvolution(ATK_Convolution* filter) {
     filter->tail = NULL;
     free_fft_block(filter->fft);
     filter->fft = NULL;
+    free_fft_partition(filter->part);
+    filter->part = NULL;
     ATK_free(filter);
 }
 
@@ -729,6 +1179,9 @@ void ATK_ResetConvolution(ATK_Convolution* filter) {
         return;
     }
     memset(filter->tail,0,sizeof(float)*filter->ksize);
+    if (filter->part != NULL) {
+        reset_fft_partition(filter->part);
+    }
 }
 
 /**
@@ -742,6 +1195,9 @@ void ATK_ResetConvolution(ATK_Convolution* filter) {
  */
 void ATK_ScaleConvolution(ATK_Convolution* filter, float scalar) {
     ATK_VecScale(filter->kernel, scalar, filter->kernel, filter->ksize);
+    if (filter->part != NULL) {
+        scale_fft_partition(filter->part, scalar);
+    }
 }
 
 
@@ -775,6 +1231,12 @@ size_t ATK_GetConvolutionSize(ATK_Convolution* filter) {
  * @return the next value in this convolution.
  */
 float ATK_StepConvolution(ATK_Convolution* filter, float value) {
+    if (filter->part != NULL) {
+        float result;
+        ATK_ApplyPartitionedConvolution(filter, &value, &result, 1);
+        return result;
+    }
+
     float result = filter->tail[0];
     memmove(filter->tail, filter->tail+1, sizeof(float)*(filter->ksize-1));
     filter->tail[filter->ksize-1] = 0;
@@ -806,6 +1268,12 @@ float ATK_StepConvolution(ATK_Convolution* filter, float value) {
 size_t ATK_FinishConvolution(ATK_Convolution* filter, float* buffer) {
     if (filter == NULL) {
         return 0;
+    } else if (filter->part != NULL) {
+        // Flush the partition history with silence
+        memset(buffer,0,sizeof(float)*(filter->ksize-1));
+        ATK_ApplyPartitionedConvolution(filter, buffer, buffer, filter->ksize-1);
+        ATK_ResetConvolution(filter);
+        return filter->ksize;
     }
     memcpy(buffer,filter->tail,sizeof(float)*(filter->ksize-1));
     memset(filter->tail,0,sizeof(float)*(filter->ksize));
@@ -833,6 +1301,13 @@ size_t ATK_FinishConvolution(ATK_Convolution* filter, float* buffer) {
 size_t ATK_FinishConvolution_stride(ATK_Convolution* filter, float* buffer, size_t stride) {
     if (filter == NULL) {
         return 0;
+    } else if (filter->part != NULL) {
+        // Flush the partition history with silence
+        ATK_VecClear_stride(buffer,stride,filter->ksize-1);
+        ATK_ApplyPartitionedConvolution_stride(filter, buffer, stride, buffer, stride,
+                                               filter->ksize-1);
+        ATK_ResetConvolution(filter);
+        return filter->ksize;
     }
     ATK_VecCopy_stride(filter->tail,1,buffer,stride,filter->ksize-1);
     memset(filter->tail,0,sizeof(float)*(filter->ksize));
@@ -1097,5 +1572,134 @@ void ATK_ApplyFFTConvolution_stride(ATK_Convolution* filter,
     }
 }
 
+#pragma mark -
+#pragma mark Partitioned Convolutions
+/**
+ * Returns a newly allocated partitioned convolution filter for the given kernel.
+ *
+ * A partitioned convolution is designed for streaming long kernels, such as
+ * the impulse responses used in convolutional reverb. The kernel is split into
+ * a direct-form head, followed by partitions whose spectra are computed once,
+ * at allocation. Input is combined with these partitions using overlap-save
+ * and a frequency-domain delay line. The convolution has no latency, and the
+ * cost per sample grows with the number of partitions, not with the size of
+ * the buffers passed to {@link ATK_ApplyPartitionedConvolution}.
+ *
+ * The block size is the size of the uniform partitions, and is rounded up to
+ * a power of two. If it is zero, the block size is 1024. The head size is the
+ * number of taps computed directly, and is also rounded up to a power of two.
+ * If it is zero, the head size is 64. If the head is smaller than the block
+ * size, the taps between them are covered by partitions of doubling size
+ * (a non-uniform partition). Otherwise, the kernel is uniformly partitioned,
+ * but the direct-form head is an entire block.
+ *
+ * The filter returned may also be used with the other convolution functions.
+ * However, partitioned convolutions keep their own state, so the filter must
+ * be reset when switching between partitioned and other convolutions.
+ *
+ * This function will copy the kernel, and not try to acquire ownership of it.
+ * Future changes to the kernel will leave this filter unaffected.
+ *
+ * @param kernel    The convolution kernel
+ * @param size      The kernel size
+ * @param block     The partition block size
+ * @param head      The direct-form head size
+ *
+ * @return a newly allocated partitioned convolution filter for the given kernel.
+ */
+ATK_Convolution* ATK_AllocPartitionedConvolution(float* kernel, size_t size,
+                                                 size_t block, size_t head) {
+    ATK_Convolution* result = ATK_AllocConvolution(kernel, size, block);
+    if (result == NULL) {
+        return NULL;
+    }
+
+    result->part = alloc_fft_partition(kernel, size, block, head);
+    if (result->part == NULL) {
+        ATK_FreeConvolution(result);
+        return NULL;
+    }
+    return result;
+}
+
+/**
+ * Applies a partitioned convolution on the given input, storing it in output
+ *
+ * This function is intended for real-time streaming, as it performs no
+ * allocations and accepts buffers of any size. Each call costs at most one
+ * forward and one inverse FFT per partition size for every completed block,
+ * plus a direct-form head. If the filter was not allocated with
+ * {@link ATK_AllocPartitionedConvolution}, this function is the same as
+ * {@link ATK_ApplyFFTConvolution}.
+ *
+ * The input and output should both have size len. It is safe for these
+ * to be the same buffer.
+ *
+ * Note that the restriction on size means this function does not place the
+ * tail (e.g. the last {@link ATK_GetConvolutionSize}-1 elemetns) of the
+ * convolution in output. Instead, it keeps it internally as the input history
+ * of the partitions. That way, calling this function twice on two-halves of an
+ * array is the same as calling it once on the entire array. To access the
+ * final tail of the convolution, call {@link ATK_FinishConvolution}.
+ *
+ * @param filter    The convolution filter
+ * @param input     The input values
+ * @param output    The buffer to store len output values
+ * @param len       The number of elements to process
+ */
+void ATK_ApplyPartitionedConvolution(ATK_Convolution* filter, const float* input,
+                                     float* output, size_t len) {
+    ATK_ApplyPartitionedConvolution_stride(filter, input, 1, output, 1, len);
+}
+
+/**
+ * Applies a partitioned convolution on the given input, storing it in output
+ *
+ * This function is intended for real-time streaming, as it performs no
+ * allocations and accepts buffers of any size. Each call costs at most one
+ * forward and one inverse FFT per partition size for every completed block,
+ * plus a direct-form head. If the filter was not allocated with
+ * {@link ATK_AllocPartitionedConvolution}, this function is the same as
+ * {@link ATK_ApplyFFTConvolution_stride}.
+ *
+ * The input and output should both have size len. It is safe for these
+ * to be the same buffer, provided that the strides align.
+ *
+ * Note that the restriction on size means this function does not place the
+ * tail (e.g. the last {@link ATK_GetConvolutionSize}-1 elemetns) of the
+ * convolution in output. Instead, it keeps it internally as the input history
+ * of the partitions. That way, calling this function twice on two-halves of an
+ * array is the same as calling it once on the entire array. To access the
+ * final tail of the convolution, call {@link ATK_FinishConvolution}.
+ *
+ * @param filter    The convolution filter
+ * @param input     The input values
+ * @param istride   The data stride of the input buffer
+ * @param output    The buffer to store len output values
+ * @param ostride   The data stride of the output buffer
+ * @param len       The number of elements to process
+ */
+void ATK_ApplyPartitionedConvolution_stride(ATK_Convolution* filter,
+                                            const float* input, size_t istride,
+                                            float* output, size_t ostride, size_t len) {
+    ATK_FFTPartition* part = filter->part;
+    if (part == NULL) {
+        if (istride == 1 && ostride == 1) {
+            ATK_ApplyFFTConvolution(filter, input, output, len);
+        } else {
+            ATK_ApplyFFTConvolution_stride(filter, input, istride, output, ostride, len);
+        }
+        return;
+    }
+
+    size_t pos = 0;
+    while (pos < len) {
+        size_t amt = part->head-part->fill;
+        amt = amt < len-pos ? amt : len-pos;
+        convolve_fft_piece(part, input+pos*istride, istride, output+pos*ostride, ostride, amt);
+        pos += amt;
+    }
+}
+
 #pragma mark -
 #pragma mark Cross-Correlation
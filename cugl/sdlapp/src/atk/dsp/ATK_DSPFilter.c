@@ -32,16 +32,17 @@
 #include <ATK_error.h>
 #include <kiss_fft.h>
 #include <kiss_fftr.h>
+#include "../math/ATK_simd_c.h"
 
 /**
  * @file ATK_DSPFilter
  *
  * This component provides the IIR and FIR filters for SDL_atk. We provide
  * several special purpose first-order and second-order filters, and optimize
- * them. Note that we do not do any vectorization (SSE, AVX) as that is not
- * portable (especially with the rise of ARM) and our experience is that
- * compiling this module on -O2 or -Os outperforms these optimizations. In
- * particularly, we ran experiments on this algorithm for biquad filters:
+ * them. Note that we do not vectorize (SSE, AVX) the single stream filters,
+ * as our experience is that compiling this module on -O2 or -Os outperforms
+ * these optimizations. In particularly, we ran experiments on this algorithm
+ * for biquad filters:
  *
  *   https://pdfs.semanticscholar.org/d150/a3f75dc033916f14029cd9101a8ea1d050bb.pdf
  *
@@ -49,6 +50,10 @@
  * to interleaved channels. Instead, we simply write tight loops so that
  * the optimizing compiler can do its job.
  *
+ * The exception is the multichannel filter {@link ATK_SOSFilter}. It does not
+ * vectorize the recurrence. Instead it runs an independent biquad for each
+ * channel in the lanes of a vector register, which is a clear win.
+ *
  * You will notice that we have separate stride and adjacent versions of each
  * function. This may seem redundant (just set stride 1!). But our experiments
  * have shown that on some platforms there is a slight, but significant
@@ -1391,33 +1396,22 @@ ATK_IIRFilter* ATK_AllocFOFilter(ATK_FOFilter type, float param) {
 }
 
 /**
- * Returns a newly allocated second-order filter.
- *
- * Second order filters have at most 2 feedback and feedforward coefficients
- * each. They are typically represented as biquad filter, where qfactor is
- * the classic biquad quality factor:
+ * Computes the biquad coefficients of a common second-order filter.
  *
- *    https://www.motioncontroltips.com/what-are-biquad-and-other-filter-types-for-servo-tuning
- *
- * For many applications, a Q factor of 1/sqrt(2) (or ATK_Q_VALUE) is sufficient.
- * Specialized filters should compute the Q factor from either {@link ATK_BandwidthQ}
- * or {@link ATK_ShelfSlopeQ}.
- *
- * The gain factor only applies to the parametric equalizer and shelf filters.
+ * The filter types and parameters are the same as {@link ATK_AllocSOFilter}.
+ * Both a and b must have room for three coefficients.
  *
  * @param type      The filter type
  * @param freq      The normalized frequency (frequence / sample rate)
  * @param gain      The filter input gain (in decibels)
  * @param qfactor   The biquad quality factor
+ * @param a         The array to store the a (feedback) coefficients
+ * @param b         The array to store the b (feedforward) coefficients
  *
- * @return a newly allocated second-order filter.
+ * @return 1 if the coefficients were computed, 0 otherwise
  */
-ATK_IIRFilter* ATK_AllocSOFilter(ATK_SOFilter type, float frequency,
-                                 float gain, float qfactor) {
-    float a[3];
-    float b[3];
-    size_t asize = 3;
-    size_t bsize = 3;
+static int so_coefficients(ATK_SOFilter type, float frequency, float gain,
+                           float qfactor, float* a, float* b) {
     a[0] = 1;
 
     double amp = pow(10, SDL_fabs(gain) / 40.0);
@@ -1505,7 +1499,7 @@ ATK_IIRFilter* ATK_AllocSOFilter(ATK_SOFilter type, float frequency,
             // Taken from STK
             if (frequency < 0.0 || frequency > 0.5) {
                 ATK_SetError("Normalized frequency %f out of range for resonance",frequency);
-                return NULL;
+                return 0;
             }
             b[0] = (float)(0.5 - 0.5 * qfactor * qfactor);
             b[1] = 0.0;
@@ -1515,10 +1509,541 @@ ATK_IIRFilter* ATK_AllocSOFilter(ATK_SOFilter type, float frequency,
             break;
 
         default:
-            break;
+            ATK_SetError("Unknown second-order filter type %d",(int)type);
+            return 0;
     }
 
-    return ATK_AllocIIRFilter(a, asize, b, bsize);
+    return 1;
+}
+
+
+/**
+ * Returns a newly allocated second-order filter.
+ *
+ * Second order filters have at most 2 feedback and feedforward coefficients
+ * each. They are typically represented as biquad filter, where qfactor is
+ * the classic biquad quality factor:
+ *
+ *    https://www.motioncontroltips.com/what-are-biquad-and-other-filter-types-for-servo-tuning
+ *
+ * For many applications, a Q factor of 1/sqrt(2) (or ATK_Q_VALUE) is sufficient.
+ * Specialized filters should compute the Q factor from either {@link ATK_BandwidthQ}
+ * or {@link ATK_ShelfSlopeQ}.
+ *
+ * The gain factor only applies to the parametric equalizer and shelf filters.
+ *
+ * @param type      The filter type
+ * @param freq      The normalized frequency (frequence / sample rate)
+ * @param gain      The filter input gain (in decibels)
+ * @param qfactor   The biquad quality factor
+ *
+ * @return a newly allocated second-order filter.
+ */
+ATK_IIRFilter* ATK_AllocSOFilter(ATK_SOFilter type, float frequency,
+                                 float gain, float qfactor) {
+    float a[3];
+    float b[3];
+    if (!so_coefficients(type, frequency, gain, qfactor, a, b)) {
+        return NULL;
+    }
+    return ATK_AllocIIRFilter(a, 3, b, 3);
+}
+
+#pragma mark -
+#pragma mark Multichannel Filters
+/*
+ * Multichannel filters run one biquad per channel, with the channels of an
+ * interleaved stream in the lanes of a vector register. Unlike vectorizing a
+ * single recurrence, the lanes are independent, so a full group of 4 (SSE2)
+ * or 8 (AVX2) channels costs about as much as one. A partial group pays an
+ * extra copy into a padded scratch buffer. The instruction set is
+ * chosen at runtime with SDL_cpuinfo. The vector kernels perform exactly the
+ * same floating point operations as the scalar loop, so the results are
+ * bit-for-bit identical on every path.
+ */
+/** The number of channels padded per coefficient row (the widest vector) */
+#define ATK_SOS_LANES   8
+/** The number of frames copied at a time for a partial group of channels */
+#define ATK_SOS_CHUNK   64
+
+/**
+ * A multichannel cascade of second-order sections
+ *
+ * Each section is a biquad in transposed direct form II, with its own
+ * coefficients for every channel. The coefficients and state are stored
+ * as rows of width channels (padded to ATK_SOS_LANES), so that a group of
+ * channels can be loaded into a single vector register. Padded lanes are
+ * identity sections, and never affect the stream.
+ */
+typedef struct ATK_SOSFilter {
+    /** The number of interleaved channels */
+    size_t channels;
+    /** The number of second-order sections */
+    size_t sections;
+    /** The row width (channels rounded up to ATK_SOS_LANES) */
+    size_t width;
+    /** The coefficients, as rows b0, b1, b2, a1, a2 per section (a negated) */
+    float* coeffs;
+    /** The state, as rows z1, z2 per section */
+    float* state;
+} ATK_SOSFilter;
+
+/**
+ * Applies the multichannel filter using scalar code
+ *
+ * The filter is applied one section at a time to each channel, so that the
+ * coefficients and state of a section remain in registers. The input and
+ * output may be the same buffer.
+ *
+ * @param filter    The multichannel filter
+ * @param input     The interleaved input buffer
+ * @param output    The interleaved output buffer
+ * @param frames    The number of audio frames to process
+ */
+static void fill_sos(ATK_SOSFilter* filter, const float* input, float* output, size_t frames) {
+    size_t channels = filter->channels;
+    size_t width = filter->width;
+    for(size_t ch = 0; ch < channels; ch++) {
+        for(size_t ss = 0; ss < filter->sections; ss++) {
+            const float* coef = filter->coeffs+5*width*ss+ch;
+            float* state = filter->state+2*width*ss+ch;
+            float b0 = coef[0];
+            float b1 = coef[width];
+            float b2 = coef[2*width];
+            float a1 = coef[3*width];
+            float a2 = coef[4*width];
+            float z1 = state[0];
+            float z2 = state[width];
+
+            const float* src = (ss == 0 ? input : output)+ch;
+            float* dst = output+ch;
+            float x, y;
+            for(size_t ii = 0; ii < frames; ii++) {
+                x = *src;
+                y = b0*x+z1;
+                z1 = (b1*x+a1*y)+z2;
+                z2 = b2*x+a2*y;
+                *dst = y;
+                src += channels;
+                dst += channels;
+            }
+            state[0] = z1;
+            state[width] = z2;
+        }
+    }
+}
+
+#if ATK_VEC_X86
+/**
+ * Applies all sections to a group of 4 channels with SSE2
+ *
+ * The first section reads from src, and the remaining sections work in place
+ * on dst. Both buffers hold groups of 4 channels separated by their stride.
+ *
+ * @param filter    The multichannel filter
+ * @param ch        The first channel of the group
+ * @param src       The input buffer
+ * @param sstride   The input stride between frames
+ * @param dst       The output buffer
+ * @param dstride   The output stride between frames
+ * @param frames    The number of audio frames to process
+ */
+ATK_SSE2 static void fill_sos_group_sse2(ATK_SOSFilter* filter, size_t ch,
+                                         const float* src, size_t sstride,
+                                         float* dst, size_t dstride, size_t frames) {
+    size_t width = filter->width;
+    for(size_t ss = 0; ss < filter->sections; ss++) {
+        const float* coef = filter->coeffs+5*width*ss+ch;
+        float* state = filter->state+2*width*ss+ch;
+        __m128 b0 = _mm_loadu_ps(coef);
+        __m128 b1 = _mm_loadu_ps(coef+width);
+        __m128 b2 = _mm_loadu_ps(coef+2*width);
+        __m128 a1 = _mm_loadu_ps(coef+3*width);
+        __m128 a2 = _mm_loadu_ps(coef+4*width);
+        __m128 z1 = _mm_loadu_ps(state);
+        __m128 z2 = _mm_loadu_ps(state+width);
+
+        const float* input = ss == 0 ? src : dst;
+        size_t istride = ss == 0 ? sstride : dstride;
+        float* output = dst;
+        __m128 x, y;
+        for(size_t ii = 0; ii < frames; ii++) {
+            x  = _mm_loadu_ps(input);
+            y  = _mm_add_ps(_mm_mul_ps(b0, x), z1);
+            z1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b1, x), _mm_mul_ps(a1, y)), z2);
+            z2 = _mm_add_ps(_mm_mul_ps(b2, x), _mm_mul_ps(a2, y));
+            _mm_storeu_ps(output, y);
+            input  += istride;
+            output += dstride;
+        }
+        _mm_storeu_ps(state, z1);
+        _mm_storeu_ps(state+width, z2);
+    }
+}
+
+/**
+ * Applies all sections to a group of 8 channels with AVX2
+ *
+ * The first section reads from src, and the remaining sections work in place
+ * on dst. Both buffers hold groups of 8 channels separated by their stride.
+ *
+ * @param filter    The multichannel filter
+ * @param ch        The first channel of the group
+ * @param src       The input buffer
+ * @param sstride   The input stride between frames
+ * @param dst       The output buffer
+ * @param dstride   The output stride between frames
+ * @param frames    The number of audio frames to process
+ */
+ATK_AVX2 static void fill_sos_group_avx2(ATK_SOSFilter* filter, size_t ch,
+                                         const float* src, size_t sstride,
+                                         float* dst, size_t dstride, size_t frames) {
+    size_t width = filter->width;
+    for(size_t ss = 0; ss < filter->sections; ss++) {
+        const float* coef = filter->coeffs+5*width*ss+ch;
+        float* state = filter->state+2*width*ss+ch;
+        __m256 b0 = _mm256_loadu_ps(coef);
+        __m256 b1 = _mm256_loadu_ps(coef+width);
+        __m256 b2 = _mm256_loadu_ps(coef+2*width);
+        __m256 a1 = _mm256_loadu_ps(coef+3*width);
+        __m256 a2 = _mm256_loadu_ps(coef+4*width);
+        __m256 z1 = _mm256_loadu_ps(state);
+        __m256 z2 = _mm256_loadu_ps(state+width);
+
+        const float* input = ss == 0 ? src : dst;
+        size_t istride = ss == 0 ? sstride : dstride;
+        float* output = dst;
+        __m256 x, y;
+        for(size_t ii = 0; ii < frames; ii++) {
+            x  = _mm256_loadu_ps(input);
+            y  = _mm256_add_ps(_mm256_mul_ps(b0, x), z1);
+            z1 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(b1, x), _mm256_mul_ps(a1, y)), z2);
+            z2 = _mm256_add_ps(_mm256_mul_ps(b2, x), _mm256_mul_ps(a2, y));
+            _mm256_storeu_ps(output, y);
+            input  += istride;
+            output += dstride;
+        }
+        _mm256_storeu_ps(state, z1);
+        _mm256_storeu_ps(state+width, z2);
+    }
+}
+
+/**
+ * Copies a partial group of channels into a zero-padded scratch buffer (SSE2)
+ *
+ * The scratch buffer holds 4 lanes per frame. Each frame is assembled in a
+ * register and written with a single vector store, so that the group kernel
+ * can reload it without a store-forwarding stall.
+ *
+ * @param src       The first channel of the group in the interleaved buffer
+ * @param stride    The stride between frames
+ * @param amt       The number of channels in the group (less than 4)
+ * @param scratch   The scratch buffer
+ * @param frames    The number of audio frames to copy
+ */
+ATK_SSE2 static void gather_sos_sse2(const float* src, size_t stride, size_t amt,
+                                     float* scratch, size_t frames) {
+    __m128 x;
+    for(size_t ii = 0; ii < frames; ii++) {
+        switch (amt) {
+            case 1:
+                x = _mm_load_ss(src);
+                break;
+            case 2:
+                x = _mm_setr_ps(src[0], src[1], 0.0f, 0.0f);
+                break;
+            default:
+                x = _mm_setr_ps(src[0], src[1], src[2], 0.0f);
+                break;
+        }
+        _mm_storeu_ps(scratch, x);
+        src += stride;
+        scratch += 4;
+    }
+}
+
+/**
+ * Copies a partial group of channels into a zero-padded scratch buffer (AVX2)
+ *
+ * The scratch buffer holds 8 lanes per frame. Each frame is read with a masked
+ * load and written with a single vector store, so that the group kernel can
+ * reload it without a store-forwarding stall.
+ *
+ * @param src       The first channel of the group in the interleaved buffer
+ * @param stride    The stride between frames
+ * @param amt       The number of channels in the group (less than 8)
+ * @param scratch   The scratch buffer
+ * @param frames    The number of audio frames to copy
+ */
+ATK_AVX2 static void gather_sos_avx2(const float* src, size_t stride, size_t amt,
+                                     float* scratch, size_t frames) {
+    __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32((int)amt),
+                                      _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    for(size_t ii = 0; ii < frames; ii++) {
+        _mm256_storeu_ps(scratch, _mm256_maskload_ps(src, mask));
+        src += stride;
+        scratch += 8;
+    }
+}
+#endif
+
+/** The function type of the vector group kernels */
+typedef void (*ATK_SOSGroupKernel)(ATK_SOSFilter* filter, size_t ch,
+                                   const float* src, size_t sstride,
+                                   float* dst, size_t dstride, size_t frames);
+
+/** The function type of the vector scratch gathers */
+typedef void (*ATK_SOSGather)(const float* src, size_t stride, size_t amt,
+                              float* scratch, size_t frames);
+
+/**
+ * Applies the multichannel filter with a vector group kernel
+ *
+ * Full groups of channels are processed directly on the interleaved buffers.
+ * A partial group (such as a stereo stream on 8 lanes) is copied in chunks
+ * into a zero-padded scratch buffer, so that the kernel can always use full
+ * vector loads and stores without touching memory outside of the stream.
+ * The input and output may be the same buffer.
+ *
+ * @param filter    The multichannel filter
+ * @param kernel    The vector group kernel
+ * @param gather    The vector scratch gather
+ * @param lanes     The number of channels processed by the kernel
+ * @param input     The interleaved input buffer
+ * @param output    The interleaved output buffer
+ * @param frames    The number of audio frames to process
+ */
+static void fill_sos_lanes(ATK_SOSFilter* filter, ATK_SOSGroupKernel kernel,
+                           ATK_SOSGather gather, size_t lanes,
+                           const float* input, float* output, size_t frames) {
+    size_t channels = filter->channels;
+    float scratch[ATK_SOS_CHUNK*ATK_SOS_LANES];
+    for(size_t ch = 0; ch < channels; ch += lanes) {
+        size_t amt = channels-ch;
+        if (amt >= lanes) {
+            kernel(filter, ch, input+ch, channels, output+ch, channels, frames);
+            continue;
+        }
+
+        for(size_t pos = 0; pos < frames; pos += ATK_SOS_CHUNK) {
+            size_t size = frames-pos < ATK_SOS_CHUNK ? frames-pos : ATK_SOS_CHUNK;
+            gather(input+pos*channels+ch, channels, amt, scratch, size);
+            kernel(filter, ch, scratch, lanes, scratch, lanes, size);
+            float* dst = output+pos*channels+ch;
+            for(size_t ii = 0; ii < size; ii++) {
+                for(size_t jj = 0; jj < amt; jj++) {
+                    dst[jj] = scratch[ii*lanes+jj];
+                }
+                dst += channels;
+            }
+        }
+    }
+}
+
+/**
+ * Returns a newly allocated multichannel filter of cascaded second-order sections
+ *
+ * The filter processes interleaved audio with the given number of channels.
+ * Each channel runs through the same number of second-order sections (biquads),
+ * but every channel may have its own coefficients. On x86, the channels are
+ * processed in the lanes of SSE2 or AVX2 registers, so the cost per frame is
+ * nearly flat up to 4 or 8 channels, respectively.
+ *
+ * All sections are initially identity sections. Use the functions
+ * {@link ATK_SetSOSFilterSection} and {@link ATK_SetSOSFilterCoefficients} to
+ * define each section.
+ *
+ * @param channels  The number of interleaved channels
+ * @param sections  The number of second-order sections
+ *
+ * @return a newly allocated multichannel filter of cascaded second-order sections
+ */
+ATK_SOSFilter* ATK_AllocSOSFilter(size_t channels, size_t sections) {
+    if (channels == 0 || sections == 0) {
+        ATK_SetError("Attempt to allocate SOS filter with %d channels and %d sections",
+                     (int)channels, (int)sections);
+        return NULL;
+    }
+
+    size_t width = (channels+ATK_SOS_LANES-1) & ~(size_t)(ATK_SOS_LANES-1);
+    ATK_SOSFilter* result = (ATK_SOSFilter*)ATK_malloc(sizeof(ATK_SOSFilter));
+    if (result == NULL) {
+        ATK_OutOfMemory();
+        return NULL;
+    }
+
+    result->channels = channels;
+    result->sections = sections;
+    result->width  = width;
+    result->coeffs = (float*)ATK_malloc(sizeof(float)*5*width*sections);
+    result->state  = (float*)ATK_malloc(sizeof(float)*2*width*sections);
+    if (result->coeffs == NULL || result->state == NULL) {
+        ATK_OutOfMemory();
+        ATK_FreeSOSFilter(result);
+        return NULL;
+    }
+
+    memset(result->coeffs, 0, sizeof(float)*5*width*sections);
+    for(size_t ss = 0; ss < sections; ss++) {
+        float* b0 = result->coeffs+5*width*ss;
+        for(size_t ii = 0; ii < width; ii++) {
+            b0[ii] = 1.0f;
+        }
+    }
+    memset(result->state, 0, sizeof(float)*2*width*sections);
+    return result;
+}
+
+/**
+ * Frees a previously allocated multichannel filter
+ *
+ * @param filter    The multichannel filter
+ */
+void ATK_FreeSOSFilter(ATK_SOSFilter* filter) {
+    if (filter == NULL) {
+        return;
+    }
+    if (filter->coeffs != NULL) {
+        ATK_free(filter->coeffs);
+        filter->coeffs = NULL;
+    }
+    if (filter->state != NULL) {
+        ATK_free(filter->state);
+        filter->state = NULL;
+    }
+    ATK_free(filter);
+}
+
+/**
+ * Resets the state of a multichannel filter
+ *
+ * Multichannel filters have to keep state of the inputs they have received so
+ * far. Reseting a filter zeroes the state so that it is the same as if the
+ * filter were just allocated. The coefficients are unaffected.
+ *
+ * @param filter    The multichannel filter
+ */
+void ATK_ResetSOSFilter(ATK_SOSFilter* filter) {
+    if (filter == NULL) {
+        return;
+    }
+    memset(filter->state, 0, sizeof(float)*2*filter->width*filter->sections);
+}
+
+/**
+ * Sets the coefficients of a section of a multichannel filter
+ *
+ * The coefficients define the standard biquad difference equation:
+ *
+ *   a[0]*y[n] = b[0]*x[n]+b[1]*x[n-1]+b[2]*x[n-2]-a[1]*y[n-1]-a[2]*y[n-2]
+ *
+ * Both a and b must have three elements. If a[0] is not equal to 1, the
+ * coefficients are normalized by a[0]. If channel is negative, the
+ * coefficients are applied to all channels.
+ *
+ * Changing the coefficients does not reset the filter state, so it is safe
+ * to update a filter while it is applied to a stream.
+ *
+ * @param filter    The multichannel filter
+ * @param section   The section to set
+ * @param channel   The channel to set (or negative for all channels)
+ * @param a         The a (feedback) coefficients
+ * @param b         The b (feedforward) coefficients
+ *
+ * @return 0 if the coefficients were set, -1 otherwise
+ */
+int ATK_SetSOSFilterCoefficients(ATK_SOSFilter* filter, size_t section, int channel,
+                                 const float* a, const float* b) {
+    if (filter == NULL) {
+        return -1;
+    } else if (section >= filter->sections) {
+        ATK_SetError("Section %d is out of range",(int)section);
+        return -1;
+    } else if (channel >= (int)filter->channels) {
+        ATK_SetError("Channel %d is out of range",channel);
+        return -1;
+    } else if (a[0] == 0) {
+        ATK_SetError("Attempt to set section with a[0] = 0");
+        return -1;
+    }
+
+    size_t width = filter->width;
+    size_t first = channel < 0 ? 0 : (size_t)channel;
+    size_t last  = channel < 0 ? filter->channels : first+1;
+    float* coef = filter->coeffs+5*width*section;
+    float a0 = a[0];
+    for(size_t ch = first; ch < last; ch++) {
+        coef[ch]         =  b[0]/a0;
+        coef[ch+width]   =  b[1]/a0;
+        coef[ch+2*width] =  b[2]/a0;
+        coef[ch+3*width] = -a[1]/a0;
+        coef[ch+4*width] = -a[2]/a0;
+    }
+    return 0;
+}
+
+/**
+ * Sets a section of a multichannel filter to a common second-order filter.
+ *
+ * The filter types and parameters are the same as {@link ATK_AllocSOFilter}.
+ * If channel is negative, the section is set for all channels.
+ *
+ * Changing a section does not reset the filter state, so it is safe to
+ * update a filter while it is applied to a stream.
+ *
+ * @param filter    The multichannel filter
+ * @param section   The section to set
+ * @param channel   The channel to set (or negative for all channels)
+ * @param type      The filter type
+ * @param frequency The normalized frequency (frequence / sample rate)
+ * @param gain      The filter input gain (in decibels)
+ * @param qfactor   The biquad quality factor
+ *
+ * @return 0 if the section was set, -1 otherwise
+ */
+int ATK_SetSOSFilterSection(ATK_SOSFilter* filter, size_t section, int channel,
+                            ATK_SOFilter type, float frequency, float gain, float qfactor) {
+    float a[3];
+    float b[3];
+    if (!so_coefficients(type, frequency, gain, qfactor, a, b)) {
+        return -1;
+    }
+    return ATK_SetSOSFilterCoefficients(filter, section, channel, a, b);
+}
+
+/**
+ * Applies the multichannel filter to an interleaved buffer, storing the result in output
+ *
+ * Both input and output should have frames*channels elements, where channels
+ * is the number of channels of the filter. It is safe for these buffers to be
+ * the same. Multichannel filters have to keep state of the inputs they have
+ * received so far. This makes it not safe to use a filter on multiple streams
+ * simultaneously.
+ *
+ * @param filter    The multichannel filter
+ * @param input     The interleaved input buffer
+ * @param output    The interleaved output buffer
+ * @param frames    The number of audio frames to process
+ */
+void ATK_ApplySOSFilter(ATK_SOSFilter* filter, const float* input,
+                        float* output, size_t frames) {
+    if (frames == 0) {
+        return;
+    }
+    // A mono stream has nothing to put in the other lanes
+    switch (filter->channels == 1 ? ATK_SIMD_NONE : ATK_SimdLevel()) {
+#if ATK_VEC_X86
+        case ATK_SIMD_AVX2:
+            fill_sos_lanes(filter, fill_sos_group_avx2, gather_sos_avx2, 8, input, output, frames);
+            break;
+        case ATK_SIMD_SSE2:
+            fill_sos_lanes(filter, fill_sos_group_sse2, gather_sos_sse2, 4, input, output, frames);
+            break;
+#endif
+        default:
+            fill_sos(filter, input, output, frames);
+            break;
+    }
 }
 
 #pragma mark -
@@ -28,6 +28,7 @@
  * 3. This notice may not be removed or altered from any source distribution.
  */
 #include <ATK_math.h>
+#include "ATK_simd_c.h"
 
 /**
  * @file ATK_MathVec.c
@@ -43,6 +44,894 @@
  * benefit from the separation, we just went YOLO and separated them all.
  */
 #pragma mark -
+#pragma mark Vector Kernels
+/*
+ * The element-wise stream functions below process the bulk of their buffers
+ * with vector instructions when the CPU supports them. The instruction set
+ * is chosen at runtime with SDL_cpuinfo, and the scalar loops remain as the
+ * reference implementation (and handle any remainder). The vector kernels
+ * perform exactly the same floating point operations as the scalar loops,
+ * so the results are bit-for-bit identical on every path.
+ *
+ * Stride and aggregation functions are not vectorized. Reordering a sum
+ * would change its rounding.
+ */
+/** The cached vector instruction set (-1 if not yet detected) */
+static int atk_simd_level = -1;
+
+/**
+ * Returns the best vector instruction set for this CPU
+ *
+ * The instruction set is detected with SDL_cpuinfo. The result is cached
+ * after the first call, and is shared by every module with vector kernels.
+ * Detection is idempotent, so it is harmless if several threads race on
+ * the first call.
+ *
+ * @return the best vector instruction set for this CPU
+ */
+int ATK_SimdLevel(void) {
+    if (atk_simd_level < 0) {
+        int level = ATK_SIMD_NONE;
+#if ATK_VEC_X86
+        if (SDL_HasAVX2()) {
+            level = ATK_SIMD_AVX2;
+        } else if (SDL_HasSSE2()) {
+            level = ATK_SIMD_SSE2;
+        }
+#endif
+        atk_simd_level = level;
+    }
+    return atk_simd_level;
+}
+
+#if ATK_VEC_X86
+/**
+ * Adds two input buffers together with SSE2, 4 elements at a time
+ *
+ * @param input1  The first input buffer
+ * @param input2  The second input buffer
+ * @param output  The output buffer
+ * @param len     The number of elements to add
+ *
+ * @return the number of elements processed
+ */
+ATK_SSE2 static size_t add_sse2(const float* input1, const float* input2, float* output, size_t len) {
+    size_t last = len & ~(size_t)3;
+    for(size_t ii = 0; ii < last; ii += 4) {
+        _mm_storeu_ps(output+ii, _mm_add_ps(_mm_loadu_ps(input1+ii), _mm_loadu_ps(input2+ii)));
+    }
+    return last;
+}
+
+/**
+ * Subtracts the second buffer from the first with SSE2, 4 elements at a time
+ *
+ * @param input1  The first input buffer
+ * @param input2  The second input buffer
+ * @param output  The output buffer
+ * @param len     The number of elements to subtract
+ *
+ * @return the number of elements processed
+ */
+ATK_SSE2 static size_t sub_sse2(const float* input1, const float* input2, float* output, size_t len) {
+    size_t last = len & ~(size_t)3;
+    for(size_t ii = 0; ii < last; ii += 4) {
+        _mm_storeu_ps(output+ii, _mm_sub_ps(_mm_loadu_ps(input1+ii), _mm_loadu_ps(input2+ii)));
+    }
+    return last;
+}
+
+/**
+ * Multiplies two input buffers together with SSE2, 4 elements at a time
+ *
+ * @param input1  The first input buffer
+ * @param input2  The second input buffer
+ * @param output  The output buffer
+ * @param len     The number of elements to multiply
+ *
+ * @return the number of elements processed
+ */
+ATK_SSE2 static size_t mult_sse2(const float* input1, const float* input2, float* output, size_t len) {
+    size_t last = len & ~(size_t)3;
+    for(size_t ii = 0; ii < last; ii += 4) {
+        _mm_storeu_ps(output+ii, _mm_mul_ps(_mm_loadu_ps(input1+ii), _mm_loadu_ps(input2+ii)));
+    }
+    return last;
+}
+
+/**
+ * Divides the first buffer by the second (0 for a zero divisor) with SSE2, 4 elements at a time
+ *
+ * @param input1  The first input buffer
+ * @param input2  The second input buffer
+ * @param output  The output buffer
+ * @param len     The number of elements to divide
+ *
+ * @return the number of elements processed
+ */
+ATK_SSE2 static size_t div_sse2(const float* input1, const float* input2, float* output, size_t len) {
+    const __m128 zero = _mm_setzero_ps();
+    size_t last = len & ~(size_t)3;
+    for(size_t ii = 0; ii < last; ii += 4) {
+        __m128 temp2 = _mm_loadu_ps(input2+ii);
+        __m128 quot  = _mm_div_ps(_mm_loadu_ps(input1+ii), temp2);
+        _mm_storeu_ps(output+ii, _mm_andnot_ps(_mm_cmpeq_ps(temp2, zero), quot));
+    }
+    return last;
+}
+
+/**
+ * Scales an input buffer with SSE2, 4 elements at a time
+ *
+ * @param input   The input buffer
+ * @param scalar  The scalar to mutliply by
+ * @param output  The output buffer
+ * @param len     The number of elements to multiply
+ *
+ * @return the number of elements processed
+ */
+ATK_SSE2 static size_t scale_sse2(const float* input, float scalar, float* output, size_t len) {
+    const __m128 factor = _mm_set1_ps(scalar);
+    size_t last = len & ~(size_t)3;
+    for(size_t ii = 0; ii < last; ii += 4) {
+        _mm_storeu_ps(output+ii, _mm_mul_ps(_mm_loadu_ps(input+ii), factor));
+    }
+    return last;
+}
+
+/**
+ * Scales an input buffer and adds it to another with SSE2, 4 elements at a time
+ *
+ * @param input1  The first input buffer
+ * @param input2  The second input buffer
+ * @param scalar  The scalar to mutliply input1 by
+ * @param output  The output buffer
+ * @param len     The number of elements to process
+ *
+ * @return the number of elements processed
+ */
+ATK_SSE2 static size_t scale_add_sse2(const float* input1, const float* input2, float scalar, float* output, size_t len) {
+    const __m128 factor = _mm_set1_ps(scalar);
+    size_t last = len & ~(size_t)3;
+    for(size_t ii = 0; ii < last; ii += 4) {
+        __m128 temp = _mm_mul_ps(_mm_loadu_ps(input1+ii), factor);
+        _mm_storeu_ps(output+ii, _mm_add_ps(temp, _mm_loadu_ps(input2+ii)));
+    }
+    return last;
+}
+
+/**
+ * Outputs the absolute value of the input buffer with SSE2, 4 elements at a time
+ *
+ * @param input   The input buffer
+ * @param output  The output buffer
+ * @param len     The number of elements in the buffers
+ *
+ * @return the number of elements processed
+ */
+ATK_SSE2 static size_t abs_sse2(const float* input, float* output, size_t len) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    size_t last = len & ~(size_t)3;
+    for(size_t ii = 0; ii < last; ii += 4) {
+        __m128 temp = _mm_loadu_ps(input+ii);
+        __m128 mask = _mm_cmplt_ps(temp, zero);
+        _mm_storeu_ps(output+ii, _mm_or_ps(_mm_and_ps(mask, _mm_xor_ps(temp, sign)), _mm_andnot_ps(mask, temp)));
+    }
+    return last;
+}
+
+/**
+ * Outputs the negative value of the input buffer with SSE2, 4 elements at a time
+ *
+ * @param input   The input buffer
+ * @param output  The output buffer
+ * @param len     The number of elements in the buffers
+ *
+ * @return the number of elements processed
+ */
+ATK_SSE2 static size_t neg_sse2(const float* input, float* output, size_t len) {
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    size_t last = len & ~(size_t)3;
+    for(size_t ii = 0; ii < last; ii += 4) {
+        _mm_storeu_ps(output+ii, _mm_xor_ps(_mm_loadu_ps(input+ii), sign));
+    }
+    return last;
+}
+
+/**
+ * Clips the input buffer to the range [min,max] with SSE2, 4 elements at a time
+ *
+ * @param input   The input buffer
+ * @param min     The minimum allowed value
+ * @param max     The maximum allowed value
+ * @param output  The output buffer
+ * @param len     The number of elements to clip
+ *
+ * @return the number of elements processed
+ */
+ATK_SSE2 static size_t clip_sse2(const float* input, float min, float max, float* output, size_t len) {
+    const __m128 vmin = _mm_set1_ps(min);
+    const __m128 vmax = _mm_set1_ps(max);
+    size_t last = len & ~(size_t)3;
+    for(size_t ii = 0; ii < last; ii += 4) {
+        __m128 temp = _mm_loadu_ps(input+ii);
+        __m128 above = _mm_cmpgt_ps(temp, vmax);
+        __m128 below = _mm_cmplt_ps(temp, vmin);
+        __m128 value = _mm_or_ps(_mm_and_ps(above, vmax), _mm_andnot_ps(above, temp));
+        _mm_storeu_ps(output+ii, _mm_or_ps(_mm_and_ps(below, vmin), _mm_andnot_ps(below, value)));
+    }
+    return last;
+}
+
+/**
+ * Soft clips the input buffer to the range [-bound,bound] with SSE2, 4 elements at a time
+ *
+ * @param input   The input buffer
+ * @param bound   The asymptotic bound
+ * @param knee    The soft knee bound
+ * @param output  The output buffer
+ * @param len     The number of elements to clip
+ *
+ * @return the number of elements processed
+ */
+ATK_SSE2 static size_t clip_knee_sse2(const float* input, float bound, float knee, float* output, size_t len) {
+    const __m128 vbound  = _mm_set1_ps(bound);
+    const __m128 vfactor = _mm_set1_ps(bound*knee-knee*knee);
+    const __m128 vupper  = _mm_set1_ps(knee);
+    const __m128 vlower  = _mm_set1_ps(-knee);
+    size_t last = len & ~(size_t)3;
+    for(size_t ii = 0; ii < last; ii += 4) {
+        __m128 temp = _mm_loadu_ps(input+ii);
+        __m128 prod = _mm_mul_ps(vbound, temp);
+        __m128 upper = _mm_div_ps(_mm_sub_ps(prod, vfactor), temp);
+        __m128 lower = _mm_div_ps(_mm_add_ps(prod, vfactor), temp);
+        __m128 above = _mm_cmpgt_ps(temp, vupper);
+        __m128 below = _mm_cmplt_ps(temp, vlower);
+        __m128 value = _mm_or_ps(_mm_and_ps(below, lower), _mm_andnot_ps(below, temp));
+        _mm_storeu_ps(output+ii, _mm_or_ps(_mm_and_ps(above, upper), _mm_andnot_ps(above, value)));
+    }
+    return last;
+}
+
+/**
+ * Scales an input buffer by the sliding factor start+step*i with SSE2, 4 elements at a time
+ *
+ * @param input   The input buffer
+ * @param start   The initial scalar value
+ * @param step    The scalar increment per element
+ * @param output  The output buffer
+ * @param len     The number of elements to multiply
+ *
+ * @return the number of elements processed
+ */
+ATK_SSE2 static size_t slide_sse2(const float* input, float start, float step, float* output, size_t len) {
+    const __m128 vstart = _mm_set1_ps(start);
+    const __m128 vstep  = _mm_set1_ps(step);
+    const __m128i base = _mm_setr_epi32(0, 1, 2, 3);
+    size_t last = len & ~(size_t)3;
+    for(size_t ii = 0; ii < last; ii += 4) {
+        __m128i index = _mm_add_epi32(base, _mm_set1_epi32((int)ii));
+        __m128 factor = _mm_add_ps(vstart, _mm_mul_ps(vstep, _mm_cvtepi32_ps(index)));
+        _mm_storeu_ps(output+ii, _mm_mul_ps(_mm_loadu_ps(input+ii), factor));
+    }
+    return last;
+}
+
+/**
+ * Scales an input buffer by the sliding factor start+step*i and adds it to another with SSE2, 4 elements at a time
+ *
+ * @param input1  The first input buffer
+ * @param input2  The second input buffer
+ * @param start   The initial scalar value
+ * @param step    The scalar increment per element
+ * @param output  The output buffer
+ * @param len     The number of elements to process
+ *
+ * @return the number of elements processed
+ */
+ATK_SSE2 static size_t slide_add_sse2(const float* input1, const float* input2, float start, float step, float* output, size_t len) {
+    const __m128 vstart = _mm_set1_ps(start);
+    const __m128 vstep  = _mm_set1_ps(step);
+    const __m128i base = _mm_setr_epi32(0, 1, 2, 3);
+    size_t last = len & ~(size_t)3;
+    for(size_t ii = 0; ii < last; ii += 4) {
+        __m128i index = _mm_add_epi32(base, _mm_set1_epi32((int)ii));
+        __m128 factor = _mm_add_ps(vstart, _mm_mul_ps(vstep, _mm_cvtepi32_ps(index)));
+        __m128 temp = _mm_mul_ps(_mm_loadu_ps(input1+ii), factor);
+        _mm_storeu_ps(output+ii, _mm_add_ps(temp, _mm_loadu_ps(input2+ii)));
+    }
+    return last;
+}
+
+/**
+ * Adds two input buffers together with AVX2, 8 elements at a time
+ *
+ * @param input1  The first input buffer
+ * @param input2  The second input buffer
+ * @param output  The output buffer
+ * @param len     The number of elements to add
+ *
+ * @return the number of elements processed
+ */
+ATK_AVX2 static size_t add_avx2(const float* input1, const float* input2, float* output, size_t len) {
+    size_t last = len & ~(size_t)7;
+    for(size_t ii = 0; ii < last; ii += 8) {
+        _mm256_storeu_ps(output+ii, _mm256_add_ps(_mm256_loadu_ps(input1+ii), _mm256_loadu_ps(input2+ii)));
+    }
+    return last;
+}
+
+/**
+ * Subtracts the second buffer from the first with AVX2, 8 elements at a time
+ *
+ * @param input1  The first input buffer
+ * @param input2  The second input buffer
+ * @param output  The output buffer
+ * @param len     The number of elements to subtract
+ *
+ * @return the number of elements processed
+ */
+ATK_AVX2 static size_t sub_avx2(const float* input1, const float* input2, float* output, size_t len) {
+    size_t last = len & ~(size_t)7;
+    for(size_t ii = 0; ii < last; ii += 8) {
+        _mm256_storeu_ps(output+ii, _mm256_sub_ps(_mm256_loadu_ps(input1+ii), _mm256_loadu_ps(input2+ii)));
+    }
+    return last;
+}
+
+/**
+ * Multiplies two input buffers together with AVX2, 8 elements at a time
+ *
+ * @param input1  The first input buffer
+ * @param input2  The second input buffer
+ * @param output  The output buffer
+ * @param len     The number of elements to multiply
+ *
+ * @return the number of elements processed
+ */
+ATK_AVX2 static size_t mult_avx2(const float* input1, const float* input2, float* output, size_t len) {
+    size_t last = len & ~(size_t)7;
+    for(size_t ii = 0; ii < last; ii += 8) {
+        _mm256_storeu_ps(output+ii, _mm256_mul_ps(_mm256_loadu_ps(input1+ii), _mm256_loadu_ps(input2+ii)));
+    }
+    return last;
+}
+
+/**
+ * Divides the first buffer by the second (0 for a zero divisor) with AVX2, 8 elements at a time
+ *
+ * @param input1  The first input buffer
+ * @param input2  The second input buffer
+ * @param output  The output buffer
+ * @param len     The number of elements to divide
+ *
+ * @return the number of elements processed
+ */
+ATK_AVX2 static size_t div_avx2(const float* input1, const float* input2, float* output, size_t len) {
+    const __m256 zero = _mm256_setzero_ps();
+    size_t last = len & ~(size_t)7;
+    for(size_t ii = 0; ii < last; ii += 8) {
+        __m256 temp2 = _mm256_loadu_ps(input2+ii);
+        __m256 quot  = _mm256_div_ps(_mm256_loadu_ps(input1+ii), temp2);
+        _mm256_storeu_ps(output+ii, _mm256_andnot_ps(_mm256_cmp_ps(temp2, zero, _CMP_EQ_OQ), quot));
+    }
+    return last;
+}
+
+/**
+ * Scales an input buffer with AVX2, 8 elements at a time
+ *
+ * @param input   The input buffer
+ * @param scalar  The scalar to mutliply by
+ * @param output  The output buffer
+ * @param len     The number of elements to multiply
+ *
+ * @return the number of elements processed
+ */
+ATK_AVX2 static size_t scale_avx2(const float* input, float scalar, float* output, size_t len) {
+    const __m256 factor = _mm256_set1_ps(scalar);
+    size_t last = len & ~(size_t)7;
+    for(size_t ii = 0; ii < last; ii += 8) {
+        _mm256_storeu_ps(output+ii, _mm256_mul_ps(_mm256_loadu_ps(input+ii), factor));
+    }
+    return last;
+}
+
+/**
+ * Scales an input buffer and adds it to another with AVX2, 8 elements at a time
+ *
+ * @param input1  The first input buffer
+ * @param input2  The second input buffer
+ * @param scalar  The scalar to mutliply input1 by
+ * @param output  The output buffer
+ * @param len     The number of elements to process
+ *
+ * @return the number of elements processed
+ */
+ATK_AVX2 static size_t scale_add_avx2(const float* input1, const float* input2, float scalar, float* output, size_t len) {
+    const __m256 factor = _mm256_set1_ps(scalar);
+    size_t last = len & ~(size_t)7;
+    for(size_t ii = 0; ii < last; ii += 8) {
+        __m256 temp = _mm256_mul_ps(_mm256_loadu_ps(input1+ii), factor);
+        _mm256_storeu_ps(output+ii, _mm256_add_ps(temp, _mm256_loadu_ps(input2+ii)));
+    }
+    return last;
+}
+
+/**
+ * Outputs the absolute value of the input buffer with AVX2, 8 elements at a time
+ *
+ * @param input   The input buffer
+ * @param output  The output buffer
+ * @param len     The number of elements in the buffers
+ *
+ * @return the number of elements processed
+ */
+ATK_AVX2 static size_t abs_avx2(const float* input, float* output, size_t len) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    size_t last = len & ~(size_t)7;
+    for(size_t ii = 0; ii < last; ii += 8) {
+        __m256 temp = _mm256_loadu_ps(input+ii);
+        __m256 mask = _mm256_cmp_ps(temp, zero, _CMP_LT_OQ);
+        _mm256_storeu_ps(output+ii, _mm256_or_ps(_mm256_and_ps(mask, _mm256_xor_ps(temp, sign)), _mm256_andnot_ps(mask, temp)));
+    }
+    return last;
+}
+
+/**
+ * Outputs the negative value of the input buffer with AVX2, 8 elements at a time
+ *
+ * @param input   The input buffer
+ * @param output  The output buffer
+ * @param len     The number of elements in the buffers
+ *
+ * @return the number of elements processed
+ */
+ATK_AVX2 static size_t neg_avx2(const float* input, float* output, size_t len) {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    size_t last = len & ~(size_t)7;
+    for(size_t ii = 0; ii < last; ii += 8) {
+        _mm256_storeu_ps(output+ii, _mm256_xor_ps(_mm256_loadu_ps(input+ii), sign));
+    }
+    return last;
+}
+
+/**
+ * Clips the input buffer to the range [min,max] with AVX2, 8 elements at a time
+ *
+ * @param input   The input buffer
+ * @param min     The minimum allowed value
+ * @param max     The maximum allowed value
+ * @param output  The output buffer
+ * @param len     The number of elements to clip
+ *
+ * @return the number of elements processed
+ */
+ATK_AVX2 static size_t clip_avx2(const float* input, float min, float max, float* output, size_t len) {
+    const __m256 vmin = _mm256_set1_ps(min);
+    const __m256 vmax = _mm256_set1_ps(max);
+    size_t last = len & ~(size_t)7;
+    for(size_t ii = 0; ii < last; ii += 8) {
+        __m256 temp = _mm256_loadu_ps(input+ii);
+        __m256 above = _mm256_cmp_ps(temp, vmax, _CMP_GT_OQ);
+        __m256 below = _mm256_cmp_ps(temp, vmin, _CMP_LT_OQ);
+        __m256 value = _mm256_or_ps(_mm256_and_ps(above, vmax), _mm256_andnot_ps(above, temp));
+        _mm256_storeu_ps(output+ii, _mm256_or_ps(_mm256_and_ps(below, vmin), _mm256_andnot_ps(below, value)));
+    }
+    return last;
+}
+
+/**
+ * Soft clips the input buffer to the range [-bound,bound] with AVX2, 8 elements at a time
+ *
+ * @param input   The input buffer
+ * @param bound   The asymptotic bound
+ * @param knee    The soft knee bound
+ * @param output  The output buffer
+ * @param len     The number of elements to clip
+ *
+ * @return the number of elements processed
+ */
+ATK_AVX2 static size_t clip_knee_avx2(const float* input, float bound, float knee, float* output, size_t len) {
+    const __m256 vbound  = _mm256_set1_ps(bound);
+    const __m256 vfactor = _mm256_set1_ps(bound*knee-knee*knee);
+    const __m256 vupper  = _mm256_set1_ps(knee);
+    const __m256 vlower  = _mm256_set1_ps(-knee);
+    size_t last = len & ~(size_t)7;
+    for(size_t ii = 0; ii < last; ii += 8) {
+        __m256 temp = _mm256_loadu_ps(input+ii);
+        __m256 prod = _mm256_mul_ps(vbound, temp);
+        __m256 upper = _mm256_div_ps(_mm256_sub_ps(prod, vfactor), temp);
+        __m256 lower = _mm256_div_ps(_mm256_add_ps(prod, vfactor), temp);
+        __m256 above = _mm256_cmp_ps(temp, vupper, _CMP_GT_OQ);
+        __m256 below = _mm256_cmp_ps(temp, vlower, _CMP_LT_OQ);
+        __m256 value = _mm256_or_ps(_mm256_and_ps(below, lower), _mm256_andnot_ps(below, temp));
+        _mm256_storeu_ps(output+ii, _mm256_or_ps(_mm256_and_ps(above, upper), _mm256_andnot_ps(above, value)));
+    }
+    return last;
+}
+
+/**
+ * Scales an input buffer by the sliding factor start+step*i with AVX2, 8 elements at a time
+ *
+ * @param input   The input buffer
+ * @param start   The initial scalar value
+ * @param step    The scalar increment per element
+ * @param output  The output buffer
+ * @param len     The number of elements to multiply
+ *
+ * @return the number of elements processed
+ */
+ATK_AVX2 static size_t slide_avx2(const float* input, float start, float step, float* output, size_t len) {
+    const __m256 vstart = _mm256_set1_ps(start);
+    const __m256 vstep  = _mm256_set1_ps(step);
+    const __m256i base = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    size_t last = len & ~(size_t)7;
+    for(size_t ii = 0; ii < last; ii += 8) {
+        __m256i index = _mm256_add_epi32(base, _mm256_set1_epi32((int)ii));
+        __m256 factor = _mm256_add_ps(vstart, _mm256_mul_ps(vstep, _mm256_cvtepi32_ps(index)));
+        _mm256_storeu_ps(output+ii, _mm256_mul_ps(_mm256_loadu_ps(input+ii), factor));
+    }
+    return last;
+}
+
+/**
+ * Scales an input buffer by the sliding factor start+step*i and adds it to another with AVX2, 8 elements at a time
+ *
+ * @param input1  The first input buffer
+ * @param input2  The second input buffer
+ * @param start   The initial scalar value
+ * @param step    The scalar increment per element
+ * @param output  The output buffer
+ * @param len     The number of elements to process
+ *
+ * @return the number of elements processed
+ */
+ATK_AVX2 static size_t slide_add_avx2(const float* input1, const float* input2, float start, float step, float* output, size_t len) {
+    const __m256 vstart = _mm256_set1_ps(start);
+    const __m256 vstep  = _mm256_set1_ps(step);
+    const __m256i base = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    size_t last = len & ~(size_t)7;
+    for(size_t ii = 0; ii < last; ii += 8) {
+        __m256i index = _mm256_add_epi32(base, _mm256_set1_epi32((int)ii));
+        __m256 factor = _mm256_add_ps(vstart, _mm256_mul_ps(vstep, _mm256_cvtepi32_ps(index)));
+        __m256 temp = _mm256_mul_ps(_mm256_loadu_ps(input1+ii), factor);
+        _mm256_storeu_ps(output+ii, _mm256_add_ps(temp, _mm256_loadu_ps(input2+ii)));
+    }
+    return last;
+}
+#endif
+
+/**
+ * Adds two input buffers together with the best available vector instructions
+ *
+ * This function returns the number of elements processed, which is a
+ * multiple of the vector width. The caller processes the remainder.
+ *
+ * @param input1  The first input buffer
+ * @param input2  The second input buffer
+ * @param output  The output buffer
+ * @param len     The number of elements to add
+ *
+ * @return the number of elements processed
+ */
+static size_t simd_add(const float* input1, const float* input2, float* output, size_t len) {
+#if ATK_VEC_X86
+    switch (ATK_SimdLevel()) {
+        case ATK_SIMD_AVX2:
+            return add_avx2(input1, input2, output, len);
+        case ATK_SIMD_SSE2:
+            return add_sse2(input1, input2, output, len);
+        default:
+            break;
+    }
+#endif
+    return 0;
+}
+
+/**
+ * Subtracts the second buffer from the first with the best available vector instructions
+ *
+ * This function returns the number of elements processed, which is a
+ * multiple of the vector width. The caller processes the remainder.
+ *
+ * @param input1  The first input buffer
+ * @param input2  The second input buffer
+ * @param output  The output buffer
+ * @param len     The number of elements to subtract
+ *
+ * @return the number of elements processed
+ */
+static size_t simd_sub(const float* input1, const float* input2, float* output, size_t len) {
+#if ATK_VEC_X86
+    switch (ATK_SimdLevel()) {
+        case ATK_SIMD_AVX2:
+            return sub_avx2(input1, input2, output, len);
+        case ATK_SIMD_SSE2:
+            return sub_sse2(input1, input2, output, len);
+        default:
+            break;
+    }
+#endif
+    return 0;
+}
+
+/**
+ * Multiplies two input buffers together with the best available vector instructions
+ *
+ * This function returns the number of elements processed, which is a
+ * multiple of the vector width. The caller processes the remainder.
+ *
+ * @param input1  The first input buffer
+ * @param input2  The second input buffer
+ * @param output  The output buffer
+ * @param len     The number of elements to multiply
+ *
+ * @return the number of elements processed
+ */
+static size_t simd_mult(const float* input1, const float* input2, float* output, size_t len) {
+#if ATK_VEC_X86
+    switch (ATK_SimdLevel()) {
+        case ATK_SIMD_AVX2:
+            return mult_avx2(input1, input2, output, len);
+        case ATK_SIMD_SSE2:
+            return mult_sse2(input1, input2, output, len);
+        default:
+            break;
+    }
+#endif
+    return 0;
+}
+
+/**
+ * Divides the first buffer by the second (0 for a zero divisor) with the best available vector instructions
+ *
+ * This function returns the number of elements processed, which is a
+ * multiple of the vector width. The caller processes the remainder.
+ *
+ * @param input1  The first input buffer
+ * @param input2  The second input buffer
+ * @param output  The output buffer
+ * @param len     The number of elements to divide
+ *
+ * @return the number of elements processed
+ */
+static size_t simd_div(const float* input1, const float* input2, float* output, size_t len) {
+#if ATK_VEC_X86
+    switch (ATK_SimdLevel()) {
+        case ATK_SIMD_AVX2:
+            return div_avx2(input1, input2, output, len);
+        case ATK_SIMD_SSE2:
+            return div_sse2(input1, input2, output, len);
+        default:
+            break;
+    }
+#endif
+    return 0;
+}
+
+/**
+ * Scales an input buffer with the best available vector instructions
+ *
+ * This function returns the number of elements processed, which is a
+ * multiple of the vector width. The caller processes the remainder.
+ *
+ * @param input   The input buffer
+ * @param scalar  The scalar to mutliply by
+ * @param output  The output buffer
+ * @param len     The number of elements to multiply
+ *
+ * @return the number of elements processed
+ */
+static size_t simd_scale(const float* input, float scalar, float* output, size_t len) {
+#if ATK_VEC_X86
+    switch (ATK_SimdLevel()) {
+        case ATK_SIMD_AVX2:
+            return scale_avx2(input, scalar, output, len);
+        case ATK_SIMD_SSE2:
+            return scale_sse2(input, scalar, output, len);
+        default:
+            break;
+    }
+#endif
+    return 0;
+}
+
+/**
+ * Scales an input buffer and adds it to another with the best available vector instructions
+ *
+ * This function returns the number of elements processed, which is a
+ * multiple of the vector width. The caller processes the remainder.
+ *
+ * @param input1  The first input buffer
+ * @param input2  The second input buffer
+ * @param scalar  The scalar to mutliply input1 by
+ * @param output  The output buffer
+ * @param len     The number of elements to process
+ *
+ * @return the number of elements processed
+ */
+static size_t simd_scale_add(const float* input1, const float* input2, float scalar, float* output, size_t len) {
+#if ATK_VEC_X86
+    switch (ATK_SimdLevel()) {
+        case ATK_SIMD_AVX2:
+            return scale_add_avx2(input1, input2, scalar, output, len);
+        case ATK_SIMD_SSE2:
+            return scale_add_sse2(input1, input2, scalar, output, len);
+        default:
+            break;
+    }
+#endif
+    return 0;
+}
+
+/**
+ * Outputs the absolute value of the input buffer with the best available vector instructions
+ *
+ * This function returns the number of elements processed, which is a
+ * multiple of the vector width. The caller processes the remainder.
+ *
+ * @param input   The input buffer
+ * @param output  The output buffer
+ * @param len     The number of elements in the buffers
+ *
+ * @return the number of elements processed
+ */
+static size_t simd_abs(const float* input, float* output, size_t len) {
+#if ATK_VEC_X86
+    switch (ATK_SimdLevel()) {
+        case ATK_SIMD_AVX2:
+            return abs_avx2(input, output, len);
+        case ATK_SIMD_SSE2:
+            return abs_sse2(input, output, len);
+        default:
+            break;
+    }
+#endif
+    return 0;
+}
+
+/**
+ * Outputs the negative value of the input buffer with the best available vector instructions
+ *
+ * This function returns the number of elements processed, which is a
+ * multiple of the vector width. The caller processes the remainder.
+ *
+ * @param input   The input buffer
+ * @param output  The output buffer
+ * @param len     The number of elements in the buffers
+ *
+ * @return the number of elements processed
+ */
+static size_t simd_neg(const float* input, float* output, size_t len) {
+#if ATK_VEC_X86
+    switch (ATK_SimdLevel()) {
+        case ATK_SIMD_AVX2:
+            return neg_avx2(input, output, len);
+        case ATK_SIMD_SSE2:
+            return neg_sse2(input, output, len);
+        default:
+            break;
+    }
+#endif
+    return 0;
+}
+
+/**
+ * Clips the input buffer to the range [min,max] with the best available vector instructions
+ *
+ * This function returns the number of elements processed, which is a
+ * multiple of the vector width. The caller processes the remainder.
+ *
+ * @param input   The input buffer
+ * @param min     The minimum allowed value
+ * @param max     The maximum allowed value
+ * @param output  The output buffer
+ * @param len     The number of elements to clip
+ *
+ * @return the number of elements processed
+ */
+static size_t simd_clip(const float* input, float min, float max, float* output, size_t len) {
+#if ATK_VEC_X86
+    switch (ATK_SimdLevel()) {
+        case ATK_SIMD_AVX2:
+            return clip_avx2(input, min, max, output, len);
+        case ATK_SIMD_SSE2:
+            return clip_sse2(input, min, max, output, len);
+        default:
+            break;
+    }
+#endif
+    return 0;
+}
+
+/**
+ * Soft clips the input buffer to the range [-bound,bound] with the best available vector instructions
+ *
+ * This function returns the number of elements processed, which is a
+ * multiple of the vector width. The caller processes the remainder.
+ *
+ * @param input   The input buffer
+ * @param bound   The asymptotic bound
+ * @param knee    The soft knee bound
+ * @param output  The output buffer
+ * @param len     The number of elements to clip
+ *
+ * @return the number of elements processed
+ */
+static size_t simd_clip_knee(const float* input, float bound, float knee, float* output, size_t len) {
+#if ATK_VEC_X86
+    switch (ATK_SimdLevel()) {
+        case ATK_SIMD_AVX2:
+            return clip_knee_avx2(input, bound, knee, output, len);
+        case ATK_SIMD_SSE2:
+            return clip_knee_sse2(input, bound, knee, output, len);
+        default:
+            break;
+    }
+#endif
+    return 0;
+}
+
+/**
+ * Scales an input buffer by the sliding factor start+step*i with the best available vector instructions
+ *
+ * This function returns the number of elements processed, which is a
+ * multiple of the vector width. The caller processes the remainder.
+ *
+ * @param input   The input buffer
+ * @param start   The initial scalar value
+ * @param step    The scalar increment per element
+ * @param output  The output buffer
+ * @param len     The number of elements to multiply
+ *
+ * @return the number of elements processed
+ */
+static size_t simd_slide(const float* input, float start, float step, float* output, size_t len) {
+#if ATK_VEC_X86
+    switch (ATK_SimdLevel()) {
+        case ATK_SIMD_AVX2:
+            return slide_avx2(input, start, step, output, len);
+        case ATK_SIMD_SSE2:
+            return slide_sse2(input, start, step, output, len);
+        default:
+            break;
+    }
+#endif
+    return 0;
+}
+
+/**
+ * Scales an input buffer by the sliding factor start+step*i and adds it to another with the best available vector instructions
+ *
+ * This function returns the number of elements processed, which is a
+ * multiple of the vector width. The caller processes the remainder.
+ *
+ * @param input1  The first input buffer
+ * @param input2  The second input buffer
+ * @param start   The initial scalar value
+ * @param step    The scalar increment per element
+ * @param output  The output buffer
+ * @param len     The number of elements to process
+ *
+ * @return the number of elements processed
+ */
+static size_t simd_slide_add(const float* input1, const float* input2, float start, float step, float* output, size_t len) {
+#if ATK_VEC_X86
+    switch (ATK_SimdLevel()) {
+        case ATK_SIMD_AVX2:
+            return slide_add_avx2(input1, input2, start, step, output, len);
+        case ATK_SIMD_SSE2:
+            return slide_add_sse2(input1, input2, start, step, output, len);
+        default:
+            break;
+    }
+#endif
+    return 0;
+}
+#pragma mark -
 #pragma mark Distance Utils
 /**
  * Returns the distance squared between the arrays adata and bdata
@@ -1343,9 +2232,11 @@ void ATK_VecRamp_stride(float* data, size_t stride,
  * @param len       The number of elements in the buffers
  */
 void ATK_VecAbs(const float* input, float* output, size_t len) {
-    const float* src = input;
-    float* dst = output;
+    size_t done = simd_abs(input, output, len);
+    const float* src = input+done;
+    float* dst = output+done;
     float temp;
+    len -= done;
     while(len--) {
         temp = *src++;
         *dst++ = (temp < 0 ? -temp : temp);
@@ -1450,8 +2341,10 @@ void ATK_VecAbsNeg_stride(const float* input, size_t istride,
  * @param len       The number of elements in the buffers
  */
 void ATK_VecNeg(const float* input, float* output, size_t len) {
-    const float* src = input;
-    float* dst = output;
+    size_t done = simd_neg(input, output, len);
+    const float* src = input+done;
+    float* dst = output+done;
+    len -= done;
     while(len--) {
         *dst++ = -*src++;
     }
@@ -1557,9 +2450,11 @@ void ATK_VecInv_stride(const float* input, size_t istride,
  */
 void ATK_VecAdd(const float* input1, const float* input2,
                 float* output, size_t len) {
-    const float* src1 = input1;
-    const float* src2 = input2;
-    float* dst = output;
+    size_t done = simd_add(input1, input2, output, len);
+    const float* src1 = input1+done;
+    const float* src2 = input2+done;
+    float* dst = output+done;
+    len -= done;
     while(len--) {
         *dst++ = *(src1++)+*(src2++);
     }
@@ -1616,9 +2511,11 @@ void ATK_VecAdd_stride(const float* input1, size_t istride1,
  */
 void ATK_VecSub(const float* input1, const float* input2,
                 float* output, size_t len) {
-    const float* src1 = input1;
-    const float* src2 = input2;
-    float* dst = output;
+    size_t done = simd_sub(input1, input2, output, len);
+    const float* src1 = input1+done;
+    const float* src2 = input2+done;
+    float* dst = output+done;
+    len -= done;
     while(len--) {
         *dst++ = *(src1++)-*(src2++);
     }
@@ -1675,9 +2572,11 @@ void ATK_VecSub_stride(const float* input1, size_t istride1,
  */
 void ATK_VecMult(const float* input1, const float* input2,
                  float* output, size_t len) {
-    const float* src1 = input1;
-    const float* src2 = input2;
-    float* dst = output;
+    size_t done = simd_mult(input1, input2, output, len);
+    const float* src1 = input1+done;
+    const float* src2 = input2+done;
+    float* dst = output+done;
+    len -= done;
     while(len--) {
         *dst++ = *(src1++) * *(src2++);
     }
@@ -1738,11 +2637,13 @@ void ATK_VecMult_stride(const float* input1, size_t istride1,
  */
 void ATK_VecDiv(const float* input1, const float* input2,
                 float* output, size_t len) {
-    const float* src1 = input1;
-    const float* src2 = input2;
-    float* dst = output;
+    size_t done = simd_div(input1, input2, output, len);
+    const float* src1 = input1+done;
+    const float* src2 = input2+done;
+    float* dst = output+done;
     float temp1 = 0;
     float temp2 = 0;
+    len -= done;
     while(len--) {
         temp1 = *src1++;
         temp2 = *src2++;
@@ -1806,8 +2707,10 @@ void ATK_VecDiv_stride(const float* input1, size_t istride1,
  * @param len       The number of elements to multiply
  */
 void ATK_VecScale(const float* input, float scalar, float* output, size_t len) {
-    const float* src = input;
-    float* dst = output;
+    size_t done = simd_scale(input, scalar, output, len);
+    const float* src = input+done;
+    float* dst = output+done;
+    len -= done;
     while(len--) {
         *dst++ = *(src++) * scalar;
     }
@@ -1858,9 +2761,11 @@ void ATK_VecScale_stride(const float* input, size_t istride, float scalar,
  */
 void ATK_VecScaleAdd(const float* input1, const float* input2, float scalar,
                      float* output, size_t len) {
-    const float* src1 = input1;
-    const float* src2 = input2;
-    float* dst  = output;
+    size_t done = simd_scale_add(input1, input2, scalar, output, len);
+    const float* src1 = input1+done;
+    const float* src2 = input2+done;
+    float* dst  = output+done;
+    len -= done;
     while(len--) {
         *dst++ = *(src1++)*scalar+*(src2++);
     }
@@ -1925,9 +2830,11 @@ void ATK_VecScaleAdd_stride(const float* input1, size_t istride1,
  */
 void ATK_VecClip(const float* input, float min, float max,
                  float* output, size_t len) {
-    const float* left = input;
-    float* rght = output;
+    size_t done = simd_clip(input, min, max, output, len);
+    const float* left = input+done;
+    float* rght = output+done;
     float temp;
+    len -= done;
     while(len--) {
         temp = *left++;
         if (temp < min) {
@@ -2174,9 +3081,11 @@ void ATK_VecClipCount_stride(const float* input, size_t istride,
 void ATK_VecClipKnee(const float* input, float bound, float knee,
                      float* output, size_t len) {
     float factor = bound*knee-knee*knee;
-    const float* left = input;
-    float* rght = output;
+    size_t done = simd_clip_knee(input, bound, knee, output, len);
+    const float* left = input+done;
+    float* rght = output+done;
     float temp;
+    len -= done;
     while(len--) {
         temp = *left++;
         if (temp > knee) {
@@ -3202,14 +4111,14 @@ void ATK_VecSlide(const float* input, float start, float end,
         return;
     }
     float step = (end-start)/(len-1);
-    float curr = start;
-
-    const float* src = input;
-    float* dst = output;
     size_t amt = len-1;
-    while(amt--) {
-        *(dst++) = *(src++) * curr;
-        curr += step;
+
+    // Compute each factor directly so that vector lanes agree with the loop
+    size_t done = simd_slide(input, start, step, output, amt);
+    const float* src = input+done;
+    float* dst = output+done;
+    for(size_t ii = done; ii < amt; ii++) {
+        *(dst++) = *(src++) * (start+step*ii);
     }
     *dst = *src * end;  // Round off
 }
@@ -3283,15 +4192,15 @@ void ATK_VecSlideAdd(const float* input1, const float* input2,
         return;
     }
     float step = (end-start)/(len-1);
-    float curr = start;
-
-    const float* src1 = input1;
-    const float* src2 = input2;
-    float* dst = output;
     size_t amt = len-1;
-    while(amt--) {
-        *(dst++) = *(src1++) * curr + *(src2++);
-        curr += step;
+
+    // Compute each factor directly so that vector lanes agree with the loop
+    size_t done = simd_slide_add(input1, input2, start, step, output, amt);
+    const float* src1 = input1+done;
+    const float* src2 = input2+done;
+    float* dst = output+done;
+    for(size_t ii = done; ii < amt; ii++) {
+        *(dst++) = *(src1++) * (start+step*ii) + *(src2++);
     }
     *dst = *src1 * end + *src2;    // Round off
 }
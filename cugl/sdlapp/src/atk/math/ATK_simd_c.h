@@ -0,0 +1,82 @@
+/*
+ * SDL_atk:  An audio toolkit library for use with SDL
+ * Copyright (C) 2022-2023 Walker M. White
+ *
+ * This is a library to load different types of audio files as PCM data,
+ * and process them with basic DSP tools. The goal of this library is to
+ * create an audio equivalent of SDL_image, where we can load and process
+ * audio files without having to initialize the audio subsystem. In addition,
+ * giving us direct control of the audio allows us to add more custom
+ * effects than is possible in SDL_mixer.
+ * 
+ * SDL License:
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+#ifndef __ATK_SIMD_C_H__
+#define __ATK_SIMD_C_H__
+
+/* This is an internal header for the vector kernels */
+#include <SDL_atk.h>
+
+// Vector kernels are only available on x86 (with runtime detection)
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define ATK_VEC_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define ATK_SSE2
+        #define ATK_AVX2
+    #else
+        #define ATK_SSE2 __attribute__((target("sse2")))
+        #define ATK_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+#include <begin_code.h>
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** No vector instructions */
+#define ATK_SIMD_NONE   0
+/** SSE2 vector instructions (4 floats) */
+#define ATK_SIMD_SSE2   1
+/** AVX2 vector instructions (8 floats) */
+#define ATK_SIMD_AVX2   2
+
+/**
+ * Returns the best vector instruction set for this CPU
+ *
+ * The instruction set is detected with SDL_cpuinfo. The result is cached
+ * after the first call, and is shared by every module with vector kernels.
+ * Detection is idempotent, so it is harmless if several threads race on
+ * the first call.
+ *
+ * @return the best vector instruction set for this CPU
+ */
+extern DECLSPEC int SDLCALL ATK_SimdLevel(void);
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+#include <close_code.h>
+
+#endif /* __ATK_SIMD_C_H__ */
@@ -55,6 +55,11 @@
 
 using namespace cugl::audio;
 
+/** Request to restart the fade-out tail */
+#define REQUEST_TAIL    0x01
+/** Request to clear the reverb filters */
+#define REQUEST_CLEAR   0x02
+
 /**
  * Creates a degenerate audio player with no associated source.
  *
@@ -62,11 +67,13 @@ using namespace cugl::audio;
  * The player must be initialized to be used.
  */
 AlgorithmicReverb::AlgorithmicReverb() : AudioNode(),
+_pending(0),
+_dirty(false),
 _reverb(NULL),
-_outdone(false),
 _outmark(-1),
+_outsize(-1),
 _fadeout(0),
-_dirty(false) {
+_outdone(false) {
     _classname = "AudioReverb";
 
     ATK_AlgoReverbDef settings;
@@ -180,6 +187,12 @@ void AlgorithmicReverb::dispose() {
         _width = 0;
         _ingain = 0;
         _roomsize = 0;
+        _pending = 0;
+        _dirty = false;
+        _outmark = -1;
+        _outsize = -1;
+        _fadeout = 0;
+        _outdone = false;
         if (_reverb != NULL) {
             ATK_FreeAlgoReverb(_reverb);
             _reverb = NULL;
@@ -233,7 +246,7 @@ std::shared_ptr<AudioNode> AlgorithmicReverb::detach() {
     }
 
     std::shared_ptr<AudioNode> result = std::atomic_exchange_explicit(&_input, {}, std::memory_order_relaxed);
-    ATK_ResetAlgoReverb(_reverb);
+    _pending.fetch_or(REQUEST_CLEAR,std::memory_order_release);
     return result;
 }
 
@@ -242,7 +255,7 @@ std::shared_ptr<AudioNode> AlgorithmicReverb::detach() {
  * Clears all filters in the reverb subgraph.
  */
 void AlgorithmicReverb::clear() {
-    ATK_ResetAlgoReverb(_reverb);
+    _pending.fetch_or(REQUEST_CLEAR,std::memory_order_release);
 }
 
 /**
@@ -255,6 +268,9 @@ void AlgorithmicReverb::clear() {
  * The buffer should have enough room to store frames * channels elements.
  * The channels are interleaved into the output buffer.
  *
+ * This method never waits on the main thread. Changes to the tail or
+ * the reverb settings are applied at the start of the next call.
+ *
  * This method will always forward the read position after reading. Reading
  * again may return different data.
  *
@@ -264,12 +280,12 @@ void AlgorithmicReverb::clear() {
  * @return the actual number of frames read
  */
 Uint32 AlgorithmicReverb::read(float* buffer, Uint32 frames) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (_dirty.load(std::memory_order_relaxed)) {
+    applyRequests();
+    if (_dirty.exchange(false,std::memory_order_acquire)) {
         updateReverb();
     }
     
-    std::shared_ptr<AudioNode> input = _input;
+    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     Uint32 actual = 0;
     if (input == nullptr || _paused.load(std::memory_order_relaxed)) {
         std::memset(buffer, 0, frames*_channels * sizeof(float));
@@ -277,8 +293,8 @@ Uint32 AlgorithmicReverb::read(float* buffer, Uint32 frames) {
     } else if (_fadeout > 0) {
         actual = std::min(frames,(Uint32)_fadeout);
         std::memset(buffer, 0, actual*_channels * sizeof(float));
-        float start = (float)_fadeout/(float)_outmark;
-        float ends  = (float)(_fadeout-actual)/(float)_outmark;
+        float start = (float)_fadeout/(float)_outsize;
+        float ends  = (float)(_fadeout-actual)/(float)_outsize;
         _fadeout -= actual;
         _outdone = (_fadeout == 0);
 
@@ -290,20 +306,20 @@ Uint32 AlgorithmicReverb::read(float* buffer, Uint32 frames) {
     } else if (!_outdone) {
         actual = input->read(buffer, frames);
         Uint32 fadeidx = actual;
-        if ((actual < frames || input->completed()) && _outmark > 0) {
+        if ((actual < frames || input->completed()) && _outsize > 0) {
             Uint32 remain = frames - actual;
-            remain = (Uint32)(remain < _outmark ? remain : _outmark);
+            remain = (Uint32)(remain < _outsize ? remain : _outsize);
             std::memset(buffer+actual*_channels, 0, remain*sizeof(float)*_channels);
             actual += remain;
-            _fadeout = _outmark-remain;
+            _fadeout = _outsize-remain;
             _outdone = _fadeout == 0;
         }
 
         ATK_ApplyAlgoReverb(_reverb, buffer, buffer, actual);
         if (fadeidx < actual) {
             Uint32 left = std::min(actual-fadeidx,(Uint32)_fadeout);
-            float start = (float)_fadeout/(float)_outmark;
-            float ends  = (float)(_fadeout-left)/(float)_outmark;
+            float start = (float)_fadeout/(float)_outsize;
+            float ends  = (float)(_fadeout-left)/(float)_outsize;
             ATK_VecSlide(buffer+fadeidx*_channels,start,ends,
                          buffer+fadeidx*_channels,left*_channels);
         }
@@ -358,6 +374,25 @@ void AlgorithmicReverb::updateReverb() {
     ATK_UpdateAlgoReverb(_reverb, &settings);
 }
 
+/**
+ * Applies the pending tail and clear requests.
+ *
+ * This method is called by {@link read} before it processes any audio.
+ *
+ * AUDIO THREAD ONLY: Users should never access this method directly.
+ */
+void AlgorithmicReverb::applyRequests() {
+    Uint32 pending = _pending.exchange(0,std::memory_order_acquire);
+    if (pending & REQUEST_CLEAR) {
+        ATK_ResetAlgoReverb(_reverb);
+    }
+    if (pending & REQUEST_TAIL) {
+        _outsize = _outmark.load(std::memory_order_relaxed);
+        _fadeout = 0;
+        _outdone.store(false,std::memory_order_relaxed);
+    }
+}
+
 
 /**
  * Sets the room size associated this reverb filter.
@@ -480,10 +515,9 @@ float AlgorithmicReverb::getWidth() {
  * @param duration  The fade-out tail in seconds
  */
 void AlgorithmicReverb::setTail(double duration) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    _outmark = (Sint64)(duration*_sampling);
-    _fadeout = 0;
-    _outdone = false;
+    _outmark.store((Sint64)(duration*_sampling),std::memory_order_relaxed);
+    _outdone.store(false,std::memory_order_relaxed);
+    _pending.fetch_or(REQUEST_TAIL,std::memory_order_release);
 }
 
 /**
@@ -501,8 +535,7 @@ void AlgorithmicReverb::setTail(double duration) {
  * @return the fade-out tail for this reverb node
  */
 double AlgorithmicReverb::getTail() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return ((double)_outmark)/_sampling;
+    return ((double)_outmark.load(std::memory_order_relaxed))/_sampling;
 }
 
 #pragma mark -
@@ -590,8 +623,8 @@ bool AlgorithmicReverb::reset() {
     if (input) {
         return input->reset();
     }
-    _outdone = false;
-    _fadeout = 0;
+    _outdone.store(false,std::memory_order_relaxed);
+    _pending.fetch_or(REQUEST_TAIL,std::memory_order_release);
     return false;
 }
 
@@ -54,6 +54,23 @@
 
 using namespace cugl::audio;
 
+/** Request to start (or cancel) a fade-in */
+#define REQUEST_IN     0x01
+/** Request to start a fade-out */
+#define REQUEST_OUT    0x02
+/** Modifier for REQUEST_OUT to persist the fade-out on a reset */
+#define REQUEST_KEEP   0x04
+/** Request to start a fade-pause */
+#define REQUEST_DIP    0x08
+/** Request to cancel the first half of a fade-pause */
+#define REQUEST_UNDIP  0x10
+/** Request to cancel all fades, except a persistent fade-out */
+#define REQUEST_RESET  0x20
+/** Request to cancel all fades */
+#define REQUEST_CLEAR  0x40
+/** All of the fade requests */
+#define REQUEST_ALL    0x7f
+
 /**
  * Creates a degenerate audio fader.
  *
@@ -61,15 +78,19 @@ using namespace cugl::audio;
  * be initialized to be used.
  */
 AudioFader::AudioFader() :
+_pending(0),
+_reqin(-1),
+_reqout(-1),
+_reqdip(0),
+_inmark(-1),
 _fadein(0),
+_outmark(-1),
 _fadeout(0),
+_outdone(false),
+_outkeep(false),
 _fadedip(0),
-_inmark(-1),
-_outmark(-1),
 _dipmark(-1),
 _dipstop(0),
-_outdone(false),
-_outkeep(false),
 _diphalf(false) {
     _classname = "AudioFader";
 }
@@ -143,11 +164,13 @@ bool AudioFader::init(const std::shared_ptr<AudioNode>& input) {
 void AudioFader::dispose() {
     if (_booted) {
         AudioNode::dispose();
+        _pending = 0;
         _fadein = 0;
         _inmark = -1;
         _fadeout = 0;
         _outmark = -1;
         _outkeep = false;
+        _outdone = false;
         _fadedip = 0;
         _dipmark = -1;
         _dipstop = 0;
@@ -222,14 +245,9 @@ std::shared_ptr<AudioNode> AudioFader::detach() {
  * @param duration  The fade-in time in seconds
  */
 void AudioFader::fadeIn(double duration) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (duration <= 0) {
-        _inmark = -1;
-        _fadein = 0;
-    } else {
-        _inmark = (Sint64)(duration*getRate());
-        _fadein = 0;
-    }
+    Sint64 frames = duration <= 0 ? -1 : (Sint64)(duration*getRate());
+    _reqin.store(frames,std::memory_order_relaxed);
+    request(REQUEST_IN,REQUEST_IN);
 }
 
 /**
@@ -238,8 +256,13 @@ void AudioFader::fadeIn(double duration) {
  * @return true if this node is in an active fade-in.
  */
 bool AudioFader::isFadeIn() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _inmark >= 0;
+    Uint32 pending = _pending.load(std::memory_order_acquire);
+    if (pending & REQUEST_IN) {
+        return _reqin.load(std::memory_order_relaxed) >= 0;
+    } else if (pending & (REQUEST_RESET | REQUEST_CLEAR)) {
+        return false;
+    }
+    return _inmark.load(std::memory_order_relaxed) >= 0;
 }
 
 /**
@@ -262,17 +285,9 @@ bool AudioFader::isFadeIn() {
  * @param wrap      Whether to support a fade-out after reset
  */
 void AudioFader::fadeOut(double duration, bool wrap) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (duration <= 0) {
-        _outmark = -1;
-        _fadeout = 0;
-        _outdone = true;
-    } else {
-        _outmark = (Sint64)(duration*getRate());
-        _fadeout = 0;
-        _outdone = false;
-    }
-    _outkeep = wrap;
+    Sint64 frames = duration <= 0 ? -1 : (Sint64)(duration*getRate());
+    _reqout.store(frames,std::memory_order_relaxed);
+    request(REQUEST_OUT | REQUEST_KEEP, wrap ? REQUEST_OUT | REQUEST_KEEP : REQUEST_OUT);
 }
 
 /**
@@ -281,8 +296,15 @@ void AudioFader::fadeOut(double duration, bool wrap) {
  * @return true if this node is in an active fade-out.
  */
 bool AudioFader::isFadeOut() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _outmark >= 0;
+    Uint32 pending = _pending.load(std::memory_order_acquire);
+    if (pending & REQUEST_OUT) {
+        return _reqout.load(std::memory_order_relaxed) >= 0;
+    } else if (pending & REQUEST_CLEAR) {
+        return false;
+    } else if ((pending & REQUEST_RESET) && !_outkeep.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    return _outmark.load(std::memory_order_relaxed) >= 0;
 }
 
 /**
@@ -327,24 +349,16 @@ void AudioFader::fadePause(double duration) {
  * @param fadein   The fade-in time in seconds
  */
 void AudioFader::fadePause(double fadeout, double fadein) {
-    std::lock_guard<std::mutex> lock(_mutex);
-
     // Do not pause twice
-    if (_dipmark >= 0) {
+    if (isFadePause() || fadein < 0 || fadeout < 0) {
         return;
     }
     
     // Now pause
-    if (fadein < 0 || fadeout < 0) {
-        _dipmark = -1;
-        _fadedip = 0;
-        _dipstop = 0;
-    } else {
-        _dipmark = (Sint64)(fadeout*getRate());
-        _dipstop = (Uint64)(fadein*getRate());
-        _fadedip = 0;
-    }
-    _diphalf = false;
+    Uint64 dipmark = (Uint32)(fadeout*getRate());
+    Uint64 dipstop = (Uint32)(fadein*getRate());
+    _reqdip.store((dipmark << 32) | dipstop,std::memory_order_relaxed);
+    request(REQUEST_DIP | REQUEST_UNDIP,REQUEST_DIP);
 }
 
 /**
@@ -356,8 +370,101 @@ void AudioFader::fadePause(double fadeout, double fadein) {
  * @return true if this node is in an active fade-pause.
  */
 bool AudioFader::isFadePause() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _dipmark >= 0;
+    Uint32 pending = _pending.load(std::memory_order_acquire);
+    if (pending & REQUEST_DIP) {
+        return true;
+    } else if (pending & (REQUEST_UNDIP | REQUEST_RESET | REQUEST_CLEAR)) {
+        return false;
+    }
+    return _dipmark.load(std::memory_order_relaxed) >= 0;
+}
+
+/**
+ * Posts a fade request for the audio thread.
+ *
+ * The requests in drop are withdrawn before the requests in add are
+ * posted. This is how a later request (such as a change of position)
+ * cancels an earlier one that the audio thread has not yet seen. The
+ * parameters of a request must be stored before it is posted.
+ *
+ * @param drop  The pending requests to withdraw
+ * @param add   The requests to post
+ */
+void AudioFader::request(Uint32 drop, Uint32 add) {
+    _pending.fetch_and(~drop,std::memory_order_relaxed);
+    _pending.fetch_or(add,std::memory_order_release);
+}
+
+/**
+ * Applies the pending fade requests.
+ *
+ * This method is called by {@link read} before it processes any audio.
+ * Cancellations are applied before new fades, so a request posted after
+ * a cancellation survives it.
+ *
+ * AUDIO THREAD ONLY: Users should never access this method directly.
+ * The only exception is when the user needs to create a custom subclass
+ * of this AudioNode.
+ */
+void AudioFader::applyRequests() {
+    Uint32 pending = _pending.exchange(0,std::memory_order_acquire);
+    if (pending == 0) {
+        return;
+    }
+    
+    if (pending & (REQUEST_RESET | REQUEST_CLEAR)) {
+        _inmark.store(-1,std::memory_order_relaxed);
+        _fadein = 0;
+        if ((pending & REQUEST_CLEAR) || !_outkeep.load(std::memory_order_relaxed)) {
+            _outmark.store(-1,std::memory_order_relaxed);
+            _fadeout.store(0,std::memory_order_relaxed);
+            _outkeep.store(false,std::memory_order_relaxed);
+        }
+        _outdone.store(false,std::memory_order_relaxed);
+    }
+    if (pending & (REQUEST_UNDIP | REQUEST_RESET | REQUEST_CLEAR)) {
+        _dipmark.store(-1,std::memory_order_relaxed);
+        _fadedip = 0;
+        _dipstop = 0;
+        _diphalf.store(false,std::memory_order_relaxed);
+    }
+    if (pending & REQUEST_IN) {
+        _inmark.store(_reqin.load(std::memory_order_relaxed),std::memory_order_relaxed);
+        _fadein = 0;
+    }
+    if (pending & REQUEST_OUT) {
+        Sint64 frames = _reqout.load(std::memory_order_relaxed);
+        _outmark.store(frames,std::memory_order_relaxed);
+        _fadeout.store(0,std::memory_order_relaxed);
+        _outdone.store(frames < 0,std::memory_order_relaxed);
+        _outkeep.store((pending & REQUEST_KEEP) != 0,std::memory_order_relaxed);
+    }
+    if (pending & REQUEST_DIP) {
+        Uint64 dip = _reqdip.load(std::memory_order_relaxed);
+        _dipmark.store((Sint64)(dip >> 32),std::memory_order_relaxed);
+        _dipstop = dip & 0xffffffff;
+        _fadedip = 0;
+        _diphalf.store(false,std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Returns true if this node is in the first half of a fade-pause.
+ *
+ * This includes a fade-pause that has been requested but that the audio
+ * thread has not yet started.
+ *
+ * @return true if this node is in the first half of a fade-pause.
+ */
+bool AudioFader::isDipping() const {
+    Uint32 pending = _pending.load(std::memory_order_acquire);
+    if (pending & REQUEST_DIP) {
+        return true;
+    } else if (pending & (REQUEST_UNDIP | REQUEST_RESET | REQUEST_CLEAR)) {
+        return false;
+    }
+    return (_dipmark.load(std::memory_order_relaxed) >= 0 &&
+            !_diphalf.load(std::memory_order_relaxed));
 }
 
 /**
@@ -380,14 +487,15 @@ bool AudioFader::isFadePause() {
  * @return the actual number of frames processed
  */
 Uint32 AudioFader::doFadeIn(float* buffer, Uint32 frames) {
-    if (_inmark >= 0) {
-        Uint32 left = std::min(frames,(Uint32)(_inmark-_fadein));
-        float start = (float)_fadein/(float)_inmark;
-        float ends  = (float)(left+_fadein)/(float)_inmark;
+    Sint64 inmark = _inmark.load(std::memory_order_relaxed);
+    if (inmark >= 0) {
+        Uint32 left = std::min(frames,(Uint32)(inmark-_fadein));
+        float start = (float)_fadein/(float)inmark;
+        float ends  = (float)(left+_fadein)/(float)inmark;
         ATK_VecSlide(buffer,start,ends,buffer,left*_channels);
         _fadein += left;
-        if (_fadein >= _inmark) {
-            _inmark = -1;
+        if (_fadein >= inmark) {
+            _inmark.store(-1,std::memory_order_relaxed);
             _fadein = 0;
             if (_calling.load(std::memory_order_relaxed)) {
                 notify(shared_from_this(),Action::FADE_IN);
@@ -418,17 +526,20 @@ Uint32 AudioFader::doFadeIn(float* buffer, Uint32 frames) {
  */
 Uint32 AudioFader::doFadeOut(float* buffer, Uint32 frames) {
     Sint32 amt = frames;
-    if (_outmark >= 0) {
-        Sint32 left = std::max(std::min(amt,(Sint32)(_outmark-_fadeout)),0);
-        float start = (float)(_outmark-_fadeout)/(float)_outmark;
-        float ends  = (float)(_outmark-left-_fadeout)/(float)_outmark;
+    Sint64 outmark = _outmark.load(std::memory_order_relaxed);
+    if (outmark >= 0) {
+        Uint64 fadeout = _fadeout.load(std::memory_order_relaxed);
+        Sint32 left = std::max(std::min(amt,(Sint32)(outmark-fadeout)),0);
+        float start = (float)(outmark-fadeout)/(float)outmark;
+        float ends  = (float)(outmark-left-fadeout)/(float)outmark;
         ATK_VecSlide(buffer,start,ends,buffer,left*_channels);
-        _fadeout += left;
-        if (_fadeout >= _outmark) {
-            _outmark = -1;
-            _fadeout = 0;
-            _outkeep = false;
-            _outdone = true;
+        fadeout += left;
+        _fadeout.store(fadeout,std::memory_order_relaxed);
+        if (fadeout >= outmark) {
+            _outmark.store(-1,std::memory_order_relaxed);
+            _fadeout.store(0,std::memory_order_relaxed);
+            _outkeep.store(false,std::memory_order_relaxed);
+            _outdone.store(true,std::memory_order_relaxed);
             if (_calling.load(std::memory_order_relaxed)) {
                 notify(shared_from_this(),Action::FADE_OUT);
             }
@@ -462,29 +573,30 @@ Uint32 AudioFader::doFadeOut(float* buffer, Uint32 frames) {
  */
 Uint32 AudioFader::doFadePause(float* buffer, Uint32 frames) {
     Uint32 amt = frames;
-    if (_dipmark >= 0) {
-        if (_diphalf) {
-            Uint32 left = std::min(amt,(Uint32)std::max((Sint32)(_dipmark+_dipstop-_fadedip),(Sint32)0));
-            float start = (float)(_fadedip-_dipmark)/(float)_dipstop;
-            float ends  = (float)(left+_fadedip-_dipmark)/(float)_dipstop;
+    Sint64 dipmark = _dipmark.load(std::memory_order_relaxed);
+    if (dipmark >= 0) {
+        if (_diphalf.load(std::memory_order_relaxed)) {
+            Uint32 left = std::min(amt,(Uint32)std::max((Sint32)(dipmark+_dipstop-_fadedip),(Sint32)0));
+            float start = (float)(_fadedip-dipmark)/(float)_dipstop;
+            float ends  = (float)(left+_fadedip-dipmark)/(float)_dipstop;
             ATK_VecSlide(buffer,start,ends,buffer,left*_channels);
             _fadedip += left;
-            if (_fadedip >= _dipmark+_dipstop) {
-                _dipmark = -1;
+            if (_fadedip >= dipmark+_dipstop) {
+                _dipmark.store(-1,std::memory_order_relaxed);
                 _dipstop = 0;
                 _fadedip = 0;
-                _diphalf = false;
+                _diphalf.store(false,std::memory_order_relaxed);
             }
         } else {
-            Uint32 left = std::min(amt,(Uint32)std::max((Sint32)(_dipmark-_fadedip),(Sint32)0));
-            float start = (float)(_dipmark-_fadedip)/(float)_dipmark;
-            float ends  = (float)(_dipmark-left-_fadedip)/(float)_dipmark;
+            Uint32 left = std::min(amt,(Uint32)std::max((Sint32)(dipmark-_fadedip),(Sint32)0));
+            float start = (float)(dipmark-_fadedip)/(float)dipmark;
+            float ends  = (float)(dipmark-left-_fadedip)/(float)dipmark;
             ATK_VecSlide(buffer,start,ends,buffer,left*_channels);
             _fadedip += left;
-            if (_fadedip >= _dipmark) {
+            if (_fadedip >= dipmark) {
                 _paused.store(true,std::memory_order_relaxed);
                 std::memset(buffer+left*_channels,0,(amt-left)*_channels*sizeof(float));
-                _diphalf = true;
+                _diphalf.store(true,std::memory_order_relaxed);
                 if (_calling.load(std::memory_order_relaxed)) {
                     notify(shared_from_this(),Action::FADE_DIP);
                 }
@@ -529,8 +641,7 @@ void AudioFader::setReadSize(Uint32 size) {
  * @return true if this node is currently paused
  */
 bool AudioFader::isPaused() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _paused.load(std::memory_order_relaxed) || (_dipmark >= 0 && !_diphalf);
+    return _paused.load(std::memory_order_relaxed) || isDipping();
 }
 
 /**
@@ -542,8 +653,7 @@ bool AudioFader::isPaused() {
  * @return true if the node was successfully paused
  */
 bool AudioFader::pause() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (_dipmark < 0 || _diphalf) {
+    if (!isDipping()) {
         return !_paused.exchange(true);
     }
     return false;
@@ -557,11 +667,8 @@ bool AudioFader::pause() {
  * @return true if the node was successfully resumed
  */
 bool AudioFader::resume() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (_dipmark >= 0 && !_diphalf) {
-        _dipmark = -1;
-        _fadedip = 0;
-        _dipstart = 0;
+    if (isDipping()) {
+        request(REQUEST_DIP,REQUEST_UNDIP);
         _paused.store(false,std::memory_order_relaxed);
         return true;
     }
@@ -592,8 +699,8 @@ Uint32 AudioFader::read(float* buffer, Uint32 frames) {
         std::memset(buffer,0,frames*_channels*sizeof(float));
         return frames;
     } else {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (!_outdone) {
+        applyRequests();
+        if (!_outdone.load(std::memory_order_relaxed)) {
             Uint32 amt = input->read(buffer, frames);
             float gain = _ndgain.load(std::memory_order_relaxed);
             if (gain != 1) {
@@ -617,10 +724,12 @@ Uint32 AudioFader::read(float* buffer, Uint32 frames) {
  * @return true if this audio node has no more data.
  */
 bool AudioFader::completed() {
-    bool outdone = false;
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        outdone = _outdone;
+    Uint32 pending = _pending.load(std::memory_order_acquire);
+    bool outdone = _outdone.load(std::memory_order_relaxed);
+    if (pending & REQUEST_OUT) {
+        outdone = _reqout.load(std::memory_order_relaxed) < 0;
+    } else if (pending & (REQUEST_RESET | REQUEST_CLEAR)) {
+        outdone = false;
     }
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     return (input == nullptr || input->completed() || outdone);
@@ -669,25 +778,12 @@ bool AudioFader::unmark() {
  * @return true if the read position was moved.
  */
 bool AudioFader::reset() {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (_inmark >= 0) {
-            _inmark = -1;
-            _fadein = 0;
-        }
-        if (_outmark >= 0) {
-            if (!_outkeep) {
-                _outmark = -1;
-                _fadeout = 0;
-            }
-        }
-        _outdone = false;
-        if (_dipmark >= 0) {
-            _dipmark = -1;
-            _fadedip = 0;
-            _dipstop = 0;
-        }
-        _diphalf = false;
+    // A pending fade-out survives the reset only if it persists
+    Uint32 pending = _pending.load(std::memory_order_relaxed);
+    if ((pending & REQUEST_OUT) && !(pending & REQUEST_KEEP)) {
+        request(REQUEST_ALL,REQUEST_CLEAR);
+    } else {
+        request(REQUEST_IN | REQUEST_DIP | REQUEST_UNDIP,REQUEST_RESET);
     }
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     if (input) {
@@ -709,25 +805,7 @@ bool AudioFader::reset() {
  * @return the actual number of frames advanced; -1 if not supported
  */
 Sint64 AudioFader::advance(Uint32 frames) {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (_inmark >= 0) {
-            _inmark = -1;
-            _fadein = 0;
-        }
-        if (_outmark >= 0) {
-            _outmark = -1;
-            _fadeout = 0;
-        }
-        _outdone = false;
-        _outkeep = false;
-        if (_dipmark >= 0) {
-            _dipmark = -1;
-            _fadedip = 0;
-            _dipstop = 0;
-        }
-        _diphalf = false;
-    }
+    request(REQUEST_ALL,REQUEST_CLEAR);
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     if (input) {
         return input->advance(frames);
@@ -764,25 +842,7 @@ Sint64 AudioFader::getPosition() const {
  * @return the new frame position of this audio node.
  */
 Sint64 AudioFader::setPosition(Uint32 position)  {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (_inmark >= 0) {
-            _inmark = -1;
-            _fadein = 0;
-        }
-        if (_outmark >= 0) {
-            _outmark = -1;
-            _fadeout = 0;
-        }
-        _outdone = false;
-        _outkeep = false;
-        if (_dipmark >= 0) {
-            _dipmark = -1;
-            _fadedip = 0;
-            _dipstop = 0;
-        }
-        _diphalf = false;
-    }
+    request(REQUEST_ALL,REQUEST_CLEAR);
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     if (input) {
         return input->setPosition(position);
@@ -819,25 +879,7 @@ double AudioFader::getElapsed() const {
  * @return the new elapsed time in seconds.
  */
 double AudioFader::setElapsed(double time) {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (_inmark >= 0) {
-            _inmark = -1;
-            _fadein = 0;
-        }
-        if (_outmark >= 0) {
-            _outmark = -1;
-            _fadeout = 0;
-        }
-        _outdone = false;
-        _outkeep = false;
-        if (_dipmark >= 0) {
-            _dipmark = -1;
-            _fadedip = 0;
-            _dipstop = 0;
-        }
-        _diphalf = false;
-    }
+    request(REQUEST_ALL,REQUEST_CLEAR);
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     if (input) {
         return input->setElapsed(time);
@@ -855,8 +897,9 @@ double AudioFader::setElapsed(double time) {
  */
 double AudioFader::getRemaining() const  {
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
-    if (_outmark >= 0) {
-        Sint64 temp =  std::max((Sint64)0,_outmark-(Sint64)_fadeout);
+    Sint64 outmark = _outmark.load(std::memory_order_relaxed);
+    if (outmark >= 0) {
+        Sint64 temp =  std::max((Sint64)0,outmark-(Sint64)_fadeout.load(std::memory_order_relaxed));
         return ((double)temp)/_sampling;
     }
     if (input) {
@@ -878,25 +921,7 @@ double AudioFader::getRemaining() const  {
  * @return the new remaining time in seconds.
  */
 double AudioFader::setRemaining(double time) {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (_inmark >= 0) {
-            _inmark = -1;
-            _fadein = 0;
-        }
-        if (_outmark >= 0) {
-            _outmark = -1;
-            _fadeout = 0;
-        }
-        _outdone = false;
-        _outkeep = false;
-        if (_dipmark >= 0) {
-            _dipmark = -1;
-            _fadedip = 0;
-            _dipstop = 0;
-        }
-        _diphalf = false;
-    }
+    request(REQUEST_ALL,REQUEST_CLEAR);
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     if (input) {
         return input->setRemaining(time);
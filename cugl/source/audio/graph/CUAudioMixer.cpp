@@ -68,10 +68,12 @@ const float AudioMixer::DEFAULT_KNEE  = 0.9;
  * must be initialized to be used.
  */
 AudioMixer::AudioMixer() :
-_width(0),
-_knee(-1),
 _inputs(nullptr),
-_buffer(nullptr) {
+_width(0),
+_active(&_empty),
+_readers(0),
+_buffer(nullptr),
+_knee(-1) {
     _classname = "AudioScheduler";
 #if CU_PLATFORM == CU_PLATFORM_ANDROID
 	// Android handles clipping very badly.
@@ -89,6 +91,57 @@ void AudioMixer::allocateBuffer() {
     _buffer = (float*)malloc(_readsize*_channels*sizeof(float));
 }
 
+/**
+ * Publishes the current inputs as a new input list for the readers.
+ *
+ * The previous list is retired, and released once there are no readers.
+ * This method must be called while holding the mutex.
+ */
+void AudioMixer::publish() {
+    InputList* list = new InputList();
+    list->nodes.assign(_inputs,_inputs+_width);
+    InputList* prev = _active.exchange(list,std::memory_order_seq_cst);
+    if (prev != &_empty) {
+        _retired.push_back(prev);
+    }
+    reclaim();
+}
+
+/**
+ * Releases any retired input lists if there are no active readers.
+ *
+ * This method must be called while holding the mutex.
+ */
+void AudioMixer::reclaim() {
+    // A reader that registers after this check sees the newest list
+    if (!_retired.empty() && _readers.load(std::memory_order_seq_cst) == 0) {
+        for(auto it = _retired.begin(); it != _retired.end(); ++it) {
+            delete *it;
+        }
+        _retired.clear();
+    }
+}
+
+/**
+ * Returns the current input list, registering this caller as a reader.
+ *
+ * This method never blocks, and may be called from any thread. Every
+ * call must be balanced by a call to {@link #release}.
+ *
+ * @return the current input list
+ */
+AudioMixer::InputList* AudioMixer::acquire() const {
+    _readers.fetch_add(1,std::memory_order_seq_cst);
+    return _active.load(std::memory_order_seq_cst);
+}
+
+/**
+ * Unregisters a reader previously registered by {@link #acquire}.
+ */
+void AudioMixer::release() const {
+    _readers.fetch_sub(1,std::memory_order_release);
+}
+
 /**
  * Initializes the mixer with default stereo settings
  *
@@ -169,6 +222,8 @@ bool AudioMixer::init(Uint8 width, Uint8 channels, Uint32 rate) {
             _inputs[ii] = nullptr;
         }
         allocateBuffer();
+        std::lock_guard<std::mutex> lock(_mutex);
+        publish();
         return true;
     }
     return false;
@@ -183,6 +238,15 @@ bool AudioMixer::init(Uint8 width, Uint8 channels, Uint32 rate) {
 void AudioMixer::dispose() {
     if (_booted) {
         AudioNode::dispose();
+        std::lock_guard<std::mutex> lock(_mutex);
+        InputList* prev = _active.exchange(&_empty,std::memory_order_seq_cst);
+        if (prev != &_empty) {
+            delete prev;
+        }
+        for(auto it = _retired.begin(); it != _retired.end(); ++it) {
+            delete *it;
+        }
+        _retired.clear();
         if (_inputs != nullptr) {
             delete[] _inputs;
             _inputs = nullptr;
@@ -231,9 +295,13 @@ std::shared_ptr<AudioNode> AudioMixer::attach(Uint8 slot, const std::shared_ptr<
         input->setReadSize(_readsize);
     }
     
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::shared_ptr<AudioNode> result = _inputs[slot];
+    _inputs[slot] = input;
     _marked.store(0,std::memory_order_relaxed);
     _offset.store(0,std::memory_order_relaxed);
-    return std::atomic_exchange_explicit(_inputs+slot,input,std::memory_order_relaxed);
+    publish();
+    return result;
 }
 
 /**
@@ -247,7 +315,11 @@ std::shared_ptr<AudioNode> AudioMixer::attach(Uint8 slot, const std::shared_ptr<
  */
 std::shared_ptr<AudioNode> AudioMixer::detach(Uint8 slot) {
     CUAssertLog(slot < _width, "Slot %d is out of range",slot);
-    return std::atomic_exchange_explicit(_inputs+slot,{},std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::shared_ptr<AudioNode> result = _inputs[slot];
+    _inputs[slot] = nullptr;
+    publish();
+    return result;
 }
 
 /**
@@ -263,15 +335,15 @@ std::shared_ptr<AudioNode> AudioMixer::detach(Uint8 slot) {
  * @return true if this audio node has no more data.
  */
 bool AudioMixer::completed() {
-    std::lock_guard<std::mutex> lock(_mutex);
+    InputList* inputs = acquire();
     bool success = true;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+    for(auto it = inputs->nodes.begin(); it != inputs->nodes.end(); ++it) {
+        AudioNode* temp = it->get();
         if (temp) {
             success = success && temp->completed();
         }
     }
+    release();
     return success;
 }
 
@@ -297,15 +369,16 @@ Uint32 AudioMixer::read(float* buffer, Uint32 frames) {
     std::memset(buffer,0,frames*_channels*sizeof(float));
     Uint32 actual = 0;
     if (!_paused.load(std::memory_order_relaxed)) {
-        std::lock_guard<std::mutex> lock(_mutex);
-        std::shared_ptr<AudioNode> temp;
+        // Never lock or touch a reference count on the audio thread
+        InputList* inputs = acquire();
+        Uint32 width = (Uint32)inputs->nodes.size();
         Uint32 remain = frames;
         float* output = buffer;
         while (remain > 0) {
             Uint32 chunk = std::min(remain,_readsize);
             Uint32 taken = 0;
-            for(int ii = 0; ii < _width; ii++) {
-                temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+            for(Uint32 ii = 0; ii < width; ii++) {
+                AudioNode* temp = inputs->nodes[ii].get();
                 if (temp) {
                     Uint32 amt = temp->read(_buffer,chunk);
                     taken = std::max(amt,taken);
@@ -323,6 +396,7 @@ Uint32 AudioMixer::read(float* buffer, Uint32 frames) {
                 remain -= taken;
             }
         }
+        release();
         ATK_VecScale(buffer,_ndgain.load(std::memory_order_relaxed),buffer,actual*_channels);
         float knee = _knee.load(std::memory_order_relaxed);
         if (knee == 1) {
@@ -343,28 +417,30 @@ Uint32 AudioMixer::read(float* buffer, Uint32 frames) {
 /**
  * Sets the width of this mixer.
  *
- * The width is the number of supported input slots. This method will only
- * succeed if the mixer is paused.  Otherwise, it will fail.
+ * The width is the number of supported input slots. This method is safe
+ * to call while the mixer is playing, as the audio thread picks up the
+ * new width at the start of its next read.
  *
  * Once the width is adjusted, the children will be reassigned in order.
  * If the new width is less than the old width, children at the end of
  * the mixer will be dropped.
  *
+ * @param width The number of input slots
+ *
  * @return true if the mixer width was reset
  */
 bool AudioMixer::setWidth(Uint8 width) {
-    if (_paused.load(std::memory_order_relaxed)) {
-        std::shared_ptr<AudioNode>* replace = new std::shared_ptr<AudioNode>[width];
-        Uint32 min = width < _width ? width : _width;
-        for(int ii = 0; ii < width; ii++) {
-            replace[ii] = ii < min ? _inputs[ii] : nullptr;
-        }
-        delete[] _inputs;
-        _inputs = replace;
-        _width = width;
-        return true;
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::shared_ptr<AudioNode>* replace = new std::shared_ptr<AudioNode>[width];
+    Uint32 min = width < _width ? width : _width;
+    for(Uint32 ii = 0; ii < width; ii++) {
+        replace[ii] = ii < min ? _inputs[ii] : nullptr;
     }
-    return false;
+    delete[] _inputs;
+    _inputs = replace;
+    _width = width;
+    publish();
+    return true;
 }
 
 /**
@@ -389,8 +465,9 @@ void AudioMixer::setReadSize(Uint32 size) {
     if (_readsize != size) {
         _readsize = size;
         allocateBuffer();
+        std::lock_guard<std::mutex> lock(_mutex);
         for(int ii = 0; ii < _width; ii++) {
-            std::shared_ptr<AudioNode> temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+            std::shared_ptr<AudioNode> temp = _inputs[ii];
             if (temp != nullptr) {
                 temp->setReadSize(_readsize);
             }
@@ -455,16 +532,16 @@ void AudioMixer::setKnee(float knee) {
  * @return true if the read position was marked across all inputs.
  */
 bool AudioMixer::mark() {
-    std::lock_guard<std::mutex> lock(_mutex);
+    InputList* inputs = acquire();
     bool success = true;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+    for(auto it = inputs->nodes.begin(); it != inputs->nodes.end(); ++it) {
+        AudioNode* temp = it->get();
         if (temp) {
             success = temp->mark() && success;
         }
     }
     _marked.store(_offset.load(std::memory_order_relaxed),std::memory_order_relaxed);
+    release();
     return success;
 }
 
@@ -488,16 +565,16 @@ bool AudioMixer::mark() {
  * @return true if the read position was marked.
  */
 bool AudioMixer::unmark() {
-    std::lock_guard<std::mutex> lock(_mutex);
+    InputList* inputs = acquire();
     bool success = true;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+    for(auto it = inputs->nodes.begin(); it != inputs->nodes.end(); ++it) {
+        AudioNode* temp = it->get();
         if (temp) {
             success = temp->unmark() && success;
         }
     }
     _marked.store(0,std::memory_order_relaxed);
+    release();
     return success;
 }
 
@@ -516,16 +593,16 @@ bool AudioMixer::unmark() {
  * @return true if the read position was moved.
  */
 bool AudioMixer::reset() {
-    std::lock_guard<std::mutex> lock(_mutex);
+    InputList* inputs = acquire();
     bool success = true;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+    for(auto it = inputs->nodes.begin(); it != inputs->nodes.end(); ++it) {
+        AudioNode* temp = it->get();
         if (temp) {
             success = temp->reset() && success;
         }
     }
     _offset.store(_marked.load(std::memory_order_relaxed),std::memory_order_relaxed);
+    release();
     return success;
 }
 
@@ -546,12 +623,11 @@ bool AudioMixer::reset() {
  * @return the actual number of frames advanced; -1 if not supported
  */
 Sint64 AudioMixer::advance(Uint32 frames) {
-    std::lock_guard<std::mutex> lock(_mutex);
+    InputList* inputs = acquire();
     Sint64 actual = 0;
     bool fail = false;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+    for(auto it = inputs->nodes.begin(); it != inputs->nodes.end(); ++it) {
+        AudioNode* temp = it->get();
         if (temp) {
             Sint64 amt = temp->advance(frames);
             actual = std::max(actual,amt);
@@ -561,6 +637,7 @@ Sint64 AudioMixer::advance(Uint32 frames) {
     
     Uint64 pos = _offset.load(std::memory_order_relaxed);
     _offset.store(pos+actual,std::memory_order_relaxed);
+    release();
     return fail ? -1 : actual;
 }
 
@@ -600,12 +677,11 @@ Sint64 AudioMixer::getPosition() const {
  * @return the new frame position of this audio node.
  */
 Sint64 AudioMixer::setPosition(Uint32 position) {
-    std::lock_guard<std::mutex> lock(_mutex);
+    InputList* inputs = acquire();
     Sint64 actual = 0;
     bool fail = false;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+    for(auto it = inputs->nodes.begin(); it != inputs->nodes.end(); ++it) {
+        AudioNode* temp = it->get();
         if (temp) {
             Sint64 amt = temp->setPosition(position);
             actual = std::max(actual,amt);
@@ -614,6 +690,7 @@ Sint64 AudioMixer::setPosition(Uint32 position) {
     }
     
     _offset.store(actual,std::memory_order_relaxed);
+    release();
     return fail ? -1 : actual;
 }
 
@@ -675,11 +752,11 @@ double AudioMixer::setElapsed(double time) {
  */
 double AudioMixer::getRemaining() const {
     // An unavoidable race condition has minor effects on accuracy
+    InputList* inputs = acquire();
     double actual = 0;
     bool fail = false;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+    for(auto it = inputs->nodes.begin(); it != inputs->nodes.end(); ++it) {
+        AudioNode* temp = it->get();
         if (temp) {
             double amt = temp->getRemaining();
             actual = std::max(actual,amt);
@@ -687,6 +764,7 @@ double AudioMixer::getRemaining() const {
         }
     }
     
+    release();
     return fail ? -1 : actual;
 }
 
@@ -712,14 +790,13 @@ double AudioMixer::getRemaining() const {
  * @return the new remaining time in seconds.
  */
 double AudioMixer::setRemaining(double time) {
-    std::lock_guard<std::mutex> lock(_mutex);
+    InputList* inputs = acquire();
     
     // Get longest time remaining
     double actual = 0;
     bool fail = false;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+    for(auto it = inputs->nodes.begin(); it != inputs->nodes.end(); ++it) {
+        AudioNode* temp = it->get();
         if (temp) {
             double amt = temp->getRemaining();
             actual = std::max(actual,amt);
@@ -730,8 +807,8 @@ double AudioMixer::setRemaining(double time) {
     Uint64 pos = _offset.load(std::memory_order_relaxed)+actual*getRate();
     
     // Now push forward
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+    for(auto it = inputs->nodes.begin(); it != inputs->nodes.end(); ++it) {
+        AudioNode* temp = it->get();
         if (temp) {
             Uint64 off = temp->setPosition((Uint32)pos);
             if (off < 0) {
@@ -744,5 +821,6 @@ double AudioMixer::setRemaining(double time) {
     }
     
     _offset.store(pos,std::memory_order_relaxed);
+    release();
     return fail ? -1 : actual;
 }
@@ -682,10 +682,15 @@ static std::function<void(const float*, float*, size_t)> select_algorithm(Uint8
  * be initialized to be used.
  */
 AudioRedistributor::AudioRedistributor() :
+_conduits(0),
+_request(nullptr),
+_resize(false),
+_posted(nullptr),
+_columns(0),
 _matrix(nullptr),
+_matsize(0),
 _buffer(nullptr),
-_conduits(0),
-_matsize(0) {
+_pagesize(0) {
     _input = nullptr;
     _director = nullptr;
     _classname = "AudioRedistributor";
@@ -782,6 +787,11 @@ void AudioRedistributor::dispose() {
         AudioNode::dispose();
         _input = nullptr;
         _director = nullptr;
+        Request* request = _request.exchange(nullptr);
+        if (request != nullptr) {
+            free(request->matrix);
+            delete request;
+        }
         if (_matrix != nullptr) {
             free(_matrix);
             _matrix = nullptr;
@@ -790,6 +800,12 @@ void AudioRedistributor::dispose() {
             free(_buffer);
             _buffer = nullptr;
         }
+        _resize   = false;
+        _posted   = nullptr;
+        _conduits = 0;
+        _columns  = 0;
+        _matsize  = 0;
+        _pagesize = 0;
     }
 }
 
@@ -896,16 +912,7 @@ std::shared_ptr<AudioNode> AudioRedistributor::detach() {
 void AudioRedistributor::setConduits(Uint8 number) {
     Uint8 original = _conduits.load(std::memory_order_acquire);
     if (original != number) {
-        std::unique_lock<std::mutex> lk(_buffmtex);
-        _matsize  = 0;
-        _pagesize = 0;
-        if (_matrix != nullptr) {
-            free(_matrix);
-            _matrix = nullptr;
-        }
-        
-        _director = select_algorithm(number, _channels);
-        _conduits = number;
+        post(number,nullptr);
     }
 }
 
@@ -936,30 +943,7 @@ void AudioRedistributor::setConduits(Uint8 number) {
 void AudioRedistributor::setConduits(Uint8 number, const float* matrix) {
     Uint8 original = _conduits.load(std::memory_order_acquire);
     if (original != number) {
-        std::unique_lock<std::mutex> lk(_buffmtex);
-        _conduits = number;
-        _matsize  = 0;
-        _pagesize = 0;
-        if (_matrix != nullptr) {
-            free(_matrix);
-            _matrix = nullptr;
-        }
-        allocateBuffer();
-        
-        Uint32 size = (number+1)*_channels;
-        _matrix = (float*)malloc(size*sizeof(float));
-        std::memcpy(_matrix,matrix,size*sizeof(float));
-
-        if (number > _channels) {
-            _director = [this](const float* input, float* output, size_t size) {
-                            scaleDown(input,output,size);
-                        };
-        } else {
-            _director = [this](const float* input, float* output, size_t size) {
-                            scaleUp(input,output,size);
-                        };
-        }
-        _matsize = size;
+        post(number,matrix);
     }
 }
 
@@ -976,8 +960,7 @@ void AudioRedistributor::setConduits(Uint8 number, const float* matrix) {
 const float* const AudioRedistributor::getMatrix() {
     Uint32 size = _matsize.load(std::memory_order_acquire);
     if (size > 0) {
-        std::unique_lock<std::mutex> lk(_buffmtex);
-        return _matrix;
+        return _posted;
     }
     return nullptr;
 }
@@ -995,18 +978,7 @@ const float* const AudioRedistributor::getMatrix() {
  * @param matrix    The redistribution matrix
  */
 void AudioRedistributor::setMatrix(const float* matrix) {
-    std::unique_lock<std::mutex> lk(_buffmtex);
-    Uint32 size = _conduits;
-    size = (size+1)*_channels;
-    _matsize = 0;
-    if (_matrix != nullptr) {
-        free(_matrix);
-        _matrix = nullptr;
-    }
-    _matrix = (float*)malloc(size*sizeof(float));
-    std::memcpy(_matrix,matrix,size*sizeof(float));
-    _director = nullptr;
-    _matsize = size;
+    post(_conduits.load(std::memory_order_acquire),matrix);
 }
 
 /**
@@ -1030,7 +1002,7 @@ void AudioRedistributor::setMatrix(const float* matrix) {
 void AudioRedistributor::setReadSize(Uint32 size) {
     if (_readsize != size) {
         _readsize = size;
-        allocateBuffer();
+        _resize.store(true,std::memory_order_release);
     }
 }
 
@@ -1046,6 +1018,9 @@ void AudioRedistributor::setReadSize(Uint32 size) {
  * The buffer should have enough room to store frames * channels elements.
  * The channels are interleaved into the output buffer.
  *
+ * This method never waits on the main thread. Changes to the input
+ * channels or the matrix are applied at the start of the next call.
+ *
  * This method will always forward the read position after reading. Reading
  * again may return different data.
  *
@@ -1061,9 +1036,9 @@ Uint32 AudioRedistributor::read(float* buffer, Uint32 frames) {
         std::memset(buffer,0,frames*_channels*sizeof(float));
         take = frames;
     } else {
-        std::unique_lock<std::mutex> lk(_buffmtex);
+        applyRequests();
         // Prevent a subtle race
-        if (_conduits != input->getChannels() || _director == nullptr) {
+        if (_columns != input->getChannels() || _director == nullptr) {
             std::memset(buffer,0,frames*_channels*sizeof(float));
             take = frames;
         } else {
@@ -1071,7 +1046,8 @@ Uint32 AudioRedistributor::read(float* buffer, Uint32 frames) {
             while (take < frames && !abort) {
                 Uint32 amt = frames;
                 if (_buffer != nullptr) {
-                    amt = _pagesize < frames-take ? _pagesize : frames-take;
+                    Uint32 page = _pagesize/_columns;
+                    amt = page < frames-take ? page : frames-take;
                     amt = input->read(_buffer,amt);
                     _director(_buffer,_buffer,amt);
                     std::memcpy(buffer+take*_channels, _buffer, amt*_channels*sizeof(float));
@@ -1325,7 +1301,7 @@ double AudioRedistributor::setRemaining(double time) {
  */
 void AudioRedistributor::scaleUp(const float* input, float* output, size_t size) {
     Uint32 rows = _channels;
-    Uint32 cols = _conduits;
+    Uint32 cols = _columns;
     Uint32 work = rows*cols;
     
     const float* src = input + size*cols;
@@ -1366,7 +1342,7 @@ void AudioRedistributor::scaleUp(const float* input, float* output, size_t size)
  */
 void AudioRedistributor::scaleDown(const float* input, float* output, size_t size) {
     Uint32 rows = _channels;
-    Uint32 cols = _conduits;
+    Uint32 cols = _columns;
     Uint32 work = rows*cols;
     
     const float* src = input;
@@ -1388,13 +1364,83 @@ void AudioRedistributor::scaleDown(const float* input, float* output, size_t siz
  * Allocates the intermediate buffer for downscaling
  */
 void AudioRedistributor::allocateBuffer() {
-    Uint8 number = _conduits.load(std::memory_order_acquire);
+    Uint8 number = _columns;
     if (_buffer != nullptr) {
         free(_buffer);
         _buffer = nullptr;
     }
+    _pagesize = 0;
     if (number > _channels) {
         _pagesize = _readsize*number+number;
         _buffer = (float*)malloc(_pagesize*sizeof(float));
     }
 }
+
+/**
+ * Posts a change of input channels for the audio thread.
+ *
+ * If matrix is nullptr, the redistributor will use the default algorithm
+ * for the given number of channels. Otherwise, the matrix is copied. Any
+ * earlier request that the audio thread has not yet applied is discarded.
+ *
+ * @param number    The number of input channels
+ * @param matrix    The redistribution matrix (or nullptr)
+ */
+void AudioRedistributor::post(Uint8 number, const float* matrix) {
+    Uint32 size = matrix ? (number+1)*_channels : 0;
+    float* copy = nullptr;
+    if (matrix != nullptr) {
+        copy = (float*)malloc(size*sizeof(float));
+        std::memcpy(copy,matrix,size*sizeof(float));
+    }
+    Request* request = new Request;
+    request->conduits = number;
+    request->matrix = copy;
+    
+    // The request belongs to the audio thread once it is posted
+    Request* previous = _request.exchange(request,std::memory_order_acq_rel);
+    if (previous != nullptr) {
+        // The audio thread never saw the previous request
+        free(previous->matrix);
+        delete previous;
+    }
+    _posted = copy;
+    _conduits = number;
+    _matsize  = size;
+}
+
+/**
+ * Applies the pending change of input channels.
+ *
+ * This method is called by {@link read} before it processes any audio.
+ *
+ * AUDIO THREAD ONLY: Users should never access this method directly.
+ */
+void AudioRedistributor::applyRequests() {
+    Request* request = _request.exchange(nullptr,std::memory_order_acq_rel);
+    bool resize = _resize.exchange(false,std::memory_order_acquire);
+    if (request != nullptr) {
+        if (_matrix != nullptr) {
+            free(_matrix);
+        }
+        _matrix  = request->matrix;
+        _columns = request->conduits;
+        delete request;
+        
+        if (_matrix == nullptr) {
+            _director = select_algorithm(_columns, _channels);
+        } else if (_columns > _channels) {
+            _director = [this](const float* input, float* output, size_t size) {
+                            scaleDown(input,output,size);
+                        };
+        } else {
+            _director = [this](const float* input, float* output, size_t size) {
+                            scaleUp(input,output,size);
+                        };
+        }
+        resize = true;
+    }
+    if (resize) {
+        allocateBuffer();
+    }
+}
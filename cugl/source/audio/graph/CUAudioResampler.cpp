@@ -107,6 +107,13 @@ static double bessel(double x, double err=1.0e-21) {
 /** The default stoppband attenuation */
 #define STOPBAND_ATTEN  80.0
 
+/** Request to rebuild the filter table (and the sampling buffer) */
+#define REQUEST_FILTER  0x01
+/** Request to rebuild the sampling buffer */
+#define REQUEST_BUFFER  0x02
+/** Request to discard the sampling buffer after the input has moved */
+#define REQUEST_FLUSH   0x04
+
 /**
  * Creates a degenerate audio resampler.
  *
@@ -117,21 +124,22 @@ static double bessel(double x, double err=1.0e-21) {
  * the heap, use the factory in {@link AudioManager}.
  */
 AudioResampler::AudioResampler() : AudioNode(),
+_pending(0),
 _inputrate(0),
 _stopband(STOPBAND_ATTEN),
 _zero_cross(ZERO_CROSSINGS),
 _precision(BITS_PER_SAMPLE),
 _per_crossing(0),
+_padding(0),
 _filter_size(0),
 _filter_table(nullptr),
 _filter_diffs(nullptr),
+_cvtbuffer(nullptr),
 _capacity(0),
 _cvtavail(0),
 _cvtoffset(0),
 _cvtoversc(0),
-_intime(0.0),
-_mktime(0.0),
-_cvtbuffer(nullptr) {
+_intime(0.0) {
     _input = nullptr;
     _classname = "AudioResampler";
 }
@@ -199,9 +207,9 @@ bool AudioResampler::init(const std::shared_ptr<AudioNode>& input, Uint32 rate)
  */
 void AudioResampler::dispose() {
     if (_booted) {
-        std::unique_lock<std::mutex> lk(_buffmtex);
         AudioNode::dispose();
         _input = nullptr;
+        _pending = 0;
         if (_filter_table  != nullptr) {
             free(_filter_table);
             _filter_table = nullptr;
@@ -223,9 +231,9 @@ void AudioResampler::dispose() {
         _zero_cross = ZERO_CROSSINGS;
         _precision  = BITS_PER_SAMPLE;
         _per_crossing  = 0;
+        _padding = 0;
         _filter_size   = 0;
         _intime = 0;
-        _mktime = 0;
     }
 }
 
@@ -270,11 +278,7 @@ bool AudioResampler::attach(const std::shared_ptr<AudioNode>& node) {
         node->setReadSize(_readsize);
     }
     
-    {
-        std::unique_lock<std::mutex> lk(_buffmtex);
-        _intime = 0;
-    }
-
+    request(REQUEST_FLUSH);
     std::atomic_store_explicit(&_input,node,std::memory_order_relaxed);
     return true;
 }
@@ -343,20 +347,8 @@ void AudioResampler::setReadSize(Uint32 size) {
  * @param value The input sample rate of this filter.
  */
 void AudioResampler::setInputRate(Uint32 value) {
-    std::unique_lock<std::mutex> lk(_buffmtex);
     _inputrate = value;
-
-    if (_cvtbuffer != nullptr) {
-        free(_cvtbuffer);
-        _cvtbuffer = nullptr;
-    }
-
-    _capacity  = std::max(_readsize,_pagesize);
-    _cvtbuffer = (float*)malloc(sizeof(float)*(_capacity+_zero_cross)*_channels);
-    memset(_cvtbuffer,0,sizeof(float)*(_capacity+_zero_cross)*_channels);
-    _cvtoffset = 0;
-    _cvtavail  = 0;
-    _cvtoversc = 0;
+    request(REQUEST_BUFFER);
 }
 
 /**
@@ -373,9 +365,8 @@ void AudioResampler::setInputRate(Uint32 value) {
 void AudioResampler::setStopband(float value) {
     float oldval = getStopband();
     if (value != oldval) {
-        std::unique_lock<std::mutex> lk(_buffmtex);
         _stopband = value;
-        setup();
+        request(REQUEST_FILTER);
     }
 }
 
@@ -398,9 +389,8 @@ void AudioResampler::setStopband(float value) {
 void AudioResampler::setBitPrecision(Uint32 value) {
     float oldval = getBitPrecision();
     if (value != oldval) {
-        std::unique_lock<std::mutex> lk(_buffmtex);
         _precision = value;
-        setup();
+        request(REQUEST_FILTER);
     }
 }
 
@@ -425,9 +415,8 @@ void AudioResampler::setBitPrecision(Uint32 value) {
 void AudioResampler::setZeroCrossings(Uint32 value) {
     float oldval = getZeroCrossings();
     if (value != oldval) {
-        std::unique_lock<std::mutex> lk(_buffmtex);
         _zero_cross = value;
-        setup();
+        request(REQUEST_FILTER);
     }
 }
 
@@ -459,6 +448,9 @@ bool AudioResampler::completed() {
  * The buffer should have enough room to store frames * channels elements.
  * The channels are interleaved into the output buffer.
  *
+ * This method never waits on the main thread. Changes to the filter or
+ * the read position are applied at the start of the next call.
+ *
  * This method will always forward the read position.
  *
  * @param buffer    The read buffer to store the results
@@ -468,6 +460,7 @@ bool AudioResampler::completed() {
  */
 Uint32 AudioResampler::read(float* buffer, Uint32 frames) {
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_seq_cst);
+    applyRequests();
     Uint32 cnvrate = _inputrate.load(std::memory_order_seq_cst);
     double inrate  = cnvrate;
     double outrate = getRate();
@@ -476,25 +469,22 @@ Uint32 AudioResampler::read(float* buffer, Uint32 frames) {
     if (input == nullptr || _paused.load(std::memory_order_relaxed)) {
         std::memset(buffer,0,frames*_channels*sizeof(float));
         take = frames;
-    } if (cnvrate == getRate()) {
+    } else if (cnvrate == getRate()) {
         take = input->read(buffer,frames);
+    } else if (cnvrate != input->getRate() || _cvtbuffer == nullptr) {
+        // Prevent a subtle race (the input is attached before its rate is applied)
+        std::memset(buffer,0,frames*_channels*sizeof(float));
+        take = frames;
     } else {
-        std::unique_lock<std::mutex> lk(_buffmtex);
-        // Prevent a subtle race
-        if (cnvrate != input->getRate()) {
-            std::memset(buffer,0,frames*_channels*sizeof(float));
-            take = frames;
-        } else {
-            bool abort = false;
-            while (take < frames && !abort) {
-                // FIll more stuff into the buffer
-                fillBuffer();
-                Uint32 amount = pageFilter(buffer+take*_channels,frames-take,
-                                           inrate,outrate);
-                take += amount;
-                if (amount == 0) {
-                    abort = true;
-                }
+        bool abort = false;
+        while (take < frames && !abort) {
+            // FIll more stuff into the buffer
+            fillBuffer();
+            Uint32 amount = pageFilter(buffer+take*_channels,frames-take,
+                                       inrate,outrate);
+            take += amount;
+            if (amount == 0) {
+                abort = true;
             }
         }
     }
@@ -524,12 +514,7 @@ Uint32 AudioResampler::read(float* buffer, Uint32 frames) {
 bool AudioResampler::mark() {
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     if (input) {
-        std::unique_lock<std::mutex> lk(_buffmtex);
-        bool result = input->mark();
-        if (result) {
-            _mktime = _intime;
-        }
-        return result;
+        return input->mark();
     }
     return false;
 }
@@ -550,12 +535,7 @@ bool AudioResampler::mark() {
 bool AudioResampler::unmark() {
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     if (input) {
-        std::unique_lock<std::mutex> lk(_buffmtex);
-        bool result = input->unmark();
-        if (result) {
-            _mktime = 0;
-        }
-        return result;
+        return input->unmark();
     }
     return false;
 }
@@ -577,10 +557,9 @@ bool AudioResampler::unmark() {
 bool AudioResampler::reset() {
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     if (input) {
-        std::unique_lock<std::mutex> lk(_buffmtex);
         bool result = input->reset();
         if (result) {
-            _intime = _mktime;
+            request(REQUEST_FLUSH);
         }
         return result;
     }
@@ -608,7 +587,7 @@ Sint64 AudioResampler::advance(Uint32 frames) {
         double outrate = getRate();
         Sint64 actual = input->advance(frames*inrate/outrate);
         Sint64 adjust = actual*outrate/inrate;
-        _intime += adjust*inrate/outrate;
+        request(REQUEST_FLUSH);
         return adjust;
     }
     return -1;
@@ -659,7 +638,7 @@ Sint64 AudioResampler::setPosition(Uint32 position) {
         double outrate = getRate();
         Sint64 actual = input->setPosition(position*inrate/outrate);
         Sint64 adjust = actual*outrate/inrate;
-        _intime = adjust*inrate/outrate;
+        request(REQUEST_FLUSH);
         return adjust;
     }
     return -1;
@@ -704,12 +683,8 @@ double AudioResampler::getElapsed() const {
 double AudioResampler::setElapsed(double time) {
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     if (input) {
-        std::unique_lock<std::mutex> lk(_buffmtex);
-        double inrate  = _inputrate;
-        double outrate = getRate();
         double actual = input->setElapsed(time);
-        Sint64 pos = input->getPosition();
-        _intime = pos*outrate/inrate;
+        request(REQUEST_FLUSH);
         return actual;
     }
     return -1;
@@ -759,17 +734,63 @@ double AudioResampler::getRemaining() const {
 double AudioResampler::setRemaining(double time) {
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     if (input) {
-        std::unique_lock<std::mutex> lk(_buffmtex);
-        double inrate  = _inputrate;
-        double outrate = getRate();
         double actual = input->setRemaining(time);
-        Sint64 pos = input->getPosition();
-        _intime = pos*outrate/inrate;
+        request(REQUEST_FLUSH);
         return actual;
     }
     return -1;
 }
 
+#pragma mark -
+#pragma mark Filter Requests
+/**
+ * Posts a request for the audio thread.
+ *
+ * The audio thread applies all pending requests at the start of its
+ * next {@link read}. The parameters of a request must be stored before
+ * it is posted.
+ *
+ * @param add   The requests to post
+ */
+void AudioResampler::request(Uint32 add) {
+    _pending.fetch_or(add,std::memory_order_release);
+}
+
+/**
+ * Applies the pending requests.
+ *
+ * This method is called by {@link read} before it processes any audio.
+ * A new filter or buffer discards any buffered input, as does a change
+ * of position in the input node.
+ *
+ * AUDIO THREAD ONLY: Users should never access this method directly.
+ */
+void AudioResampler::applyRequests() {
+    Uint32 pending = _pending.exchange(0,std::memory_order_acquire);
+    if (pending == 0) {
+        return;
+    }
+    
+    if (pending & REQUEST_FILTER) {
+        setup();
+    }
+    if (pending & (REQUEST_FILTER | REQUEST_BUFFER)) {
+        if (_cvtbuffer != nullptr) {
+            free(_cvtbuffer);
+            _cvtbuffer = nullptr;
+        }
+        _capacity  = std::max(_readsize,_pagesize);
+        _cvtbuffer = (float*)malloc(sizeof(float)*(_capacity+_padding)*_channels);
+    }
+    if (_cvtbuffer != nullptr) {
+        memset(_cvtbuffer,0,sizeof(float)*(_capacity+_padding)*_channels);
+    }
+    _cvtoffset = 0;
+    _cvtavail  = 0;
+    _cvtoversc = 0;
+    _intime = 0;
+}
+
 #pragma mark -
 #pragma mark Filter Algorithm
 /**
@@ -792,8 +813,9 @@ void AudioResampler::setup() {
     }
 
     // Initialize the new filter
+    _padding = _zero_cross.load(std::memory_order_relaxed);
     _per_crossing = (1 << ((_precision / 2) + 1));
-    _filter_size = ((_per_crossing * _zero_cross) + 1);
+    _filter_size = ((_per_crossing * _padding) + 1);
 
     _filter_table = (float*)malloc(sizeof(float)*_filter_size);
     _filter_diffs = (float*)malloc(sizeof(float)*_filter_size);
@@ -819,7 +841,7 @@ void AudioResampler::setup() {
     _filter_diffs[lenm1] = 0.0;
     
     // Need to ensure large enough convolution window.
-    _pagesize = nextPOT(2*_zero_cross+1);
+    _pagesize = nextPOT(2*_padding+1);
 }
 
 /**
@@ -842,7 +864,7 @@ void AudioResampler::filterFrame(float* buffer,
     Uint32 index   = (Uint32)_intime;
     double currtime =  index / inrate;
     double nexttime = (index + 1) / inrate;
-    index += _zero_cross;
+    index += _padding;
     
     double interp0 = 1.0 - ((nexttime - (_intime/inrate)) / (nexttime - currtime));
     Uint32 filterindex0 = (Uint32)(interp0 * _per_crossing);
@@ -914,7 +936,7 @@ void AudioResampler::fillBuffer() {
     if (_cvtoffset > 0) {
         // Shift everything down
         size_t pos = chans*_cvtoffset;
-        size_t amt = chans*(_cvtavail+_cvtoversc+_zero_cross-_cvtoffset);
+        size_t amt = chans*(_cvtavail+_cvtoversc+_padding-_cvtoffset);
 
         if (amt > pos) {
             memmove(_cvtbuffer,_cvtbuffer+pos,amt*sizeof(float));
@@ -945,14 +967,14 @@ void AudioResampler::fillBuffer() {
     
     // Read in up to the buffer
     Uint32 remain = (Uint32)(_capacity-_cvtavail);
-    Uint32 actual = input->read(_cvtbuffer+(_cvtavail+_zero_cross)*chans, remain);
+    Uint32 actual = input->read(_cvtbuffer+(_cvtavail+_padding)*chans, remain);
 
     if (actual < remain) {
         Uint32 tail = remain-actual;
-        memset(_cvtbuffer+(_cvtavail+_zero_cross+actual)*chans, 0, tail*chans*sizeof(float));
-        _cvtoversc = (tail > _zero_cross) ? 0 : _zero_cross-tail;
+        memset(_cvtbuffer+(_cvtavail+_padding+actual)*chans, 0, tail*chans*sizeof(float));
+        _cvtoversc = (tail > _padding) ? 0 : _padding-tail;
     } else {
-        _cvtoversc = _zero_cross;
+        _cvtoversc = _padding;
     }
     _cvtavail += actual-_cvtoversc;
 }
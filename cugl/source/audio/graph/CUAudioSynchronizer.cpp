@@ -357,8 +357,6 @@ Uint32 AudioSynchronizer::read(float* buffer, Uint32 frames) {
         std::memset(buffer,0,frames*_channels*sizeof(float));
         take = frames;
     } else if (input->getChannels() != _channels) {
-        std::unique_lock<std::mutex> lk(_mutex);
-        
         bool abort = false;
         while (take < frames && !abort) {
             Uint32 amt = std::min(frames,_readsize);
@@ -405,7 +403,6 @@ Uint32 AudioSynchronizer::read(float* buffer, Uint32 frames) {
             take += amt;
         }
     } else {
-        std::unique_lock<std::mutex> lk(_mutex);
         take = input->read(buffer, frames);
         double inputBPM = _inputBPM.load(std::memory_order_relaxed);
         if (inputBPM > 0) {
@@ -48,9 +48,13 @@
 #include <cugl/core/assets/CUAssetManager.h>
 #include <cugl/core/io/CUJsonReader.h>
 #include <cugl/core/CUApplication.h>
+#include <thread>
 
 using namespace cugl;
 
+/** The maximum number of decoder threads created by default */
+#define DEFAULT_DECODERS 4
+
 #pragma mark -
 #pragma mark Constructors
 /**
@@ -65,11 +69,44 @@ using namespace cugl;
  * This constructor does not attach any loaders. It simply creates an
  * object that is ready to accept loader objects.
  *
+ * Loaders with a thread-safe decode stage (such as textures) may also
+ * decode assets in parallel on a separate pool of decoder threads. This
+ * initializer leaves one core for the main thread, and creates at most
+ * 4 decoders. A single core device has no decoder pool.
+ *
  * @return a newly allocated asset manager.
  */
 bool AssetManager::init() {
+    Uint32 cores = std::thread::hardware_concurrency();
+    Uint32 decoders = cores > 1 ? cores-1 : 0;
+    return init(decoders > DEFAULT_DECODERS ? DEFAULT_DECODERS : decoders);
+}
+
+/**
+ * Initializes a new asset manager with the given number of decoders.
+ *
+ * The asset manager has a single thread, as some of the asset loading
+ * operations (particularly fonts) cannot be run in multiple threads
+ * simultaneously. However, it will run in a distinct thread from the
+ * main application.
+ *
+ * Loaders with a thread-safe decode stage (such as textures) may also
+ * decode assets in parallel on a separate pool of decoder threads. The
+ * results are still finished (e.g. uploaded to OpenGL) on the main
+ * thread. If decoders is 0, there is no decoder pool and all decoding
+ * happens on the single loader thread.
+ *
+ * This initializer does not attach any loaders.  It simply creates an
+ * object that is ready to accept loader objects.
+ *
+ * @param decoders  The number of decoder threads
+ *
+ * @return true if the asset manager was initialized successfully
+ */
+bool AssetManager::init(Uint32 decoders) {
     _workers = ThreadPool::alloc(1);
-    return true;
+    _decoders = decoders == 0 ? nullptr : ThreadPool::alloc(decoders);
+    return _workers != nullptr;
 }
 
 /**
@@ -82,6 +119,7 @@ bool AssetManager::init() {
 void AssetManager::dispose() {
     detachAll();
     _workers = nullptr;
+    _decoders = nullptr;
 }
 
 #pragma mark -
@@ -120,13 +158,7 @@ bool AssetManager::readCategory(size_t hash, const std::shared_ptr<JsonValue>& j
         return false;
     }
     
-    bool success = true;
-    for(int ii = 0; ii < json->size(); ii++) {
-        std::shared_ptr<JsonValue> child = json->get(ii);
-        success = loader->load(child) && success;
-    }
-    
-    return success;
+    return loader->loadCategory(json);
 }
 
 /**
@@ -4,8 +4,12 @@
 //
 //  This module a modern C++ alternative to the CUJSON interface for reading
 //  JSON files.  In particular, this gives us better type-checking and memory
-//  management.  With that said, it still uses CUJSON as the underlying parsing
-//  engine.
+//  management.  Parsing is done in a single pass directly into the JsonValue
+//  tree, with the nodes allocated from an arena. CUJSON is only used to
+//  serialize the tree back to a string.
+//
+//  Trees may also be encoded as compiled JSON, a compact binary format that
+//  can be decoded without any string parsing.
 //
 //  This class uses our standard shared-pointer architecture.
 //
@@ -44,6 +48,13 @@
 #include <cugl/core/assets/CUJsonValue.h>
 #include <cugl/core/util/CUDebug.h>
 #include <cugl/core/util/CUStringTools.h>
+#include <cugl/core/util/CUEndian.h>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <cstring>
+#include <cmath>
+#include <functional>
 
 using namespace cugl;
 
@@ -83,6 +94,849 @@ static std::string isolate_error(const char* data, const char* error, int& linen
     return std::string(error,len);
 }
 
+#pragma mark -
+#pragma mark JSON Parsing
+/** The size of a single block in a node arena */
+#define ARENA_BLOCK 16384
+/** The number of children before an object is indexed by key */
+#define INDEX_THRESHOLD 8
+
+/**
+ * Returns the long value for a parsed number
+ *
+ * Values out of range are clamped to the range of a long.
+ *
+ * @param n The parsed number
+ *
+ * @return the long value for a parsed number
+ */
+static long clamp_long(double n) {
+    if (n >= (double)std::numeric_limits<long>::max()) {
+        return std::numeric_limits<long>::max();
+    } else if (n <= (double)std::numeric_limits<long>::min()) {
+        return std::numeric_limits<long>::min();
+    }
+    return (long)n;
+}
+
+/**
+ * A bump allocator for the nodes of a parsed JSON tree.
+ *
+ * Parsing a large JSON file creates thousands of small nodes. Allocating
+ * each one separately is a significant part of the parse time. Instead,
+ * the parser allocates the nodes (and their shared pointer control blocks)
+ * from large blocks. Individual nodes are never freed. The blocks are freed
+ * together when the last node of the tree is deleted.
+ *
+ * An arena is only written to by the parser that created it, so it does
+ * not need to be thread-safe.
+ */
+class JsonArena {
+private:
+    /** The allocated memory blocks */
+    std::vector<std::unique_ptr<Uint8[]>> _blocks;
+    /** The offset of the next free byte in the current block */
+    size_t _offset;
+    /** The capacity of the current block */
+    size_t _capacity;
+
+public:
+    /**
+     * Creates an empty arena
+     */
+    JsonArena() : _offset(0), _capacity(0) {}
+
+    /**
+     * Returns a pointer to size bytes with the given alignment.
+     *
+     * @param size  The number of bytes to allocate
+     * @param align The required alignment (a power of two)
+     *
+     * @return a pointer to size bytes with the given alignment.
+     */
+    void* allocate(size_t size, size_t align) {
+        size_t start = (_offset+align-1) & ~(align-1);
+        if (_blocks.empty() || start+size > _capacity) {
+            _capacity = std::max(size, (size_t)ARENA_BLOCK);
+            _blocks.push_back(std::unique_ptr<Uint8[]>(new Uint8[_capacity]));
+            start = 0;
+        }
+        _offset = start+size;
+        return _blocks.back().get()+start;
+    }
+};
+
+/**
+ * An STL allocator for allocating JSON nodes from a {@link JsonArena}.
+ *
+ * Every copy of this allocator shares ownership of the arena. As
+ * std::allocate_shared stores a copy in each control block, the arena
+ * lives as long as any node allocated from it.
+ */
+template <typename T>
+class JsonAllocator {
+public:
+    typedef T value_type;
+    /** The arena to allocate from */
+    std::shared_ptr<JsonArena> arena;
+
+    /**
+     * Creates an allocator for the given arena
+     *
+     * @param arena The arena to allocate from
+     */
+    JsonAllocator(const std::shared_ptr<JsonArena>& arena) : arena(arena) {}
+
+    /**
+     * Creates a copy of the given allocator (for a different type)
+     *
+     * @param other The allocator to copy
+     */
+    template <typename U>
+    JsonAllocator(const JsonAllocator<U>& other) : arena(other.arena) {}
+
+    /**
+     * Returns storage for n objects of type T
+     *
+     * @param n The number of objects
+     *
+     * @return storage for n objects of type T
+     */
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena->allocate(n*sizeof(T), alignof(T)));
+    }
+
+    /**
+     * Releases storage for objects (this does nothing)
+     *
+     * The storage is reclaimed when the arena itself is released.
+     */
+    void deallocate(T*, size_t) {}
+
+    /** Returns true if the allocators share the same arena */
+    template <typename U>
+    bool operator==(const JsonAllocator<U>& other) const { return arena == other.arena; }
+
+    /** Returns true if the allocators do not share the same arena */
+    template <typename U>
+    bool operator!=(const JsonAllocator<U>& other) const { return arena != other.arena; }
+};
+
+/**
+ * A single-pass recursive descent JSON parser.
+ *
+ * This parser writes directly to the {@link JsonValue} tree, with no
+ * intermediate representation. Nodes are allocated from a {@link JsonArena}
+ * and the children of each node are gathered on a shared stack, so that
+ * each child vector is allocated exactly once. Strings without escape
+ * sequences are copied directly out of the source buffer.
+ *
+ * This parser accepts the same language as CUJSON. In particular, any
+ * content after the first JSON value is ignored.
+ */
+class JsonParser {
+private:
+    /** The arena for allocating nodes */
+    std::shared_ptr<JsonArena> _arena;
+    /** The children gathered so far (for all nodes under construction) */
+    std::vector<std::shared_ptr<JsonValue>> _stack;
+
+    /**
+     * Returns the given position advanced past any whitespace
+     *
+     * @param pos   The current parse position
+     *
+     * @return the given position advanced past any whitespace
+     */
+    static const char* skip(const char* pos) {
+        while (*pos && (unsigned char)*pos <= 32) {
+            pos++;
+        }
+        return pos;
+    }
+
+    /**
+     * Returns the value of the four hexadecimal digits at pos
+     *
+     * If the characters are not hexadecimal, this function returns 0.
+     *
+     * @param pos   The current parse position
+     *
+     * @return the value of the four hexadecimal digits at pos
+     */
+    static unsigned hex4(const char* pos) {
+        unsigned result = 0;
+        for(int ii = 0; ii < 4; ii++) {
+            char c = pos[ii];
+            result <<= 4;
+            if (c >= '0' && c <= '9') {
+                result += c-'0';
+            } else if (c >= 'A' && c <= 'F') {
+                result += 10+c-'A';
+            } else if (c >= 'a' && c <= 'f') {
+                result += 10+c-'a';
+            } else {
+                return 0;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Appends the UTF-8 encoding of the given code point to out
+     *
+     * @param out   The string to append to
+     * @param uc    The unicode code point
+     */
+    static void encode(std::string& out, unsigned uc) {
+        if (uc < 0x80) {
+            out.push_back((char)uc);
+        } else if (uc < 0x800) {
+            out.push_back((char)(0xC0 | (uc >> 6)));
+            out.push_back((char)(0x80 | (uc & 0x3F)));
+        } else if (uc < 0x10000) {
+            out.push_back((char)(0xE0 | (uc >> 12)));
+            out.push_back((char)(0x80 | ((uc >> 6) & 0x3F)));
+            out.push_back((char)(0x80 | (uc & 0x3F)));
+        } else {
+            out.push_back((char)(0xF0 | (uc >> 18)));
+            out.push_back((char)(0x80 | ((uc >> 12) & 0x3F)));
+            out.push_back((char)(0x80 | ((uc >> 6) & 0x3F)));
+            out.push_back((char)(0x80 | (uc & 0x3F)));
+        }
+    }
+
+    /**
+     * Returns a newly allocated node from the arena
+     *
+     * @return a newly allocated node from the arena
+     */
+    std::shared_ptr<JsonValue> allocNode() {
+        if (_arena == nullptr) {
+            _arena = std::make_shared<JsonArena>();
+        }
+        return std::allocate_shared<JsonValue>(JsonAllocator<JsonValue>(_arena));
+    }
+
+    /**
+     * Parses the string at pos into out, returning the next parse position
+     *
+     * If there is an error, this method returns nullptr and stores the
+     * position of the error in {@link #error}.
+     *
+     * @param out   The string to store the result
+     * @param pos   The current parse position
+     *
+     * @return the next parse position
+     */
+    const char* parseString(std::string& out, const char* pos) {
+        if (*pos != '\"') {
+            error = pos;
+            return nullptr;
+        }
+
+        // Fast path for strings with no escapes
+        const char* begin = pos+1;
+        const char* end = begin;
+        while (*end && *end != '\"' && *end != '\\') {
+            end++;
+        }
+        if (*end == '\"') {
+            out.assign(begin,end-begin);
+            return end+1;
+        }
+
+        out.assign(begin,end-begin);
+        pos = end;
+        while (*pos && *pos != '\"') {
+            if (*pos != '\\') {
+                out.push_back(*pos++);
+                continue;
+            }
+            pos++;
+            switch (*pos) {
+                case 'b':
+                    out.push_back('\b');
+                    break;
+                case 'f':
+                    out.push_back('\f');
+                    break;
+                case 'n':
+                    out.push_back('\n');
+                    break;
+                case 'r':
+                    out.push_back('\r');
+                    break;
+                case 't':
+                    out.push_back('\t');
+                    break;
+                case '\"':
+                case '\\':
+                case '/':
+                    out.push_back(*pos);
+                    break;
+                case 'u':
+                {
+                    // Transcode UTF-16 to UTF-8
+                    unsigned uc = hex4(pos+1);
+                    pos += 4;
+                    if ((uc >= 0xDC00 && uc <= 0xDFFF) || uc == 0) {
+                        error = begin-1;
+                        return nullptr;
+                    }
+                    if (uc >= 0xD800 && uc <= 0xDBFF) {
+                        if (pos[1] != '\\' || pos[2] != 'u') {
+                            error = begin-1;
+                            return nullptr;
+                        }
+                        unsigned uc2 = hex4(pos+3);
+                        pos += 6;
+                        if (uc2 < 0xDC00 || uc2 > 0xDFFF) {
+                            error = begin-1;
+                            return nullptr;
+                        }
+                        uc = 0x10000 + (((uc & 0x3FF) << 10) | (uc2 & 0x3FF));
+                    }
+                    encode(out,uc);
+                }
+                    break;
+                default:
+                    error = begin-1;
+                    return nullptr;
+            }
+            pos++;
+        }
+
+        if (*pos != '\"') {
+            error = begin-1;
+            return nullptr;
+        }
+        return pos+1;
+    }
+
+    /**
+     * Parses the number at pos into node, returning the next parse position
+     *
+     * This uses the same (locale independent) algorithm as CUJSON.
+     *
+     * @param node  The node to store the result
+     * @param pos   The current parse position
+     *
+     * @return the next parse position
+     */
+    const char* parseNumber(JsonValue* node, const char* pos) {
+        double n = 0;
+        double sign = 1;
+        double scale = 0;
+        int subscale = 0;
+        int signsubscale = 1;
+
+        if (*pos == '-') {
+            sign = -1;
+            pos++;
+        }
+        if (*pos == '0') {
+            pos++;
+        }
+        if (*pos >= '1' && *pos <= '9') {
+            do {
+                n = (n*10.0) + (*pos++ - '0');
+            } while (*pos >= '0' && *pos <= '9');
+        }
+        if (*pos == '.' && pos[1] >= '0' && pos[1] <= '9') {
+            pos++;
+            do {
+                n = (n*10.0) + (*pos++ - '0');
+                scale--;
+            } while (*pos >= '0' && *pos <= '9');
+        }
+        if (*pos == 'e' || *pos == 'E') {
+            pos++;
+            if (*pos == '+') {
+                pos++;
+            } else if (*pos == '-') {
+                signsubscale = -1;
+                pos++;
+            }
+            while (*pos >= '0' && *pos <= '9') {
+                subscale = (subscale*10) + (*pos++ - '0');
+            }
+        }
+
+        n = sign*n*pow(10.0, (scale+subscale*signsubscale));
+        node->_type = JsonValue::Type::NumberType;
+        node->_doubleValue = n;
+        node->_longValue = clamp_long(n);
+        return pos;
+    }
+
+    /**
+     * Parses the array at pos into node, returning the next parse position
+     *
+     * If there is an error, this method returns nullptr and stores the
+     * position of the error in {@link #error}.
+     *
+     * @param node  The node to store the result
+     * @param pos   The current parse position
+     *
+     * @return the next parse position
+     */
+    const char* parseArray(JsonValue* node, const char* pos) {
+        node->_type = JsonValue::Type::ArrayType;
+        size_t mark = _stack.size();
+        pos = skip(pos+1);
+        if (*pos != ']') {
+            while (true) {
+                std::shared_ptr<JsonValue> child = allocNode();
+                child->_parent = node;
+                pos = parseValue(child.get(),skip(pos));
+                if (pos == nullptr) {
+                    return nullptr;
+                }
+                _stack.push_back(std::move(child));
+                pos = skip(pos);
+                if (*pos != ',') {
+                    break;
+                }
+                pos++;
+            }
+            if (*pos != ']') {
+                error = pos;
+                return nullptr;
+            }
+        }
+        gather(node,mark);
+        return pos+1;
+    }
+
+    /**
+     * Parses the object at pos into node, returning the next parse position
+     *
+     * If there is an error, this method returns nullptr and stores the
+     * position of the error in {@link #error}.
+     *
+     * @param node  The node to store the result
+     * @param pos   The current parse position
+     *
+     * @return the next parse position
+     */
+    const char* parseObject(JsonValue* node, const char* pos) {
+        node->_type = JsonValue::Type::ObjectType;
+        size_t mark = _stack.size();
+        pos = skip(pos+1);
+        if (*pos != '}') {
+            while (true) {
+                std::shared_ptr<JsonValue> child = allocNode();
+                child->_parent = node;
+                pos = parseString(child->_key,skip(pos));
+                if (pos == nullptr) {
+                    return nullptr;
+                }
+                pos = skip(pos);
+                if (*pos != ':') {
+                    error = pos;
+                    return nullptr;
+                }
+                pos = parseValue(child.get(),skip(pos+1));
+                if (pos == nullptr) {
+                    return nullptr;
+                }
+                _stack.push_back(std::move(child));
+                pos = skip(pos);
+                if (*pos != ',') {
+                    break;
+                }
+                pos++;
+            }
+            if (*pos != '}') {
+                error = pos;
+                return nullptr;
+            }
+        }
+        gather(node,mark);
+        return pos+1;
+    }
+
+    /**
+     * Moves the children above mark on the stack into node
+     *
+     * @param node  The node to receive the children
+     * @param mark  The stack size before the node was parsed
+     */
+    void gather(JsonValue* node, size_t mark) {
+        node->_children.assign(std::make_move_iterator(_stack.begin()+mark),
+                               std::make_move_iterator(_stack.end()));
+        _stack.resize(mark);
+        node->reindex();
+    }
+
+public:
+    /** The position of the parse error (nullptr if none) */
+    const char* error;
+
+    /**
+     * Creates a new parser
+     *
+     * The arena is not allocated until the first child node, so parsing a
+     * single value (e.g. a number) does not allocate any memory.
+     */
+    JsonParser() : error(nullptr) {}
+
+    /**
+     * Parses the value at pos into node, returning the next parse position
+     *
+     * If there is an error, this method returns nullptr and stores the
+     * position of the error in {@link #error}.
+     *
+     * @param node  The node to store the result
+     * @param pos   The current parse position
+     *
+     * @return the next parse position
+     */
+    const char* parseValue(JsonValue* node, const char* pos) {
+        switch (*pos) {
+            case 'n':
+                if (!strncmp(pos, "null", 4)) {
+                    node->_type = JsonValue::Type::NullType;
+                    return pos+4;
+                }
+                break;
+            case 'f':
+                if (!strncmp(pos, "false", 5)) {
+                    node->_type = JsonValue::Type::BoolType;
+                    node->_longValue = 0;
+                    return pos+5;
+                }
+                break;
+            case 't':
+                if (!strncmp(pos, "true", 4)) {
+                    node->_type = JsonValue::Type::BoolType;
+                    node->_longValue = 1;
+                    return pos+4;
+                }
+                break;
+            case '\"':
+                node->_type = JsonValue::Type::StringType;
+                return parseString(node->_stringValue, pos);
+            case '[':
+                return parseArray(node, pos);
+            case '{':
+                return parseObject(node, pos);
+            default:
+                if (*pos == '-' || (*pos >= '0' && *pos <= '9')) {
+                    return parseNumber(node, pos);
+                }
+                break;
+        }
+        error = pos;
+        return nullptr;
+    }
+
+    /**
+     * Parses the given JSON string into the node
+     *
+     * If there is an error, this method returns false and stores the
+     * position of the error in {@link #error}.
+     *
+     * @param node  The node to store the result
+     * @param json  The JSON string
+     *
+     * @return true if parsing was successful
+     */
+    bool parse(JsonValue* node, const char* json) {
+        return parseValue(node, skip(json)) != nullptr;
+    }
+};
+
+#pragma mark -
+#pragma mark Compiled JSON
+/** The magic number at the start of compiled JSON */
+#define BINARY_MAGIC    "CUBJ"
+/** The current version of compiled JSON */
+#define BINARY_VERSION  1
+/** The size of the compiled JSON header (magic number and version) */
+#define BINARY_HEADER   5
+/** The maximum nesting of compiled JSON (to bound recursion) */
+#define BINARY_DEPTH    1000
+
+/** The compiled JSON tag for null */
+#define BINARY_NULL     0
+/** The compiled JSON tag for false */
+#define BINARY_FALSE    1
+/** The compiled JSON tag for true */
+#define BINARY_TRUE     2
+/** The compiled JSON tag for an integer (zigzag LEB128) */
+#define BINARY_INT      3
+/** The compiled JSON tag for a double (network order) */
+#define BINARY_REAL     4
+/** The compiled JSON tag for a string (length and bytes) */
+#define BINARY_STRING   5
+/** The compiled JSON tag for an array (count and values) */
+#define BINARY_ARRAY    6
+/** The compiled JSON tag for an object (count and key-value pairs) */
+#define BINARY_OBJECT   7
+
+/**
+ * Appends the LEB128 encoding of value to out
+ *
+ * @param out   The byte buffer to append to
+ * @param value The value to encode
+ */
+static void encode_size(std::vector<std::byte>& out, Uint64 value) {
+    while (value >= 0x80) {
+        out.push_back((std::byte)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back((std::byte)value);
+}
+
+/**
+ * Appends the length and bytes of the string to out
+ *
+ * @param out   The byte buffer to append to
+ * @param value The string to encode
+ */
+static void encode_string(std::vector<std::byte>& out, const std::string& value) {
+    encode_size(out, value.size());
+    const std::byte* start = reinterpret_cast<const std::byte*>(value.data());
+    out.insert(out.end(), start, start+value.size());
+}
+
+/**
+ * Appends the compiled JSON encoding of node (and its descendants) to out
+ *
+ * @param out   The byte buffer to append to
+ * @param node  The node to encode
+ */
+static void encode_value(std::vector<std::byte>& out, const JsonValue* node) {
+    switch (node->_type) {
+        case JsonValue::Type::NullType:
+            out.push_back((std::byte)BINARY_NULL);
+            break;
+        case JsonValue::Type::BoolType:
+            out.push_back((std::byte)(node->_longValue ? BINARY_TRUE : BINARY_FALSE));
+            break;
+        case JsonValue::Type::NumberType:
+            // Use a varint if the double is integral (but not -0.0)
+            if ((double)node->_longValue == node->_doubleValue &&
+                (node->_longValue != 0 || !std::signbit(node->_doubleValue))) {
+                Sint64 value = node->_longValue;
+                out.push_back((std::byte)BINARY_INT);
+                encode_size(out, ((Uint64)value << 1) ^ (Uint64)(value >> 63));
+            } else {
+                double value = marshall(node->_doubleValue);
+                const std::byte* start = reinterpret_cast<const std::byte*>(&value);
+                out.push_back((std::byte)BINARY_REAL);
+                out.insert(out.end(), start, start+sizeof(double));
+            }
+            break;
+        case JsonValue::Type::StringType:
+            out.push_back((std::byte)BINARY_STRING);
+            encode_string(out, node->_stringValue);
+            break;
+        case JsonValue::Type::ArrayType:
+            out.push_back((std::byte)BINARY_ARRAY);
+            encode_size(out, node->_children.size());
+            for(auto it = node->_children.begin(); it != node->_children.end(); ++it) {
+                encode_value(out, it->get());
+            }
+            break;
+        case JsonValue::Type::ObjectType:
+            out.push_back((std::byte)BINARY_OBJECT);
+            encode_size(out, node->_children.size());
+            for(auto it = node->_children.begin(); it != node->_children.end(); ++it) {
+                encode_string(out, (*it)->_key);
+                encode_value(out, it->get());
+            }
+            break;
+    }
+}
+
+/**
+ * A decoder for compiled JSON.
+ *
+ * Like {@link JsonParser}, this decoder writes directly to the
+ * {@link JsonValue} tree, allocating the nodes from a {@link JsonArena} and
+ * gathering children on a shared stack. As every length is known in advance,
+ * there is no scanning or string parsing. All reads are bounds checked, so
+ * it is safe to decode untrusted data.
+ */
+class JsonDecoder {
+private:
+    /** The arena for allocating nodes */
+    std::shared_ptr<JsonArena> _arena;
+    /** The children gathered so far (for all nodes under construction) */
+    std::vector<std::shared_ptr<JsonValue>> _stack;
+    /** The current decode position */
+    const Uint8* _pos;
+    /** The end of the compiled JSON */
+    const Uint8* _end;
+    /** The current nesting depth */
+    int _depth;
+
+    /**
+     * Returns a newly allocated node from the arena
+     *
+     * @return a newly allocated node from the arena
+     */
+    std::shared_ptr<JsonValue> allocNode() {
+        if (_arena == nullptr) {
+            _arena = std::make_shared<JsonArena>();
+        }
+        return std::allocate_shared<JsonValue>(JsonAllocator<JsonValue>(_arena));
+    }
+
+    /**
+     * Decodes a LEB128 value into out, returning false on error
+     *
+     * @param out   The variable to store the result
+     *
+     * @return true if the value was successfully decoded
+     */
+    bool decodeSize(Uint64& out) {
+        out = 0;
+        for(int shift = 0; shift < 64 && _pos < _end; shift += 7) {
+            Uint8 byte = *_pos++;
+            out |= (Uint64)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Decodes a string into out, returning false on error
+     *
+     * @param out   The string to store the result
+     *
+     * @return true if the string was successfully decoded
+     */
+    bool decodeString(std::string& out) {
+        Uint64 length;
+        if (!decodeSize(length) || length > (Uint64)(_end-_pos)) {
+            return false;
+        }
+        out.assign(reinterpret_cast<const char*>(_pos), (size_t)length);
+        _pos += length;
+        return true;
+    }
+
+    /**
+     * Decodes the children of an array or object into node
+     *
+     * @param node  The node to receive the children
+     * @param keyed Whether each child is preceded by a key
+     *
+     * @return true if the children were successfully decoded
+     */
+    bool decodeChildren(JsonValue* node, bool keyed) {
+        Uint64 count;
+        // Every child takes at least one byte
+        if (!decodeSize(count) || count > (Uint64)(_end-_pos) || ++_depth > BINARY_DEPTH) {
+            return false;
+        }
+
+        size_t mark = _stack.size();
+        for(Uint64 ii = 0; ii < count; ii++) {
+            std::shared_ptr<JsonValue> child = allocNode();
+            child->_parent = node;
+            if ((keyed && !decodeString(child->_key)) || !decodeValue(child.get())) {
+                return false;
+            }
+            _stack.push_back(std::move(child));
+        }
+        node->_children.assign(std::make_move_iterator(_stack.begin()+mark),
+                               std::make_move_iterator(_stack.end()));
+        _stack.resize(mark);
+        node->reindex();
+        _depth--;
+        return true;
+    }
+
+public:
+    /**
+     * Creates a decoder for the given compiled JSON
+     *
+     * @param data  The compiled JSON (without the header)
+     * @param size  The number of bytes of compiled JSON
+     */
+    JsonDecoder(const std::byte* data, size_t size) : _depth(0) {
+        _pos = reinterpret_cast<const Uint8*>(data);
+        _end = _pos+size;
+    }
+
+    /**
+     * Returns true if all of the compiled JSON has been decoded
+     *
+     * @return true if all of the compiled JSON has been decoded
+     */
+    bool atEnd() const {
+        return _pos == _end;
+    }
+
+    /**
+     * Decodes the next value into node, returning false on error
+     *
+     * @param node  The node to store the result
+     *
+     * @return true if the value was successfully decoded
+     */
+    bool decodeValue(JsonValue* node) {
+        if (_pos >= _end) {
+            return false;
+        }
+        switch (*_pos++) {
+            case BINARY_NULL:
+                node->_type = JsonValue::Type::NullType;
+                return true;
+            case BINARY_FALSE:
+            case BINARY_TRUE:
+                node->_type = JsonValue::Type::BoolType;
+                node->_longValue = (_pos[-1] == BINARY_TRUE);
+                return true;
+            case BINARY_INT:
+            {
+                Uint64 bits;
+                if (!decodeSize(bits)) {
+                    return false;
+                }
+                Sint64 value = (Sint64)(bits >> 1) ^ -(Sint64)(bits & 1);
+                node->_type = JsonValue::Type::NumberType;
+                node->_doubleValue = (double)value;
+                node->_longValue = clamp_long(node->_doubleValue);
+                if (value >= std::numeric_limits<long>::min() && value <= std::numeric_limits<long>::max()) {
+                    node->_longValue = (long)value;
+                }
+                return true;
+            }
+            case BINARY_REAL:
+            {
+                if (_end-_pos < (ptrdiff_t)sizeof(double)) {
+                    return false;
+                }
+                double value;
+                std::memcpy(&value, _pos, sizeof(double));
+                _pos += sizeof(double);
+                node->_type = JsonValue::Type::NumberType;
+                node->_doubleValue = marshall(value);
+                node->_longValue = clamp_long(node->_doubleValue);
+                return true;
+            }
+            case BINARY_STRING:
+                node->_type = JsonValue::Type::StringType;
+                return decodeString(node->_stringValue);
+            case BINARY_ARRAY:
+                node->_type = JsonValue::Type::ArrayType;
+                return decodeChildren(node, false);
+            case BINARY_OBJECT:
+                node->_type = JsonValue::Type::ObjectType;
+                return decodeChildren(node, true);
+        }
+        return false;
+    }
+};
+
 #pragma mark -
 #pragma mark JSON Conversions
 /**
@@ -181,7 +1035,8 @@ std::shared_ptr<JsonValue> JsonValue::toJsonValue(const CUJSON* node) {
         }
     }
     result->_children.assign(items.begin(),items.end());
-    
+    result->reindex();
+
     return result;
 }
 
@@ -221,6 +1076,7 @@ void JsonValue::toJsonValue(JsonValue* value, const CUJSON* node) {
         }
     }
     value->_children.assign(items.begin(),items.end());
+    value->reindex();
 }
 
 /**
@@ -278,6 +1134,89 @@ CUJSON* JsonValue::toCUJSON(const JsonValue* value) {
     return result;
 }
 
+#pragma mark -
+#pragma mark Key Index
+/**
+ * Rebuilds the key index of this node.
+ *
+ * Objects with many children keep a table of key hashes sorted by hash,
+ * so that lookup by key does not need to compare every key. This method
+ * rebuilds that table, or clears it if this node is not a large object.
+ * It must be called whenever the children or their keys change, including
+ * a key change of a child that has since moved to another parent.
+ *
+ * The index is maintained on change (and not built lazily on lookup) so
+ * that it is safe for multiple threads to read the same tree. As the
+ * children are public, lookups still check each index entry against the
+ * children, and fall back to a linear search if the index is out of date.
+ */
+void JsonValue::reindex() {
+    _index.clear();
+    if (_type != Type::ObjectType || _children.size() < INDEX_THRESHOLD) {
+        return;
+    }
+
+    std::hash<std::string_view> hasher;
+    _index.reserve(_children.size());
+    for(Uint32 ii = 0; ii < _children.size(); ii++) {
+        _index.emplace_back(hasher(_children[ii]->_key), ii);
+    }
+    std::sort(_index.begin(), _index.end());
+}
+
+/**
+ * Adds the last child of this node to the key index.
+ *
+ * This is an optimization of {@link #reindex} for appending a child.
+ */
+void JsonValue::reindexLast() {
+    if (_index.empty() || _index.size()+1 != _children.size()) {
+        reindex();
+        return;
+    }
+
+    // The new position is the largest, so it goes last among equal hashes
+    Uint32 pos = (Uint32)_children.size()-1;
+    std::pair<size_t,Uint32> entry(std::hash<std::string_view>()(_children[pos]->_key), pos);
+    _index.insert(std::upper_bound(_index.begin(), _index.end(), entry), entry);
+}
+
+/**
+ * Returns the position of the first child with the given key.
+ *
+ * If there is no child with that key, this method returns -1.
+ *
+ * @param key   The key identifying the child
+ *
+ * @return the position of the first child with the given key.
+ */
+int JsonValue::search(std::string_view key) const {
+    // Small objects (and arrays) have no index. Direct edits of the
+    // children can also leave an index that no longer matches them.
+    bool stale = _index.size() != _children.size();
+    if (!stale) {
+        size_t hash = std::hash<std::string_view>()(key);
+        auto it = std::lower_bound(_index.begin(), _index.end(), std::pair<size_t,Uint32>(hash,0));
+        for(; it != _index.end() && it->first == hash && !stale; ++it) {
+            if (it->second >= _children.size()) {
+                stale = true;
+            } else if (_children[it->second]->_key == key) {
+                return (int)it->second;
+            }
+        }
+        if (!stale) {
+            return -1;
+        }
+    }
+
+    for(size_t ii = 0; ii < _children.size(); ii++) {
+        if (_children[ii]->_key == key) {
+            return (int)ii;
+        }
+    }
+    return -1;
+}
+
 #pragma mark -
 #pragma mark Constructors
 /**
@@ -391,6 +1330,10 @@ bool JsonValue::init(double value) {
  * node will be deleted when this node is deleted (provided there are
  * no other references).
  *
+ * The descendants of this node are allocated together from a memory
+ * arena. The arena is not released until all of them are deleted. So
+ * keeping a small subtree of a large file keeps the whole tree in memory.
+ *
  * If there is a parsing error, this  method will return false.  Detailed
  * information about the parsing error will be passed to an assert.  Hence
  * error messages are suppressed if asserts are turned off.
@@ -400,13 +1343,23 @@ bool JsonValue::init(double value) {
  * @return  true if the JSON node is initialized properly, false otherwise.
  */
 bool JsonValue::initWithJson(const std::string json) {
-    const char *error = NULL;
-    CUJSON* node = CUJSON_ParseWithOpts(json.c_str(), &error, 0);
-    if (node) {
-        toJsonValue(this,node);
-        CUJSON_Delete(node);
+    JsonParser parser;
+    JsonValue root;
+    if (parser.parse(&root, json.c_str())) {
+        // Only modify this node on success
+        _type = root._type;
+        _stringValue = std::move(root._stringValue);
+        _longValue = root._longValue;
+        _doubleValue = root._doubleValue;
+        _children = std::move(root._children);
+        _index = std::move(root._index);
+        for(auto it = _children.begin(); it != _children.end(); ++it) {
+            (*it)->_parent = this;
+        }
         return true;
     }
+    
+    const char* error = parser.error;
     if (error) {
         int line = 0;
         std::string source = isolate_error(json.c_str(),error,line);
@@ -417,6 +1370,59 @@ bool JsonValue::initWithJson(const std::string json) {
     return false; // If asserts turned off
 }
 
+/**
+ * Initializes a new JsonValue from the given compiled JSON.
+ *
+ * Compiled JSON is a compact binary encoding of a JSON tree, produced by
+ * {@link #toBinary}. Decoding it requires no string parsing. Strings and
+ * keys are copied by length and numbers are read directly, so this is much
+ * faster than {@link #initWithJson} for large files (such as scene graphs).
+ *
+ * As with {@link #initWithJson}, the descendants of this node are allocated
+ * together from a memory arena.
+ *
+ * If the data is not valid compiled JSON, this method will return false.
+ * This includes any data after the root value. Detailed information about
+ * the error will be passed to an assert. Hence error messages are
+ * suppressed if asserts are turned off.
+ *
+ * @param data  The compiled JSON
+ * @param size  The number of bytes of compiled JSON
+ *
+ * @return  true if the JSON node is initialized properly, false otherwise.
+ */
+bool JsonValue::initWithBinary(const std::byte* data, size_t size) {
+    if (size < BINARY_HEADER || std::memcmp(data, BINARY_MAGIC, 4) != 0) {
+        CUAssertLog(false, "Data is not compiled JSON");
+        return false;
+    } else if ((Uint8)data[4] != BINARY_VERSION) {
+        CUAssertLog(false, "Unsupported compiled JSON version %d", (int)data[4]);
+        return false;
+    }
+
+    JsonDecoder decoder(data+BINARY_HEADER, size-BINARY_HEADER);
+    JsonValue root;
+    if (!decoder.decodeValue(&root)) {
+        CUAssertLog(false, "Compiled JSON is truncated or corrupt");
+        return false; // If asserts turned off
+    } else if (!decoder.atEnd()) {
+        CUAssertLog(false, "Compiled JSON has data after the root value");
+        return false; // If asserts turned off
+    }
+
+    // Only modify this node on success
+    _type = root._type;
+    _stringValue = std::move(root._stringValue);
+    _longValue = root._longValue;
+    _doubleValue = root._doubleValue;
+    _children = std::move(root._children);
+    _index = std::move(root._index);
+    for(auto it = _children.begin(); it != _children.end(); ++it) {
+        (*it)->_parent = this;
+    }
+    return true;
+}
+
 
 #pragma mark -
 #pragma mark Type
@@ -809,6 +1815,9 @@ void JsonValue::setKey(const std::string key) {
         CUAssertLog(!_parent->has(key), "The key %s is already in use", key.c_str());
     }
     _key = key;
+    if (_parent) {
+        _parent->reindex();
+    }
 }
 
 /**
@@ -839,14 +1848,9 @@ const int JsonValue::index() const {
  *
  * @return true if a child with the specified name exists.
  */
-bool JsonValue::has(const std::string key) const {
+bool JsonValue::has(std::string_view key) const {
     CUAssertLog(isObject(), "Node is not an object type");
-    for(auto it = _children.begin(); it != _children.end(); it++) {
-        if ((*it)->_key == key) {
-            return true;
-        }
-    }
-    return false;
+    return search(key) >= 0;
 }
 
 /**
@@ -893,14 +1897,10 @@ const std::shared_ptr<JsonValue> JsonValue::get(int index) const {
  *
  * @return the child with the specified key.
  */
-std::shared_ptr<JsonValue> JsonValue::get(const std::string key) {
+std::shared_ptr<JsonValue> JsonValue::get(std::string_view key) {
     CUAssertLog(isObject(), "Node is not an object type");
-    for(auto it = _children.begin(); it != _children.end(); it++) {
-        if ((*it)->_key == key) {
-            return *it;
-        }
-    }
-    return nullptr;
+    int pos = search(key);
+    return pos < 0 ? nullptr : _children[pos];
 }
 
 /**
@@ -915,14 +1915,10 @@ std::shared_ptr<JsonValue> JsonValue::get(const std::string key) {
  *
  * @return the child with the specified key.
  */
-const std::shared_ptr<JsonValue> JsonValue::get(const std::string key) const {
+const std::shared_ptr<JsonValue> JsonValue::get(std::string_view key) const {
     CUAssertLog(isObject(), "Node is not an object type");
-    for(auto it = _children.begin(); it != _children.end(); it++) {
-        if ((*it)->_key == key) {
-            return *it;
-        }
-    }
-    return nullptr;
+    int pos = search(key);
+    return pos < 0 ? nullptr : _children[pos];
 }
 
 #pragma mark -
@@ -940,7 +1936,7 @@ const std::shared_ptr<JsonValue> JsonValue::get(const std::string key) const {
  *
  * @return the string value of the child with the specified key.
  */
-const std::string JsonValue::getString (const std::string key, const std::string defaultValue) const {
+const std::string JsonValue::getString (std::string_view key, const std::string defaultValue) const {
     JsonValue* child = get(key).get();
     bool astr = (child != nullptr && child->isValue());
     return astr ? child->asString(defaultValue) : std::string(defaultValue);
@@ -959,7 +1955,7 @@ const std::string JsonValue::getString (const std::string key, const std::string
  *
  * @return the float value of the child with the specified key.
  */
-float JsonValue::getFloat(const std::string key, float defaultValue) const {
+float JsonValue::getFloat(std::string_view key, float defaultValue) const {
     JsonValue* child = get(key).get();
     bool astr = (child != nullptr && child->isNumber());
     return astr ? child->asFloat(defaultValue) : defaultValue;
@@ -978,7 +1974,7 @@ float JsonValue::getFloat(const std::string key, float defaultValue) const {
  *
  * @return the double value of the child with the specified key.
  */
-double JsonValue::getDouble(const std::string key, double defaultValue) const {
+double JsonValue::getDouble(std::string_view key, double defaultValue) const {
     JsonValue* child = get(key).get();
     bool astr = (child != nullptr && child->isNumber());
     return astr ? child->asFloat(defaultValue) : defaultValue;
@@ -997,7 +1993,7 @@ double JsonValue::getDouble(const std::string key, double defaultValue) const {
  *
  * @return the long value of the child with the specified key.
  */
-long JsonValue::getLong(const std::string key, long defaultValue) const {
+long JsonValue::getLong(std::string_view key, long defaultValue) const {
     JsonValue* child = get(key).get();
     bool astr = (child != nullptr && child->isNumber());
     return astr ? child->asLong(defaultValue) : defaultValue;
@@ -1016,7 +2012,7 @@ long JsonValue::getLong(const std::string key, long defaultValue) const {
  *
  * @return the int value of the child with the specified key.
  */
-int JsonValue::getInt (const std::string key, int defaultValue) const {
+int JsonValue::getInt (std::string_view key, int defaultValue) const {
     JsonValue* child = get(key).get();
     bool astr = (child != nullptr && child->isNumber());
     return astr ? child->asInt(defaultValue) : defaultValue;
@@ -1035,7 +2031,7 @@ int JsonValue::getInt (const std::string key, int defaultValue) const {
  *
  * @return the boolean value of the child with the specified key.
  */
-bool JsonValue::getBool(const std::string key, bool defaultValue) const {
+bool JsonValue::getBool(std::string_view key, bool defaultValue) const {
     JsonValue* child = get(key).get();
     bool astr = (child != nullptr && child->isBool());
     return astr ? child->asBool(defaultValue) : defaultValue;
@@ -1060,6 +2056,7 @@ std::shared_ptr<JsonValue> JsonValue::removeChild(int index) {
     std::shared_ptr<JsonValue> result = _children[index];
     _children.erase(_children.begin() + index);
     result->_parent = nullptr;
+    reindex();
     return result;
 }
 
@@ -1075,17 +2072,13 @@ std::shared_ptr<JsonValue> JsonValue::removeChild(int index) {
  *
  * Returns the child with the specified key and removes it from this node.
  */
-std::shared_ptr<JsonValue> JsonValue::removeChild(const std::string key) {
-    auto jt = _children.end();
-    for(auto it = _children.begin(); jt == _children.end() && it != _children.end(); it++) {
-        if ((*it)->_key == key) {
-            jt = it;
-        }
-    }
-    if (jt != _children.end()) {
-        std::shared_ptr<JsonValue> result = *jt;
-        _children.erase(jt);
+std::shared_ptr<JsonValue> JsonValue::removeChild(std::string_view key) {
+    int pos = search(key);
+    if (pos >= 0) {
+        std::shared_ptr<JsonValue> result = _children[pos];
+        _children.erase(_children.begin() + pos);
         result->_parent = nullptr;
+        reindex();
         return result;
     }
     return nullptr;
@@ -1102,10 +2095,16 @@ std::shared_ptr<JsonValue> JsonValue::removeChild(const std::string key) {
  */
 void JsonValue::merge(const std::shared_ptr<JsonValue>& node) {
     CUAssertLog(_parent != nullptr, "You cannot merge with the root node");
+    JsonValue* previous = node->_parent;
     node->_parent = _parent;
     node->_key = _key;
     _parent->removeChild(_key);
     node->_parent->_children.push_back(node);
+    node->_parent->reindex();
+    // The node may still be listed (under its new key) by its old parent
+    if (previous != nullptr && previous != node->_parent) {
+        previous->reindex();
+    }
 }
 
 
@@ -1131,6 +2130,7 @@ void JsonValue::appendChild(const std::shared_ptr<JsonValue>& child) {
                 "The key %s is already in use", child->key().c_str());
     _children.push_back(child);
     child->_parent = this;
+    reindexLast();
 }
 
 /**
@@ -1156,6 +2156,7 @@ void JsonValue::appendChild(const std::string key, const std::shared_ptr<JsonVal
     child->_key = key;
     _children.push_back(child);
     child->_parent = this;
+    reindexLast();
 }
 
 /**
@@ -1180,6 +2181,7 @@ void JsonValue::insertChild(unsigned int index, const std::shared_ptr<JsonValue>
     CUAssertLog(isArray() || isObject(), "This node is a value type");
     _children.insert(_children.begin()+index,child);
     child->_parent = this;
+    reindex();
 }
 
 /**
@@ -1209,6 +2211,7 @@ void JsonValue::insertChild(unsigned int index, const std::string key,
     child->_key = key;
     _children.insert(_children.begin()+index,child);
     child->_parent = this;
+    reindex();
 }
 
 
@@ -1245,3 +2248,28 @@ std::string JsonValue::toString(bool format) const {
     }
     return "";
 }
+
+/**
+ * Returns the compiled JSON encoding of this JSON.
+ *
+ * Compiled JSON is a compact binary encoding of a JSON tree. It is a four
+ * byte magic number "CUBJ" and a version byte, followed by the root value.
+ * Each value is a one byte tag followed by its contents. Lengths, counts,
+ * and integers are variable length (LEB128), while other numbers are stored
+ * as doubles in network order. Object keys precede each child.
+ *
+ * Providing this encoding to the {@link allocWithBinary} constructor is
+ * guaranteed to make a duplicate of this JSON tree.
+ *
+ * @return the compiled JSON encoding of this JSON.
+ */
+std::vector<std::byte> JsonValue::toBinary() const {
+    std::vector<std::byte> result;
+    const char* magic = BINARY_MAGIC;
+    for(int ii = 0; ii < 4; ii++) {
+        result.push_back((std::byte)magic[ii]);
+    }
+    result.push_back((std::byte)BINARY_VERSION);
+    encode_value(result, this);
+    return result;
+}
@@ -4,7 +4,8 @@
 //
 //  This module provides a specific implementation of the Loader class to load
 //  (non-directory) json assets. It is essentially a wrapper around JsonReader
-//  that allows it to be used with AssetManager.
+//  that allows it to be used with AssetManager. Widget files with the extension
+//  .cubj are loaded as compiled JSON instead.
 //
 //  As with all of our loaders, this loader is designed to be attached to an
 //  asset manager. In addition, this class uses our standard shared-pointer
@@ -44,6 +45,8 @@
 //
 #include <cugl/core/assets/CUWidgetLoader.h>
 #include <cugl/core/io/CUJsonReader.h>
+#include <cugl/core/io/CUBinaryReader.h>
+#include <cugl/core/util/CUStringTools.h>
 #include <cugl/core/util/CUFiletools.h>
 #include <cugl/core/CUApplication.h>
 
@@ -52,6 +55,29 @@ using namespace cugl;
 /** What the source name is if we do not know it */
 #define UNKNOWN_SOURCE  "<unknown>"
 
+/** The file extension for compiled JSON */
+#define BINARY_EXT   ".cubj"
+
+/**
+ * Returns the JSON tree for the given asset file
+ *
+ * If the file has the extension ".cubj", it is assumed to be compiled JSON
+ * (see {@link JsonValue#toBinary}). Compiled JSON is memory mapped and
+ * decoded without any string parsing. Otherwise, the file is parsed as text.
+ *
+ * @param source    The relative path to the asset
+ *
+ * @return the JSON tree for the given asset file
+ */
+static std::shared_ptr<JsonValue> read_json(const std::string source) {
+    if (strtool::ends_with(source, BINARY_EXT)) {
+        std::shared_ptr<BinaryReader> reader = BinaryReader::allocWithMappedAsset(source);
+        return (reader == nullptr ? nullptr : reader->readJson());
+    }
+    std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
+    return (reader == nullptr ? nullptr : reader->readJson());
+}
+
 /**
  * Finishes loading the widget file, cleaning up the wait queues.
  *
@@ -116,21 +142,16 @@ bool WidgetLoader::read(const std::string key, const std::string source, LoaderC
     bool absolute = cugl::filetool::is_absolute(source);
     CUAssertLog(!absolute, "This loader does not accept absolute paths for assets");
 
-    std::string root = Application::get()->getAssetDirectory();
-    std::string path = root+source;
-    
     bool success = false;
     if (_loader == nullptr || !async) {
         enqueue(key);
-        std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(path);
-        std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
+        std::shared_ptr<JsonValue> json = read_json(source);
 		std::shared_ptr<WidgetValue> widget = WidgetValue::alloc(json);
         success = materialize(key,widget,callback);
     } else {
         _loader->addTask([=,this](void) {
             this->enqueue(key);
-            std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(path);
-            std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
+            std::shared_ptr<JsonValue> json = read_json(source);
 			std::shared_ptr<WidgetValue> widget = WidgetValue::alloc(json);
             Application::get()->schedule([=,this](void) {
                 this->materialize(key,widget,callback);
@@ -172,15 +193,13 @@ bool WidgetLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback c
     bool success = false;
     if (_loader == nullptr || !async) {
         enqueue(key);
-        std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
-        std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
+        std::shared_ptr<JsonValue> json = read_json(source);
 		std::shared_ptr<WidgetValue> widget = WidgetValue::alloc(json);
         success = materialize(key,widget,callback);
     } else {
         _loader->addTask([=,this](void) {
             this->enqueue(key);
-            std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
-            std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
+            std::shared_ptr<JsonValue> json = read_json(source);
 			std::shared_ptr<WidgetValue> widget = WidgetValue::alloc(json);
             Application::get()->schedule([=,this](void) {
                 this->materialize(key,widget,callback);
@@ -17,6 +17,10 @@
 //  have proper file systems.  You should confine all files to either the asset
 //  or the save directory.
 //
+//  A reader may optionally memory map its file instead of reading it in chunks.
+//  In that case all reads are simple pointer arithmetic on the mapped file.
+//  Files that cannot be mapped (such as Android assets) fall back to chunks.
+//
 //  This class uses our standard shared-pointer architecture.
 //
 //  1. The constructor does not perform any initialization; it just sets all
@@ -54,7 +58,10 @@
 #include <cugl/core/util/CUDebug.h>
 #include <cugl/core/util/CUEndian.h>
 #include <cugl/core/util/CUFiletools.h>
+#include <cugl/core/assets/CUJsonValue.h>
 #include <cugl/core/CUApplication.h>
+#include <algorithm>
+#include <cstring>
 
 using namespace cugl;
 
@@ -167,6 +174,61 @@ bool BinaryReader::initWithAsset(const std::string file, unsigned int capacity)
     return _ssize >= 0;
 }
 
+/**
+ * Initializes a reader that memory maps the given file.
+ *
+ * Mapping the file removes the chunked reads from the file. All reads are
+ * performed directly on the mapped memory. If the file cannot be mapped,
+ * this reader falls back to reading the file in chunks with the default
+ * buffer capacity. Use {@link #isMapped} to distinguish the two cases.
+ *
+ * If the file is a relative path, this reader will look for the file in
+ * the application save directory {@see Application#getSaveDirectory()}.
+ * If you wish to read a file in any other directory, you must provide
+ * an absolute path.
+ *
+ * @param file  the path (absolute or relative) to the file
+ *
+ * @return true if the reader is initialized properly, false otherwise.
+ */
+bool BinaryReader::initWithMapping(const std::string file) {
+    _name = filetool::normalize_path(file);
+    if (map()) {
+        return true;
+    }
+    return init(file,BUFFSIZE);
+}
+
+/**
+ * Initializes a reader that memory maps the given asset file.
+ *
+ * Mapping the file removes the chunked reads from the file. All reads are
+ * performed directly on the mapped memory. If the file cannot be mapped
+ * (which is always the case for Android assets), this reader falls back
+ * to reading the file in chunks with the default buffer capacity. Use
+ * {@link #isMapped} to distinguish the two cases.
+ *
+ * This initializer assumes that the file name is a relative path. It will
+ * search the application assert directory {@see Application#getAssetDirectory()}
+ * for the file and return false if it cannot find it there.
+ *
+ * @param file  the relative path to the file
+ *
+ * @return true if the reader is initialized properly, false otherwise.
+ */
+bool BinaryReader::initWithMappedAsset(const std::string file) {
+    bool absolute = filetool::is_absolute(file);
+    CUAssertLog(!absolute, "This initializer does not accept absolute paths");
+
+    _name = Application::get()->getAssetDirectory();
+    _name.append(file);
+    _name = filetool::normalize_path(_name);
+    if (map()) {
+        return true;
+    }
+    return initWithAsset(file,BUFFSIZE);
+}
+
 
 #pragma mark -
 #pragma mark Stream Management
@@ -177,15 +239,26 @@ bool BinaryReader::initWithAsset(const std::string file, unsigned int capacity)
  * if the stream has been closed.
  */
 void BinaryReader::reset() {
-    if (_stream) {
+    if (_mapped) {
+        if (_buffer || map()) {
+            _bufoff = 0;
+            return;
+        }
+        // The file can no longer be mapped
+        _mapped = false;
+        _capacity = BUFFSIZE;
+    }
+
+    if (_stream || _buffer) {
         close();
     }
     _stream = SDL_RWFromFile(_name.c_str(), "rb");
     _ssize  = SDL_RWsize(_stream);
     _buffer = new char[_capacity];
     _bufsize = 0;
-    _bufoff  = 0;
+    _bufoff  = -1;
     _scursor = 0;
+    fill();
 }
 
 /**
@@ -195,6 +268,16 @@ void BinaryReader::reset() {
  * on a previously closed stream has no effect.
  */
 void BinaryReader::close() {
+    if (_mapped) {
+        // Keep the mapped flag so that reset can map the file again
+        if (_buffer) {
+            filetool::file_unmap(_buffer, _bufsize);
+            _buffer  = nullptr;
+            _bufsize = 0;
+            _scursor = 0;
+        }
+        return;
+    }
     if (_stream) {
         SDL_RWclose(_stream);
         _stream  = nullptr;
@@ -241,7 +324,7 @@ void BinaryReader::fill(unsigned int bytes) {
     
     if (_bufoff == -1 || _bufoff+bytes > _bufsize) {
         if (_bufoff < _bufsize) {
-            memcpy(_buffer, &(_buffer[_bufoff]), _bufsize-_bufoff);
+            memmove(_buffer, &(_buffer[_bufoff]), _bufsize-_bufoff);
             _bufsize -= _bufoff;
         } else {
             _bufsize = 0;
@@ -254,6 +337,78 @@ void BinaryReader::fill(unsigned int bytes) {
     _scursor += amt;
 }
 
+/**
+ * Maps the file for this reader into memory.
+ *
+ * On success, the buffer is the mapped file and there is no SDL stream.
+ * This method fails if the file cannot be mapped, or if it is too large
+ * to be indexed by the buffer offset.
+ *
+ * @return true if the file was successfully mapped
+ */
+bool BinaryReader::map() {
+    size_t size = 0;
+    const char* data = filetool::file_map(_name, &size);
+    if (data == nullptr) {
+        return false;
+    } else if (size > (size_t)SDL_MAX_SINT32) {
+        filetool::file_unmap(data, size);
+        return false;
+    }
+
+    // The mapping is never written to
+    _buffer   = const_cast<char*>(data);
+    _capacity = (Uint32)size;
+    _bufsize  = (Uint32)size;
+    _bufoff   = 0;
+    _ssize    = (Sint64)size;
+    _scursor  = (Sint64)size;
+    _mapped   = true;
+    return true;
+}
+
+/**
+ * Reads a sequence of marshalled values from the stream.
+ *
+ * This is the shared implementation of the typed array reads. Elements are
+ * copied and marshalled in a single pass over each buffered chunk, which
+ * allows the compiler to vectorize the byte swaps. When the file is memory
+ * mapped, the entire read is one such pass.
+ *
+ * @param buffer    The array to store the data when read
+ * @param maximum   The maximum number of elements to read from the stream
+ * @param offset    The offset to start in the buffer array
+ *
+ * @return the number of elements read from the stream
+ */
+template <typename T>
+size_t BinaryReader::readArray(T* buffer, size_t maximum, size_t offset) {
+    CUAssertLog(ready(), "Attempt to read a finished stream");
+    const unsigned int bytes = sizeof(T);
+    size_t pos = offset;
+    while (pos-offset < maximum && ready(bytes)) {
+        if (_bufsize-_bufoff < bytes) {
+            fill(bytes);
+        }
+        size_t amount = std::min((size_t)(_bufsize-_bufoff)/bytes, maximum-(pos-offset));
+        if (!amount) {
+            break;
+        }
+
+        // Copy and swap together to make a single vectorizable pass
+        const char* source = _buffer+_bufoff;
+        T* target = buffer+pos;
+        for(size_t ii = 0; ii < amount; ii++) {
+            T value;
+            memcpy(&value, source+ii*bytes, bytes);
+            target[ii] = (T)marshall(value);
+        }
+        _bufoff += (Sint32)(amount*bytes);
+        pos += amount;
+    }
+    return pos-offset;
+}
+
 #pragma mark -
 #pragma mark Single Element Reads
 /**
@@ -457,6 +612,9 @@ size_t BinaryReader::read(char* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
     unsigned int pos = (unsigned int)offset;
     while (ready(1) && pos-offset < maximum) {
+        if (_bufoff >= (Sint32)_bufsize) {
+            fill(1);
+        }
         size_t available = _bufsize-_bufoff;
         size_t wanted = maximum-(pos-offset);
         wanted = wanted < available ? wanted : available;
@@ -483,6 +641,9 @@ size_t BinaryReader::read(Uint8* buffer, size_t maximum, size_t offset)  {
     CUAssertLog(ready(), "Attempt to read a finished stream");
     unsigned int pos = (unsigned int)offset;
     while (ready(1) && pos-offset < maximum) {
+        if (_bufoff >= (Sint32)_bufsize) {
+            fill(1);
+        }
         size_t available = _bufsize-_bufoff;
         size_t wanted = maximum-(pos-offset);
         wanted = wanted < available ? wanted : available;
@@ -509,22 +670,7 @@ size_t BinaryReader::read(Uint8* buffer, size_t maximum, size_t offset)  {
  * @return the number of 16 bit signed integers read from the stream
  */
 size_t BinaryReader::read(Sint16* buffer, size_t maximum, size_t offset) {
-    CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 2;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer, maximum, offset);
 }
 
 /**
@@ -543,22 +689,7 @@ size_t BinaryReader::read(Sint16* buffer, size_t maximum, size_t offset) {
  * @return the number of 16 bit unsigned integers read from the stream
  */
 size_t BinaryReader::read(Uint16* buffer, size_t maximum, size_t offset)  {
-    CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 2;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer, maximum, offset);
 }
 
 
@@ -578,22 +709,7 @@ size_t BinaryReader::read(Uint16* buffer, size_t maximum, size_t offset)  {
  * @return the number of 32 bit signed integers read from the stream
  */
 size_t BinaryReader::read(Sint32* buffer, size_t maximum, size_t offset) {
-    CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 4;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer, maximum, offset);
 }
 
 /**
@@ -612,22 +728,7 @@ size_t BinaryReader::read(Sint32* buffer, size_t maximum, size_t offset) {
  * @return the number of 32 bit unsigned integers read from the stream
  */
 size_t BinaryReader::read(Uint32* buffer, size_t maximum, size_t offset) {
-    CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 4;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer, maximum, offset);
 }
 
 /**
@@ -646,22 +747,7 @@ size_t BinaryReader::read(Uint32* buffer, size_t maximum, size_t offset) {
  * @return the number of 32 bit signed integers read from the stream
  */
 size_t BinaryReader::read(Sint64* buffer, size_t maximum, size_t offset) {
-    CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 8;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer, maximum, offset);
 }
 
 /**
@@ -680,22 +766,7 @@ size_t BinaryReader::read(Sint64* buffer, size_t maximum, size_t offset) {
  * @return the number of 32 bit unsigned integers read from the stream
  */
 size_t BinaryReader::read(Uint64* buffer, size_t maximum, size_t offset) {
-    CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 8;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer, maximum, offset);
 }
 
 /**
@@ -714,22 +785,7 @@ size_t BinaryReader::read(Uint64* buffer, size_t maximum, size_t offset) {
  * @return the number of floats read from the stream
  */
 size_t BinaryReader::read(float* buffer, size_t maximum, size_t offset) {
-    CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 4;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer, maximum, offset);
 }
 
 /**
@@ -748,21 +804,39 @@ size_t BinaryReader::read(float* buffer, size_t maximum, size_t offset) {
  * @return the number of doubles read from the stream
  */
 size_t BinaryReader::read(double* buffer, size_t maximum, size_t offset) {
+    return readArray(buffer, maximum, offset);
+}
+
+#pragma mark -
+#pragma mark JSON Reads
+/**
+ * Returns a JSON tree decoded from the rest of the stream.
+ *
+ * The stream must contain compiled JSON, as produced by either
+ * {@link JsonValue#toBinary} or {@link BinaryWriter#writeJson}. This method
+ * consumes the remainder of the stream, so the compiled JSON must come last.
+ *
+ * When the file is memory mapped, the JSON is decoded directly from the
+ * mapped file without any intermediate copies. Either way, no string parsing
+ * is required. This method returns nullptr if the data is not valid.
+ *
+ * @return a JSON tree decoded from the rest of the stream.
+ */
+std::shared_ptr<JsonValue> BinaryReader::readJson() {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 8;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
+    if (_mapped) {
+        // Decode in place
+        const std::byte* data = reinterpret_cast<const std::byte*>(_buffer+_bufoff);
+        size_t size = _bufsize-_bufoff;
+        _bufoff = _bufsize;
+        return JsonValue::allocWithBinary(data, size);
     }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
+
+    size_t remain = (size_t)(_ssize-_scursor);
+    if (_bufoff >= 0) {
+        remain += _bufsize-_bufoff;
     }
-    
-    return pos-offset;
+    std::vector<std::byte> data(remain);
+    size_t size = read(reinterpret_cast<Uint8*>(data.data()), remain);
+    return JsonValue::allocWithBinary(data.data(), size);
 }
-
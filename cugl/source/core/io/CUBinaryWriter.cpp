@@ -17,6 +17,10 @@
 //  have proper file systems.  You should confine all files to either the asset
 //  or the save directory.
 //
+//  Array writes marshall directly into the write buffer, and the buffer may
+//  optionally be flushed by a background thread. For large dumps, a capacity
+//  much larger than the default is recommended.
+//
 //  This class uses our standard shared-pointer architecture.
 //
 //  1. The constructor does not perform any initialization; it just sets all
@@ -54,13 +58,126 @@
 #include <cugl/core/util/CUEndian.h>
 #include <cugl/core/util/CUDebug.h>
 #include <cugl/core/util/CUFiletools.h>
+#include <cugl/core/assets/CUJsonValue.h>
 #include <cugl/core/CUApplication.h>
+#include <algorithm>
 #include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 using namespace cugl;
 
 #define BUFFSIZE 1024
 
+#pragma mark -
+#pragma mark Background Flushing
+namespace cugl {
+
+/**
+ * A background thread for writing the buffers of a {@link BinaryWriter}.
+ *
+ * The flusher owns a spare buffer of the same capacity as the writer. When
+ * the writer fills its buffer, it trades that buffer for the spare. The
+ * thread then writes the full buffer to the file while the writer continues
+ * in the spare. There is never more than one buffer pending.
+ */
+class BinaryFlusher {
+private:
+    /** The SDL I/O stream for writing (owned by the writer) */
+    SDL_RWops* _stream;
+    /** The buffer that is pending or spare */
+    char*  _buffer;
+    /** The number of bytes pending in the buffer */
+    size_t _amount;
+    /** Whether the buffer is pending */
+    bool   _busy;
+    /** Whether the thread should keep running */
+    bool   _active;
+    /** The thread writing the buffer */
+    std::thread _thread;
+    /** The mutex for the buffer state */
+    std::mutex _mutex;
+    /** The condition for a change in the buffer state */
+    std::condition_variable _cond;
+
+    /**
+     * Writes pending buffers until the flusher is stopped.
+     */
+    void run() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            _cond.wait(lock, [this] { return _busy || !_active; });
+            if (!_busy) {
+                return;
+            }
+            lock.unlock();
+            size_t amt = SDL_RWwrite(_stream, _buffer, 1, _amount);
+            CUAssertLog(amt == _amount, "Unable to fully flush the writer");
+            lock.lock();
+            _busy = false;
+            _cond.notify_all();
+        }
+    }
+
+public:
+    /**
+     * Creates a flusher for the given stream and buffer capacity.
+     *
+     * @param stream    The SDL I/O stream for writing
+     * @param capacity  The buffer capacity
+     */
+    BinaryFlusher(SDL_RWops* stream, Uint32 capacity) :
+    _stream(stream), _amount(0), _busy(false), _active(true) {
+        _buffer = new char[capacity];
+        _thread = std::thread(&BinaryFlusher::run, this);
+    }
+
+    /**
+     * Deletes this flusher, writing any pending buffer first.
+     */
+    ~BinaryFlusher() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _active = false;
+        }
+        _cond.notify_all();
+        _thread.join();
+        delete[] _buffer;
+    }
+
+    /**
+     * Returns the spare buffer after taking a full one to write.
+     *
+     * This method blocks until the previous buffer has been written.
+     *
+     * @param buffer    The full buffer
+     * @param amount    The number of bytes in the full buffer
+     *
+     * @return the spare buffer after taking a full one to write.
+     */
+    char* trade(char* buffer, size_t amount) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cond.wait(lock, [this] { return !_busy; });
+        std::swap(_buffer, buffer);
+        _amount = amount;
+        _busy = true;
+        lock.unlock();
+        _cond.notify_all();
+        return buffer;
+    }
+
+    /**
+     * Blocks until any pending buffer has been written.
+     */
+    void wait() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cond.wait(lock, [this] { return !_busy; });
+    }
+};
+
+}
+
 #pragma mark -
 #pragma mark Constructors
 
@@ -124,6 +241,9 @@ bool BinaryWriter::init(const std::string file, unsigned int capacity) {
  * when the buffer fills, or just before the file is closed.
  */
 void BinaryWriter::flush() {
+    if (_flusher) {
+        _flusher->wait();
+    }
     size_t amt = SDL_RWwrite(_stream, _cbuffer, 1, _bufoff);
     CUAssertLog(amt == _bufoff, "Unable to fully flush the writer");
     _bufoff = 0;
@@ -139,6 +259,10 @@ void BinaryWriter::flush() {
 void BinaryWriter::close() {
     if (_stream) {
         flush();
+        if (_flusher) {
+            delete _flusher;
+            _flusher = nullptr;
+        }
         SDL_RWclose(_stream);
         _stream  = nullptr;
     }
@@ -148,6 +272,81 @@ void BinaryWriter::close() {
     }
 }
 
+/**
+ * Sets whether this writer flushes in a background thread.
+ *
+ * In asynchronous mode, a full buffer is written to the file by a background
+ * thread while this writer fills a second buffer. This is useful for large
+ * dumps (such as simulation traces) where the file system would otherwise
+ * stall the writing thread. Asynchronous mode doubles the buffer memory.
+ *
+ * The writer itself is still not thread-safe. Only the flushing happens in
+ * another thread. Disabling asynchronous mode waits for any pending buffer
+ * to be written. This method has no effect on a closed stream.
+ *
+ * @param value Whether to flush in a background thread
+ */
+void BinaryWriter::setAsync(bool value) {
+    if (!_stream || value == (_flusher != nullptr)) {
+        return;
+    } else if (value) {
+        _flusher = new BinaryFlusher(_stream,_capacity);
+    } else {
+        delete _flusher;
+        _flusher = nullptr;
+    }
+}
+
+/**
+ * Empties the write buffer so that it can receive more data.
+ *
+ * In synchronous mode this is the same as {@link #flush}. In asynchronous
+ * mode the full buffer is handed to the background thread, and writing
+ * continues in a second buffer while the first is written to the file.
+ */
+void BinaryWriter::spill() {
+    if (_flusher == nullptr) {
+        flush();
+    } else if (_bufoff > 0) {
+        _cbuffer = _flusher->trade(_cbuffer,_bufoff);
+        _bufoff = 0;
+    }
+}
+
+/**
+ * Writes an array of marshalled values to the binary file.
+ *
+ * This is the shared implementation of the typed array writes. Values are
+ * marshalled straight into the write buffer in a single pass per buffer,
+ * which allows the compiler to vectorize the byte swaps.
+ *
+ * @param array  the array of values to write
+ * @param length the number of values to write
+ * @param offset the initial offset into the array
+ */
+template <typename T>
+void BinaryWriter::writeArray(const T* array, size_t length, size_t offset) {
+    CUAssertLog(_stream, "Attempt to write to a closed stream");
+    const unsigned int bytes = sizeof(T);
+    const T* source = array+offset;
+    while (length > 0) {
+        if (_bufoff+bytes > _capacity) {
+            spill();
+        }
+        size_t amount = std::min(length, (size_t)(_capacity-_bufoff)/bytes);
+
+        // Marshall straight into the buffer in one vectorizable pass
+        char* target = _cbuffer+_bufoff;
+        for(size_t ii = 0; ii < amount; ii++) {
+            auto value = marshall(source[ii]);
+            memcpy(target+ii*bytes, &value, bytes);
+        }
+        _bufoff += (Sint32)(amount*bytes);
+        source += amount;
+        length -= amount;
+    }
+}
+
 
 #pragma mark -
 #pragma mark Single Element Writes
@@ -163,7 +362,7 @@ void BinaryWriter::close() {
 void BinaryWriter::write(char c) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
     if (_bufoff >= _capacity) {
-        flush();
+        spill();
     }
     _cbuffer[_bufoff++] = c;
 }
@@ -180,7 +379,7 @@ void BinaryWriter::write(char c) {
 void BinaryWriter::writeUint8(Uint8 c) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
     if (_bufoff >= _capacity) {
-        flush();
+        spill();
     }
     _cbuffer[_bufoff++] = c;
 }
@@ -200,7 +399,7 @@ void BinaryWriter::writeUint8(Uint8 c) {
 void BinaryWriter::writeSint16(Sint16 n) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
     if (_bufoff+2 > _capacity) {
-        flush();
+        spill();
     }
     
     Sint16* pointer = (Sint16*)(&_cbuffer[_bufoff]);
@@ -223,7 +422,7 @@ void BinaryWriter::writeSint16(Sint16 n) {
 void BinaryWriter::writeUint16(Uint16 n) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
     if (_bufoff+2 > _capacity) {
-        flush();
+        spill();
     }
     
     Uint16* pointer = (Uint16*)(&_cbuffer[_bufoff]);
@@ -246,7 +445,7 @@ void BinaryWriter::writeUint16(Uint16 n) {
 void BinaryWriter::writeSint32(Sint32 n) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
     if (_bufoff+4 > _capacity) {
-        flush();
+        spill();
     }
     
     Sint32* pointer = (Sint32*)(&_cbuffer[_bufoff]);
@@ -269,7 +468,7 @@ void BinaryWriter::writeSint32(Sint32 n) {
 void BinaryWriter::writeUint32(Uint32 n) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
     if (_bufoff+4 > _capacity) {
-        flush();
+        spill();
     }
     
     Uint32* pointer = (Uint32*)(&_cbuffer[_bufoff]);
@@ -292,7 +491,7 @@ void BinaryWriter::writeUint32(Uint32 n) {
 void BinaryWriter::writeSint64(Sint64 n) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
     if (_bufoff+8 > _capacity) {
-        flush();
+        spill();
     }
     
     Sint64* pointer = (Sint64*)(&_cbuffer[_bufoff]);
@@ -315,7 +514,7 @@ void BinaryWriter::writeSint64(Sint64 n) {
 void BinaryWriter::writeUint64(Uint64 n) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
     if (_bufoff+8 > _capacity) {
-        flush();
+        spill();
     }
     
     Uint64* pointer = (Uint64*)(&_cbuffer[_bufoff]);
@@ -339,7 +538,7 @@ void BinaryWriter::writeUint64(Uint64 n) {
 void BinaryWriter::writeFloat(float n) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
     if (_bufoff+4 > _capacity) {
-        flush();
+        spill();
     }
     
     float* pointer = (float*)(&_cbuffer[_bufoff]);
@@ -363,7 +562,7 @@ void BinaryWriter::writeFloat(float n) {
 void BinaryWriter::writeDouble(double n) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
     if (_bufoff+8 > _capacity) {
-        flush();
+        spill();
     }
     
     double* pointer = (double*)(&_cbuffer[_bufoff]);
@@ -388,20 +587,24 @@ void BinaryWriter::writeDouble(double n) {
  */
 void BinaryWriter::write(const char* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    if (_bufoff+length > _capacity) {
+    if (length >= _capacity) {
+        // Write the array directly instead of copying it through the buffer
         flush();
+        size_t amt = SDL_RWwrite(_stream, array+offset, 1, length);
+        CUAssertLog(amt == length, "Unable to fully write the array");
+        return;
     }
-    while (length-pos > _capacity-_bufoff) {
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]),_capacity-_bufoff);
-        pos += _capacity-_bufoff;
-        _bufoff = _capacity;
-        flush();
+
+    size_t pos = 0;
+    while (pos < length) {
+        if (_bufoff >= (Sint32)_capacity) {
+            spill();
+        }
+        size_t amount = std::min(length-pos, (size_t)(_capacity-_bufoff));
+        memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), amount);
+        _bufoff += (Sint32)amount;
+        pos += amount;
     }
-    
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), length-pos);
-    _bufoff += (Sint32)(length-pos);
 }
 
 /**
@@ -417,20 +620,24 @@ void BinaryWriter::write(const char* array, size_t length, size_t offset) {
  */
 void BinaryWriter::write(const Uint8* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-        
-    if (_bufoff+length > _capacity) {
+    if (length >= _capacity) {
+        // Write the array directly instead of copying it through the buffer
         flush();
+        size_t amt = SDL_RWwrite(_stream, array+offset, 1, length);
+        CUAssertLog(amt == length, "Unable to fully write the array");
+        return;
     }
-    while (length-pos > _capacity-_bufoff) {
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]),_capacity-_bufoff);
-        pos += _capacity-_bufoff;
-        _bufoff = _capacity;
-        flush();
+
+    size_t pos = 0;
+    while (pos < length) {
+        if (_bufoff >= (Sint32)_capacity) {
+            spill();
+        }
+        size_t amount = std::min(length-pos, (size_t)(_capacity-_bufoff));
+        memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), amount);
+        _bufoff += (Sint32)amount;
+        pos += amount;
     }
-        
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), length-pos);
-    _bufoff += (Sint32)(length-pos);
 }
 
 /**
@@ -448,35 +655,7 @@ void BinaryWriter::write(const Uint8* array, size_t length, size_t offset) {
  * @param offset the initial offset into the array
  */
 void BinaryWriter::write(const Sint16* array, size_t length, size_t offset) {
-    CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 2;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            Sint16* ref = (Sint16*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        Sint16* ref = (Sint16*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-
-    _bufoff += skip;
+    writeArray(array, length, offset);
 }
 
 /**
@@ -494,35 +673,7 @@ void BinaryWriter::write(const Sint16* array, size_t length, size_t offset) {
  * @param offset the initial offset into the array
  */
 void BinaryWriter::write(const Uint16* array, size_t length, size_t offset) {
-    CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 2;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            Uint16* ref = (Uint16*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        Uint16* ref = (Uint16*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array, length, offset);
 }
 
 /**
@@ -540,35 +691,7 @@ void BinaryWriter::write(const Uint16* array, size_t length, size_t offset) {
  * @param offset the initial offset into the array
  */
 void BinaryWriter::write(const Sint32* array, size_t length, size_t offset) {
-    CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 4;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            Sint32* ref = (Sint32*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        Sint32* ref = (Sint32*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array, length, offset);
 }
 
 
@@ -587,35 +710,7 @@ void BinaryWriter::write(const Sint32* array, size_t length, size_t offset) {
  * @param offset the initial offset into the array
  */
 void BinaryWriter::write(const Uint32* array, size_t length, size_t offset) {
-    CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 4;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            Uint32* ref = (Uint32*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        Uint32* ref = (Uint32*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array, length, offset);
 }
 
 
@@ -634,35 +729,7 @@ void BinaryWriter::write(const Uint32* array, size_t length, size_t offset) {
  * @param offset the initial offset into the array
  */
 void BinaryWriter::write(const Sint64* array, size_t length, size_t offset) {
-    CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 8;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            Sint64* ref = (Sint64*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        Sint64* ref = (Sint64*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array, length, offset);
 }
 
 
@@ -681,35 +748,7 @@ void BinaryWriter::write(const Sint64* array, size_t length, size_t offset) {
  * @param offset the initial offset into the array
  */
 void BinaryWriter::write(const Uint64* array, size_t length, size_t offset) {
-    CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 8;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            Uint64* ref = (Uint64*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        Uint64* ref = (Uint64*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array, length, offset);
 }
 
 
@@ -728,35 +767,7 @@ void BinaryWriter::write(const Uint64* array, size_t length, size_t offset) {
  * @param offset the initial offset into the array
  */
 void BinaryWriter::write(const float* array, size_t length, size_t offset) {
-    CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 4;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            float* ref = (float*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        float* ref = (float*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array, length, offset);
 }
 
 /**
@@ -774,33 +785,27 @@ void BinaryWriter::write(const float* array, size_t length, size_t offset) {
  * @param offset the initial offset into the array
  */
 void BinaryWriter::write(const double* array, size_t length, size_t offset) {
-    CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 8;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            double* ref = (double*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        double* ref = (double*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array, length, offset);
+}
+
+#pragma mark -
+#pragma mark JSON Writes
+/**
+ * Writes the given JSON tree to the binary file as compiled JSON.
+ *
+ * Compiled JSON is a compact binary encoding that can be decoded without any
+ * string parsing. It can be read back with {@link BinaryReader#readJson} or
+ * {@link JsonValue#allocWithBinary}. As {@link BinaryReader#readJson} reads
+ * the remainder of a file, the JSON should be the last thing written.
+ *
+ * The data is written to the internal buffer, but is not necessarily
+ * flushed automatically.  It will be written when the buffer reaches
+ * capacity or the file is closed.
+ *
+ * @param json  the JSON tree to write
+ */
+void BinaryWriter::writeJson(const std::shared_ptr<JsonValue>& json) {
+    CUAssertLog(json, "Attempt to write a null JSON tree");
+    std::vector<std::byte> data = json->toBinary();
+    write(reinterpret_cast<const Uint8*>(data.data()), data.size());
 }
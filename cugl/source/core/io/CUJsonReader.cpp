@@ -6,6 +6,11 @@
 //  It does not require that the entire file conform to JSON standards; it can
 //  read a JSON string embedded in a larger text file.
 //
+//  In addition to reading a complete JSON tree, this module can stream a JSON
+//  value as a sequence of events (start/end of objects and arrays, keys, and
+//  values). Streaming reads the file in chunks, so its memory usage depends
+//  on the nesting depth, not the file size.
+//
 //  By default, this module (and every module in the io package) accesses the
 //  application save directory.  If you want to access another directory, you
 //  will need to specify an absolute path for the file name.  Keep in mind that
@@ -48,9 +53,55 @@
 //
 #include <cugl/core/io/CUJsonReader.h>
 #include <cugl/core/util/CUDebug.h>
+#include <cstring>
+#include <cstdlib>
 
 using namespace cugl;
 
+/**
+ * Returns the value of the given hexadecimal digit (or -1 if invalid)
+ *
+ * @param c     The hexadecimal digit
+ *
+ * @return the value of the given hexadecimal digit (or -1 if invalid)
+ */
+static int hex_digit(int c) {
+    if (c >= '0' && c <= '9') {
+        return c-'0';
+    } else if (c >= 'A' && c <= 'F') {
+        return 10+c-'A';
+    } else if (c >= 'a' && c <= 'f') {
+        return 10+c-'a';
+    }
+    return -1;
+}
+
+/**
+ * Appends the UTF-8 encoding of the given code point to out
+ *
+ * @param out   The string to append to
+ * @param uc    The unicode code point
+ */
+static void utf8_encode(std::string& out, unsigned uc) {
+    if (uc < 0x80) {
+        out.push_back((char)uc);
+    } else if (uc < 0x800) {
+        out.push_back((char)(0xC0 | (uc >> 6)));
+        out.push_back((char)(0x80 | (uc & 0x3F)));
+    } else if (uc < 0x10000) {
+        out.push_back((char)(0xE0 | (uc >> 12)));
+        out.push_back((char)(0x80 | ((uc >> 6) & 0x3F)));
+        out.push_back((char)(0x80 | (uc & 0x3F)));
+    } else {
+        out.push_back((char)(0xF0 | (uc >> 18)));
+        out.push_back((char)(0x80 | ((uc >> 12) & 0x3F)));
+        out.push_back((char)(0x80 | ((uc >> 6) & 0x3F)));
+        out.push_back((char)(0x80 | (uc & 0x3F)));
+    }
+}
+
+#pragma mark -
+#pragma mark Read Methods
 /**
  * Returns the next available JSON string
  *
@@ -69,7 +120,7 @@ std::string JsonReader::readJsonString() {
     skip();
     
     // Make sure first character a bracket
-    CUAssertLog(_sbuffer[_bufoff] == '{', "JSON is missing initial {");
+    CUAssertLog(_view[_bufoff] == '{', "JSON is missing initial {");
     
     int depth = 0;
     std::string data;
@@ -77,21 +128,21 @@ std::string JsonReader::readJsonString() {
     while (ready()) {
         fill();
         int pos = 0;
-        for(auto it = _sbuffer.begin()+_bufoff; it != _sbuffer.end(); ++it) {
+        for(auto it = _view.begin()+_bufoff; it != _view.end(); ++it) {
             if (*it == '{') {
                 depth++;
             } else if (*it == '}') {
                 depth--;
             }
             if (depth == 0) {
-                data.append(_sbuffer.begin()+_bufoff,it+1);
+                data.append(_view.begin()+_bufoff,it+1);
                 _bufoff += pos+1;
                 return data;
             }
             pos++;
         }
-        data.append(_sbuffer.begin()+_bufoff,_sbuffer.end());
-        _bufoff =  (int)_sbuffer.size();
+        data.append(_view.begin()+_bufoff,_view.end());
+        _bufoff =  (int)_view.size();
     }
     CUAssertLog(false, "JSON is missing closing }");
     return "";
@@ -116,3 +167,348 @@ std::shared_ptr<JsonValue> JsonReader::readJson() {
     }
     return nullptr;
 }
+
+#pragma mark -
+#pragma mark Event Parsing
+/**
+ * Returns the next character of the stream without consuming it.
+ *
+ * This method refills the buffer as necessary. It returns -1 if there
+ * are no more characters in the stream.
+ *
+ * @return the next character of the stream without consuming it.
+ */
+int JsonReader::peekChar() {
+    if (_bufoff < 0 || (size_t)_bufoff >= _view.size()) {
+        fill();
+        if (_bufoff < 0 || (size_t)_bufoff >= _view.size()) {
+            return -1;
+        }
+    }
+    return (unsigned char)_view[_bufoff];
+}
+
+/**
+ * Returns the next non-whitespace character without consuming it.
+ *
+ * All whitespace before that character is consumed. This method returns
+ * -1 if there are no more characters in the stream.
+ *
+ * @return the next non-whitespace character without consuming it.
+ */
+int JsonReader::peekToken() {
+    int c = peekChar();
+    while (c >= 0 && c <= 32) {
+        _bufoff++;
+        c = peekChar();
+    }
+    return c;
+}
+
+/**
+ * Reads a quoted JSON string into the given buffer.
+ *
+ * The stream must be positioned at the opening quote. All escape
+ * sequences are decoded.
+ *
+ * @param out   The buffer to store the string
+ *
+ * @return true if the string was read successfully
+ */
+bool JsonReader::readQuoted(std::string& out) {
+    out.clear();
+    _bufoff++;
+    while (peekChar() >= 0) {
+        // Copy runs of unescaped characters directly from the buffer
+        size_t start = _bufoff;
+        size_t end = start;
+        while (end < _view.size() && _view[end] != '\"' && _view[end] != '\\') {
+            end++;
+        }
+        out.append(_view, start, end-start);
+        _bufoff = (Sint32)end;
+        if (end == _view.size()) {
+            continue;
+        } else if (_view[end] == '\"') {
+            _bufoff++;
+            return true;
+        }
+        
+        _bufoff++;
+        int c = peekChar();
+        _bufoff++;
+        switch (c) {
+            case 'b':
+                out.push_back('\b');
+                break;
+            case 'f':
+                out.push_back('\f');
+                break;
+            case 'n':
+                out.push_back('\n');
+                break;
+            case 'r':
+                out.push_back('\r');
+                break;
+            case 't':
+                out.push_back('\t');
+                break;
+            case '\"':
+            case '\\':
+            case '/':
+                out.push_back((char)c);
+                break;
+            case 'u':
+            {
+                // Transcode UTF-16 (with surrogate pairs) to UTF-8
+                unsigned code[2] = {0, 0};
+                int units = 1;
+                for(int ii = 0; ii < units; ii++) {
+                    if (ii > 0) {
+                        if (peekChar() != '\\') {
+                            return false;
+                        }
+                        _bufoff++;
+                        if (peekChar() != 'u') {
+                            return false;
+                        }
+                        _bufoff++;
+                    }
+                    for(int jj = 0; jj < 4; jj++) {
+                        int digit = hex_digit(peekChar());
+                        if (digit < 0) {
+                            return false;
+                        }
+                        code[ii] = (code[ii] << 4) | digit;
+                        _bufoff++;
+                    }
+                    if (ii == 0 && code[0] >= 0xD800 && code[0] <= 0xDBFF) {
+                        units = 2;
+                    }
+                }
+                
+                unsigned uc = code[0];
+                if (uc == 0 || (uc >= 0xDC00 && uc <= 0xDFFF)) {
+                    return false;
+                } else if (units == 2) {
+                    if (code[1] < 0xDC00 || code[1] > 0xDFFF) {
+                        return false;
+                    }
+                    uc = 0x10000 + (((uc & 0x3FF) << 10) | (code[1] & 0x3FF));
+                }
+                utf8_encode(out,uc);
+            }
+                break;
+            default:
+                return false;
+        }
+    }
+    return false;
+}
+
+/**
+ * Returns the event for the value starting with the given character.
+ *
+ * @param c     The first character of the value
+ *
+ * @return the event for the value starting with the given character.
+ */
+JsonReader::Event JsonReader::readValueEvent(int c) {
+    if (c == '{') {
+        _bufoff++;
+        _scopes.push_back('{');
+        _state = State::FIRST_KEY;
+        return Event::BEGIN_OBJECT;
+    } else if (c == '[') {
+        _bufoff++;
+        _scopes.push_back('[');
+        _state = State::FIRST_ITEM;
+        return Event::BEGIN_ARRAY;
+    } else if (c == '\"') {
+        if (!readQuoted(_token)) {
+            return fail("Invalid JSON string");
+        }
+        _eventValue.set(_token);
+    } else if (c == '-' || (c >= '0' && c <= '9')) {
+        _token.clear();
+        while (c >= 0 && (strchr("+-.eE", c) || (c >= '0' && c <= '9'))) {
+            _token.push_back((char)c);
+            _bufoff++;
+            c = peekChar();
+        }
+        // The whole token must be consumed, so 1-2 or 3e are rejected
+        char* end = nullptr;
+        double value = std::strtod(_token.c_str(), &end);
+        if (end != _token.c_str()+_token.size()) {
+            return fail("Invalid JSON number");
+        }
+        _eventValue.set(value);
+    } else if (c >= 'a' && c <= 'z') {
+        _token.clear();
+        while (c >= 'a' && c <= 'z') {
+            _token.push_back((char)c);
+            _bufoff++;
+            c = peekChar();
+        }
+        if (_token == "true" || _token == "false") {
+            _eventValue.set(_token == "true");
+        } else if (_token == "null") {
+            _eventValue.setNull();
+        } else {
+            return fail("Invalid JSON literal");
+        }
+    } else {
+        return fail(c < 0 ? "Unexpected end of JSON" : "Invalid JSON value");
+    }
+    
+    _state = _scopes.empty() ? State::DONE : State::NEXT;
+    return Event::VALUE;
+}
+
+/**
+ * Returns the event for the key starting with the given character.
+ *
+ * This method consumes the colon after the key.
+ *
+ * @param c     The first character of the key
+ *
+ * @return the event for the key starting with the given character.
+ */
+JsonReader::Event JsonReader::readKeyEvent(int c) {
+    if (c != '\"' || !readQuoted(_eventKey)) {
+        return fail("Invalid JSON key");
+    }
+    if (peekToken() != ':') {
+        return fail("JSON key is missing ':'");
+    }
+    _bufoff++;
+    _state = State::VALUE;
+    return Event::KEY;
+}
+
+/**
+ * Returns the event closing the current array or object.
+ *
+ * @param event The event to return (END_ARRAY or END_OBJECT)
+ *
+ * @return the event closing the current array or object.
+ */
+JsonReader::Event JsonReader::closeScope(Event event) {
+    _bufoff++;
+    _scopes.pop_back();
+    _state = _scopes.empty() ? State::DONE : State::NEXT;
+    return event;
+}
+
+/**
+ * Returns the ERROR event, recording the given message.
+ *
+ * @param message   The error message
+ *
+ * @return the ERROR event
+ */
+JsonReader::Event JsonReader::fail(const char* message) {
+    _state = State::FAILED;
+    CUAssertLog(false, "%s in %s", message, _name.c_str());
+    return Event::ERROR;
+}
+
+#pragma mark -
+#pragma mark Streaming
+/**
+ * Returns the next event of the streamed JSON value.
+ *
+ * The first call starts a new JSON value at the current position. The
+ * value may be any JSON type, not just an object. Subsequent calls
+ * report the contents of that value in order. Once the value is complete,
+ * this method returns END, and the next call will start a new value. It
+ * also returns END if there is no more input.
+ *
+ * For KEY events, the key is available with {@link #getEventKey}. For
+ * VALUE events, the value is available with {@link #getEventValue}. Only
+ * the most recent key and value are stored, so memory usage is bounded
+ * by the nesting depth, not the file size.
+ *
+ * If the JSON is malformed, this method returns ERROR, and it will
+ * continue to do so until the reader is reset. Detailed information
+ * about the parsing error will be passed to an assert.  Hence error
+ * messages are suppressed if asserts are turned off.
+ *
+ * It is safe to mix this method with the other read methods, but only
+ * between JSON values (e.g. after an END event).
+ *
+ * @return the next event of the streamed JSON value.
+ */
+JsonReader::Event JsonReader::readEvent() {
+    // A negative offset means the stream was reset
+    if (_bufoff < 0) {
+        _scopes.clear();
+        _state = State::START;
+    }
+    
+    int c;
+    switch (_state) {
+        case State::FAILED:
+            return Event::ERROR;
+        case State::DONE:
+            _state = State::START;
+            return Event::END;
+        case State::START:
+            c = peekToken();
+            if (c < 0) {
+                return Event::END;
+            }
+            return readValueEvent(c);
+        case State::VALUE:
+            return readValueEvent(peekToken());
+        case State::FIRST_ITEM:
+            c = peekToken();
+            if (c == ']') {
+                return closeScope(Event::END_ARRAY);
+            }
+            return readValueEvent(c);
+        case State::FIRST_KEY:
+            c = peekToken();
+            if (c == '}') {
+                return closeScope(Event::END_OBJECT);
+            }
+            return readKeyEvent(c);
+        case State::KEY:
+            return readKeyEvent(peekToken());
+        case State::NEXT:
+            c = peekToken();
+            if (c == ',') {
+                _bufoff++;
+                c = peekToken();
+                return _scopes.back() == '{' ? readKeyEvent(c) : readValueEvent(c);
+            } else if (c == '}' && _scopes.back() == '{') {
+                return closeScope(Event::END_OBJECT);
+            } else if (c == ']' && _scopes.back() == '[') {
+                return closeScope(Event::END_ARRAY);
+            }
+            return fail(c < 0 ? "Unexpected end of JSON" : "Expected ',' or closing bracket");
+    }
+    return Event::ERROR;
+}
+
+/**
+ * Streams the next JSON value to the given handler.
+ *
+ * This method calls {@link #readEvent} until the JSON value is complete,
+ * passing each event to the handler. The handler is not called for the
+ * final END event. Streaming stops early if the handler returns false.
+ *
+ * @param handler   The handler for each event
+ *
+ * @return true if the entire value was streamed without error
+ */
+bool JsonReader::streamJson(EventHandler handler) {
+    Event event = readEvent();
+    while (event != Event::END && event != Event::ERROR) {
+        if (!handler(event)) {
+            return false;
+        }
+        event = readEvent();
+    }
+    return event == Event::END;
+}
@@ -13,6 +13,10 @@
 //  have proper file systems.  You should confine all files to either the asset
 //  or the save directory.
 //
+//  A reader may optionally memory map its file instead of reading it in chunks.
+//  In that case all reads are performed directly on the mapped file. Files that
+//  cannot be mapped (such as Android assets) fall back to chunks.
+//
 //  This class uses our standard shared-pointer architecture.
 //
 //  1. The constructor does not perform any initialization; it just sets all
@@ -164,6 +168,63 @@ bool TextReader::initWithAsset(const std::string file, unsigned int capacity) {
     return _ssize >= 0;
 }
 
+/**
+ * Initializes a reader that memory maps the given file.
+ *
+ * Mapping the file removes the chunked reads from the file. All reads are
+ * performed directly on the mapped memory. If the file cannot be mapped,
+ * this reader falls back to reading the file in chunks with the default
+ * buffer capacity. Use {@link #isMapped} to distinguish the two cases.
+ *
+ * If the file is a relative path, this reader will look for the file in
+ * the application save directory {@see Application#getSaveDirectory()}.
+ * If you wish to read a file in any other directory, you must provide
+ * an absolute path.
+ *
+ * @param file  the path (absolute or relative) to the file
+ *
+ * @return true if the reader is initialized properly, false otherwise.
+ */
+bool TextReader::initWithMapping(const std::string file) {
+    _name = filetool::normalize_path(file);
+    if (map()) {
+        fill();
+        return true;
+    }
+    return init(file,BUFFSIZE);
+}
+
+/**
+ * Initializes a reader that memory maps the given asset file.
+ *
+ * Mapping the file removes the chunked reads from the file. All reads are
+ * performed directly on the mapped memory. If the file cannot be mapped
+ * (which is always the case for Android assets), this reader falls back
+ * to reading the file in chunks with the default buffer capacity. Use
+ * {@link #isMapped} to distinguish the two cases.
+ *
+ * This initializer assumes that the file name is a relative path. It will
+ * search the application assert directory {@see Application#getAssetDirectory()}
+ * for the file and return false if it cannot find it there.
+ *
+ * @param file  the relative path to the file
+ *
+ * @return true if the reader is initialized properly, false otherwise.
+ */
+bool TextReader::initWithMappedAsset(const std::string file) {
+    bool absolute = filetool::is_absolute(file);
+    CUAssertLog(!absolute, "This initializer does not accept absolute paths");
+
+    _name = Application::get()->getAssetDirectory();
+    _name.append(file);
+    _name = filetool::normalize_path(_name);
+    if (map()) {
+        fill();
+        return true;
+    }
+    return initWithAsset(file,BUFFSIZE);
+}
+
 
 #pragma mark -
 #pragma mark Stream Management
@@ -174,13 +235,25 @@ bool TextReader::initWithAsset(const std::string file, unsigned int capacity) {
  * if the stream has been closed.
  */
 void TextReader::reset() {
-    if (_stream) {
+    if (_mapped) {
+        if (_view.data() || map()) {
+            _bufoff  = -1;
+            _scursor = 0;
+            return;
+        }
+        // The file can no longer be mapped
+        _mapped = false;
+        _capacity = BUFFSIZE;
+    }
+
+    if (_stream || _cbuffer) {
         close();
     }
     _stream = SDL_RWFromFile(_name.c_str(), "r");
     _ssize  = SDL_RWsize(_stream);
     _cbuffer = new char[_capacity];
     _sbuffer.clear();
+    _view = _sbuffer;
     _bufoff  = -1;
     _scursor = 0;
 }
@@ -192,6 +265,15 @@ void TextReader::reset() {
  * on a previously closed stream has no effect.
  */
 void TextReader::close() {
+    if (_mapped) {
+        // Keep the mapped flag so that reset can map the file again
+        if (_view.data()) {
+            filetool::file_unmap(_view.data(), _view.size());
+            _view = std::string_view();
+            _scursor = 0;
+        }
+        return;
+    }
     if (_stream) {
         SDL_RWclose(_stream);
         _stream  = nullptr;
@@ -210,7 +292,14 @@ void TextReader::close() {
  * to read from the file in predefined chunks.
  */
 void TextReader::fill() {
-    if (!_bufoff || !_stream || _scursor == _ssize) {
+    if (_mapped) {
+        // The whole file is already available
+        if (_bufoff < 0) {
+            _bufoff  = 0;
+            _scursor = _ssize;
+        }
+        return;
+    } else if (!_bufoff || !_stream || _scursor == _ssize) {
         return;
     } else if (_bufoff > 0) {
 		_sbuffer.erase(_sbuffer.begin(), _sbuffer.begin() + _bufoff);
@@ -219,9 +308,38 @@ void TextReader::fill() {
     _bufoff = 0;
     size_t amt = SDL_RWread(_stream, _cbuffer, 1, _capacity-_sbuffer.size());
     _sbuffer.append(_cbuffer,amt);
+    _view = _sbuffer;
     _scursor += amt;
 }
 
+/**
+ * Maps the file for this reader into memory.
+ *
+ * On success, the read buffer views the mapped file and there is no SDL
+ * stream. This method fails if the file cannot be mapped, or if it is too
+ * large to be indexed by the buffer offset.
+ *
+ * @return true if the file was successfully mapped
+ */
+bool TextReader::map() {
+    size_t size = 0;
+    const char* data = filetool::file_map(_name, &size);
+    if (data == nullptr) {
+        return false;
+    } else if (size > (size_t)SDL_MAX_SINT32) {
+        filetool::file_unmap(data, size);
+        return false;
+    }
+
+    // The cursor is not advanced until the first fill
+    _view    = std::string_view(data, size);
+    _ssize   = (Sint64)size;
+    _scursor = 0;
+    _bufoff  = -1;
+    _mapped  = true;
+    return true;
+}
+
 #pragma mark -
 #pragma mark Read Methods
 /**
@@ -254,11 +372,11 @@ char TextReader::read() {
  */
 std::string& TextReader::read(std::string& data) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff >= _sbuffer.size()) {
+    if ((size_t)_bufoff >= _view.size()) {
         fill();
     }
 
-    data.push_back(_sbuffer[_bufoff++]);
+    data.push_back(_view[_bufoff++]);
     return data;
 }
 
@@ -291,16 +409,16 @@ std::string TextReader::readUTF8() {
  */
 std::string& TextReader::readUTF8(std::string& data) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff+3 >= _sbuffer.size()) { // Need a full UTF8 sequence
+    if (_bufoff < 0 || (size_t)_bufoff+3 >= _view.size()) { // Need a full UTF8 sequence
         fill();
     }
     
     size_t orig = data.size();
     
-    std::string::iterator start = _sbuffer.begin()+_bufoff;
-    utf8::next(start,_sbuffer.end());
+    std::string_view::const_iterator start = _view.begin()+_bufoff;
+    utf8::next(start,_view.end());
     
-    data.append(_sbuffer.begin()+_bufoff,start);
+    data.append(_view.begin()+_bufoff,start);
     _bufoff += (Sint32)(data.size()-orig);
     
     return data;
@@ -340,21 +458,23 @@ std::string TextReader::readLine() {
  */
 std::string& TextReader::readLine(std::string& data) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff >= _sbuffer.size()) {
+    if ((size_t)_bufoff >= _view.size()) {
         fill();
     }
     
     bool found = false;
     while (!found) {
-        size_t pos = _sbuffer.find('\n',_bufoff);
+        size_t pos = _view.find('\n',_bufoff);
         if (pos != std::string::npos) {
-            data.append(_sbuffer.begin()+_bufoff,_sbuffer.begin()+pos);
+            data.append(_view.begin()+_bufoff,_view.begin()+pos);
             _bufoff = (Sint32)(pos+1);
             found = true;
         } else {
-            data.append(_sbuffer.begin()+_bufoff,_sbuffer.end());
-            _bufoff = (Sint32)_sbuffer.size();
+            data.append(_view.begin()+_bufoff,_view.end());
+            _bufoff = (Sint32)_view.size();
             fill();
+            // The file may end without a newline
+            found = (size_t)_bufoff >= _view.size();
         }
     }
     return data;
@@ -388,13 +508,13 @@ std::string TextReader::readAll() {
  */
 std::string& TextReader::readAll(std::string& data) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff >= _sbuffer.size()) {
+    if ((size_t)_bufoff >= _view.size()) {
         fill();
     }
     
     while (ready()) {
-        data.append(_sbuffer.begin()+_bufoff,_sbuffer.end());
-        _bufoff = (Sint32)_sbuffer.size();
+        data.append(_view.begin()+_bufoff,_view.end());
+        _bufoff = (Sint32)_view.size();
         fill();
     }
     return data;
@@ -408,14 +528,14 @@ std::string& TextReader::readAll(std::string& data) {
  */
 void TextReader::skip() {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff >= _sbuffer.size()) {
+    if ((size_t)_bufoff >= _view.size()) {
         fill();
     }
     
     bool found = false;
-    while (isspace(_sbuffer[_bufoff]) && !found) {
+    while (isspace(_view[_bufoff]) && !found) {
         _bufoff++;
-        if (_bufoff >= _sbuffer.size()) {
+        if ((size_t)_bufoff >= _view.size()) {
             if (ready()) {
                 fill();
             } else {
@@ -0,0 +1,528 @@
+//
+//  CUBatchTriangulator.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module is a factory for triangulating many polygons at once. The
+//  triangulators EarclipTriangulator and DelaunayTriangulator process a single
+//  polygon on the calling thread. That is too slow for tessellating a large
+//  collection of shapes, such as the vector art of a level. This factory
+//  packs all of the shapes into a single vertex buffer, and triangulates them
+//  in parallel on a thread pool. The results are packed into a single index
+//  buffer, so that the entire batch may be drawn as one mesh.
+//
+//  Because math objects are intended to be on the stack, we do not provide
+//  any shared pointer support in this class.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty. In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+//
+#include <cugl/core/math/polygon/CUBatchTriangulator.h>
+#include <cugl/core/math/polygon/CUEarclipTriangulator.h>
+#include <cugl/core/math/polygon/CUDelaunayTriangulator.h>
+#include <cugl/core/math/CUPoly2.h>
+#include <cugl/core/math/CUPath2.h>
+#include <cugl/core/util/CUThreadPool.h>
+#include <cugl/core/util/CUDebug.h>
+#include <algorithm>
+#include <cstring>
+
+using namespace cugl;
+
+/**
+ * Triangulates a single polygon, appending the indices to buffer
+ *
+ * The triangulator is cleared before use, but it retains its internal
+ * buffers. So reusing a triangulator for many polygons avoids most of
+ * the allocation.
+ *
+ * @param triangulator  The triangulator to use
+ * @param verts         The polygon vertices (hull followed by holes)
+ * @param hullsize      The number of vertices in the hull
+ * @param holes         The size of each hole
+ * @param holesize      The number of holes
+ * @param buffer        The buffer to store the triangle indices
+ *
+ * @return the number of indices added to the buffer
+ */
+template <typename T>
+static size_t triangulate_shape(T& triangulator, const Vec2* verts, size_t hullsize,
+                                const size_t* holes, size_t holesize,
+                                std::vector<Uint32>& buffer) {
+    triangulator.clear();
+    triangulator.set(verts,hullsize);
+    const Vec2* curr = verts+hullsize;
+    for(size_t ii = 0; ii < holesize; ii++) {
+        triangulator.addHole(curr,holes[ii]);
+        curr += holes[ii];
+    }
+    triangulator.calculate();
+    return triangulator.getTriangulation(buffer);
+}
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Creates a batch triangulator with no polygons.
+ *
+ * The triangulator has no thread pool, so all calculation is performed
+ * on the calling thread.
+ */
+BatchTriangulator::BatchTriangulator() :
+_pool(nullptr),
+_method(Method::EARCLIP),
+_calculated(false) {
+}
+
+/**
+ * Creates a batch triangulator with no polygons, using the given pool.
+ *
+ * The calculation will be shared between the workers of the thread pool
+ * and the calling thread. The pool may be shared with other systems, but
+ * calculate must not be called from a task of this same pool.
+ *
+ * @param pool  The thread pool for the calculation
+ */
+BatchTriangulator::BatchTriangulator(const std::shared_ptr<ThreadPool>& pool) :
+_pool(pool),
+_method(Method::EARCLIP),
+_calculated(false) {
+}
+
+/**
+ * Deletes this triangulator, releasing all resources.
+ */
+BatchTriangulator::~BatchTriangulator() {
+}
+
+#pragma mark -
+#pragma mark Initialization
+/**
+ * Adds a polygon with the given exterior hull to the batch.
+ *
+ * The vertices should define the hull in a counter-clockwise traversal.
+ * Holes for this polygon may be added afterwards with {@link addHole}.
+ * The vertex data is copied. The triangulator does not retain any
+ * references to the original data.
+ *
+ * @param points    The exterior hull vertices
+ * @param size      The number of vertices
+ *
+ * @return the index of the new polygon in the batch
+ */
+size_t BatchTriangulator::addPath(const Vec2* points, size_t size) {
+    Shape shape;
+    shape.vertstart = _input.size();
+    shape.hullsize  = size;
+    shape.holestart = _holes.size();
+    shape.holesize  = 0;
+    _shapes.push_back(shape);
+    _input.insert(_input.end(), points, points+size);
+    return _shapes.size()-1;
+}
+
+/**
+ * Adds a polygon with the given exterior hull to the batch.
+ *
+ * The path should be closed, and define the hull in a counter-clockwise
+ * traversal. Holes for this polygon may be added afterwards with
+ * {@link addHole}. The vertex data is copied. The triangulator does not
+ * retain any references to the original data.
+ *
+ * @param path      The exterior hull
+ *
+ * @return the index of the new polygon in the batch
+ */
+size_t BatchTriangulator::addPath(const Path2& path) {
+    return addPath(path.vertices.data(), path.vertices.size());
+}
+
+/**
+ * Adds a polygon for each of the given exterior hulls to the batch.
+ *
+ * Each path should be closed, and define a hull in a counter-clockwise
+ * traversal. The polygons are added in order, and so their indices are
+ * consecutive. This method reserves space for all of the vertices at once,
+ * so it is faster than adding the paths individually.
+ *
+ * @param paths     The exterior hulls
+ * @param size      The number of hulls
+ */
+void BatchTriangulator::addPaths(const Path2* paths, size_t size) {
+    size_t total = 0;
+    for(size_t ii = 0; ii < size; ii++) {
+        total += paths[ii].vertices.size();
+    }
+    reserve(_shapes.size()+size, _input.size()+total);
+    for(size_t ii = 0; ii < size; ii++) {
+        addPath(paths[ii].vertices.data(), paths[ii].vertices.size());
+    }
+}
+
+/**
+ * Adds the given hole to the most recently added polygon.
+ *
+ * The hole is assumed to be a closed path with no self-crossings. In
+ * addition, it is assumed to be inside the polygon hull, with vertices
+ * ordered in clockwise traversal. If any of these is not true, the results
+ * are undefined. The vertex data is copied.
+ *
+ * @param points    The hole vertices
+ * @param size      The number of vertices
+ */
+void BatchTriangulator::addHole(const Vec2* points, size_t size) {
+    CUAssertLog(!_shapes.empty(), "There is no polygon for this hole");
+    _holes.push_back(size);
+    _shapes.back().holesize++;
+    _input.insert(_input.end(), points, points+size);
+}
+
+/**
+ * Adds the given hole to the most recently added polygon.
+ *
+ * The hole path should be closed, with no self-crossings. In addition, it
+ * is assumed to be inside the polygon hull, with vertices ordered in
+ * clockwise traversal. If any of these is not true, the results are
+ * undefined. The vertex data is copied.
+ *
+ * @param path      The hole path
+ */
+void BatchTriangulator::addHole(const Path2& path) {
+    addHole(path.vertices.data(), path.vertices.size());
+}
+
+/**
+ * Reserves space for the given number of polygons and vertices
+ *
+ * This method is an optimization to avoid reallocation when the size of
+ * the batch is known ahead of time.
+ *
+ * @param shapes    The number of polygons
+ * @param vertices  The total number of vertices (including holes)
+ */
+void BatchTriangulator::reserve(size_t shapes, size_t vertices) {
+    _shapes.reserve(shapes);
+    _input.reserve(vertices);
+}
+
+#pragma mark -
+#pragma mark Calculation
+/**
+ * Clears the triangulation results, but still maintains the polygons.
+ */
+void BatchTriangulator::reset() {
+    _output.clear();
+    _ranges.clear();
+    _calculated = false;
+}
+
+/**
+ * Clears all internal data, including the polygons.
+ *
+ * The buffers are retained for reuse by the next batch.
+ */
+void BatchTriangulator::clear() {
+    reset();
+    _input.clear();
+    _shapes.clear();
+    _holes.clear();
+}
+
+/**
+ * Performs a triangulation of all of the polygons in the batch.
+ *
+ * If this triangulator has a thread pool, the work is shared between the
+ * pool workers and the calling thread. In either case, this method blocks
+ * until all polygons are triangulated.
+ */
+void BatchTriangulator::calculate() {
+    reset();
+    CUAssertLog(_input.size() <= 0xFFFFFFFF, "Batch has too many vertices for 32 bit indices");
+    _ranges.resize(_shapes.size()+1,0);
+    if (_shapes.empty()) {
+        _calculated = true;
+        return;
+    }
+
+    partition();
+    size_t blocks = _blocks.size()-1;
+    if (_scratch.size() < blocks) {
+        _scratch.resize(blocks);
+        _earclip.resize(blocks);
+        _delaunay.resize(blocks);
+    }
+    // Allocate the triangulators here, as the workers must not resize
+    for(size_t ii = 0; ii < blocks; ii++) {
+        if (_method == Method::DELAUNAY && _delaunay[ii] == nullptr) {
+            _delaunay[ii] = std::make_unique<DelaunayTriangulator>();
+        } else if (_method != Method::DELAUNAY && _earclip[ii] == nullptr) {
+            _earclip[ii] = std::make_unique<EarclipTriangulator>();
+        }
+    }
+
+    bool parallel = _pool != nullptr && blocks > 1;
+    if (parallel) {
+        _pool->parallelFor(blocks, [this](size_t begin, size_t end) {
+            triangulate(begin,end);
+        });
+    } else {
+        triangulate(0,blocks);
+    }
+
+    // Each polygon knows its size; now find its offset
+    for(size_t ii = 0; ii < _shapes.size(); ii++) {
+        _ranges[ii+1] += _ranges[ii];
+    }
+
+    // Pack the blocks into the output buffer
+    _output.resize(_ranges.back());
+    auto pack = [this](size_t begin, size_t end) {
+        for(size_t ii = begin; ii < end; ii++) {
+            const std::vector<Uint32>& block = _scratch[ii];
+            if (!block.empty()) {
+                std::memcpy(_output.data()+_ranges[_blocks[ii]], block.data(),
+                            block.size()*sizeof(Uint32));
+            }
+        }
+    };
+    if (parallel) {
+        _pool->parallelFor(blocks, pack);
+    } else {
+        pack(0,blocks);
+    }
+    _calculated = true;
+}
+
+#pragma mark -
+#pragma mark Materialization
+/**
+ * Returns the position of the first vertex of the given polygon
+ *
+ * This is a position in the packed vertex buffer {@link getVertices}.
+ *
+ * @param shape The polygon index
+ *
+ * @return the position of the first vertex of the given polygon
+ */
+size_t BatchTriangulator::getVertexOffset(size_t shape) const {
+    CUAssertLog(shape < _shapes.size(), "Polygon %zu is out of bounds",shape);
+    return _shapes[shape].vertstart;
+}
+
+/**
+ * Returns the number of vertices of the given polygon (including holes)
+ *
+ * @param shape The polygon index
+ *
+ * @return the number of vertices of the given polygon (including holes)
+ */
+size_t BatchTriangulator::getVertexCount(size_t shape) const {
+    CUAssertLog(shape < _shapes.size(), "Polygon %zu is out of bounds",shape);
+    size_t end = shape+1 < _shapes.size() ? _shapes[shape+1].vertstart : _input.size();
+    return end-_shapes[shape].vertstart;
+}
+
+/**
+ * Returns the position of the first index of the given polygon
+ *
+ * This is a position in the packed index buffer {@link getIndices}. If
+ * the calculation is not yet performed, this method returns 0.
+ *
+ * @param shape The polygon index
+ *
+ * @return the position of the first index of the given polygon
+ */
+size_t BatchTriangulator::getIndexOffset(size_t shape) const {
+    CUAssertLog(shape < _shapes.size(), "Polygon %zu is out of bounds",shape);
+    return _calculated ? _ranges[shape] : 0;
+}
+
+/**
+ * Returns the number of triangle indices of the given polygon
+ *
+ * This value is three times the number of triangles. If the calculation
+ * is not yet performed, this method returns 0.
+ *
+ * @param shape The polygon index
+ *
+ * @return the number of triangle indices of the given polygon
+ */
+size_t BatchTriangulator::getIndexCount(size_t shape) const {
+    CUAssertLog(shape < _shapes.size(), "Polygon %zu is out of bounds",shape);
+    return _calculated ? _ranges[shape+1]-_ranges[shape] : 0;
+}
+
+/**
+ * Returns a polygon representing the triangulation of the given shape.
+ *
+ * The polygon contains the vertices of the exterior hull and any holes,
+ * and its indices are relative to these vertices (not the packed buffer).
+ * If the calculation is not yet performed, this method will return the
+ * empty polygon.
+ *
+ * @param shape The polygon index
+ *
+ * @return a polygon representing the triangulation of the given shape.
+ */
+Poly2 BatchTriangulator::getPolygon(size_t shape) const {
+    Poly2 poly;
+    getPolygon(shape,&poly);
+    return poly;
+}
+
+/**
+ * Stores the triangulation of the given shape in the buffer.
+ *
+ * The polygon contains the vertices of the exterior hull and any holes.
+ * This data is appended to the buffer, with indices adjusted for the
+ * existing vertices. You should clear the buffer first if you do not
+ * want to preserve the original data. If the calculation is not yet
+ * performed, this method will do nothing.
+ *
+ * @param shape     The polygon index
+ * @param buffer    The buffer to store the triangulated polygon
+ *
+ * @return a reference to the buffer for chaining.
+ */
+Poly2* BatchTriangulator::getPolygon(size_t shape, Poly2* buffer) const {
+    CUAssertLog(buffer, "Destination buffer is null");
+    CUAssertLog(shape < _shapes.size(), "Polygon %zu is out of bounds",shape);
+    if (_calculated) {
+        size_t start = _shapes[shape].vertstart;
+        size_t count = getVertexCount(shape);
+        Uint32 offset = (Uint32)buffer->vertices.size();
+        buffer->vertices.insert(buffer->vertices.end(), _input.begin()+start,
+                                _input.begin()+start+count);
+
+        auto first = _output.begin()+_ranges[shape];
+        auto last  = _output.begin()+_ranges[shape+1];
+        buffer->indices.reserve(buffer->indices.size()+(last-first));
+        for(auto it = first; it != last; ++it) {
+            buffer->indices.push_back(offset+(*it-(Uint32)start));
+        }
+    }
+    return buffer;
+}
+
+/**
+ * Stores the triangulation of the entire batch in the buffer.
+ *
+ * The result is a single polygon with the packed vertices and indices.
+ * This data is appended to the buffer, with indices adjusted for the
+ * existing vertices. You should clear the buffer first if you do not
+ * want to preserve the original data. If the calculation is not yet
+ * performed, this method will do nothing.
+ *
+ * @param buffer    The buffer to store the triangulated polygons
+ *
+ * @return a reference to the buffer for chaining.
+ */
+Poly2* BatchTriangulator::getPolygon(Poly2* buffer) const {
+    CUAssertLog(buffer, "Destination buffer is null");
+    if (_calculated) {
+        Uint32 offset = (int)buffer->vertices.size();
+        if (offset > 0) {
+            buffer->vertices.insert(buffer->vertices.end(), _input.begin(), _input.end());
+            buffer->indices.reserve(buffer->indices.size()+_output.size());
+            for(auto it = _output.begin(); it != _output.end(); ++it) {
+                buffer->indices.push_back(offset+*it);
+            }
+        } else {
+            buffer->vertices = _input;
+            buffer->indices  = _output;
+        }
+    }
+    return buffer;
+}
+
+#pragma mark -
+#pragma mark Internal Computation
+/**
+ * Divides the polygons into blocks of roughly equal vertex count
+ *
+ * The blocks are the units of work shared between the threads, with one
+ * block for each thread (including the calling thread). Balancing the
+ * vertex counts keeps any thread from being left idle when the polygons
+ * vary in size.
+ */
+void BatchTriangulator::partition() {
+    size_t threads = _pool == nullptr ? 1 : _pool->getThreadCount()+1;
+    size_t count = std::min(threads,_shapes.size());
+    size_t limit = (_input.size()+count-1)/count;
+
+    _blocks.clear();
+    _blocks.push_back(0);
+    size_t total = 0;
+    for(size_t ii = 0; ii+1 < _shapes.size(); ii++) {
+        total += getVertexCount(ii);
+        if (total >= limit*_blocks.size()) {
+            _blocks.push_back(ii+1);
+        }
+    }
+    _blocks.push_back(_shapes.size());
+}
+
+/**
+ * Triangulates the polygons in the given range of blocks
+ *
+ * The results of each block are stored in its scratch buffer, and the
+ * index count of each polygon is stored in the range list. All of the
+ * blocks in the range share the triangulator of the first block. These
+ * triangulators persist between calculations, so their buffers are only
+ * allocated once.
+ *
+ * @param begin The first block to process
+ * @param end   The block after the last block to process
+ */
+void BatchTriangulator::triangulate(size_t begin, size_t end) {
+    // Ranges are disjoint, so no other thread uses this slot
+    EarclipTriangulator* earclip = _earclip[begin].get();
+    DelaunayTriangulator* delaunay = _delaunay[begin].get();
+    for(size_t bb = begin; bb < end; bb++) {
+        std::vector<Uint32>& buffer = _scratch[bb];
+        buffer.clear();
+        for(size_t ii = _blocks[bb]; ii < _blocks[bb+1]; ii++) {
+            const Shape& shape = _shapes[ii];
+            if (shape.hullsize < 3) {
+                continue;
+            }
+
+            size_t start = buffer.size();
+            const Vec2* verts = _input.data()+shape.vertstart;
+            const size_t* holes = _holes.data()+shape.holestart;
+            size_t amt;
+            if (_method == Method::DELAUNAY) {
+                amt = triangulate_shape(*delaunay, verts, shape.hullsize,
+                                        holes, shape.holesize, buffer);
+            } else {
+                amt = triangulate_shape(*earclip, verts, shape.hullsize,
+                                        holes, shape.holesize, buffer);
+            }
+
+            // Make the indices relative to the packed buffer
+            Uint32 offset = (Uint32)shape.vertstart;
+            for(size_t jj = start; jj < buffer.size(); jj++) {
+                buffer[jj] += offset;
+            }
+            _ranges[ii+1] = amt;
+        }
+    }
+}
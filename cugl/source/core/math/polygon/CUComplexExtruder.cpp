@@ -271,7 +271,8 @@ void ComplexExtruder::clear() {
  *
  * This method uses the Clipper library to perform the extrusion. While
  * accurate and preferred for static shapes, it is not ideal to call
- * this method at framerate.
+ * this method at framerate. The Clipper state is reused from the previous
+ * calculation, so repeated extrusions do not reallocate it.
  *
  * @param stroke    The stroke width of the extrusion
  */
@@ -283,18 +284,17 @@ void ComplexExtruder::calculate(float stroke) {
         return;
     }
     
-    ClipperLib::Path inverts;
-    ClipperLib::PolyTree solution;
+    _inverts.clear();
     for(auto it = _input.vertices.begin(); it != _input.vertices.end(); ++it) {
-        inverts << ClipperLib::IntPoint((ClipperLib::cInt)(it->x*_resolution),
-                                        (ClipperLib::cInt)(it->y*_resolution));
+        _inverts << ClipperLib::IntPoint((ClipperLib::cInt)(it->x*_resolution),
+                                         (ClipperLib::cInt)(it->y*_resolution));
     }
     
-    ClipperLib::ClipperOffset worker;
-    worker.MiterLimit = _mitrelimit;
-    worker.AddPath( inverts, _joint, _input.closed ?  ClipperLib::etClosedLine : _endcap );
-    worker.Execute(solution, stroke*_resolution);
-    for(auto it = solution.Childs.begin(); it != solution.Childs.end(); it++) {
+    _worker.Clear();
+    _worker.MiterLimit = _mitrelimit;
+    _worker.AddPath( _inverts, _joint, _input.closed ?  ClipperLib::etClosedLine : _endcap );
+    _worker.Execute(_solution, stroke*_resolution);
+    for(auto it = _solution.Childs.begin(); it != _solution.Childs.end(); it++) {
         processNode(*it);
     }
 
@@ -318,7 +318,8 @@ void ComplexExtruder::processNode(const ClipperLib::PolyNode* node) {
     path.closed = true;
     _bounds.push_back(path);
 
-    DelaunayTriangulator triang(path);
+    _triangulator.clear();
+    _triangulator.set(path);
     for(auto it = node->Childs.begin(); it != node->Childs.end(); ++it) {
         Path2 hole;
         for(auto jt = (*it)->Contour.begin(); jt != (*it)->Contour.end(); ++jt) {
@@ -326,11 +327,11 @@ void ComplexExtruder::processNode(const ClipperLib::PolyNode* node) {
         }
         hole.closed = true;
         _bounds.push_back(hole);
-        triang.addHole(hole);
+        _triangulator.addHole(hole);
     }
 
-    triang.calculate();
-    triang.getPolygon(&_output);
+    _triangulator.calculate();
+    _triangulator.getPolygon(&_output);
 
     // Just in case.  But should never be called.
     for(auto it = node->Childs.begin(); it != node->Childs.end(); ++it) {
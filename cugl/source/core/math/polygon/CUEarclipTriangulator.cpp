@@ -4,8 +4,10 @@
 //
 //  This module is a factory for a lightweight earclipping triangulator. While
 //  we do have access to the very powerful Pol2Tri, that API has a lot of overhead
-//  with it. While earclipping is an O(n^2) algorithm, the lower overhead of this
-//  class makes it more performant in smaller applications.
+//  with it. Earclipping is naively an O(n^2) algorithm. However, we keep the
+//  candidate ears in a priority queue, and only test ears against the reflex
+//  vertices near them (using a z-order spatial hash). This makes the expected
+//  running time O(n log n), even for large outlines.
 //
 //  Because math objects are intended to be on the stack, we do not provide
 //  any shared pointer support in this class.
@@ -39,9 +41,14 @@
 #include <cugl/core/math/CUPoly2.h>
 #include <cugl/core/math/CUPath2.h>
 #include <cugl/core/util/CUDebug.h>
+#include <algorithm>
+#include <queue>
 
 using namespace cugl;
 
+/** The resolution of each axis in the z-order spatial hash */
+#define ZORDER_SCALE    32767.0f
+
 #pragma mark Support Class
 /**
  * An internal class that manages vertex data
@@ -62,6 +69,10 @@ public:
     bool eartip;
     /** Whether or not this vertex is (currently) active */
     bool active;
+    /** Whether or not this vertex is (currently) reflex */
+    bool reflex;
+    /** The z-order (Morton) code of this vertex */
+    Uint32 zcode;
     /** The next vertex along this path */
     Vertex* next;
     /** The previous vertex along this path */
@@ -75,6 +86,8 @@ public:
     angle(0),
     eartip(false),
     active(true),
+    reflex(false),
+    zcode(0),
     next(nullptr),
     prev(nullptr) {
     }
@@ -89,6 +102,8 @@ public:
     angle(0),
     eartip(false),
     active(true),
+    reflex(false),
+    zcode(0),
     next(nullptr),
     prev(nullptr) {
         index = pos;
@@ -108,6 +123,8 @@ public:
         angle = 0;
         eartip = false;
         active = true;
+        reflex = false;
+        zcode = 0;
         next = nullptr;
         prev = nullptr;
     }
@@ -124,6 +141,8 @@ public:
         dst->angle  = angle;
         dst->eartip = eartip;
         dst->active = active;
+        dst->reflex = reflex;
+        dst->zcode  = zcode;
         dst->next = next;
         dst->prev = prev;
     }
@@ -188,13 +207,53 @@ public:
         return (convex(prev->coord, coord, p) || convex(coord, next->coord, p));
     }
 
+    /**
+     * Returns the z-order (Morton) code for the given point
+     *
+     * The point is quantized to 15 bits per axis, relative to the bounding
+     * box of the vertices. The bits of the two axes are then interleaved.
+     * Points in a box always have codes between the codes of its corners.
+     *
+     * @param p         The point to hash
+     * @param origin    The bottom left corner of the vertex bounds
+     * @param scale     The quantization scale
+     *
+     * @return the z-order (Morton) code for the given point
+     */
+    static Uint32 zorder(const Vec2& p, const Vec2& origin, float scale) {
+        Uint32 x = (Uint32)((p.x-origin.x)*scale);
+        Uint32 y = (Uint32)((p.y-origin.y)*scale);
+
+        x = (x | (x << 8)) & 0x00FF00FF;
+        x = (x | (x << 4)) & 0x0F0F0F0F;
+        x = (x | (x << 2)) & 0x33333333;
+        x = (x | (x << 1)) & 0x55555555;
+
+        y = (y | (y << 8)) & 0x00FF00FF;
+        y = (y | (y << 4)) & 0x0F0F0F0F;
+        y = (y | (y << 2)) & 0x33333333;
+        y = (y | (y << 1)) & 0x55555555;
+
+        return x | (y << 1);
+    }
+
     /**
      * Updates this vertex to determine ear status
      *
      * This method should be called whenever an ear is clipped from the
-     * vertex set.
+     * vertex set. Only reflex vertices can lie inside of an ear, so we only
+     * test the (active) reflex vertices, which are sorted by z-order. The
+     * vertices in the bounding box of the ear have z-order codes between
+     * those of the box corners, so this is a simple range search.
+     *
+     * A vertex never becomes reflex during ear clipping. But a reflex vertex
+     * may become convex, in which case it is no longer tested.
+     *
+     * @param zlist     The reflex vertices, sorted by z-order
+     * @param origin    The bottom left corner of the vertex bounds
+     * @param scale     The z-order quantization scale
      */
-    void update() {
+    void update(const std::vector<Vertex*>& zlist, const Vec2& origin, float scale) {
         Vec2 vec1 = prev->coord-coord;
         Vec2 vec3 = next->coord-coord;
         vec1.normalize();
@@ -202,14 +261,28 @@ public:
         
         angle = vec1.x * vec3.x + vec1.y * vec3.y;
         if (convex()) {
+            reflex = false;
             eartip = true;
-            Vertex* curr = next->next;
-            while (curr != prev) {
-                bool test = curr->index != index && curr->index != prev->index && curr->index != next->index;
-                if (test && inside(curr->coord)) {
+
+            Vec2 min(std::min(std::min(prev->coord.x,coord.x),next->coord.x),
+                     std::min(std::min(prev->coord.y,coord.y),next->coord.y));
+            Vec2 max(std::max(std::max(prev->coord.x,coord.x),next->coord.x),
+                     std::max(std::max(prev->coord.y,coord.y),next->coord.y));
+            Uint32 zmin = zorder(min,origin,scale);
+            Uint32 zmax = zorder(max,origin,scale);
+
+            auto curr = std::lower_bound(zlist.begin(), zlist.end(), zmin,
+                                         [](const Vertex* v, Uint32 z) { return v->zcode < z; });
+            for(; eartip && curr != zlist.end() && (*curr)->zcode <= zmax; ++curr) {
+                const Vertex* v = *curr;
+                if (!v->active || !v->reflex) {
+                    continue;
+                }
+                const Vec2& p = v->coord;
+                bool test = v->index != index && v->index != prev->index && v->index != next->index;
+                if (test && p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y && inside(p)) {
                     eartip = false;
                 }
-                curr = curr->next;
             }
         } else {
             eartip = false;
@@ -218,28 +291,58 @@ public:
 };
 
 /**
- * Returns true if the lines defined by the two pairs of vectors intersect
+ * A candidate ear in the clipping queue
  *
- * @param p11   First vector of first line
- * @param p12   Second vector of first line
- * @param p21   First vector of second line
- * @param p22   Second vector of second line
+ * Candidates are not removed from the queue when their vertex changes.
+ * Instead, a candidate is ignored if its vertex is no longer an active ear
+ * with the same angle.
+ */
+typedef struct {
+    /** The interior angle (cosine) of the ear when queued */
+    float angle;
+    /** The position of the ear vertex in the vertex buffer */
+    size_t pos;
+} EarCandidate;
+
+/**
+ * The priority order of the candidate ears
  *
- * @return true if the lines defined by the two pairs of vectors intersect
+ * The queue pops the sharpest ear first, breaking ties by position in the
+ * vertex buffer.
  */
-static bool intersects(const Vec2& p11, const Vec2& p12, const Vec2& p21, const Vec2& p22) {
-    if (p11 == p21 || p11 == p22 || p12 == p21 || p12 == p22) {
-        return false;
+struct EarPriority {
+    /**
+     * Returns true if ear a has lower priority than ear b
+     *
+     * @param a The first ear
+     * @param b The second ear
+     *
+     * @return true if ear a has lower priority than ear b
+     */
+    bool operator()(const EarCandidate& a, const EarCandidate& b) const {
+        return a.angle < b.angle || (a.angle == b.angle && a.pos > b.pos);
     }
-    
-    Vec2 v1ort(p12.y-p11.y,p11.x-p12.x);
-    Vec2 v2ort(p22.y-p21.y,p21.x-p22.x);
-    float dot21 = v1ort.dot(p21-p11);
-    float dot22 = v1ort.dot(p22-p11);
-    float dot11 = v2ort.dot(p11-p21);
-    float dot12 = v2ort.dot(p12-p21);
-    
-    return !(dot11 * dot12 > 0 || dot21 * dot22 > 0);
+};
+
+/**
+ * Returns true if p is inside (or on the boundary of) the triangle abc
+ *
+ * The triangle may have either orientation.
+ *
+ * @param a     The first triangle vertex
+ * @param b     The second triangle vertex
+ * @param c     The third triangle vertex
+ * @param p     The point to check
+ *
+ * @return true if p is inside (or on the boundary of) the triangle abc
+ */
+static bool intriangle(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& p) {
+    float d1 = (b.x-a.x)*(p.y-a.y)-(b.y-a.y)*(p.x-a.x);
+    float d2 = (c.x-b.x)*(p.y-b.y)-(c.y-b.y)*(p.x-b.x);
+    float d3 = (a.x-c.x)*(p.y-c.y)-(a.y-c.y)*(p.x-c.x);
+    bool neg = d1 < 0 || d2 < 0 || d3 < 0;
+    bool pos = d1 > 0 || d2 > 0 || d3 > 0;
+    return !(neg && pos);
 }
 
 #pragma mark -
@@ -650,6 +753,10 @@ void EarclipTriangulator::allocateVertices() {
 
 /**
  * Slices out holes, merging vertices into one doubly-linked list
+ *
+ * Holes are processed from right to left. Each hole is joined to the
+ * exterior by casting a ray to the right from its rightmost vertex. The
+ * bridge is the nearest visible vertex at the smallest angle to that ray.
  */
 void EarclipTriangulator::removeHoles() {
     if (_holes.size() == 0) {
@@ -684,40 +791,50 @@ void EarclipTriangulator::removeHoles() {
         
         Vertex* holepoint = _vertices+holeindx;
         Vertex* bestpoint = nullptr;
+        const Vec2& hp = holepoint->coord;
 
-        // Find the point on the exterior to connect it to
-        bool repeat = true;
+        // Cast a ray to the right to find the nearest edge of the exterior.
+        // The remaining holes are all to the left, so they cannot block it.
+        float bestx = 0;
         Vertex* curr = _vertices;
-        while (repeat || curr != _vertices) {
-            if (curr->coord.x > holepoint->coord.x && curr->incone(holepoint->coord)) {
-                bool checkit = true;
-                if (bestpoint) {
-                    Vec2 v1 = curr->coord-holepoint->coord;
-                    Vec2 v2 = bestpoint->coord-holepoint->coord;
-                    v1.normalize();
-                    v2.normalize();
-                    if (v2.x > v1.x) {
-                        checkit = false;
-                    }
+        do {
+            const Vec2& p1 = curr->coord;
+            const Vec2& p2 = curr->next->coord;
+            if (p1.y <= hp.y && p2.y >= hp.y && p1.y != p2.y) {
+                float x = p1.x + (hp.y-p1.y)*(p2.x-p1.x)/(p2.y-p1.y);
+                if (x >= hp.x && (bestpoint == nullptr || x < bestx)) {
+                    bestx = x;
+                    bestpoint = p1.x > p2.x ? curr : curr->next;
                 }
-                if (checkit) {
-                    bool pointvisible = true;
-                    for(size_t ii = 0; pointvisible && ii < holessize; ii++) {
-                        for(size_t jj = 0; pointvisible && jj < holesleft[2*ii+1]; jj++) {
-                            Vertex* checkpt = _vertices+holesleft[2*ii]+jj;
-                            Vertex* nextpt  = checkpt->next;
-                            if (intersects(holepoint->coord, curr->coord, checkpt->coord, nextpt->coord)) {
-                                pointvisible = false;
-                            }
-                        }
-                    }
-                    if (pointvisible) {
+            }
+            curr = curr->next;
+        } while (curr != _vertices);
+        
+        // Any vertex in the triangle to the edge may block the view. If so,
+        // the visible vertex at the smallest angle to the ray is the bridge.
+        if (bestpoint != nullptr) {
+            Vec2 ip(bestx,hp.y);
+            Vec2 pp = bestpoint->coord;
+            Vertex* edgepoint = bestpoint;
+            float tanmin = 0;
+            bestpoint = nullptr;
+            curr = _vertices;
+            do {
+                const Vec2& p = curr->coord;
+                if (p.x > hp.x && p.x <= std::max(pp.x,ip.x) && intriangle(hp,ip,pp,p) &&
+                    curr->incone(hp)) {
+                    float tan = std::abs(hp.y-p.y)/(p.x-hp.x);
+                    if (bestpoint == nullptr || tan < tanmin ||
+                        (tan == tanmin && p.x > bestpoint->coord.x)) {
                         bestpoint = curr;
+                        tanmin = tan;
                     }
                 }
+                curr = curr->next;
+            } while (curr != _vertices);
+            if (bestpoint == nullptr) {
+                bestpoint = edgepoint;
             }
-            repeat = false;
-            curr = curr->next;
         }
         
         if (bestpoint == nullptr) {
@@ -762,23 +879,49 @@ void EarclipTriangulator::computeTriangles() {
         return;
     }
     
+    // Hash the reflex vertices in z-order
+    Vec2 origin = _vertices[0].coord;
+    Vec2 corner = origin;
+    for(size_t ii = 1; ii < _vertsize; ii++) {
+        const Vec2& p = _vertices[ii].coord;
+        origin.set(std::min(origin.x,p.x),std::min(origin.y,p.y));
+        corner.set(std::max(corner.x,p.x),std::max(corner.y,p.y));
+    }
+    float extent = std::max(corner.x-origin.x,corner.y-origin.y);
+    float scale  = extent > 0 ? ZORDER_SCALE/extent : 0;
+
+    std::vector<Vertex*> zlist;
+    for(size_t ii = 0; ii < _vertsize; ii++) {
+        Vertex* v = _vertices+ii;
+        v->zcode  = Vertex::zorder(v->coord,origin,scale);
+        v->reflex = !v->convex();
+        if (v->reflex) {
+            zlist.push_back(v);
+        }
+    }
+    std::sort(zlist.begin(), zlist.end(),
+              [](const Vertex* a, const Vertex* b) { return a->zcode < b->zcode; });
+    
     // Find some initial ears
+    std::priority_queue<EarCandidate,std::vector<EarCandidate>,EarPriority> ears;
     for(size_t ii = 0; ii < _vertsize; ii++) {
-        _vertices[ii].update();
+        _vertices[ii].update(zlist,origin,scale);
+        if (_vertices[ii].eartip) {
+            ears.push({_vertices[ii].angle,ii});
+        }
     }
     
+    size_t removed = 0;
     _output.reserve(3*(_vertsize-3));
     for(size_t ii = 0; ii < _vertsize-3; ii++) {
-        Vertex* bestear = nullptr;
         // Find the most extruded ear.
-        for(size_t jj = 0; jj < _vertsize; jj++) {
-            Vertex* v = _vertices+jj;
-            if (v->active && v->eartip) {
-                if (bestear == nullptr) {
-                    bestear = v;
-                } else if (v->angle > bestear->angle) {
-                    bestear = v;
-                }
+        Vertex* bestear = nullptr;
+        while (bestear == nullptr && !ears.empty()) {
+            EarCandidate ear = ears.top();
+            ears.pop();
+            Vertex* v = _vertices+ear.pos;
+            if (v->active && v->eartip && v->angle == ear.angle) {
+                bestear = v;
             }
         }
         
@@ -797,8 +940,25 @@ void EarclipTriangulator::computeTriangles() {
         bestear->next->prev = bestear->prev;
         
         if (ii != _vertsize - 4) {
-            bestear->prev->update();
-            bestear->next->update();
+            Vertex* neighbors[2] = { bestear->prev, bestear->next };
+            for(Vertex* v : neighbors) {
+                bool reflex = v->reflex;
+                v->update(zlist,origin,scale);
+                if (reflex && !v->reflex) {
+                    removed++;
+                }
+                if (v->eartip) {
+                    ears.push({v->angle,(size_t)(v-_vertices)});
+                }
+            }
+        }
+        
+        // Compact the hash once most of it is stale
+        if (2*removed > zlist.size()) {
+            zlist.erase(std::remove_if(zlist.begin(), zlist.end(),
+                                       [](const Vertex* v) { return !v->active || !v->reflex; }),
+                        zlist.end());
+            removed = 0;
         }
     }
 
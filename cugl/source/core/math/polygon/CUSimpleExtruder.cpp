@@ -49,6 +49,7 @@
 #include <cugl/core/util/CUDebug.h>
 #include <cugl/core/util/CUTimestamp.h>
 #include <iterator>
+#include <cstring>
 #include <cmath>
 
 /** Default rounding tolerance */
@@ -109,6 +110,30 @@ public:
     Uint32 flags;
 };
 
+/**
+ * The state of the extrusion at the start of a joint or cap
+ *
+ * The extrusion is a stream of vertices and triangles, where each joint
+ * continues from the last two vertices of the previous one. Recording this
+ * state allows us to resume the extrusion at any joint, which is how we
+ * patch an extrusion when only a few path points have moved.
+ */
+class SimpleExtruder::Stage {
+public:
+    /** The number of vertices before this stage */
+    size_t vsize;
+    /** The number of indices before this stage */
+    size_t isize;
+    /** The number of left border vertices before this stage */
+    size_t lsize;
+    /** The number of right border vertices before this stage */
+    size_t rsize;
+    /** The first vertex for the next triangle to produce */
+    Uint32 iback2;
+    /** The second vertex for the next triangle to produce */
+    Uint32 iback1;
+};
+
 }
 
 using namespace cugl;
@@ -139,7 +164,22 @@ _vsize(0),
 _lsize(0),
 _rsize(0),
 _ilimit(0),
-_isize(0) {
+_isize(0),
+_iback2(0),
+_iback1(0),
+_nleft(0),
+_stages(nullptr),
+_slimit(0),
+_lwidth(0),
+_rwidth(0),
+_ncap(0),
+_patchable(false),
+_dirtymin((size_t)-1),
+_dirtymax(0),
+_vbegin(0),
+_vend(0),
+_ibegin(0),
+_iend(0) {
 }
 
 /**
@@ -161,14 +201,33 @@ _closed(false),
 _convex(true),
 _points(nullptr),
 _verts(nullptr),
+_lefts(nullptr),
+_rghts(nullptr),
 _sides(nullptr),
 _indxs(nullptr),
 _plimit(0),
 _psize(0),
 _vlimit(0),
 _vsize(0),
+_lsize(0),
+_rsize(0),
 _ilimit(0),
-_isize(0) {
+_isize(0),
+_iback2(0),
+_iback1(0),
+_nleft(0),
+_stages(nullptr),
+_slimit(0),
+_lwidth(0),
+_rwidth(0),
+_ncap(0),
+_patchable(false),
+_dirtymin((size_t)-1),
+_dirtymax(0),
+_vbegin(0),
+_vend(0),
+_ibegin(0),
+_iend(0) {
     set(points,closed);
 }
 
@@ -201,7 +260,22 @@ _vsize(0),
 _lsize(0),
 _rsize(0),
 _ilimit(0),
-_isize(0) {
+_isize(0),
+_iback2(0),
+_iback1(0),
+_nleft(0),
+_stages(nullptr),
+_slimit(0),
+_lwidth(0),
+_rwidth(0),
+_ncap(0),
+_patchable(false),
+_dirtymin((size_t)-1),
+_dirtymax(0),
+_vbegin(0),
+_vend(0),
+_ibegin(0),
+_iend(0) {
     set(path);
 }
 
@@ -233,6 +307,10 @@ SimpleExtruder::~SimpleExtruder() {
         free(_indxs);
         _indxs = nullptr;
     }
+    if (_stages != nullptr) {
+        free(_stages);
+        _stages = nullptr;
+    }
 }
 
 
@@ -407,6 +485,46 @@ void SimpleExtruder::set(const Path2& path) {
     }
 }
 
+/**
+ * Returns the path point at the given index
+ *
+ * @param index The point index
+ *
+ * @return the path point at the given index
+ */
+Vec2 SimpleExtruder::getPoint(size_t index) const {
+    CUAssertLog(index < _psize, "Index %zu is out of bounds",index);
+    return Vec2(_points[index].x,_points[index].y);
+}
+
+/**
+ * Moves the path point at the given index
+ *
+ * This method does not reset the extrusion. Instead, the next call to
+ * {@link calculate} will re-extrude only the joints adjacent to the
+ * modified points, and patch the existing extrusion in place. This is
+ * much faster than a full extrusion when only a few points change each
+ * animation frame.
+ *
+ * A patch is only possible if the extrusion widths are the same as the
+ * previous calculation, and the joint, cap, tolerance, and mitre limit
+ * settings are unchanged. In addition, the vertex and index layout of
+ * the extrusion must be unchanged (e.g. a mitre joint cannot become a
+ * bevel). Otherwise, the next calculation performs a full extrusion.
+ *
+ * @param index The point index
+ * @param point The new point position
+ */
+void SimpleExtruder::setPoint(size_t index, const Vec2& point) {
+    CUAssertLog(index < _psize, "Index %zu is out of bounds",index);
+    _points[index].x = point.x;
+    _points[index].y = point.y;
+    measure(index == 0 ? _psize-1 : index-1);
+    measure(index);
+    _dirtymin = std::min(_dirtymin,index);
+    _dirtymax = std::max(_dirtymax,index);
+}
+
 
 #pragma mark -
 #pragma mark Calculation
@@ -423,6 +541,13 @@ void SimpleExtruder::reset() {
     _isize = 0;
     _iback1 = 0;
     _iback2 = 0;
+    _vbegin = 0;
+    _vend = 0;
+    _ibegin = 0;
+    _iend = 0;
+    _dirtymin = (size_t)-1;
+    _dirtymax = 0;
+    _patchable = false;
     _calculated = false;
 }
 
@@ -458,13 +583,14 @@ void SimpleExtruder::clear() {
  */
 void SimpleExtruder::calculate(float lwidth, float rwidth) {
     if (_calculated) {
-        return;
+        if (_dirtymin > _dirtymax || patch(lwidth, rwidth)) {
+            _dirtymin = (size_t)-1;
+            _dirtymax = 0;
+            return;
+        }
+        reset();
     }
     
-    Uint32 ind;    
-    float leftmark = lwidth > 0 ? LEFT_MK : 0;
-    float rghtmark = rwidth > 0 ? RGHT_MK : 0;
-    
     float width = lwidth+rwidth;
     Uint32 ncap = curveSegs(width, M_PI, _tolerance);
     Uint32 nbevel = analyze(width);
@@ -484,95 +610,22 @@ void SimpleExtruder::calculate(float lwidth, float rwidth) {
         }
     }
     
-    if (!cverts || !_psize) return;
+    // An open path needs a segment for its caps
+    if (!cverts || !_psize || (!_closed && _psize < 2)) return;
     prealloc(cverts);
 
-    Point* p0;
-    Point* p1;
-    Uint32 s, e;
-
-    if (_closed) {
-        // Looping
-        p0 = _points+_psize-1;
-        p1 = _points;
-        s = 0;
-        e = (Uint32)_psize;
-    } else {
-        // Add cap
-        p0 = _points;
-        p1 = _points+1;
-        s = 1;
-        e = (Uint32)_psize-1;
-
-        float dx = p1->x - p0->x;
-        float dy = p1->y - p0->y;
-        float mag = sqrtf(dx*dx+dy*dy);
-        if (mag > EPSILON) {
-            dx /= mag; dy /= mag;
-        }
-        
-        switch(_endcap) {
-        case poly2::EndCap::BUTT:
-            startButt(p0, dx, dy, lwidth, rwidth);
-            break;
-        case poly2::EndCap::SQUARE:
-            startSquare(p0, dx, dy, lwidth, rwidth, width);
-            break;
-        case poly2::EndCap::ROUND:
-            startRound(p0, dx, dy, lwidth, rwidth, ncap);
-            break;
-        }
-    }
-    for(Uint32 jj = s; jj < e; jj++) {
-        if ((p1->flags & (FLAG_BEVEL | FLAG_INNER)) != 0) {
-            if (_joint == poly2::Joint::ROUND) {
-                joinRound(p0, p1, lwidth, rwidth, ncap, _closed && jj == s);
-            } else {
-                joinBevel(p0, p1, lwidth, rwidth, _closed && jj == s);
-            }
-        } else if (_closed && jj == s) {
-            _iback2 = addPoint(p1->x - (p1->dmx * lwidth), p1->y - (p1->dmy * lwidth), leftmark, 0);
-            _iback1 = addPoint(p1->x + (p1->dmx * rwidth), p1->y + (p1->dmy * rwidth), rghtmark, 0);
-            addLeft(_iback2);
-            addRight(_iback1);
-        } else {
-            ind = addPoint(p1->x - (p1->dmx * lwidth), p1->y - (p1->dmy * lwidth), leftmark, 0);
-            addLeft(ind);
-            triLeft(ind);
-            ind = addPoint(p1->x + (p1->dmx * rwidth), p1->y + (p1->dmy * rwidth), rghtmark, 0);
-            addRight(ind);
-            triRight(ind);
-        }
-        p0 = p1++;
-    }
+    _lwidth = lwidth;
+    _rwidth = rwidth;
+    _ncap = ncap;
+    extrude(0, _closed ? _psize+1 : _psize);
     
-    if (_closed) {
-        addLeft(0);
-        triLeft(0);
-        addRight(1);
-        triRight(1);
-    } else {
-        // Add cap
-        p1 = _points+e;
-        float dx = p1->x - p0->x;
-        float dy = p1->y - p0->y;
-        float mag = sqrtf(dx*dx+dy*dy);
-        if (mag > EPSILON) {
-            dx /= mag; dy /= mag;
-        }
-        
-        switch(_endcap) {
-        case poly2::EndCap::BUTT:
-            endButt(p1, dx, dy, lwidth, rwidth);
-            break;
-        case poly2::EndCap::SQUARE:
-            endSquare(p1, dx, dy, lwidth, rwidth, width);
-            break;
-        case poly2::EndCap::ROUND:
-            endRound(p1, dx, dy, lwidth, rwidth, ncap);
-            break;
-        }
-    }
+    _vbegin = 0;
+    _vend = _vsize;
+    _ibegin = 0;
+    _iend = _isize;
+    _dirtymin = (size_t)-1;
+    _dirtymax = 0;
+    _patchable = true;
     _calculated = true;
 }
 
@@ -589,72 +642,335 @@ void SimpleExtruder::calculate(float lwidth, float rwidth) {
  */
 Uint32 SimpleExtruder::analyze(float width) {
     float iwidth = width > 0.0f ? 1.0f/width : 0.0f;
-    Uint32 nleft  = 0;
     Uint32 nbevel = 0;
     
-    Point* v0 = _points+_psize-1;
-    Point* v1 = _points;
-    for(Uint32 ii = 0; ii < _psize; ii++) {
-        float dlx0 = v0->dy;
-        float dly0 = -v0->dx;
-        float dlx1 = v1->dy;
-        float dly1 = -v1->dx;
-        
-        // Calculate extrusions
-        v1->dmx = (dlx0 + dlx1) * 0.5f;
-        v1->dmy = (dly0 + dly1) * 0.5f;
-
-        float dmr2 = v1->dmx*v1->dmx + v1->dmy*v1->dmy;
-        if (dmr2 > EPSILON) {
-            float scale = 1.0f / dmr2;
-            if (scale > SCALE_LIMIT) {
-                scale = SCALE_LIMIT;
-            }
-            v1->dmx *= scale;
-            v1->dmy *= scale;
+    _nleft = 0;
+    for(size_t ii = 0; ii < _psize; ii++) {
+        annotate(ii, iwidth);
+        Point* v1 = _points+ii;
+        if (v1->flags & FLAG_LEFT) {
+            _nleft += 1;
         }
-        
-        // Clear flags, but keep the corner.
-        v1->flags = (v1->flags & FLAG_CORNER) ? FLAG_CORNER : 0;
-
-        // Keep track of left turns.
-        float cross = v1->dx * v0->dy - v0->dx * v1->dy;
-        if (cross < 0.0) {
-            nleft += 1;
-            v1->flags |= FLAG_LEFT;
+        if ((v1->flags & (FLAG_BEVEL | FLAG_INNER)) != 0) {
+            nbevel += 1;
         }
+    }
 
-        // Calculate if we should use bevel or miter for inner join.
-        float limit = std::max(1.01f, std::min(v0->len, v1->len) * iwidth);
-        
-        if ((dmr2 * limit*limit) < 1.0f && !(v1->flags & FLAG_CORNER)) {
-            v1->flags |= FLAG_INNER;
+    _convex = (_nleft == _psize);
+    return nbevel;
+}
+
+/**
+ * Annotates the path point at the given index
+ *
+ * This method computes the extrusion direction at the point, as well as
+ * the flags determining the joint type. It is the per-point step of
+ * {@link analyze}.
+ *
+ * @param index     The point index
+ * @param iwidth    The inverse of the stroke width
+ */
+void SimpleExtruder::annotate(size_t index, float iwidth) {
+    Point* v0 = _points+(index == 0 ? _psize-1 : index-1);
+    Point* v1 = _points+index;
+    float dlx0 = v0->dy;
+    float dly0 = -v0->dx;
+    float dlx1 = v1->dy;
+    float dly1 = -v1->dx;
+    
+    // Calculate extrusions
+    v1->dmx = (dlx0 + dlx1) * 0.5f;
+    v1->dmy = (dly0 + dly1) * 0.5f;
+
+    float dmr2 = v1->dmx*v1->dmx + v1->dmy*v1->dmy;
+    if (dmr2 > EPSILON) {
+        float scale = 1.0f / dmr2;
+        if (scale > SCALE_LIMIT) {
+            scale = SCALE_LIMIT;
         }
+        v1->dmx *= scale;
+        v1->dmy *= scale;
+    }
+    
+    // Clear flags, but keep the corner.
+    v1->flags = (v1->flags & FLAG_CORNER) ? FLAG_CORNER : 0;
 
-        // Check to see if the corner needs to be beveled.
-        if (v1->flags & FLAG_CORNER) {
-            if ((dmr2 * _mitrelimit*_mitrelimit) < 1.0 ||
-                 _joint == poly2::Joint::SQUARE ||
-                 _joint == poly2::Joint::ROUND) {
-                v1->flags |= FLAG_BEVEL;
-            }
+    // Keep track of left turns.
+    float cross = v1->dx * v0->dy - v0->dx * v1->dy;
+    if (cross < 0.0) {
+        v1->flags |= FLAG_LEFT;
+    }
+
+    // Calculate if we should use bevel or miter for inner join.
+    float limit = std::max(1.01f, std::min(v0->len, v1->len) * iwidth);
+    
+    if ((dmr2 * limit*limit) < 1.0f && !(v1->flags & FLAG_CORNER)) {
+        v1->flags |= FLAG_INNER;
+    }
+
+    // Check to see if the corner needs to be beveled.
+    if (v1->flags & FLAG_CORNER) {
+        if ((dmr2 * _mitrelimit*_mitrelimit) < 1.0 ||
+             _joint == poly2::Joint::SQUARE ||
+             _joint == poly2::Joint::ROUND) {
+            v1->flags |= FLAG_BEVEL;
         }
-        
-        if ((v1->flags & (FLAG_BEVEL | FLAG_INNER)) != 0) {
-            nbevel += 1;
+    }
+}
+
+/**
+ * Computes the direction and distance from a path point to the next one
+ *
+ * The path is treated as closed for this computation, so the last point
+ * is measured against the first.
+ *
+ * @param index     The point index
+ */
+void SimpleExtruder::measure(size_t index) {
+    Point* v = _points+index;
+    Point* n = _points+(index+1 == _psize ? 0 : index+1);
+    v->dx = n->x-v->x;
+    v->dy = n->y-v->y;
+    v->len = sqrtf(v->dx*v->dx+v->dy*v->dy);
+    if (v->len > 1e-6) {
+        v->dx /= v->len;
+        v->dy /= v->len;
+    }
+}
+
+/**
+ * Produces the extrusion for the given range of stages
+ *
+ * A stage is either an end cap or the joint at a single path point. For
+ * an open path, stage 0 is the head cap, the last stage is the tail cap,
+ * and the stages in between are the joints at the corresponding points.
+ * For a closed path, stage i is the joint at point i, and a final stage
+ * closes the loop. The state of the extrusion at the start of each stage
+ * is recorded, so that the extrusion may be resumed from that stage.
+ *
+ * @param begin     The first stage to produce
+ * @param end       The stage after the last stage to produce
+ */
+void SimpleExtruder::extrude(size_t begin, size_t end) {
+    Uint32 ind;
+    float lwidth = _lwidth;
+    float rwidth = _rwidth;
+    float width  = lwidth+rwidth;
+    float leftmark = lwidth > 0 ? LEFT_MK : 0;
+    float rghtmark = rwidth > 0 ? RGHT_MK : 0;
+    size_t last = _closed ? _psize : _psize-1;
+    
+    for(size_t ii = begin; ii < end; ii++) {
+        Stage* stage = _stages+ii;
+        stage->vsize  = _vsize;
+        stage->isize  = _isize;
+        stage->lsize  = _lsize;
+        stage->rsize  = _rsize;
+        stage->iback2 = _iback2;
+        stage->iback1 = _iback1;
+
+        if (_closed && ii == last) {
+            addLeft(0);
+            triLeft(0);
+            addRight(1);
+            triRight(1);
+        } else if (!_closed && (ii == 0 || ii == last)) {
+            // Add cap
+            Point* p0 = _points+(ii == 0 ? 0 : ii-1);
+            Point* p1 = p0+1;
+            float dx = p1->x - p0->x;
+            float dy = p1->y - p0->y;
+            float mag = sqrtf(dx*dx+dy*dy);
+            if (mag > EPSILON) {
+                dx /= mag; dy /= mag;
+            }
+            
+            if (ii == 0) {
+                switch(_endcap) {
+                case poly2::EndCap::BUTT:
+                    startButt(p0, dx, dy, lwidth, rwidth);
+                    break;
+                case poly2::EndCap::SQUARE:
+                    startSquare(p0, dx, dy, lwidth, rwidth, width);
+                    break;
+                case poly2::EndCap::ROUND:
+                    startRound(p0, dx, dy, lwidth, rwidth, _ncap);
+                    break;
+                }
+            } else {
+                switch(_endcap) {
+                case poly2::EndCap::BUTT:
+                    endButt(p1, dx, dy, lwidth, rwidth);
+                    break;
+                case poly2::EndCap::SQUARE:
+                    endSquare(p1, dx, dy, lwidth, rwidth, width);
+                    break;
+                case poly2::EndCap::ROUND:
+                    endRound(p1, dx, dy, lwidth, rwidth, _ncap);
+                    break;
+                }
+            }
+        } else {
+            Point* p0 = _points+(ii == 0 ? _psize-1 : ii-1);
+            Point* p1 = _points+ii;
+            bool start = _closed && ii == 0;
+            if ((p1->flags & (FLAG_BEVEL | FLAG_INNER)) != 0) {
+                if (_joint == poly2::Joint::ROUND) {
+                    joinRound(p0, p1, lwidth, rwidth, _ncap, start);
+                } else {
+                    joinBevel(p0, p1, lwidth, rwidth, start);
+                }
+            } else if (start) {
+                _iback2 = addPoint(p1->x - (p1->dmx * lwidth), p1->y - (p1->dmy * lwidth), leftmark, 0);
+                _iback1 = addPoint(p1->x + (p1->dmx * rwidth), p1->y + (p1->dmy * rwidth), rghtmark, 0);
+                addLeft(_iback2);
+                addRight(_iback1);
+            } else {
+                ind = addPoint(p1->x - (p1->dmx * lwidth), p1->y - (p1->dmy * lwidth), leftmark, 0);
+                addLeft(ind);
+                triLeft(ind);
+                ind = addPoint(p1->x + (p1->dmx * rwidth), p1->y + (p1->dmy * rwidth), rghtmark, 0);
+                addRight(ind);
+                triRight(ind);
+            }
         }
-        v0 = v1++;
     }
+}
 
-    _convex = (nleft == _psize);
-    return nbevel;
+/**
+ * Returns true if the modified points were patched into the extrusion
+ *
+ * This method re-extrudes the stages adjacent to the modified points,
+ * starting from the recorded state of the first stage. The patch only
+ * succeeds if the new stages rejoin the previous extrusion exactly. If
+ * this method returns false, the extrusion must be recalculated.
+ *
+ * @param lwidth    The width of the left side of the extrusion
+ * @param rwidth    The width of the right side of the extrusion
+ *
+ * @return true if the modified points were patched into the extrusion
+ */
+bool SimpleExtruder::patch(float lwidth, float rwidth) {
+    if (!_patchable || lwidth != _lwidth || rwidth != _rwidth) {
+        return false;
+    }
+    
+    // Moving a point changes the annotations of its neighbors, and hence
+    // their joints. The joint after that is rerun to rejoin the stream.
+    size_t total = _closed ? _psize+1 : _psize;
+    size_t first, last;
+    if (_closed) {
+        // The first joint is shared with the closing stage; do not wrap
+        if (_dirtymin < 2 || _dirtymax+2 > _psize) {
+            return false;
+        }
+        first = _dirtymin-1;
+        last  = _dirtymax+3;
+    } else {
+        first = _dirtymin > 0 ? _dirtymin-1 : 0;
+        last  = std::min(_dirtymax+3, total);
+    }
+    
+    // Reannotate, failing if the layout would change
+    float width  = lwidth+rwidth;
+    float iwidth = width > 0.0f ? 1.0f/width : 0.0f;
+    size_t start = _dirtymin == 0 ? _psize-1 : _dirtymin-1;
+    size_t count = std::min(_dirtymax-_dirtymin+3, _psize);
+    bool changed = false;
+    for(size_t ii = 0; ii < count; ii++) {
+        Point* v = _points+((start+ii) % _psize);
+        Uint32 flags = v->flags;
+        annotate((start+ii) % _psize, iwidth);
+        if (flags & FLAG_LEFT) {
+            _nleft -= 1;
+        }
+        if (v->flags & FLAG_LEFT) {
+            _nleft += 1;
+        }
+        changed = changed || ((flags ^ v->flags) & (FLAG_BEVEL | FLAG_INNER));
+    }
+    _convex = (_nleft == _psize);
+    if (changed) {
+        return false;
+    }
+    
+    // The state at the end of the last stage we produce
+    Stage stop;
+    if (last == total) {
+        stop.vsize  = _vsize;
+        stop.isize  = _isize;
+        stop.lsize  = _lsize;
+        stop.rsize  = _rsize;
+        stop.iback2 = _iback2;
+        stop.iback1 = _iback1;
+    } else {
+        stop = _stages[last];
+    }
+    size_t vsize = _vsize;
+    size_t isize = _isize;
+    Uint32 iback2 = _iback2;
+    Uint32 iback1 = _iback1;
+    size_t ltail = _lsize-stop.lsize;
+    size_t rtail = _rsize-stop.rsize;
+    
+    // The border is not part of the mesh, so a bevel may change its length
+    // (left and right turns differ). Park the rest of the border at the end
+    // of its buffer so that it is not overwritten.
+    bool park = false;
+    for(size_t ii = first; !park && ii < last && ii < _psize; ii++) {
+        park = (_points[ii].flags & (FLAG_BEVEL | FLAG_INNER)) != 0;
+    }
+    if (park) {
+        std::memmove(_lefts+2*(_vlimit-ltail), _lefts+2*stop.lsize, sizeof(float)*2*ltail);
+        std::memmove(_rghts+2*(_vlimit-rtail), _rghts+2*stop.rsize, sizeof(float)*2*rtail);
+    }
+    
+    // Resume the extrusion at the first stage
+    Stage* stage = _stages+first;
+    _vsize  = stage->vsize;
+    _isize  = stage->isize;
+    _lsize  = stage->lsize;
+    _rsize  = stage->rsize;
+    _iback2 = stage->iback2;
+    _iback1 = stage->iback1;
+    extrude(first, last);
+    
+    // The mesh must rejoin the previous extrusion
+    bool rejoin = (_vsize == stop.vsize && _isize == stop.isize &&
+                   _iback2 == stop.iback2 && _iback1 == stop.iback1);
+    if (park) {
+        rejoin = rejoin && _lsize+ltail <= _vlimit && _rsize+rtail <= _vlimit;
+        if (rejoin) {
+            std::memmove(_lefts+2*_lsize, _lefts+2*(_vlimit-ltail), sizeof(float)*2*ltail);
+            std::memmove(_rghts+2*_rsize, _rghts+2*(_vlimit-rtail), sizeof(float)*2*rtail);
+            for(size_t ii = last; ii < total; ii++) {
+                _stages[ii].lsize = _stages[ii].lsize+_lsize-stop.lsize;
+                _stages[ii].rsize = _stages[ii].rsize+_rsize-stop.rsize;
+            }
+        }
+    } else {
+        rejoin = rejoin && _lsize == stop.lsize && _rsize == stop.rsize;
+    }
+    
+    _vbegin = _stages[first].vsize;
+    _vend   = _vsize;
+    _ibegin = _stages[first].isize;
+    _iend   = _isize;
+    _vsize  = vsize;
+    _isize  = isize;
+    _lsize  = _lsize+ltail;
+    _rsize  = _rsize+rtail;
+    _iback2 = iback2;
+    _iback1 = iback1;
+    return rejoin;
 }
 
 /**
  * Allocates space for the extrusion vertices and indices
  *
  * This method guarantees that the output buffers will have enough capacity
- * for the algorithm.
+ * for the algorithm. It also allocates a stage record for each joint and
+ * cap in the current path.
  *
  * @param size      The estimated number of vertices in the extrusion
  */
@@ -685,6 +1001,13 @@ void SimpleExtruder::prealloc(Uint32 size) {
         _ilimit = 3*(size-2);
         _indxs = (Uint32*)malloc(sizeof(Uint32)*_ilimit);
     }
+    if (_psize+1 > _slimit) {
+        if (_stages != nullptr) {
+            free(_stages);
+        }
+        _slimit = _psize+1;
+        _stages = (Stage*)malloc(sizeof(Stage)*_slimit);
+    }
 }
 
 /**
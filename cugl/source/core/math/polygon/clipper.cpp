@@ -149,15 +149,88 @@ inline cInt Abs(cInt val)
 // PolyTree methods ...
 //------------------------------------------------------------------------------
 
+PolyTree::~PolyTree()
+{
+    Clear();
+    for (PolyNodes::size_type i = 0; i < FreeNodes.size(); ++i)
+      delete FreeNodes[i];
+}
+//------------------------------------------------------------------------------
+
 void PolyTree::Clear()
 {
+    //nodes are kept (with their contour storage) for the next solution ...
     for (PolyNodes::size_type i = 0; i < AllNodes.size(); ++i)
-      delete AllNodes[i];
+    {
+      AllNodes[i]->Contour.clear();
+      AllNodes[i]->Childs.clear();
+      FreeNodes.push_back(AllNodes[i]);
+    }
     AllNodes.resize(0); 
     Childs.resize(0);
 }
 //------------------------------------------------------------------------------
 
+PolyNode* PolyTree::NewNode()
+{
+  if (FreeNodes.empty()) return new PolyNode();
+  PolyNode* result = FreeNodes.back();
+  FreeNodes.pop_back();
+  result->Parent = 0;
+  result->Index = 0;
+  result->m_IsOpen = false;
+  return result;
+}
+//------------------------------------------------------------------------------
+// Arena methods ...
+//------------------------------------------------------------------------------
+
+Arena::Arena(size_t blockSize): m_BlockSize(blockSize), m_Current(0), m_Offset(0)
+{
+}
+//------------------------------------------------------------------------------
+
+Arena::~Arena()
+{
+  for (size_t i = 0; i < m_Blocks.size(); ++i)
+    std::free(m_Blocks[i]);
+}
+//------------------------------------------------------------------------------
+
+void* Arena::Alloc(size_t size)
+{
+  //keep every record aligned for the largest member (cInt or double) ...
+  const size_t align = sizeof(cInt) > sizeof(double) ? sizeof(cInt) : sizeof(double);
+  size = (size + align - 1) & ~(align - 1);
+  while (m_Current < m_Blocks.size())
+  {
+    if (m_Offset + size <= m_Sizes[m_Current])
+    {
+      void* result = m_Blocks[m_Current] + m_Offset;
+      m_Offset += size;
+      return result;
+    }
+    m_Current++;
+    m_Offset = 0;
+  }
+  size_t bytes = size > m_BlockSize ? size : m_BlockSize;
+  char* block = static_cast<char*>(std::malloc(bytes));
+  if (!block) throw std::bad_alloc();
+  m_Blocks.push_back(block);
+  m_Sizes.push_back(bytes);
+  m_Current = m_Blocks.size() - 1;
+  m_Offset = size;
+  return block;
+}
+//------------------------------------------------------------------------------
+
+void Arena::Reset()
+{
+  m_Current = 0;
+  m_Offset = 0;
+}
+//------------------------------------------------------------------------------
+
 PolyNode* PolyTree::GetFirst() const
 {
   if (!Childs.empty())
@@ -705,14 +778,8 @@ void ReversePolyPtLinks(OutPt *pp)
 
 void DisposeOutPts(OutPt*& pp)
 {
-  if (pp == 0) return;
-    pp->Prev->Next = 0;
-  while( pp )
-  {
-    OutPt *tmpPp = pp;
-    pp = pp->Next;
-    delete tmpPp;
-  }
+  //the points are owned by the clipper's arena, so just forget them ...
+  pp = 0;
 }
 //------------------------------------------------------------------------------
 
@@ -1058,27 +1125,20 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
   if ((Closed && highI < 2) || (!Closed && highI < 1)) return false;
 
   //create a new edge array ...
-  TEdge *edges = new TEdge [highI +1];
+  TEdge *edges = m_EdgeArena.New<TEdge>(highI +1);
 
   bool IsFlat = true;
   //1. Basic (first) edge initialization ...
-  try
-  {
-    edges[1].Curr = pg[1];
-    RangeTest(pg[0], m_UseFullRange);
-    RangeTest(pg[highI], m_UseFullRange);
-    InitEdge(&edges[0], &edges[1], &edges[highI], pg[0]);
-    InitEdge(&edges[highI], &edges[0], &edges[highI-1], pg[highI]);
-    for (int i = highI - 1; i >= 1; --i)
-    {
-      RangeTest(pg[i], m_UseFullRange);
-      InitEdge(&edges[i], &edges[i+1], &edges[i-1], pg[i]);
-    }
-  }
-  catch(...)
-  {
-    delete [] edges;
-    throw; //range test fails
+  //(if a range test fails, the edges are reclaimed with the arena)
+  edges[1].Curr = pg[1];
+  RangeTest(pg[0], m_UseFullRange);
+  RangeTest(pg[highI], m_UseFullRange);
+  InitEdge(&edges[0], &edges[1], &edges[highI], pg[0]);
+  InitEdge(&edges[highI], &edges[0], &edges[highI-1], pg[highI]);
+  for (int i = highI - 1; i >= 1; --i)
+  {
+    RangeTest(pg[i], m_UseFullRange);
+    InitEdge(&edges[i], &edges[i+1], &edges[i-1], pg[i]);
   }
   TEdge *eStart = &edges[0];
 
@@ -1118,7 +1178,6 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
 
   if ((!Closed && (E == E->Next)) || (Closed && (E->Prev == E->Next)))
   {
-    delete [] edges;
     return false;
   }
 
@@ -1146,7 +1205,6 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
   {
     if (Closed) 
     {
-      delete [] edges;
       return false;
     }
     E->Prev->OutIdx = Skip;
@@ -1233,12 +1291,8 @@ bool ClipperBase::AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed)
 void ClipperBase::Clear()
 {
   DisposeLocalMinimaList();
-  for (EdgeList::size_type i = 0; i < m_edges.size(); ++i)
-  {
-    TEdge* edges = m_edges[i];
-    delete [] edges;
-  }
   m_edges.clear();
+  m_EdgeArena.Reset();
   m_UseFullRange = false;
   m_HasOpenPaths = false;
 }
@@ -1250,7 +1304,7 @@ void ClipperBase::Reset()
   if (m_CurrentLM == m_MinimaList.end()) return; //ie nothing to process
   std::sort(m_MinimaList.begin(), m_MinimaList.end(), LocMinSorter());
 
-  m_Scanbeam = ScanbeamList(); //clears/resets priority_queue
+  m_Scanbeam.clear(); //keeps the heap capacity
   //reset all edges ...
   for (MinimaList::iterator lm = m_MinimaList.begin(); lm != m_MinimaList.end(); ++lm)
   {
@@ -1334,16 +1388,19 @@ IntRect ClipperBase::GetBounds()
 
 void ClipperBase::InsertScanbeam(const cInt Y)
 {
-  m_Scanbeam.push(Y);
+  m_Scanbeam.push_back(Y);
+  std::push_heap(m_Scanbeam.begin(), m_Scanbeam.end());
 }
 //------------------------------------------------------------------------------
 
 bool ClipperBase::PopScanbeam(cInt &Y)
 {
   if (m_Scanbeam.empty()) return false;
-  Y = m_Scanbeam.top();
-  m_Scanbeam.pop();
-  while (!m_Scanbeam.empty() && Y == m_Scanbeam.top()) { m_Scanbeam.pop(); } // Pop duplicates.
+  Y = m_Scanbeam.front();
+  do {
+    std::pop_heap(m_Scanbeam.begin(), m_Scanbeam.end());
+    m_Scanbeam.pop_back();
+  } while (!m_Scanbeam.empty() && Y == m_Scanbeam.front()); // Pop duplicates.
   return true;
 }
 //------------------------------------------------------------------------------
@@ -1352,6 +1409,7 @@ void ClipperBase::DisposeAllOutRecs(){
   for (PolyOutList::size_type i = 0; i < m_PolyOuts.size(); ++i)
     DisposeOutRec(i);
   m_PolyOuts.clear();
+  m_Arena.Reset();
 }
 //------------------------------------------------------------------------------
 
@@ -1359,7 +1417,6 @@ void ClipperBase::DisposeOutRec(PolyOutList::size_type index)
 {
   OutRec *outRec = m_PolyOuts[index];
   if (outRec->Pts) DisposeOutPts(outRec->Pts);
-  delete outRec;
   m_PolyOuts[index] = 0;
 }
 //------------------------------------------------------------------------------
@@ -1379,7 +1436,7 @@ void ClipperBase::DeleteFromAEL(TEdge *e)
 
 OutRec* ClipperBase::CreateOutRec()
 {
-  OutRec* result = new OutRec;
+  OutRec* result = m_Arena.New<OutRec>();
   result->IsHole = false;
   result->IsOpen = false;
   result->FirstLeft = 0;
@@ -1562,7 +1619,7 @@ bool Clipper::ExecuteInternal()
   bool succeeded = true;
   try {
     Reset();
-    m_Maxima = MaximaList();
+    m_Maxima.clear();
     m_SortedEdges = 0;
 
     succeeded = true;
@@ -1941,7 +1998,7 @@ void Clipper::CopyAELToSEL()
 
 void Clipper::AddJoin(OutPt *op1, OutPt *op2, const IntPoint OffPt)
 {
-  Join* j = new Join;
+  Join* j = m_Arena.New<Join>();
   j->OutPt1 = op1;
   j->OutPt2 = op2;
   j->OffPt = OffPt;
@@ -1951,23 +2008,19 @@ void Clipper::AddJoin(OutPt *op1, OutPt *op2, const IntPoint OffPt)
 
 void Clipper::ClearJoins()
 {
-  for (JoinList::size_type i = 0; i < m_Joins.size(); i++)
-    delete m_Joins[i];
   m_Joins.resize(0);
 }
 //------------------------------------------------------------------------------
 
 void Clipper::ClearGhostJoins()
 {
-  for (JoinList::size_type i = 0; i < m_GhostJoins.size(); i++)
-    delete m_GhostJoins[i];
   m_GhostJoins.resize(0);
 }
 //------------------------------------------------------------------------------
 
 void Clipper::AddGhostJoin(OutPt *op, const IntPoint OffPt)
 {
-  Join* j = new Join;
+  Join* j = m_Arena.New<Join>();
   j->OutPt1 = op;
   j->OutPt2 = 0;
   j->OffPt = OffPt;
@@ -2466,7 +2519,7 @@ OutPt* Clipper::AddOutPt(TEdge *e, const IntPoint &pt)
   {
     OutRec *outRec = CreateOutRec();
     outRec->IsOpen = (e->WindDelta == 0);
-    OutPt* newOp = new OutPt;
+    OutPt* newOp = m_Arena.New<OutPt>();
     outRec->Pts = newOp;
     newOp->Idx = outRec->Idx;
     newOp->Pt = pt;
@@ -2486,7 +2539,7 @@ OutPt* Clipper::AddOutPt(TEdge *e, const IntPoint &pt)
 	if (ToFront && (pt == op->Pt)) return op;
     else if (!ToFront && (pt == op->Prev->Pt)) return op->Prev;
 
-    OutPt* newOp = new OutPt;
+    OutPt* newOp = m_Arena.New<OutPt>();
     newOp->Idx = outRec->Idx;
     newOp->Pt = pt;
     newOp->Next = op;
@@ -2847,8 +2900,6 @@ bool Clipper::ProcessIntersections(const cInt topY)
 
 void Clipper::DisposeIntersectNodes()
 {
-  for (size_t i = 0; i < m_IntersectList.size(); ++i )
-    delete m_IntersectList[i];
   m_IntersectList.clear();
 }
 //------------------------------------------------------------------------------
@@ -2882,7 +2933,7 @@ void Clipper::BuildIntersectList(const cInt topY)
       {
         IntersectPoint(*e, *eNext, Pt);
         if (Pt.Y < topY) Pt = IntPoint(TopX(*e, topY), topY);
-        IntersectNode * newNode = new IntersectNode;
+        IntersectNode * newNode = m_Arena.New<IntersectNode>();
         newNode->Edge1 = e;
         newNode->Edge2 = eNext;
         newNode->Pt = Pt;
@@ -2912,7 +2963,6 @@ void Clipper::ProcessIntersectList()
       IntersectEdges( iNode->Edge1, iNode->Edge2, iNode->Pt);
       SwapPositionsInAEL( iNode->Edge1 , iNode->Edge2 );
     }
-    delete iNode;
   }
   m_IntersectList.clear();
 }
@@ -3071,7 +3121,7 @@ void Clipper::ProcessEdgesAtTopOfScanbeam(const cInt topY)
   }
 
   //3. Process horizontals at the Top of the scanbeam ...
-  m_Maxima.sort();
+  std::sort(m_Maxima.begin(), m_Maxima.end());
   ProcessHorizontals();
   m_Maxima.clear();
 
@@ -3126,7 +3176,6 @@ void Clipper::FixupOutPolyline(OutRec &outrec)
       OutPt *tmpPP = pp->Prev;
       tmpPP->Next = pp->Next;
       pp->Next->Prev = tmpPP;
-      delete pp;
       pp = tmpPP;
     }
   }
@@ -3164,11 +3213,9 @@ void Clipper::FixupOutPolygon(OutRec &outrec)
             (!preserveCol || !Pt2IsBetweenPt1AndPt3(pp->Prev->Pt, pp->Pt, pp->Next->Pt))))
         {
             lastOK = 0;
-            OutPt *tmp = pp;
             pp->Prev->Next = pp->Next;
             pp->Next->Prev = pp->Prev;
             pp = pp->Prev;
-            delete tmp;
         }
         else if (pp == lastOK) break;
         else
@@ -3228,7 +3275,7 @@ void Clipper::BuildResult2(PolyTree& polytree)
         int cnt = PointCount(outRec->Pts);
         if ((outRec->IsOpen && cnt < 2) || (!outRec->IsOpen && cnt < 3)) continue;
         FixHoleLinkage(*outRec);
-        PolyNode* pn = new PolyNode();
+        PolyNode* pn = polytree.NewNode();
         //nb: polytree takes ownership of all the PolyNodes
         polytree.AllNodes.push_back(pn);
         outRec->PolyNd = pn;
@@ -3345,9 +3392,9 @@ void Clipper::InsertEdgeIntoAEL(TEdge *edge, TEdge* startEdge)
 }
 //----------------------------------------------------------------------
 
-OutPt* DupOutPt(OutPt* outPt, bool InsertAfter)
+OutPt* DupOutPt(Arena& arena, OutPt* outPt, bool InsertAfter)
 {
-  OutPt* result = new OutPt;
+  OutPt* result = arena.New<OutPt>();
   result->Pt = outPt->Pt;
   result->Idx = outPt->Idx;
   if (InsertAfter)
@@ -3368,7 +3415,7 @@ OutPt* DupOutPt(OutPt* outPt, bool InsertAfter)
 }
 //------------------------------------------------------------------------------
 
-bool JoinHorz(OutPt* op1, OutPt* op1b, OutPt* op2, OutPt* op2b,
+bool JoinHorz(Arena& arena, OutPt* op1, OutPt* op1b, OutPt* op2, OutPt* op2b,
   const IntPoint Pt, bool DiscardLeft)
 {
   Direction Dir1 = (op1->Pt.X > op1b->Pt.X ? dRightToLeft : dLeftToRight);
@@ -3386,12 +3433,12 @@ bool JoinHorz(OutPt* op1, OutPt* op1b, OutPt* op2, OutPt* op2b,
       op1->Next->Pt.X >= op1->Pt.X && op1->Next->Pt.Y == Pt.Y)  
         op1 = op1->Next;
     if (DiscardLeft && (op1->Pt.X != Pt.X)) op1 = op1->Next;
-    op1b = DupOutPt(op1, !DiscardLeft);
+    op1b = DupOutPt(arena, op1, !DiscardLeft);
     if (op1b->Pt != Pt) 
     {
       op1 = op1b;
       op1->Pt = Pt;
-      op1b = DupOutPt(op1, !DiscardLeft);
+      op1b = DupOutPt(arena, op1, !DiscardLeft);
     }
   } 
   else
@@ -3400,12 +3447,12 @@ bool JoinHorz(OutPt* op1, OutPt* op1b, OutPt* op2, OutPt* op2b,
       op1->Next->Pt.X <= op1->Pt.X && op1->Next->Pt.Y == Pt.Y) 
         op1 = op1->Next;
     if (!DiscardLeft && (op1->Pt.X != Pt.X)) op1 = op1->Next;
-    op1b = DupOutPt(op1, DiscardLeft);
+    op1b = DupOutPt(arena, op1, DiscardLeft);
     if (op1b->Pt != Pt)
     {
       op1 = op1b;
       op1->Pt = Pt;
-      op1b = DupOutPt(op1, DiscardLeft);
+      op1b = DupOutPt(arena, op1, DiscardLeft);
     }
   }
 
@@ -3415,12 +3462,12 @@ bool JoinHorz(OutPt* op1, OutPt* op1b, OutPt* op2, OutPt* op2b,
       op2->Next->Pt.X >= op2->Pt.X && op2->Next->Pt.Y == Pt.Y)
         op2 = op2->Next;
     if (DiscardLeft && (op2->Pt.X != Pt.X)) op2 = op2->Next;
-    op2b = DupOutPt(op2, !DiscardLeft);
+    op2b = DupOutPt(arena, op2, !DiscardLeft);
     if (op2b->Pt != Pt)
     {
       op2 = op2b;
       op2->Pt = Pt;
-      op2b = DupOutPt(op2, !DiscardLeft);
+      op2b = DupOutPt(arena, op2, !DiscardLeft);
     };
   } else
   {
@@ -3428,12 +3475,12 @@ bool JoinHorz(OutPt* op1, OutPt* op1b, OutPt* op2, OutPt* op2b,
       op2->Next->Pt.X <= op2->Pt.X && op2->Next->Pt.Y == Pt.Y) 
         op2 = op2->Next;
     if (!DiscardLeft && (op2->Pt.X != Pt.X)) op2 = op2->Next;
-    op2b = DupOutPt(op2, DiscardLeft);
+    op2b = DupOutPt(arena, op2, DiscardLeft);
     if (op2b->Pt != Pt)
     {
       op2 = op2b;
       op2->Pt = Pt;
-      op2b = DupOutPt(op2, DiscardLeft);
+      op2b = DupOutPt(arena, op2, DiscardLeft);
     };
   };
 
@@ -3485,8 +3532,8 @@ bool Clipper::JoinPoints(Join *j, OutRec* outRec1, OutRec* outRec2)
     if (reverse1 == reverse2) return false;
     if (reverse1)
     {
-      op1b = DupOutPt(op1, false);
-      op2b = DupOutPt(op2, true);
+      op1b = DupOutPt(m_Arena, op1, false);
+      op2b = DupOutPt(m_Arena, op2, true);
       op1->Prev = op2;
       op2->Next = op1;
       op1b->Next = op2b;
@@ -3496,8 +3543,8 @@ bool Clipper::JoinPoints(Join *j, OutRec* outRec1, OutRec* outRec2)
       return true;
     } else
     {
-      op1b = DupOutPt(op1, true);
-      op2b = DupOutPt(op2, false);
+      op1b = DupOutPt(m_Arena, op1, true);
+      op2b = DupOutPt(m_Arena, op2, false);
       op1->Next = op2;
       op2->Prev = op1;
       op1b->Prev = op2b;
@@ -3553,7 +3600,7 @@ bool Clipper::JoinPoints(Join *j, OutRec* outRec1, OutRec* outRec2)
       Pt = op2b->Pt; DiscardLeftSide = (op2b->Pt.X > op2->Pt.X);
     }
     j->OutPt1 = op1; j->OutPt2 = op2;
-    return JoinHorz(op1, op1b, op2, op2b, Pt, DiscardLeftSide);
+    return JoinHorz(m_Arena, op1, op1b, op2, op2b, Pt, DiscardLeftSide);
   } else
   {
     //nb: For non-horizontal joins ...
@@ -3589,8 +3636,8 @@ bool Clipper::JoinPoints(Join *j, OutRec* outRec1, OutRec* outRec2)
 
     if (Reverse1)
     {
-      op1b = DupOutPt(op1, false);
-      op2b = DupOutPt(op2, true);
+      op1b = DupOutPt(m_Arena, op1, false);
+      op2b = DupOutPt(m_Arena, op2, true);
       op1->Prev = op2;
       op2->Next = op1;
       op1b->Next = op2b;
@@ -3600,8 +3647,8 @@ bool Clipper::JoinPoints(Join *j, OutRec* outRec1, OutRec* outRec2)
       return true;
     } else
     {
-      op1b = DupOutPt(op1, true);
-      op2b = DupOutPt(op2, false);
+      op1b = DupOutPt(m_Arena, op1, true);
+      op2b = DupOutPt(m_Arena, op2, false);
       op1->Next = op2;
       op2->Prev = op1;
       op1b->Prev = op2b;
@@ -3788,19 +3835,26 @@ ClipperOffset::ClipperOffset(double miterLimit, double arcTolerance)
   this->MiterLimit = miterLimit;
   this->ArcTolerance = arcTolerance;
   m_lowest.X = -1;
+  m_destCount = 0;
 }
 //------------------------------------------------------------------------------
 
 ClipperOffset::~ClipperOffset()
 {
   Clear();
+  for (PolyNodes::size_type i = 0; i < m_freeNodes.size(); ++i)
+    delete m_freeNodes[i];
 }
 //------------------------------------------------------------------------------
 
 void ClipperOffset::Clear()
 {
+  //nodes are kept (with their contour storage) for the next path ...
   for (int i = 0; i < m_polyNodes.ChildCount(); ++i)
-    delete m_polyNodes.Childs[i];
+  {
+    m_polyNodes.Childs[i]->Contour.clear();
+    m_freeNodes.push_back(m_polyNodes.Childs[i]);
+  }
   m_polyNodes.Childs.clear();
   m_lowest.X = -1;
 }
@@ -3810,7 +3864,13 @@ void ClipperOffset::AddPath(const Path& path, JoinType joinType, EndType endType
 {
   int highI = (int)path.size() - 1;
   if (highI < 0) return;
-  PolyNode* newNode = new PolyNode();
+  PolyNode* newNode;
+  if (m_freeNodes.empty()) newNode = new PolyNode();
+  else
+  {
+    newNode = m_freeNodes.back();
+    m_freeNodes.pop_back();
+  }
   newNode->m_jointype = joinType;
   newNode->m_endtype = endType;
 
@@ -3831,7 +3891,8 @@ void ClipperOffset::AddPath(const Path& path, JoinType joinType, EndType endType
     }
   if (endType == etClosedPolygon && j < 2)
   {
-    delete newNode;
+    newNode->Contour.clear();
+    m_freeNodes.push_back(newNode);
     return;
   }
   m_polyNodes.AddChild(*newNode);
@@ -3884,31 +3945,42 @@ void ClipperOffset::FixOrientations()
 }
 //------------------------------------------------------------------------------
 
-void ClipperOffset::Execute(Paths& solution, double delta)
+void ClipperOffset::Prepare(double delta)
 {
-  solution.clear();
   FixOrientations();
   DoOffset(delta);
   
-  //now clean up 'corners' ...
-  Clipper clpr;
-  clpr.AddPaths(m_destPolys, ptSubject, true);
+  //now clean up 'corners' (reusing the clipper from the last call) ...
+  m_clipper.Clear();
+  m_clipper.ReverseSolution(false);
+  for (Paths::size_type i = 0; i < m_destCount; ++i)
+    m_clipper.AddPath(m_destPolys[i], ptSubject, true);
+  if (delta <= 0)
+  {
+    IntRect r = m_clipper.GetBounds();
+    m_outer.resize(4);
+    m_outer[0] = IntPoint(r.left - 10, r.bottom + 10);
+    m_outer[1] = IntPoint(r.right + 10, r.bottom + 10);
+    m_outer[2] = IntPoint(r.right + 10, r.top - 10);
+    m_outer[3] = IntPoint(r.left - 10, r.top - 10);
+
+    m_clipper.AddPath(m_outer, ptSubject, true);
+    m_clipper.ReverseSolution(true);
+  }
+}
+//------------------------------------------------------------------------------
+
+void ClipperOffset::Execute(Paths& solution, double delta)
+{
+  solution.clear();
+  Prepare(delta);
   if (delta > 0)
   {
-    clpr.Execute(ctUnion, solution, pftPositive, pftPositive);
+    m_clipper.Execute(ctUnion, solution, pftPositive, pftPositive);
   }
   else
   {
-    IntRect r = clpr.GetBounds();
-    Path outer(4);
-    outer[0] = IntPoint(r.left - 10, r.bottom + 10);
-    outer[1] = IntPoint(r.right + 10, r.bottom + 10);
-    outer[2] = IntPoint(r.right + 10, r.top - 10);
-    outer[3] = IntPoint(r.left - 10, r.top - 10);
-
-    clpr.AddPath(outer, ptSubject, true);
-    clpr.ReverseSolution(true);
-    clpr.Execute(ctUnion, solution, pftNegative, pftNegative);
+    m_clipper.Execute(ctUnion, solution, pftNegative, pftNegative);
     if (solution.size() > 0) solution.erase(solution.begin());
   }
 }
@@ -3917,28 +3989,14 @@ void ClipperOffset::Execute(Paths& solution, double delta)
 void ClipperOffset::Execute(PolyTree& solution, double delta)
 {
   solution.Clear();
-  FixOrientations();
-  DoOffset(delta);
-
-  //now clean up 'corners' ...
-  Clipper clpr;
-  clpr.AddPaths(m_destPolys, ptSubject, true);
+  Prepare(delta);
   if (delta > 0)
   {
-    clpr.Execute(ctUnion, solution, pftPositive, pftPositive);
+    m_clipper.Execute(ctUnion, solution, pftPositive, pftPositive);
   }
   else
   {
-    IntRect r = clpr.GetBounds();
-    Path outer(4);
-    outer[0] = IntPoint(r.left - 10, r.bottom + 10);
-    outer[1] = IntPoint(r.right + 10, r.bottom + 10);
-    outer[2] = IntPoint(r.right + 10, r.top - 10);
-    outer[3] = IntPoint(r.left - 10, r.top - 10);
-
-    clpr.AddPath(outer, ptSubject, true);
-    clpr.ReverseSolution(true);
-    clpr.Execute(ctUnion, solution, pftNegative, pftNegative);
+    m_clipper.Execute(ctUnion, solution, pftNegative, pftNegative);
     //remove the outer PolyNode rectangle ...
     if (solution.ChildCount() == 1 && solution.Childs[0]->ChildCount() > 0)
     {
@@ -3955,9 +4013,20 @@ void ClipperOffset::Execute(PolyTree& solution, double delta)
 }
 //------------------------------------------------------------------------------
 
+void ClipperOffset::AddDestPoly(const Path& poly)
+{
+  //reuse the storage of the paths from the last offset ...
+  if (m_destCount < m_destPolys.size())
+    m_destPolys[m_destCount] = poly;
+  else
+    m_destPolys.push_back(poly);
+  m_destCount++;
+}
+//------------------------------------------------------------------------------
+
 void ClipperOffset::DoOffset(double delta)
 {
-  m_destPolys.clear();
+  m_destCount = 0;
   m_delta = delta;
 
   //if Zero offset, just copy any CLOSED polygons to m_p and return ...
@@ -3968,7 +4037,7 @@ void ClipperOffset::DoOffset(double delta)
     {
       PolyNode& node = *m_polyNodes.Childs[i];
       if (node.m_endtype == etClosedPolygon)
-        m_destPolys.push_back(node.Contour);
+        AddDestPoly(node.Contour);
     }
     return;
   }
@@ -4030,7 +4099,7 @@ void ClipperOffset::DoOffset(double delta)
           else X = -1;
         }
       }
-      m_destPolys.push_back(m_destPoly);
+      AddDestPoly(m_destPoly);
       continue;
     }
     //build m_normals ...
@@ -4048,14 +4117,14 @@ void ClipperOffset::DoOffset(double delta)
       int k = len - 1;
       for (int j = 0; j < len; ++j)
         OffsetPoint(j, k, node.m_jointype);
-      m_destPolys.push_back(m_destPoly);
+      AddDestPoly(m_destPoly);
     }
     else if (node.m_endtype == etClosedLine)
     {
       int k = len - 1;
       for (int j = 0; j < len; ++j)
         OffsetPoint(j, k, node.m_jointype);
-      m_destPolys.push_back(m_destPoly);
+      AddDestPoly(m_destPoly);
       m_destPoly.clear();
       //re-build m_normals ...
       DoublePoint n = m_normals[len -1];
@@ -4065,7 +4134,7 @@ void ClipperOffset::DoOffset(double delta)
       k = 0;
       for (int j = len - 1; j >= 0; j--)
         OffsetPoint(j, k, node.m_jointype);
-      m_destPolys.push_back(m_destPoly);
+      AddDestPoly(m_destPoly);
     }
     else
     {
@@ -4122,7 +4191,7 @@ void ClipperOffset::DoOffset(double delta)
         else
           DoRound(0, 1);
       }
-      m_destPolys.push_back(m_destPoly);
+      AddDestPoly(m_destPoly);
     }
   }
 }
@@ -56,6 +56,11 @@
     #include <dirent.h>
 #endif
 
+#if !defined (__WINDOWS__)
+    #include <sys/mman.h>
+    #include <fcntl.h>
+#endif
+
 
 
 namespace cugl {
@@ -1628,7 +1633,95 @@ bool set_writable(const std::string path, bool writable, bool ownerOnly) {
     return false;
 #endif
 }
-    
+
+/**
+ * Returns a read-only memory mapping of the file for this path name.
+ *
+ * The contents of the file are mapped into the address space of this
+ * application, so they can be read without system calls or copies. The
+ * size of the file (and the mapping) is stored in size. The mapping must
+ * be released with {@link #file_unmap}.
+ *
+ * This function returns nullptr if there is no file at the given path, if
+ * the file is empty, or if the file cannot be mapped. In particular, the
+ * asset directory on Android is inside the APK and cannot be mapped. The
+ * caller should fall back to reading the file with SDL in that case. If
+ * the path is a relative path, this function will use the asset directory
+ * as the working directory.
+ *
+ * @param path  The file path name
+ * @param size  Pointer to store the size of the file
+ *
+ * @return a read-only memory mapping of the file for this path name.
+ */
+const char* file_map(const std::string path, size_t* size) {
+    const std::string fullpath = to_absolute(path);
+    const char* result = nullptr;
+#if defined (__WINDOWS__)
+    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+    std::wstring wide = converter.from_bytes(fullpath);
+    HANDLE file = CreateFileW(wide.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+
+    LARGE_INTEGER length;
+    if (GetFileSizeEx(file, &length) && length.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping != NULL) {
+            // The view keeps the mapping alive
+            result = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+        if (result != nullptr) {
+            *size = (size_t)length.QuadPart;
+        }
+    }
+    CloseHandle(file);
+#else
+    int file = open(fullpath.c_str(), O_RDONLY);
+    if (file < 0) {
+        return nullptr;
+    }
+
+    struct stat status;
+    if (fstat(file, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0) {
+        void* data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (data != MAP_FAILED) {
+            // Readers are sequential, so favor readahead
+            madvise(data, (size_t)status.st_size, MADV_SEQUENTIAL);
+            result = (const char*)data;
+            *size = (size_t)status.st_size;
+        }
+    }
+    ::close(file);
+#endif
+    return result;
+}
+
+/**
+ * Releases a memory mapping created by {@link #file_map}.
+ *
+ * The size must be the one returned by {@link #file_map}. The data may not
+ * be accessed after this function is called.
+ *
+ * @param data  The mapped file contents
+ * @param size  The size of the mapping
+ *
+ * @return true if the mapping was successfully released.
+ */
+bool file_unmap(const char* data, size_t size) {
+    if (data == nullptr) {
+        return false;
+    }
+#if defined (__WINDOWS__)
+    return UnmapViewOfFile((LPCVOID)data) != 0;
+#else
+    return munmap((void*)data, size) == 0;
+#endif
+}
+
 
 #pragma mark -
 #pragma mark File Volumes
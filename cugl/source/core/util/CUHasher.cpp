@@ -0,0 +1,1106 @@
+//
+//  CUHasher.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides fast, non-cryptographic hashing of memory and files.
+//  It is intended for content-addressed caches, asset deduplication, and
+//  change detection, where a hash must be computed over a lot of data very
+//  quickly. These hashes are NOT secure, and should never be used to protect
+//  against deliberate tampering.
+//
+//  The algorithm is XXH3 (both the 64 and 128 bit variants) from the xxHash
+//  library by Yann Collet. Our implementation produces exactly the same values
+//  as the reference implementation, so hashes may be computed ahead of time by
+//  other tools (such as the Python xxhash package). Long inputs are processed
+//  with vectorized kernels (SSE2 or AVX2) when the CPU supports them.
+//
+//  This class is meant to be created on the stack. Therefore there is no
+//  support for shared pointers or initialization like in our other, more
+//  heavy-weight classes.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  This module is a port of XXH3 from the xxHash library, which is provided
+//  under the BSD 2-Clause license (see licenses/LICENSE.xxhash.txt).
+//
+//      Copyright (c) 2012-2021 Yann Collet
+//
+//  Author: agent
+//  Version: 10/19/26
+//
+#include <cugl/core/util/CUHasher.h>
+#include <cugl/core/util/CUDebug.h>
+#include <cugl/core/util/CUFiletools.h>
+#include <cugl/core/CUApplication.h>
+#include <cstring>
+#include <SDL_app.h>
+#include "CUSimd.h"
+
+using namespace cugl;
+
+/** The number of bytes in a stripe (the unit of the long hash) */
+#define STRIPE_LEN              64
+/** The number of secret bytes consumed by each stripe */
+#define SECRET_CONSUME_RATE     8
+/** The size of the secret */
+#define SECRET_SIZE             192
+/** The smallest secret size permitted by XXH3 (used for some offsets) */
+#define SECRET_SIZE_MIN         136
+/** The number of stripes before the accumulators are scrambled */
+#define STRIPES_PER_BLOCK       ((SECRET_SIZE-STRIPE_LEN)/SECRET_CONSUME_RATE)
+/** The secret offset of the last stripe */
+#define SECRET_LASTACC_START    7
+/** The secret offset when merging the accumulators */
+#define SECRET_MERGEACCS_START  11
+/** The largest input hashed without the accumulators */
+#define MIDSIZE_MAX             240
+/** The secret offset for the second half of a medium input */
+#define MIDSIZE_STARTOFFSET     3
+/** The secret offset for the last 16 bytes of a medium input */
+#define MIDSIZE_LASTOFFSET      17
+/** The size of the chunks when a file cannot be memory mapped */
+#define FILE_CHUNK              65536
+
+#pragma mark -
+#pragma mark Hash Primitives
+
+// The primes of xxHash
+static const Uint64 PRIME32_1 = 0x9E3779B1U;
+static const Uint64 PRIME32_2 = 0x85EBCA77U;
+static const Uint64 PRIME32_3 = 0xC2B2AE3DU;
+static const Uint64 PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const Uint64 PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const Uint64 PRIME64_3 = 0x165667B19E3779F9ULL;
+static const Uint64 PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static const Uint64 PRIME64_5 = 0x27D4EB2F165667C5ULL;
+static const Uint64 PRIME_MX1 = 0x165667919E3779F9ULL;
+static const Uint64 PRIME_MX2 = 0x9FB21C651E98DF25ULL;
+
+/** The default secret of XXH3 (a seed shifts this secret) */
+alignas(64) static const Uint8 DEFAULT_SECRET[SECRET_SIZE] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+/** The initial values of the accumulators */
+static const Uint64 INITIAL_ACC[8] = {
+    PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3, PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1
+};
+
+/**
+ * Returns the little-endian 32 bit word at the given (unaligned) address
+ *
+ * @param data  The address to read
+ *
+ * @return the little-endian 32 bit word at the given address
+ */
+static inline Uint64 read32(const Uint8* data) {
+    Uint32 value;
+    std::memcpy(&value, data, sizeof(Uint32));
+    return SDL_SwapLE32(value);
+}
+
+/**
+ * Returns the little-endian 64 bit word at the given (unaligned) address
+ *
+ * @param data  The address to read
+ *
+ * @return the little-endian 64 bit word at the given address
+ */
+static inline Uint64 read64(const Uint8* data) {
+    Uint64 value;
+    std::memcpy(&value, data, sizeof(Uint64));
+    return SDL_SwapLE64(value);
+}
+
+/**
+ * Writes a 64 bit word in little-endian order to the given (unaligned) address
+ *
+ * @param data  The address to write
+ * @param value The value to write
+ */
+static inline void write64(Uint8* data, Uint64 value) {
+    value = SDL_SwapLE64(value);
+    std::memcpy(data, &value, sizeof(Uint64));
+}
+
+/**
+ * Returns the 64 bit word rotated left by the given amount
+ *
+ * @param value The word to rotate
+ * @param bits  The number of bits to rotate (0 < bits < 64)
+ *
+ * @return the 64 bit word rotated left by the given amount
+ */
+static inline Uint64 rotl64(Uint64 value, int bits) {
+    return (value << bits) | (value >> (64-bits));
+}
+
+/**
+ * Returns the full 128 bit product of two 64 bit words
+ *
+ * @param lhs   The first factor
+ * @param rhs   The second factor
+ *
+ * @return the full 128 bit product of two 64 bit words
+ */
+static inline Hash128 mult128(Uint64 lhs, Uint64 rhs) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t product = (__uint128_t)lhs*rhs;
+    return Hash128((Uint64)product, (Uint64)(product >> 64));
+#elif defined(_MSC_VER) && defined(_M_X64)
+    Uint64 high;
+    Uint64 low = _umul128(lhs, rhs, &high);
+    return Hash128(low, high);
+#else
+    Uint64 lo_lo = (lhs & 0xFFFFFFFF) * (rhs & 0xFFFFFFFF);
+    Uint64 hi_lo = (lhs >> 32) * (rhs & 0xFFFFFFFF);
+    Uint64 lo_hi = (lhs & 0xFFFFFFFF) * (rhs >> 32);
+    Uint64 hi_hi = (lhs >> 32) * (rhs >> 32);
+    Uint64 cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+    Uint64 upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    Uint64 lower = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+    return Hash128(lower, upper);
+#endif
+}
+
+/**
+ * Returns the 128 bit product of two 64 bit words, folded to 64 bits
+ *
+ * @param lhs   The first factor
+ * @param rhs   The second factor
+ *
+ * @return the 128 bit product of two 64 bit words, folded to 64 bits
+ */
+static inline Uint64 fold64(Uint64 lhs, Uint64 rhs) {
+    Hash128 product = mult128(lhs, rhs);
+    return product.low ^ product.high;
+}
+
+/**
+ * Returns the XXH64 avalanche of the given word
+ *
+ * @param hash  The word to mix
+ *
+ * @return the XXH64 avalanche of the given word
+ */
+static inline Uint64 avalanche64(Uint64 hash) {
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+/**
+ * Returns the XXH3 avalanche of the given word
+ *
+ * @param hash  The word to mix
+ *
+ * @return the XXH3 avalanche of the given word
+ */
+static inline Uint64 avalanche(Uint64 hash) {
+    hash ^= hash >> 37;
+    hash *= PRIME_MX1;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+/**
+ * Returns the stronger avalanche of the given word (for 4-8 byte inputs)
+ *
+ * @param hash  The word to mix
+ * @param len   The input length
+ *
+ * @return the stronger avalanche of the given word
+ */
+static inline Uint64 rrmxmx(Uint64 hash, Uint64 len) {
+    hash ^= rotl64(hash, 49) ^ rotl64(hash, 24);
+    hash *= PRIME_MX2;
+    hash ^= (hash >> 35) + len;
+    hash *= PRIME_MX2;
+    return hash ^ (hash >> 28);
+}
+
+/**
+ * Returns the mix of 16 bytes of input with 16 bytes of the secret
+ *
+ * @param input     The input to mix
+ * @param secret    The secret to mix with
+ * @param seed      The hash seed
+ *
+ * @return the mix of 16 bytes of input with 16 bytes of the secret
+ */
+static inline Uint64 mix16(const Uint8* input, const Uint8* secret, Uint64 seed) {
+    return fold64(read64(input) ^ (read64(secret) + seed),
+                  read64(input+8) ^ (read64(secret+8) - seed));
+}
+
+/**
+ * Returns the accumulator updated by two 16 byte mixes (for 128 bit hashes)
+ *
+ * @param acc       The accumulator
+ * @param input1    The first input to mix
+ * @param input2    The second input to mix
+ * @param secret    The secret to mix with
+ * @param seed      The hash seed
+ *
+ * @return the accumulator updated by two 16 byte mixes
+ */
+static inline Hash128 mix32(Hash128 acc, const Uint8* input1, const Uint8* input2,
+                            const Uint8* secret, Uint64 seed) {
+    acc.low  += mix16(input1, secret, seed);
+    acc.low  ^= read64(input2) + read64(input2+8);
+    acc.high += mix16(input2, secret+16, seed);
+    acc.high ^= read64(input1) + read64(input1+8);
+    return acc;
+}
+
+/**
+ * Stores the secret for the given seed in secret
+ *
+ * @param secret    The buffer to store the secret
+ * @param seed      The hash seed
+ */
+static void init_secret(Uint8* secret, Uint64 seed) {
+    for(int ii = 0; ii < SECRET_SIZE/16; ii++) {
+        write64(secret+16*ii,   read64(DEFAULT_SECRET+16*ii)+seed);
+        write64(secret+16*ii+8, read64(DEFAULT_SECRET+16*ii+8)-seed);
+    }
+}
+
+#pragma mark -
+#pragma mark Short Inputs
+/**
+ * Returns the 64 bit hash of an input of at most 16 bytes
+ *
+ * @param input     The input to hash
+ * @param len       The input length
+ * @param secret    The default secret
+ * @param seed      The hash seed
+ *
+ * @return the 64 bit hash of an input of at most 16 bytes
+ */
+static Uint64 hash64_short(const Uint8* input, size_t len, const Uint8* secret, Uint64 seed) {
+    if (len > 8) {
+        Uint64 bitflip1 = (read64(secret+24) ^ read64(secret+32)) + seed;
+        Uint64 bitflip2 = (read64(secret+40) ^ read64(secret+48)) - seed;
+        Uint64 lo = read64(input) ^ bitflip1;
+        Uint64 hi = read64(input+len-8) ^ bitflip2;
+        Uint64 acc = len + SDL_Swap64(lo) + hi + fold64(lo, hi);
+        return avalanche(acc);
+    } else if (len >= 4) {
+        seed ^= (Uint64)SDL_Swap32((Uint32)seed) << 32;
+        Uint64 input1 = read32(input);
+        Uint64 input2 = read32(input+len-4);
+        Uint64 bitflip = (read64(secret+8) ^ read64(secret+16)) - seed;
+        Uint64 keyed = (input2 + (input1 << 32)) ^ bitflip;
+        return rrmxmx(keyed, len);
+    } else if (len) {
+        Uint32 combined = ((Uint32)input[0] << 16) | ((Uint32)input[len >> 1] << 24)
+                        | ((Uint32)input[len-1]) | ((Uint32)len << 8);
+        Uint64 bitflip = (read32(secret) ^ read32(secret+4)) + seed;
+        return avalanche64((Uint64)combined ^ bitflip);
+    }
+    return avalanche64(seed ^ (read64(secret+56) ^ read64(secret+64)));
+}
+
+/**
+ * Returns the 64 bit hash of an input of 17 to 240 bytes
+ *
+ * @param input     The input to hash
+ * @param len       The input length
+ * @param secret    The default secret
+ * @param seed      The hash seed
+ *
+ * @return the 64 bit hash of an input of 17 to 240 bytes
+ */
+static Uint64 hash64_medium(const Uint8* input, size_t len, const Uint8* secret, Uint64 seed) {
+    Uint64 acc = len * PRIME64_1;
+    if (len <= 128) {
+        if (len > 32) {
+            if (len > 64) {
+                if (len > 96) {
+                    acc += mix16(input+48, secret+96, seed);
+                    acc += mix16(input+len-64, secret+112, seed);
+                }
+                acc += mix16(input+32, secret+64, seed);
+                acc += mix16(input+len-48, secret+80, seed);
+            }
+            acc += mix16(input+16, secret+32, seed);
+            acc += mix16(input+len-32, secret+48, seed);
+        }
+        acc += mix16(input, secret, seed);
+        acc += mix16(input+len-16, secret+16, seed);
+        return avalanche(acc);
+    }
+
+    size_t rounds = len/16;
+    for(size_t ii = 0; ii < 8; ii++) {
+        acc += mix16(input+16*ii, secret+16*ii, seed);
+    }
+    acc = avalanche(acc);
+    Uint64 end = mix16(input+len-16, secret+SECRET_SIZE_MIN-MIDSIZE_LASTOFFSET, seed);
+    for(size_t ii = 8; ii < rounds; ii++) {
+        end += mix16(input+16*ii, secret+16*(ii-8)+MIDSIZE_STARTOFFSET, seed);
+    }
+    return avalanche(acc+end);
+}
+
+/**
+ * Returns the 128 bit hash of an input of at most 16 bytes
+ *
+ * @param input     The input to hash
+ * @param len       The input length
+ * @param secret    The default secret
+ * @param seed      The hash seed
+ *
+ * @return the 128 bit hash of an input of at most 16 bytes
+ */
+static Hash128 hash128_short(const Uint8* input, size_t len, const Uint8* secret, Uint64 seed) {
+    if (len > 8) {
+        Uint64 bitflipl = (read64(secret+32) ^ read64(secret+40)) - seed;
+        Uint64 bitfliph = (read64(secret+48) ^ read64(secret+56)) + seed;
+        Uint64 lo = read64(input);
+        Uint64 hi = read64(input+len-8);
+        Hash128 m128 = mult128(lo ^ hi ^ bitflipl, PRIME64_1);
+        m128.low += (Uint64)(len-1) << 54;
+        hi ^= bitfliph;
+        m128.high += hi + (hi & 0xFFFFFFFF) * (PRIME32_2-1);
+        m128.low  ^= SDL_Swap64(m128.high);
+
+        Hash128 h128 = mult128(m128.low, PRIME64_2);
+        h128.high += m128.high * PRIME64_2;
+        h128.low  = avalanche(h128.low);
+        h128.high = avalanche(h128.high);
+        return h128;
+    } else if (len >= 4) {
+        seed ^= (Uint64)SDL_Swap32((Uint32)seed) << 32;
+        Uint64 lo = read32(input);
+        Uint64 hi = read32(input+len-4);
+        Uint64 bitflip = (read64(secret+16) ^ read64(secret+24)) + seed;
+        Uint64 keyed = (lo + (hi << 32)) ^ bitflip;
+
+        Hash128 m128 = mult128(keyed, PRIME64_1 + (len << 2));
+        m128.high += (m128.low << 1);
+        m128.low  ^= (m128.high >> 3);
+        m128.low  ^= m128.low >> 35;
+        m128.low  *= PRIME_MX2;
+        m128.low  ^= m128.low >> 28;
+        m128.high  = avalanche(m128.high);
+        return m128;
+    } else if (len) {
+        Uint32 combinedl = ((Uint32)input[0] << 16) | ((Uint32)input[len >> 1] << 24)
+                         | ((Uint32)input[len-1]) | ((Uint32)len << 8);
+        Uint32 swapped   = SDL_Swap32(combinedl);
+        Uint32 combinedh = (swapped << 13) | (swapped >> 19);
+        Uint64 bitflipl = (read32(secret) ^ read32(secret+4)) + seed;
+        Uint64 bitfliph = (read32(secret+8) ^ read32(secret+12)) - seed;
+        return Hash128(avalanche64((Uint64)combinedl ^ bitflipl),
+                       avalanche64((Uint64)combinedh ^ bitfliph));
+    }
+    Uint64 bitflipl = read64(secret+64) ^ read64(secret+72);
+    Uint64 bitfliph = read64(secret+80) ^ read64(secret+88);
+    return Hash128(avalanche64(seed ^ bitflipl), avalanche64(seed ^ bitfliph));
+}
+
+/**
+ * Returns the 128 bit hash of an input of 17 to 240 bytes
+ *
+ * @param input     The input to hash
+ * @param len       The input length
+ * @param secret    The default secret
+ * @param seed      The hash seed
+ *
+ * @return the 128 bit hash of an input of 17 to 240 bytes
+ */
+static Hash128 hash128_medium(const Uint8* input, size_t len, const Uint8* secret, Uint64 seed) {
+    Hash128 acc(len * PRIME64_1, 0);
+    if (len <= 128) {
+        if (len > 32) {
+            if (len > 64) {
+                if (len > 96) {
+                    acc = mix32(acc, input+48, input+len-64, secret+96, seed);
+                }
+                acc = mix32(acc, input+32, input+len-48, secret+64, seed);
+            }
+            acc = mix32(acc, input+16, input+len-32, secret+32, seed);
+        }
+        acc = mix32(acc, input, input+len-16, secret, seed);
+    } else {
+        for(size_t ii = 32; ii < 160; ii += 32) {
+            acc = mix32(acc, input+ii-32, input+ii-16, secret+ii-32, seed);
+        }
+        acc.low  = avalanche(acc.low);
+        acc.high = avalanche(acc.high);
+        for(size_t ii = 160; ii <= len; ii += 32) {
+            acc = mix32(acc, input+ii-32, input+ii-16, secret+MIDSIZE_STARTOFFSET+ii-160, seed);
+        }
+        acc = mix32(acc, input+len-16, input+len-32,
+                    secret+SECRET_SIZE_MIN-MIDSIZE_LASTOFFSET-16, 0-seed);
+    }
+
+    Hash128 result;
+    result.low  = avalanche(acc.low + acc.high);
+    result.high = (acc.low * PRIME64_1) + (acc.high * PRIME64_4) + ((len - seed) * PRIME64_2);
+    result.high = 0-avalanche(result.high);
+    return result;
+}
+
+#pragma mark -
+#pragma mark Long Input Kernels
+/**
+ * A kernel that accumulates the given number of stripes
+ *
+ * Each stripe is 64 bytes of input. The secret for each successive stripe
+ * is offset by 8 bytes.
+ */
+typedef void (*HashAccumulator)(Uint64* acc, const Uint8* input, const Uint8* secret, size_t stripes);
+
+/**
+ * A kernel that scrambles the accumulators at the end of a block
+ */
+typedef void (*HashScrambler)(Uint64* acc, const Uint8* secret);
+
+/**
+ * The kernels for the long input hash
+ */
+typedef struct {
+    /** The stripe accumulator */
+    HashAccumulator accumulate;
+    /** The block scrambler */
+    HashScrambler   scramble;
+} HashKernel;
+
+/**
+ * Accumulates the given number of stripes, one 64 bit lane at a time
+ *
+ * @param acc       The accumulators
+ * @param input     The input stripes
+ * @param secret    The secret for the first stripe
+ * @param stripes   The number of stripes
+ */
+static void accumulate_scalar(Uint64* acc, const Uint8* input, const Uint8* secret, size_t stripes) {
+    for(size_t nn = 0; nn < stripes; nn++) {
+        const Uint8* data = input+nn*STRIPE_LEN;
+        const Uint8* key  = secret+nn*SECRET_CONSUME_RATE;
+        for(size_t ii = 0; ii < 8; ii++) {
+            Uint64 value = read64(data+8*ii);
+            Uint64 mixed = value ^ read64(key+8*ii);
+            acc[ii ^ 1] += value;
+            acc[ii] += (mixed & 0xFFFFFFFF) * (mixed >> 32);
+        }
+    }
+}
+
+/**
+ * Scrambles the accumulators, one 64 bit lane at a time
+ *
+ * @param acc       The accumulators
+ * @param secret    The scrambling secret
+ */
+static void scramble_scalar(Uint64* acc, const Uint8* secret) {
+    for(size_t ii = 0; ii < 8; ii++) {
+        Uint64 value = acc[ii];
+        value ^= value >> 47;
+        value ^= read64(secret+8*ii);
+        acc[ii] = value * PRIME32_1;
+    }
+}
+
+#if CU_SIMD_X86
+/**
+ * Returns the accumulator lanes updated by 16 bytes of a stripe
+ *
+ * @param acc   The accumulator lanes
+ * @param data  The input bytes
+ * @param key   The secret bytes
+ *
+ * @return the accumulator lanes updated by 16 bytes of a stripe
+ */
+CU_SIMD_SSE2 static inline __m128i accumulate_sse2_lane(__m128i acc, __m128i data, __m128i key) {
+    __m128i mixed = _mm_xor_si128(data, key);
+    __m128i high  = _mm_shuffle_epi32(mixed, _MM_SHUFFLE(0, 3, 0, 1));
+    __m128i prod  = _mm_mul_epu32(mixed, high);
+    __m128i swap  = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+    return _mm_add_epi64(prod, _mm_add_epi64(acc, swap));
+}
+
+/**
+ * Accumulates the given number of stripes, 16 bytes at a time
+ *
+ * @param acc       The accumulators
+ * @param input     The input stripes
+ * @param secret    The secret for the first stripe
+ * @param stripes   The number of stripes
+ */
+CU_SIMD_SSE2 static void accumulate_sse2(Uint64* acc, const Uint8* input, const Uint8* secret, size_t stripes) {
+    __m128i* xacc = (__m128i*)acc;
+    __m128i acc0 = _mm_loadu_si128(xacc);
+    __m128i acc1 = _mm_loadu_si128(xacc+1);
+    __m128i acc2 = _mm_loadu_si128(xacc+2);
+    __m128i acc3 = _mm_loadu_si128(xacc+3);
+    for(size_t nn = 0; nn < stripes; nn++) {
+        const __m128i* data = (const __m128i*)(input+nn*STRIPE_LEN);
+        const __m128i* key  = (const __m128i*)(secret+nn*SECRET_CONSUME_RATE);
+        acc0 = accumulate_sse2_lane(acc0, _mm_loadu_si128(data),   _mm_loadu_si128(key));
+        acc1 = accumulate_sse2_lane(acc1, _mm_loadu_si128(data+1), _mm_loadu_si128(key+1));
+        acc2 = accumulate_sse2_lane(acc2, _mm_loadu_si128(data+2), _mm_loadu_si128(key+2));
+        acc3 = accumulate_sse2_lane(acc3, _mm_loadu_si128(data+3), _mm_loadu_si128(key+3));
+    }
+    _mm_storeu_si128(xacc,   acc0);
+    _mm_storeu_si128(xacc+1, acc1);
+    _mm_storeu_si128(xacc+2, acc2);
+    _mm_storeu_si128(xacc+3, acc3);
+}
+
+/**
+ * Scrambles the accumulators, 16 bytes at a time
+ *
+ * @param acc       The accumulators
+ * @param secret    The scrambling secret
+ */
+CU_SIMD_SSE2 static void scramble_sse2(Uint64* acc, const Uint8* secret) {
+    __m128i* xacc = (__m128i*)acc;
+    const __m128i* key = (const __m128i*)secret;
+    const __m128i prime = _mm_set1_epi32((int)PRIME32_1);
+    for(size_t ii = 0; ii < 4; ii++) {
+        __m128i value = _mm_loadu_si128(xacc+ii);
+        value = _mm_xor_si128(value, _mm_srli_epi64(value, 47));
+        value = _mm_xor_si128(value, _mm_loadu_si128(key+ii));
+        __m128i high = _mm_shuffle_epi32(value, _MM_SHUFFLE(0, 3, 0, 1));
+        __m128i prodlo = _mm_mul_epu32(value, prime);
+        __m128i prodhi = _mm_mul_epu32(high, prime);
+        _mm_storeu_si128(xacc+ii, _mm_add_epi64(prodlo, _mm_slli_epi64(prodhi, 32)));
+    }
+}
+
+/**
+ * Returns the accumulator lanes updated by 32 bytes of a stripe
+ *
+ * @param acc   The accumulator lanes
+ * @param data  The input bytes
+ * @param key   The secret bytes
+ *
+ * @return the accumulator lanes updated by 32 bytes of a stripe
+ */
+CU_SIMD_AVX2 static inline __m256i accumulate_avx2_lane(__m256i acc, __m256i data, __m256i key) {
+    __m256i mixed = _mm256_xor_si256(data, key);
+    __m256i high  = _mm256_srli_epi64(mixed, 32);
+    __m256i prod  = _mm256_mul_epu32(mixed, high);
+    __m256i swap  = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+    return _mm256_add_epi64(prod, _mm256_add_epi64(acc, swap));
+}
+
+/**
+ * Accumulates the given number of stripes, 32 bytes at a time
+ *
+ * @param acc       The accumulators
+ * @param input     The input stripes
+ * @param secret    The secret for the first stripe
+ * @param stripes   The number of stripes
+ */
+CU_SIMD_AVX2 static void accumulate_avx2(Uint64* acc, const Uint8* input, const Uint8* secret, size_t stripes) {
+    __m256i* xacc = (__m256i*)acc;
+    __m256i acc0 = _mm256_loadu_si256(xacc);
+    __m256i acc1 = _mm256_loadu_si256(xacc+1);
+    for(size_t nn = 0; nn < stripes; nn++) {
+        const __m256i* data = (const __m256i*)(input+nn*STRIPE_LEN);
+        const __m256i* key  = (const __m256i*)(secret+nn*SECRET_CONSUME_RATE);
+        acc0 = accumulate_avx2_lane(acc0, _mm256_loadu_si256(data),   _mm256_loadu_si256(key));
+        acc1 = accumulate_avx2_lane(acc1, _mm256_loadu_si256(data+1), _mm256_loadu_si256(key+1));
+    }
+    _mm256_storeu_si256(xacc,   acc0);
+    _mm256_storeu_si256(xacc+1, acc1);
+}
+
+/**
+ * Scrambles the accumulators, 32 bytes at a time
+ *
+ * @param acc       The accumulators
+ * @param secret    The scrambling secret
+ */
+CU_SIMD_AVX2 static void scramble_avx2(Uint64* acc, const Uint8* secret) {
+    __m256i* xacc = (__m256i*)acc;
+    const __m256i* key = (const __m256i*)secret;
+    const __m256i prime = _mm256_set1_epi32((int)PRIME32_1);
+    for(size_t ii = 0; ii < 2; ii++) {
+        __m256i value = _mm256_loadu_si256(xacc+ii);
+        value = _mm256_xor_si256(value, _mm256_srli_epi64(value, 47));
+        value = _mm256_xor_si256(value, _mm256_loadu_si256(key+ii));
+        __m256i high = _mm256_srli_epi64(value, 32);
+        __m256i prodlo = _mm256_mul_epu32(value, prime);
+        __m256i prodhi = _mm256_mul_epu32(high, prime);
+        _mm256_storeu_si256(xacc+ii, _mm256_add_epi64(prodlo, _mm256_slli_epi64(prodhi, 32)));
+    }
+}
+#endif
+
+/**
+ * Returns the fastest long input kernels for this CPU
+ *
+ * @return the fastest long input kernels for this CPU
+ */
+static const HashKernel& hash_kernel() {
+    static const HashKernel kernel = [] {
+        HashKernel result = { &accumulate_scalar, &scramble_scalar };
+#if CU_SIMD_X86
+        if (SDL_HasAVX2()) {
+            result = { &accumulate_avx2, &scramble_avx2 };
+        } else if (SDL_HasSSE2()) {
+            result = { &accumulate_sse2, &scramble_sse2 };
+        }
+#endif
+        return result;
+    }();
+    return kernel;
+}
+
+#pragma mark -
+#pragma mark Long Inputs
+/**
+ * Accumulates the stripes of an input, continuing the current block
+ *
+ * This function scrambles the accumulators at the end of each block. The
+ * value stripes is the number of stripes accumulated in the current block,
+ * and is updated by this function.
+ *
+ * @param acc       The accumulators
+ * @param stripes   The number of stripes accumulated in the current block
+ * @param input     The input stripes
+ * @param count     The number of stripes to accumulate
+ * @param secret    The hash secret
+ * @param kernel    The kernels to use
+ *
+ * @return the input after the accumulated stripes
+ */
+static const Uint8* consume_stripes(Uint64* acc, size_t* stripes, const Uint8* input, size_t count,
+                                    const Uint8* secret, const HashKernel& kernel) {
+    const Uint8* start = secret + (*stripes) * SECRET_CONSUME_RATE;
+    size_t remain = STRIPES_PER_BLOCK - *stripes;
+    if (count >= remain) {
+        do {
+            kernel.accumulate(acc, input, start, remain);
+            kernel.scramble(acc, secret+SECRET_SIZE-STRIPE_LEN);
+            input += remain*STRIPE_LEN;
+            count -= remain;
+            remain = STRIPES_PER_BLOCK;
+            start  = secret;
+            *stripes = 0;
+        } while (count >= STRIPES_PER_BLOCK);
+    }
+    if (count > 0) {
+        kernel.accumulate(acc, input, start, count);
+        input += count*STRIPE_LEN;
+        *stripes += count;
+    }
+    return input;
+}
+
+/**
+ * Returns the accumulators merged into a 64 bit hash
+ *
+ * @param acc       The accumulators
+ * @param secret    The secret to merge with
+ * @param start     The initial hash value
+ *
+ * @return the accumulators merged into a 64 bit hash
+ */
+static Uint64 merge_accs(const Uint64* acc, const Uint8* secret, Uint64 start) {
+    Uint64 result = start;
+    for(size_t ii = 0; ii < 4; ii++) {
+        result += fold64(acc[2*ii] ^ read64(secret+16*ii), acc[2*ii+1] ^ read64(secret+16*ii+8));
+    }
+    return avalanche(result);
+}
+
+/**
+ * Accumulates an input of more than 240 bytes in acc
+ *
+ * The accumulators must be initialized to {@link INITIAL_ACC}.
+ *
+ * @param acc       The accumulators
+ * @param input     The input to hash
+ * @param len       The input length
+ * @param secret    The hash secret
+ */
+static void hash_long(Uint64* acc, const Uint8* input, size_t len, const Uint8* secret) {
+    const HashKernel& kernel = hash_kernel();
+    size_t stripes = 0;
+    consume_stripes(acc, &stripes, input, (len-1)/STRIPE_LEN, secret, kernel);
+    kernel.accumulate(acc, input+len-STRIPE_LEN, secret+SECRET_SIZE-STRIPE_LEN-SECRET_LASTACC_START, 1);
+}
+
+#pragma mark -
+#pragma mark Hash128
+/**
+ * Returns a string representation of this hash
+ *
+ * The string is 32 lower-case hexadecimal digits, with the high word first.
+ *
+ * @return a string representation of this hash
+ */
+std::string Hash128::toString() const {
+    static const char* digits = "0123456789abcdef";
+    std::string result(32, '0');
+    for(int ii = 0; ii < 16; ii++) {
+        result[15-ii] = digits[(high >> (4*ii)) & 0xF];
+        result[31-ii] = digits[(low  >> (4*ii)) & 0xF];
+    }
+    return result;
+}
+
+#pragma mark -
+#pragma mark Hasher
+/**
+ * Resets this hasher to its initial state with the given seed.
+ *
+ * All data previously added to this hasher is forgotten.
+ *
+ * @param seed  The hash seed
+ */
+void Hasher::reset(Uint64 seed) {
+    std::memcpy(_acc, INITIAL_ACC, sizeof(_acc));
+    init_secret(_secret, seed);
+    _buffsize = 0;
+    _stripes = 0;
+    _length = 0;
+    _seed = seed;
+}
+
+/**
+ * Adds the given data to this hasher.
+ *
+ * Data is hashed in the order it is added. Adding data in several pieces
+ * produces the same hash as adding it all at once.
+ *
+ * @param data  The data to hash
+ * @param size  The number of bytes of data
+ */
+void Hasher::update(const void* data, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    CUAssertLog(data, "Attempt to hash a null pointer");
+    const Uint8* input = (const Uint8*)data;
+    const Uint8* end = input+size;
+    _length += size;
+
+    // Buffer the data until we know it is not the last stripe
+    if (size <= sizeof(_buffer)-_buffsize) {
+        std::memcpy(_buffer+_buffsize, input, size);
+        _buffsize += size;
+        return;
+    }
+
+    const HashKernel& kernel = hash_kernel();
+    if (_buffsize) {
+        size_t amt = sizeof(_buffer)-_buffsize;
+        std::memcpy(_buffer+_buffsize, input, amt);
+        input += amt;
+        consume_stripes(_acc, &_stripes, _buffer, sizeof(_buffer)/STRIPE_LEN, _secret, kernel);
+        _buffsize = 0;
+    }
+
+    // Hash directly from the input, keeping the last stripe for the digest
+    if (end-input > (ptrdiff_t)sizeof(_buffer)) {
+        size_t count = (size_t)(end-1-input)/STRIPE_LEN;
+        input = consume_stripes(_acc, &_stripes, input, count, _secret, kernel);
+        std::memcpy(_buffer+sizeof(_buffer)-STRIPE_LEN, input-STRIPE_LEN, STRIPE_LEN);
+    }
+
+    _buffsize = (size_t)(end-input);
+    std::memcpy(_buffer, input, _buffsize);
+}
+
+/**
+ * Adds the contents of the given file to this hasher.
+ *
+ * The file is memory mapped if possible, and otherwise read in chunks
+ * (such as for assets on Android). If the path is a relative path, it is
+ * relative to the asset directory.
+ *
+ * If the file cannot be read, this method returns false. In that case
+ * some prefix of the file may have been added to this hasher, so it should
+ * be reset before it is used again.
+ *
+ * @param path  The path to the file
+ *
+ * @return true if the entire file was added to this hasher
+ */
+bool Hasher::updateWithFile(const std::string path) {
+    size_t size = 0;
+    const char* mapped = filetool::file_map(path, &size);
+    if (mapped != nullptr) {
+        update(mapped, size);
+        filetool::file_unmap(mapped, size);
+        return true;
+    }
+
+    // Fall back to streaming (this also handles empty files)
+    std::string name = path;
+    if (!filetool::is_absolute(path) && Application::get() != nullptr) {
+        name = filetool::normalize_path(Application::get()->getAssetDirectory()+path);
+    }
+    SDL_RWops* stream = SDL_RWFromFile(name.c_str(), "rb");
+    if (stream == nullptr) {
+        CULogError("Could not open '%s' for hashing: %s", path.c_str(), SDL_GetError());
+        return false;
+    }
+
+    std::vector<Uint8> chunk(FILE_CHUNK);
+    bool success = true;
+    Sint64 remain = SDL_RWsize(stream);
+    while (remain != 0) {
+        size_t amt = SDL_RWread(stream, chunk.data(), 1, chunk.size());
+        if (amt == 0) {
+            // A negative remainder means the size is unknown
+            success = (remain < 0);
+            break;
+        }
+        update(chunk.data(), amt);
+        if (remain > 0) {
+            remain -= (Sint64)amt;
+        }
+    }
+    SDL_RWclose(stream);
+    if (!success) {
+        CULogError("Could not read '%s' for hashing", path.c_str());
+    }
+    return success;
+}
+
+/**
+ * Stores the final accumulators for the data added so far in acc
+ *
+ * This method is only valid if more than 240 bytes have been added. It
+ * accumulates the buffered data without changing the state of the hasher.
+ *
+ * @param acc   The array to store the accumulators
+ */
+void Hasher::digestLong(Uint64* acc) const {
+    std::memcpy(acc, _acc, sizeof(_acc));
+    const HashKernel& kernel = hash_kernel();
+    size_t stripes = _stripes;
+    Uint8 last[STRIPE_LEN];
+    const Uint8* lastptr;
+    if (_buffsize >= STRIPE_LEN) {
+        consume_stripes(acc, &stripes, _buffer, (_buffsize-1)/STRIPE_LEN, _secret, kernel);
+        lastptr = _buffer+_buffsize-STRIPE_LEN;
+    } else {
+        // The last stripe straddles the end of the previous buffer
+        size_t catchup = STRIPE_LEN-_buffsize;
+        std::memcpy(last, _buffer+sizeof(_buffer)-catchup, catchup);
+        std::memcpy(last+catchup, _buffer, _buffsize);
+        lastptr = last;
+    }
+    kernel.accumulate(acc, lastptr, _secret+SECRET_SIZE-STRIPE_LEN-SECRET_LASTACC_START, 1);
+}
+
+/**
+ * Returns the 64 bit hash of the data added so far.
+ *
+ * This method does not change the state of the hasher. More data may be
+ * added afterwards.
+ *
+ * @return the 64 bit hash of the data added so far.
+ */
+Uint64 Hasher::digest64() const {
+    if (_length <= MIDSIZE_MAX) {
+        return hash64(_buffer, (size_t)_length, _seed);
+    }
+
+    alignas(64) Uint64 acc[8];
+    digestLong(acc);
+    return merge_accs(acc, _secret+SECRET_MERGEACCS_START, _length*PRIME64_1);
+}
+
+/**
+ * Returns the 128 bit hash of the data added so far.
+ *
+ * This method does not change the state of the hasher. More data may be
+ * added afterwards.
+ *
+ * @return the 128 bit hash of the data added so far.
+ */
+Hash128 Hasher::digest128() const {
+    if (_length <= MIDSIZE_MAX) {
+        return hash128(_buffer, (size_t)_length, _seed);
+    }
+
+    alignas(64) Uint64 acc[8];
+    digestLong(acc);
+
+    Hash128 result;
+    result.low  = merge_accs(acc, _secret+SECRET_MERGEACCS_START, _length*PRIME64_1);
+    result.high = merge_accs(acc, _secret+SECRET_SIZE-sizeof(acc)-SECRET_MERGEACCS_START,
+                             ~(_length*PRIME64_2));
+    return result;
+}
+
+#pragma mark -
+#pragma mark One-Shot Hashing
+/**
+ * Returns the 64 bit hash of the given data
+ *
+ * This is the same as the digest of a Hasher with the same seed, after
+ * the data has been added. However, it is faster for small inputs.
+ *
+ * @param data  The data to hash
+ * @param size  The number of bytes of data
+ * @param seed  The hash seed
+ *
+ * @return the 64 bit hash of the given data
+ */
+Uint64 Hasher::hash64(const void* data, size_t size, Uint64 seed) {
+    CUAssertLog(data || size == 0, "Attempt to hash a null pointer");
+    const Uint8* input = (const Uint8*)data;
+    if (size <= 16) {
+        return hash64_short(input, size, DEFAULT_SECRET, seed);
+    } else if (size <= MIDSIZE_MAX) {
+        return hash64_medium(input, size, DEFAULT_SECRET, seed);
+    }
+
+    alignas(64) Uint8 custom[SECRET_SIZE];
+    const Uint8* secret = DEFAULT_SECRET;
+    if (seed) {
+        init_secret(custom, seed);
+        secret = custom;
+    }
+
+    alignas(64) Uint64 acc[8];
+    std::memcpy(acc, INITIAL_ACC, sizeof(acc));
+    hash_long(acc, input, size, secret);
+    return merge_accs(acc, secret+SECRET_MERGEACCS_START, (Uint64)size*PRIME64_1);
+}
+
+/**
+ * Returns the 128 bit hash of the given data
+ *
+ * This is the same as the digest of a Hasher with the same seed, after
+ * the data has been added. However, it is faster for small inputs.
+ *
+ * @param data  The data to hash
+ * @param size  The number of bytes of data
+ * @param seed  The hash seed
+ *
+ * @return the 128 bit hash of the given data
+ */
+Hash128 Hasher::hash128(const void* data, size_t size, Uint64 seed) {
+    CUAssertLog(data || size == 0, "Attempt to hash a null pointer");
+    const Uint8* input = (const Uint8*)data;
+    if (size <= 16) {
+        return hash128_short(input, size, DEFAULT_SECRET, seed);
+    } else if (size <= MIDSIZE_MAX) {
+        return hash128_medium(input, size, DEFAULT_SECRET, seed);
+    }
+
+    alignas(64) Uint8 custom[SECRET_SIZE];
+    const Uint8* secret = DEFAULT_SECRET;
+    if (seed) {
+        init_secret(custom, seed);
+        secret = custom;
+    }
+
+    alignas(64) Uint64 acc[8];
+    std::memcpy(acc, INITIAL_ACC, sizeof(acc));
+    hash_long(acc, input, size, secret);
+
+    Hash128 result;
+    result.low  = merge_accs(acc, secret+SECRET_MERGEACCS_START, (Uint64)size*PRIME64_1);
+    result.high = merge_accs(acc, secret+SECRET_SIZE-sizeof(acc)-SECRET_MERGEACCS_START,
+                             ~((Uint64)size*PRIME64_2));
+    return result;
+}
+
+/**
+ * Computes the 64 bit hash of the given file, storing it in result
+ *
+ * The file is memory mapped if possible, and otherwise read in chunks. If
+ * the path is a relative path, it is relative to the asset directory. If
+ * the file cannot be read, this method returns false and result is not
+ * modified.
+ *
+ * @param path      The path to the file
+ * @param result    Pointer to store the hash
+ * @param seed      The hash seed
+ *
+ * @return true if the file was successfully hashed
+ */
+bool Hasher::hashFile64(const std::string path, Uint64* result, Uint64 seed) {
+    CUAssertLog(result, "The result pointer is null");
+    size_t size = 0;
+    const char* mapped = filetool::file_map(path, &size);
+    if (mapped != nullptr) {
+        *result = hash64(mapped, size, seed);
+        filetool::file_unmap(mapped, size);
+        return true;
+    }
+
+    Hasher hasher(seed);
+    if (!hasher.updateWithFile(path)) {
+        return false;
+    }
+    *result = hasher.digest64();
+    return true;
+}
+
+/**
+ * Computes the 128 bit hash of the given file, storing it in result
+ *
+ * The file is memory mapped if possible, and otherwise read in chunks. If
+ * the path is a relative path, it is relative to the asset directory. If
+ * the file cannot be read, this method returns false and result is not
+ * modified.
+ *
+ * @param path      The path to the file
+ * @param result    Pointer to store the hash
+ * @param seed      The hash seed
+ *
+ * @return true if the file was successfully hashed
+ */
+bool Hasher::hashFile128(const std::string path, Hash128* result, Uint64 seed) {
+    CUAssertLog(result, "The result pointer is null");
+    size_t size = 0;
+    const char* mapped = filetool::file_map(path, &size);
+    if (mapped != nullptr) {
+        *result = hash128(mapped, size, seed);
+        filetool::file_unmap(mapped, size);
+        return true;
+    }
+
+    Hasher hasher(seed);
+    if (!hasher.updateWithFile(path)) {
+        return false;
+    }
+    *result = hasher.digest128();
+    return true;
+}
@@ -6,6 +6,9 @@
 //  user-defined hash functions in CUGL. Most of these ideas have been
 //  adapted from existing online tools like the BOOST library.
 //
+//  The Base 64 functions use vectorized kernels (SSE4.1 or AVX2) when the
+//  CPU supports them, and can write to caller-provided buffers.
+//
 //  CUGL MIT License:
 //      This software is provided 'as-is', without any express or implied
 //      warranty.  In no event will the authors be held liable for any damages
@@ -31,14 +34,435 @@
 #include <cugl/core/util/CUHashtools.h>
 #include <cugl/core/util/CUDebug.h>
 #include <random>
+#include <array>
 #include <stduuid/uuid.h>
 #include <SDL_app.h>
+#include "CUSimd.h"
 
 // Seed taken from documentation. Could be changed.
 #define UUID_SEED "47183823-2574-4bfd-b411-99ed177d3e43"
 
 // String for Base 64 conversion
 #define BASE64_ALPHA "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"
+
+#pragma mark -
+#pragma mark Base 64 Kernels
+/** A reverse lookup table for Base 64 (0xFF for invalid characters) */
+static const std::array<Uint8,256> BASE64_LOOKUP = [] {
+    std::array<Uint8,256> table;
+    table.fill(0xFF);
+    for(int ii = 0; ii < 64; ii++) {
+        table[(Uint8)BASE64_ALPHA[ii]] = (Uint8)ii;
+    }
+    return table;
+}();
+
+/**
+ * A kernel that encodes a prefix of the data in Base 64
+ *
+ * A kernel encodes as many whole blocks of data as it can, and returns the
+ * number of bytes consumed. This is always a multiple of 3, and the output
+ * is always 4/3 of this amount.
+ */
+typedef size_t (*Base64Encoder)(const Uint8* data, size_t size, char* dst);
+
+/**
+ * A kernel that decodes a prefix of the Base 64 data
+ *
+ * A kernel decodes as many whole blocks of data as it can, and returns the
+ * number of characters consumed. This is always a multiple of 4, and the
+ * output is always 3/4 of this amount. A kernel stops early at any block
+ * containing a character outside of the Base 64 alphabet (including padding).
+ */
+typedef size_t (*Base64Decoder)(const char* data, size_t size, Uint8* dst);
+
+/**
+ * Encodes a prefix of the data in Base 64, three bytes at a time
+ *
+ * @param data  The data to convert
+ * @param size  The number of bytes of data
+ * @param dst   The buffer to store the Base 64 characters
+ *
+ * @return the number of bytes consumed
+ */
+static size_t b64_encode_scalar(const Uint8* data, size_t size, char* dst) {
+    size_t pos = 0;
+    for(; pos+3 <= size; pos += 3) {
+        Uint32 word = (data[pos] << 16) | (data[pos+1] << 8) | data[pos+2];
+        *dst++ = BASE64_ALPHA[(word >> 18) & 0x3F];
+        *dst++ = BASE64_ALPHA[(word >> 12) & 0x3F];
+        *dst++ = BASE64_ALPHA[(word >>  6) & 0x3F];
+        *dst++ = BASE64_ALPHA[word & 0x3F];
+    }
+    return pos;
+}
+
+/**
+ * Decodes a prefix of the Base 64 data, four characters at a time
+ *
+ * @param data  The data to convert
+ * @param size  The number of characters of data
+ * @param dst   The buffer to store the decoded bytes
+ *
+ * @return the number of characters consumed
+ */
+static size_t b64_decode_scalar(const char* data, size_t size, Uint8* dst) {
+    size_t pos = 0;
+    for(; pos+4 <= size; pos += 4) {
+        Uint32 a = BASE64_LOOKUP[(Uint8)data[pos  ]];
+        Uint32 b = BASE64_LOOKUP[(Uint8)data[pos+1]];
+        Uint32 c = BASE64_LOOKUP[(Uint8)data[pos+2]];
+        Uint32 d = BASE64_LOOKUP[(Uint8)data[pos+3]];
+        if ((a | b | c | d) & 0x80) {
+            break;
+        }
+        Uint32 word = (a << 18) | (b << 12) | (c << 6) | d;
+        *dst++ = (Uint8)(word >> 16);
+        *dst++ = (Uint8)(word >> 8);
+        *dst++ = (Uint8)word;
+    }
+    return pos;
+}
+
+#if CU_SIMD_X86
+/**
+ * Encodes a prefix of the data in Base 64, twelve bytes at a time
+ *
+ * This is the vectorized algorithm of Muła and Lemire. The bytes are split
+ * into 6-bit indices with a shuffle and two multiplies, and the indices are
+ * mapped to characters by a second shuffle. Each block reads 16 bytes.
+ *
+ * @param data  The data to convert
+ * @param size  The number of bytes of data
+ * @param dst   The buffer to store the Base 64 characters
+ *
+ * @return the number of bytes consumed
+ */
+CU_SIMD_SSE4 static size_t b64_encode_sse4(const Uint8* data, size_t size, char* dst) {
+    const __m128i shuffle = _mm_setr_epi8(1,0,2,1, 4,3,5,4, 7,6,8,7, 10,9,11,10);
+    const __m128i offsets = _mm_setr_epi8('a'-26,'0'-52,'0'-52,'0'-52,'0'-52,'0'-52,
+                                          '0'-52,'0'-52,'0'-52,'0'-52,'0'-52,'+'-62,
+                                          '/'-63,'A',0,0);
+    size_t pos = 0;
+    for(; pos+16 <= size; pos += 12) {
+        __m128i in = _mm_loadu_si128((const __m128i*)(data+pos));
+        in = _mm_shuffle_epi8(in, shuffle);
+
+        // Extract the four 6-bit indices of each 24-bit group
+        __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+        __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+        __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+        __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+        __m128i indices = _mm_or_si128(t1, t3);
+
+        // Map each range of indices to its character offset
+        __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        __m128i lower = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+        range = _mm_or_si128(range, _mm_and_si128(lower, _mm_set1_epi8(13)));
+        __m128i out = _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+        _mm_storeu_si128((__m128i*)dst, out);
+        dst += 16;
+    }
+    return pos;
+}
+
+/**
+ * Encodes a prefix of the data in Base 64, twenty-four bytes at a time
+ *
+ * This is the AVX2 version of {@link b64_encode_sse4}, with a block in each
+ * 128-bit lane. Each block reads 28 bytes.
+ *
+ * @param data  The data to convert
+ * @param size  The number of bytes of data
+ * @param dst   The buffer to store the Base 64 characters
+ *
+ * @return the number of bytes consumed
+ */
+CU_SIMD_AVX2 static size_t b64_encode_avx2(const Uint8* data, size_t size, char* dst) {
+    const __m256i shuffle = _mm256_setr_epi8(1,0,2,1, 4,3,5,4, 7,6,8,7, 10,9,11,10,
+                                             1,0,2,1, 4,3,5,4, 7,6,8,7, 10,9,11,10);
+    const __m256i offsets = _mm256_setr_epi8('a'-26,'0'-52,'0'-52,'0'-52,'0'-52,'0'-52,
+                                             '0'-52,'0'-52,'0'-52,'0'-52,'0'-52,'+'-62,
+                                             '/'-63,'A',0,0,
+                                             'a'-26,'0'-52,'0'-52,'0'-52,'0'-52,'0'-52,
+                                             '0'-52,'0'-52,'0'-52,'0'-52,'0'-52,'+'-62,
+                                             '/'-63,'A',0,0);
+    size_t pos = 0;
+    for(; pos+28 <= size; pos += 24) {
+        __m128i lo = _mm_loadu_si128((const __m128i*)(data+pos));
+        __m128i hi = _mm_loadu_si128((const __m128i*)(data+pos+12));
+        __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        in = _mm256_shuffle_epi8(in, shuffle);
+
+        __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+        __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+        __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        __m256i indices = _mm256_or_si256(t1, t3);
+
+        __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        __m256i lower = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        range = _mm256_or_si256(range, _mm256_and_si256(lower, _mm256_set1_epi8(13)));
+        __m256i out = _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), indices);
+        _mm256_storeu_si256((__m256i*)dst, out);
+        dst += 32;
+    }
+    return pos;
+}
+
+/**
+ * Decodes a prefix of the Base 64 data, sixteen characters at a time
+ *
+ * This is the vectorized algorithm of Muła and Lemire. Characters are
+ * validated and mapped to 6-bit values with nibble lookups, and the values
+ * are packed into bytes with two multiply-adds. Each block writes 16 bytes,
+ * so the loop stops 24 characters short of the end to stay in the buffer.
+ *
+ * @param data  The data to convert
+ * @param size  The number of characters of data
+ * @param dst   The buffer to store the decoded bytes
+ *
+ * @return the number of characters consumed
+ */
+CU_SIMD_SSE4 static size_t b64_decode_sse4(const char* data, size_t size, Uint8* dst) {
+    const __m128i lut_lo = _mm_setr_epi8(0x15,0x11,0x11,0x11,0x11,0x11,0x11,0x11,
+                                         0x11,0x11,0x13,0x1A,0x1B,0x1B,0x1B,0x1A);
+    const __m128i lut_hi = _mm_setr_epi8(0x10,0x10,0x01,0x02,0x04,0x08,0x04,0x08,
+                                         0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10);
+    const __m128i lut_roll = _mm_setr_epi8(0,16,19,4,-65,-65,-71,-71,0,0,0,0,0,0,0,0);
+    const __m128i pack = _mm_setr_epi8(2,1,0,6,5,4,10,9,8,14,13,12,-1,-1,-1,-1);
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+
+    size_t pos = 0;
+    for(; pos+24 <= size; pos += 16) {
+        __m128i in = _mm_loadu_si128((const __m128i*)(data+pos));
+        __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(in, 4), nibble);
+        __m128i lo_nibbles = _mm_and_si128(in, nibble);
+        __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+        __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+        if (!_mm_testz_si128(lo, hi)) {
+            break;
+        }
+
+        __m128i eq_slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+        __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_slash, hi_nibbles));
+        __m128i values = _mm_add_epi8(in, roll);
+
+        // Pack four 6-bit values into three bytes
+        __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        __m128i out = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        out = _mm_shuffle_epi8(out, pack);
+        _mm_storeu_si128((__m128i*)dst, out);
+        dst += 12;
+    }
+    return pos;
+}
+
+/**
+ * Decodes a prefix of the Base 64 data, thirty-two characters at a time
+ *
+ * This is the AVX2 version of {@link b64_decode_sse4}, with a block in each
+ * 128-bit lane. Each block writes 32 bytes, so the loop stops 48 characters
+ * short of the end to stay in the buffer.
+ *
+ * @param data  The data to convert
+ * @param size  The number of characters of data
+ * @param dst   The buffer to store the decoded bytes
+ *
+ * @return the number of characters consumed
+ */
+CU_SIMD_AVX2 static size_t b64_decode_avx2(const char* data, size_t size, Uint8* dst) {
+    const __m256i lut_lo = _mm256_setr_epi8(0x15,0x11,0x11,0x11,0x11,0x11,0x11,0x11,
+                                            0x11,0x11,0x13,0x1A,0x1B,0x1B,0x1B,0x1A,
+                                            0x15,0x11,0x11,0x11,0x11,0x11,0x11,0x11,
+                                            0x11,0x11,0x13,0x1A,0x1B,0x1B,0x1B,0x1A);
+    const __m256i lut_hi = _mm256_setr_epi8(0x10,0x10,0x01,0x02,0x04,0x08,0x04,0x08,
+                                            0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,
+                                            0x10,0x10,0x01,0x02,0x04,0x08,0x04,0x08,
+                                            0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10);
+    const __m256i lut_roll = _mm256_setr_epi8(0,16,19,4,-65,-65,-71,-71,0,0,0,0,0,0,0,0,
+                                              0,16,19,4,-65,-65,-71,-71,0,0,0,0,0,0,0,0);
+    const __m256i pack = _mm256_setr_epi8(2,1,0,6,5,4,10,9,8,14,13,12,-1,-1,-1,-1,
+                                          2,1,0,6,5,4,10,9,8,14,13,12,-1,-1,-1,-1);
+    const __m256i lanes = _mm256_setr_epi32(0,1,2,4,5,6,7,7);
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+
+    size_t pos = 0;
+    for(; pos+48 <= size; pos += 32) {
+        __m256i in = _mm256_loadu_si256((const __m256i*)(data+pos));
+        __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), nibble);
+        __m256i lo_nibbles = _mm256_and_si256(in, nibble);
+        __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+        __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+        if (!_mm256_testz_si256(lo, hi)) {
+            break;
+        }
+
+        __m256i eq_slash = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/'));
+        __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_slash, hi_nibbles));
+        __m256i values = _mm256_add_epi8(in, roll);
+
+        __m256i merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        __m256i out = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        out = _mm256_shuffle_epi8(out, pack);
+        out = _mm256_permutevar8x32_epi32(out, lanes);
+        _mm256_storeu_si256((__m256i*)dst, out);
+        dst += 24;
+    }
+    return pos;
+}
+#endif
+
+/**
+ * Returns the fastest Base 64 encoding kernel for this CPU
+ *
+ * @return the fastest Base 64 encoding kernel for this CPU
+ */
+static Base64Encoder b64_encoder() {
+    static const Base64Encoder kernel = [] {
+#if CU_SIMD_X86
+        if (SDL_HasAVX2()) {
+            return &b64_encode_avx2;
+        } else if (SDL_HasSSE41()) {
+            return &b64_encode_sse4;
+        }
+#endif
+        return &b64_encode_scalar;
+    }();
+    return kernel;
+}
+
+/**
+ * Returns the fastest Base 64 decoding kernel for this CPU
+ *
+ * @return the fastest Base 64 decoding kernel for this CPU
+ */
+static Base64Decoder b64_decoder() {
+    static const Base64Decoder kernel = [] {
+#if CU_SIMD_X86
+        if (SDL_HasAVX2()) {
+            return &b64_decode_avx2;
+        } else if (SDL_HasSSE41()) {
+            return &b64_decode_sse4;
+        }
+#endif
+        return &b64_decode_scalar;
+    }();
+    return kernel;
+}
+
+#pragma mark -
+#pragma mark Base 64
+/**
+ * Returns the number of Base 64 characters needed to encode the data
+ *
+ * This value includes any padding characters.
+ *
+ * @param size  The number of bytes to encode
+ *
+ * @return the number of Base 64 characters needed to encode the data
+ */
+size_t cugl::hashtool::b64_encode_size(size_t size) {
+    return 4*((size+2)/3);
+}
+
+/**
+ * Returns the maximum number of bytes decoded from the Base 64 data
+ *
+ * The actual number of bytes may be less if the data has padding or any
+ * characters outside of the Base 64 alphabet.
+ *
+ * @param size  The number of Base 64 characters
+ *
+ * @return the maximum number of bytes decoded from the Base 64 data
+ */
+size_t cugl::hashtool::b64_decode_size(size_t size) {
+    return 3*(size/4)+(3*(size%4))/4;
+}
+
+/**
+ * Encodes the given binary data in Base 64, storing it in dst
+ *
+ * This function is an alternative to the string versions of b64_encode that
+ * performs no allocation. The buffer dst must have room for at least
+ * {@link b64_encode_size} characters. The result is not null-terminated.
+ *
+ * Where supported (SSE4.1 or AVX2), this function uses vectorized kernels.
+ * Otherwise, it converts three bytes at a time. See
+ *
+ * https://en.wikipedia.org/wiki/Base64
+ *
+ * @param data  The data to convert
+ * @param size  The number of bytes of data
+ * @param dst   The buffer to store the Base 64 characters
+ *
+ * @return the number of characters written to dst
+ */
+size_t cugl::hashtool::b64_encode(const std::byte* data, size_t size, char* dst) {
+    const Uint8* src = reinterpret_cast<const Uint8*>(data);
+    size_t pos = b64_encoder()(src, size, dst);
+    char* out = dst+(pos/3)*4;
+    pos += b64_encode_scalar(src+pos, size-pos, out);
+    out = dst+(pos/3)*4;
+
+    // Pad any remaining bytes
+    size_t remain = size-pos;
+    if (remain) {
+        Uint32 word = src[pos] << 16;
+        if (remain == 2) {
+            word |= src[pos+1] << 8;
+        }
+        *out++ = BASE64_ALPHA[(word >> 18) & 0x3F];
+        *out++ = BASE64_ALPHA[(word >> 12) & 0x3F];
+        *out++ = (remain == 2 ? BASE64_ALPHA[(word >> 6) & 0x3F] : '=');
+        *out++ = '=';
+    }
+    return out-dst;
+}
+
+/**
+ * Decodes the given Base 64 data, storing the result in dst
+ *
+ * This function is an alternative to {@link b64_decode} and
+ * {@link b64_tostring} that performs no allocation. The buffer dst must have
+ * room for at least {@link b64_decode_size} bytes. Decoding stops at the
+ * first character outside of the Base 64 alphabet (such as padding).
+ *
+ * Where supported (SSE4.1 or AVX2), this function uses vectorized kernels.
+ * Otherwise, it converts four characters at a time. See
+ *
+ * https://en.wikipedia.org/wiki/Base64
+ *
+ * @param data  The data to convert
+ * @param size  The number of characters of data
+ * @param dst   The buffer to store the decoded bytes
+ *
+ * @return the number of bytes written to dst
+ */
+size_t cugl::hashtool::b64_decode(const char* data, size_t size, std::byte* dst) {
+    Uint8* out = reinterpret_cast<Uint8*>(dst);
+    size_t pos = b64_decoder()(data, size, out);
+    pos += b64_decode_scalar(data+pos, size-pos, out+(pos/4)*3);
+    out += (pos/4)*3;
+
+    // Decode the partial block (which may be cut short by padding)
+    Uint32 word = 0;
+    int bits = 0;
+    for(; pos < size; pos++) {
+        Uint8 value = BASE64_LOOKUP[(Uint8)data[pos]];
+        if (value & 0x80) {
+            break;
+        }
+        word = (word << 6) | value;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            *out++ = (Uint8)(word >> bits);
+        }
+    }
+    return out-reinterpret_cast<Uint8*>(dst);
+}
+
 /**
  * Returns a text representation of the given binary data in Base 64
  *
@@ -52,23 +476,8 @@
  * @return a text representation of the given binary data in Base 64
  */
 std::string cugl::hashtool::b64_encode(const std::vector<std::byte>& data) {
-    // https://stackoverflow.com/questions/180947/base64-decode-snippet-in-c
-    std::string result;
-
-    int val = 0, valb = -6;
-    for (std::byte b : data) {
-        val = (val << 8) + static_cast<int>(b);
-        valb += 8;
-        while (valb >= 0) {
-            result.push_back(BASE64_ALPHA[(val>>valb)&0x3F]);
-            valb -= 6;
-        }
-    }
- 
-    if (valb>-6) result.push_back(BASE64_ALPHA[((val<<8)>>(valb+8))&0x3F]);
-    while (result.size() % 4) {
-        result.push_back('=');
-    }
+    std::string result(b64_encode_size(data.size()), '\0');
+    b64_encode(data.data(), data.size(), result.data());
     return result;
 }
 
@@ -87,23 +496,8 @@ std::string cugl::hashtool::b64_encode(const std::vector<std::byte>& data) {
  * @return a text representation of the given binary data in Base 64
  */
 std::string cugl::hashtool::b64_encode(const std::string data) {
-    // https://stackoverflow.com/questions/180947/base64-decode-snippet-in-c
-    std::string result;
-
-    int val = 0, valb = -6;
-    for (unsigned char c : data) {
-        val = (val << 8) + c;
-        valb += 8;
-        while (valb >= 0) {
-            result.push_back(BASE64_ALPHA[(val>>valb)&0x3F]);
-            valb -= 6;
-        }
-    }
- 
-    if (valb>-6) result.push_back(BASE64_ALPHA[((val<<8)>>(valb+8))&0x3F]);
-    while (result.size() % 4) {
-        result.push_back('=');
-    }
+    std::string result(b64_encode_size(data.size()), '\0');
+    b64_encode(reinterpret_cast<const std::byte*>(data.data()), data.size(), result.data());
     return result;
 }
 
@@ -123,27 +517,8 @@ std::string cugl::hashtool::b64_encode(const std::string data) {
  * @return a byte vector decoded from the given Base 64 data
  */
 std::vector<std::byte> cugl::hashtool::b64_decode(const std::string data) {
-    std::vector<std::byte> result;
-
-    // Create a reverse lookup table
-    std::vector<int> lookup(256,-1);
-    for (int i=0; i<64; i++) {
-        lookup[BASE64_ALPHA[i]] = i;
-    }
-
-    int val=0, valb=-8;
-    for (unsigned char c : data) {
-        if (lookup[c] == -1) {
-            break;
-        }
-        
-        val = (val << 6) + lookup[c];
-        valb += 6;
-        if (valb >= 0) {
-            result.push_back(static_cast<std::byte>((val>>valb)&0xFF));
-            valb -= 8;
-        }
-    }
+    std::vector<std::byte> result(b64_decode_size(data.size()));
+    result.resize(b64_decode(data.data(), data.size(), result.data()));
     return result;
 }
 
@@ -159,30 +534,13 @@ std::vector<std::byte> cugl::hashtool::b64_decode(const std::string data) {
  * @return a string decoded from the given Base 64 data
  */
 std::string cugl::hashtool::b64_tostring(const std::string data) {
-    std::string result;
-
-    // Create a reverse lookup table
-    std::vector<int> lookup(256,-1);
-    for (int i=0; i<64; i++) {
-        lookup[BASE64_ALPHA[i]] = i;
-    }
-
-    int val=0, valb=-8;
-    for (unsigned char c : data) {
-        if (lookup[c] == -1) {
-            break;
-        }
-        
-        val = (val << 6) + lookup[c];
-        valb += 6;
-        if (valb >= 0) {
-            result.push_back(static_cast<char>((val>>valb)&0xFF));
-            valb -= 8;
-        }
-    }
+    std::string result(b64_decode_size(data.size()), '\0');
+    result.resize(b64_decode(data.data(), data.size(), reinterpret_cast<std::byte*>(result.data())));
     return result;
 }
 
+#pragma mark -
+#pragma mark UUIDs
 /**
  * Returns a new randomly generated UUID
  *
@@ -10,6 +10,11 @@
 //  This class is a singleton and should never be allocated directly.  It
 //  should only be accessed via the static methods get() and open().
 //
+//  Asynchronous loggers share a single background thread. Each thread that
+//  logs owns a single-producer/single-consumer ring of preformatted records,
+//  so logging never takes a lock. The background thread gathers the records
+//  from every ring, orders each batch by time, and writes each file at once.
+//
 //  CUGL MIT License:
 //      This software is provided 'as-is', without any express or implied
 //      warranty.  In no event will the authors be held liable for any damages
@@ -42,17 +47,22 @@
 #include <cstring>
 #include <iomanip>
 #include <sstream>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
 
 using namespace cugl;
 
 // The buffer size allocated for time stampes
 #define STAMP_SIZE 64
-
-/** The list of all active logs */
-std::unordered_map<std::string, std::shared_ptr<Logger>> Logger::_channels;
-
-/** The SDL category to assign to the next allocated log */
-int Logger::_nextcategory = SDL_LOG_CATEGORY_CUSTOM;
+/** The number of records in the log queue of a single thread */
+#define RING_CAPACITY   512
+/** The number of characters stored inline in a log record */
+#define RECORD_TEXT     224
+/** How often (in milliseconds) the log thread checks for new records */
+#define POLL_INTERVAL   5
 
 /**
  * Returns the string representation of the given level
@@ -109,18 +119,29 @@ static SDL_LogPriority level2sdl(Logger::Level level) {
 }
 
 /**
- * Stores the time stamp in the given buffer.
+ * Returns the current time in microseconds since the epoch
+ *
+ * @return the current time in microseconds since the epoch
+ */
+static Sint64 now_micros() {
+    auto now = std::chrono::system_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+}
+
+/**
+ * Stores the time stamp for the given time in the given buffer.
  *
  * The times stamp includes the date and time up to the nearest microsecond.
  *
  * @param buffer    The buffer to store the time stamp
  * @param size      The size of the buffer
+ * @param time      The time in microseconds since the epoch
  *
  * @return the length of the string written to the buffer
  */
-static size_t stamp_time(char* buffer, size_t size) {
-    auto now = std::chrono::system_clock::now();
-    auto micro = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()) % 1000000;
+static size_t stamp_time(char* buffer, size_t size, Sint64 time) {
+    std::chrono::system_clock::time_point now{std::chrono::microseconds(time)};
+    auto micro = std::chrono::microseconds(time % 1000000);
 
     auto timer = std::chrono::system_clock::to_time_t(now);
     std::tm parse = *std::localtime(&timer);
@@ -136,6 +157,384 @@ static size_t stamp_time(char* buffer, size_t size) {
     return limit;
 }
 
+/**
+ * Stores the current time stamp in the given buffer.
+ *
+ * The times stamp includes the date and time up to the nearest microsecond.
+ *
+ * @param buffer    The buffer to store the time stamp
+ * @param size      The size of the buffer
+ *
+ * @return the length of the string written to the buffer
+ */
+static size_t stamp_time(char* buffer, size_t size) {
+    return stamp_time(buffer, size, now_micros());
+}
+
+#pragma mark -
+#pragma mark Log Backend
+namespace cugl {
+
+/**
+ * A single message posted to an asynchronous logger
+ *
+ * Short messages are stored inline so that logging does not allocate.
+ * Longer messages are allocated on the heap and freed by the log thread.
+ */
+struct LogRecord {
+    /** The logger for this message */
+    Logger* logger;
+    /** The level for the log file (NO_MSG to skip the file) */
+    Logger::Level file;
+    /** The level for the console (NO_MSG to skip the console) */
+    Logger::Level console;
+    /** The time of the message in microseconds since the epoch */
+    Sint64 time;
+    /** The message, if it does not fit inline */
+    char* overflow;
+    /** The message, if it fits inline */
+    char text[RECORD_TEXT];
+
+    /**
+     * Returns the text of this message
+     *
+     * @return the text of this message
+     */
+    const char* message() const { return overflow ? overflow : text; }
+};
+
+/**
+ * A lock-free queue of log records for a single thread
+ *
+ * This is a single-producer/single-consumer ring buffer. The producer is
+ * the thread that owns the ring, and the consumer is the log thread. The
+ * producer only writes the tail and the consumer only writes the head, so
+ * neither side ever waits on the other.
+ */
+class LogRing {
+public:
+    /** The records in this ring */
+    LogRecord slots[RING_CAPACITY];
+    /** The position of the next record to read (written by the consumer) */
+    std::atomic<size_t> head;
+    /** The position of the next record to write (written by the producer) */
+    std::atomic<size_t> tail;
+    /** Whether the owning thread has exited */
+    std::atomic<bool> retired;
+
+    /**
+     * Creates an empty ring
+     */
+    LogRing() : head(0), tail(0), retired(false) {}
+
+    /**
+     * Returns the next record to write, or nullptr if the ring is full
+     *
+     * The record is not visible to the consumer until {@link #commit}.
+     *
+     * @return the next record to write, or nullptr if the ring is full
+     */
+    LogRecord* reserve() {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        if (pos-head.load(std::memory_order_acquire) >= RING_CAPACITY) {
+            return nullptr;
+        }
+        return slots+(pos % RING_CAPACITY);
+    }
+
+    /**
+     * Publishes the record returned by {@link #reserve}
+     *
+     * @return the number of records in the ring
+     */
+    size_t commit() {
+        size_t pos = tail.load(std::memory_order_relaxed)+1;
+        tail.store(pos, std::memory_order_release);
+        return pos-head.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * The background thread shared by all asynchronous loggers
+ *
+ * The rings are registered with the backend the first time a thread posts
+ * a message. Registration is the only operation that takes a lock on the
+ * logging side. The rings of exited threads are removed once empty.
+ */
+class LogBackend {
+private:
+    /** The registered rings (one per logging thread) */
+    std::vector<std::shared_ptr<LogRing>> _rings;
+    /** The background thread */
+    std::thread* _thread;
+    /** The mutex for the rings and thread state */
+    std::mutex _mutex;
+    /** The condition variable to wake up the log thread */
+    std::condition_variable _wakeup;
+    /** The condition variable to signal a completed pass */
+    std::condition_variable _passed;
+    /** The number of completed passes of the log thread */
+    Uint64 _passes;
+    /** The number of threads waiting on a flush */
+    Uint32 _waiting;
+    /** Whether a logging thread has requested an early pass */
+    std::atomic<bool> _signaled;
+    /** Whether the log thread should keep running */
+    bool _active;
+
+    /**
+     * Writes the records from all the rings
+     *
+     * The records are ordered by time, and each file is written and flushed
+     * once per call.
+     */
+    void drain() {
+        std::vector<std::shared_ptr<LogRing>> rings;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            rings = _rings;
+        }
+
+        _batch.clear();
+        for(auto it = rings.begin(); it != rings.end(); ++it) {
+            LogRing* ring = it->get();
+            size_t head = ring->head.load(std::memory_order_relaxed);
+            size_t tail = ring->tail.load(std::memory_order_acquire);
+            for(; head != tail; head++) {
+                _batch.push_back(ring->slots[head % RING_CAPACITY]);
+                ring->slots[head % RING_CAPACITY].overflow = nullptr;
+            }
+            ring->head.store(head, std::memory_order_release);
+        }
+        std::stable_sort(_batch.begin(), _batch.end(),
+                         [](const LogRecord& a, const LogRecord& b) { return a.time < b.time; });
+
+        // Format the timestamps here, off the logging threads
+        for(auto it = _batch.begin(); it != _batch.end(); ++it) {
+            Logger* logger = it->logger;
+            if (it->file != Logger::Level::NO_MSG && logger->_open.load(std::memory_order_acquire)) {
+                stamp(it->time);
+                std::string& out = _output[logger];
+                out.append(_stamp);
+                out.push_back(' ');
+                out.append(level2name(it->file));
+                out.append(": ");
+                out.append(it->message());
+                out.push_back('\n');
+            }
+            if (it->console != Logger::Level::NO_MSG) {
+                SDL_LogMessage(SDL_LOG_CATEGORY_CUSTOM, level2sdl(it->console),
+                               "%s",it->message());
+            }
+            if (it->overflow) {
+                std::free(it->overflow);
+            }
+        }
+
+        for(auto it = _output.begin(); it != _output.end(); ++it) {
+            Logger* logger = it->first;
+            size_t dropped = logger->_dropped.exchange(0);
+            if (dropped > 0 && logger->_open.load(std::memory_order_acquire)) {
+                char now[STAMP_SIZE];
+                stamp_time(now, STAMP_SIZE);
+                it->second.append(now);
+                it->second.append(" WARN: [");
+                it->second.append(logger->_name);
+                it->second.append("] ");
+                it->second.append(std::to_string(dropped));
+                it->second.append(" messages dropped\n");
+            }
+            if (!it->second.empty() && logger->_open.load(std::memory_order_acquire)) {
+                logger->_writer->write(it->second.c_str());
+                logger->_writer->flush();
+            }
+            it->second.clear();
+        }
+        _output.clear();
+
+        // Remove the rings of exited threads once they are empty
+        std::lock_guard<std::mutex> lock(_mutex);
+        _rings.erase(std::remove_if(_rings.begin(), _rings.end(),
+                                    [](const std::shared_ptr<LogRing>& ring) {
+            return ring->retired.load(std::memory_order_acquire) &&
+                   ring->head.load(std::memory_order_relaxed) ==
+                   ring->tail.load(std::memory_order_acquire);
+        }), _rings.end());
+    }
+
+    /**
+     * Runs the log thread until the backend is stopped
+     */
+    void run() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (_active) {
+            if (_waiting == 0) {
+                _wakeup.wait_for(lock, std::chrono::milliseconds(POLL_INTERVAL), [this] {
+                    return _signaled.load() || _waiting > 0 || !_active;
+                });
+            }
+            _signaled.store(false);
+            lock.unlock();
+            drain();
+            lock.lock();
+            _passes++;
+            _passed.notify_all();
+        }
+        lock.unlock();
+        drain();
+    }
+
+    /** The records gathered in a single pass */
+    std::vector<LogRecord> _batch;
+    /** The text to write to each file in a single pass */
+    std::unordered_map<Logger*,std::string> _output;
+    /** The most recent timestamp */
+    char _stamp[STAMP_SIZE];
+    /** The second of the most recent timestamp */
+    Sint64 _second;
+    /** The length of the most recent timestamp, excluding microseconds */
+    size_t _prefix;
+
+    /**
+     * Stores the time stamp for the given time in {@link #_stamp}
+     *
+     * Converting to local time is expensive, so the date and time are only
+     * recomputed when the second changes.
+     *
+     * @param time  The time in microseconds since the epoch
+     */
+    void stamp(Sint64 time) {
+        Sint64 second = time/1000000;
+        if (second != _second) {
+            size_t limit = stamp_time(_stamp, STAMP_SIZE, time);
+            _prefix = limit > 7 ? limit-7 : limit;
+            _second = second;
+        } else {
+            std::snprintf(_stamp+_prefix, STAMP_SIZE-_prefix, ".%06d",(int)(time % 1000000));
+        }
+    }
+
+public:
+    /**
+     * Creates an idle backend
+     *
+     * The background thread is not started until it is needed.
+     */
+    LogBackend() :
+    _thread(nullptr),
+    _passes(0),
+    _waiting(0),
+    _signaled(false),
+    _active(false),
+    _second(-1),
+    _prefix(0) {
+        _stamp[0] = '\0';
+    }
+
+    /**
+     * Stops the background thread, writing any remaining messages
+     */
+    ~LogBackend() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _active = false;
+        }
+        _wakeup.notify_all();
+        if (_thread != nullptr) {
+            _thread->join();
+            delete _thread;
+            _thread = nullptr;
+        }
+    }
+
+    /**
+     * Starts the background thread if it is not running
+     */
+    void start() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_thread == nullptr) {
+            _active = true;
+            _thread = new std::thread(&LogBackend::run, this);
+        }
+    }
+
+    /**
+     * Registers the ring for a logging thread
+     *
+     * @param ring  The ring to register
+     */
+    void attach(const std::shared_ptr<LogRing>& ring) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _rings.push_back(ring);
+    }
+
+    /**
+     * Wakes up the log thread before its next scheduled pass
+     *
+     * This is called by a logging thread when its ring is filling up. It
+     * does not take a lock, and only notifies once per pass.
+     */
+    void wake() {
+        if (!_signaled.exchange(true)) {
+            _wakeup.notify_one();
+        }
+    }
+
+    /**
+     * Blocks until every record posted before this call is written
+     */
+    void flush() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_thread == nullptr) {
+            return;
+        }
+        // The current pass may have started before this call
+        Uint64 target = _passes+2;
+        _waiting++;
+        _wakeup.notify_all();
+        _passed.wait(lock, [&] { return _passes >= target || !_active; });
+        _waiting--;
+    }
+};
+
+}
+
+/**
+ * The background thread for asynchronous loggers
+ *
+ * This must be defined before the channels, so that it outlives them when
+ * the program exits.
+ */
+static LogBackend backend;
+
+/**
+ * The ring of the current thread, retired when the thread exits
+ */
+struct LogRingHandle {
+    /** The ring for the current thread */
+    std::shared_ptr<LogRing> ring;
+
+    /**
+     * Creates and registers the ring for the current thread
+     */
+    LogRingHandle() : ring(std::make_shared<LogRing>()) {
+        backend.attach(ring);
+    }
+
+    /**
+     * Retires the ring for the current thread
+     */
+    ~LogRingHandle() {
+        ring->retired.store(true, std::memory_order_release);
+    }
+};
+
+/** The list of all active logs */
+std::unordered_map<std::string, std::shared_ptr<Logger>> Logger::_channels;
+
+/** The SDL category to assign to the next allocated log */
+int Logger::_nextcategory = SDL_LOG_CATEGORY_CUSTOM;
+
 #pragma mark -
 #pragma mark Constructors
 /**
@@ -150,7 +549,9 @@ _consLevel(Level::NO_MSG),
 _buffer(nullptr),
 _capacity(0),
 _autof(false),
-_open(false) {
+_open(false),
+_async(false),
+_dropped(0) {
 }
 
 /**
@@ -159,9 +560,23 @@ _open(false) {
  * A disposed logger can be safely reinitialized.
  */
 void Logger::dispose() {
-    _writer->close();
+    if (_async) {
+        backend.flush();
+        _async = false;
+    }
+    // The log thread may still be in a pass that saw the channel open, so
+    // close it and wait out that pass before releasing the writer
+    _open = false;
+    backend.flush();
+    if (_writer != nullptr) {
+        _writer->close();
+    }
+    if (_buffer != nullptr) {
+        std::free(_buffer);
+        _buffer = nullptr;
+        _capacity = 0;
+    }
     _writer = nullptr;
-    _open  = false;
     _autof = false;
     _fileLevel = Level::NO_MSG;
     _consLevel = Level::NO_MSG;
@@ -351,7 +766,7 @@ bool Logger::close(const std::string channel) {
  */
 void Logger::setLogLevel(Level level) {
     if (_open) {
-        _writer->flush();
+        flush();
         _fileLevel = level;
     }
 }
@@ -393,12 +808,107 @@ void Logger::setAutoFlush(bool value) {
     if (_open) {
         _autof = value;
         if (value) {
-            _writer->flush();
+            flush();
         }
     }
 }
 
+/**
+ * Sets whether this logger writes messages on a background thread.
+ *
+ * An asynchronous logger only formats messages on the calling thread.
+ * The messages are written by a background thread shared by all loggers,
+ * in batches. Hence the file (and console) can lag a few milliseconds
+ * behind the calls to {@link #log}. It is safe for multiple threads to
+ * log to an asynchronous logger at the same time.
+ *
+ * Asynchronous loggers ignore {@link #doesAutoFlush}, as every batch is
+ * flushed once written. Calling {@link #flush} waits until all messages
+ * logged before the call are written to the file.
+ *
+ * Changing the value always flushes any pending messages to the file.
+ * It should not be changed while other threads are logging.
+ *
+ * @param value whether this logger writes messages on a background thread
+ */
+void Logger::setAsync(bool value) {
+    if (!_open || value == _async) {
+        return;
+    }
+    if (value) {
+        _writer->flush();
+        backend.start();
+        _async = true;
+    } else {
+        backend.flush();
+        _async = false;
+    }
+}
+
 #pragma mark Message Logging
+/**
+ * Sends a message to the background log thread.
+ *
+ * The message is formatted immediately, on the calling thread, but it
+ * is timestamped and written by the background log thread. This method
+ * never blocks. If the queue for this thread is full, the message is
+ * dropped.
+ *
+ * @param file      The log level for the file (NO_MSG to skip the file)
+ * @param console   The log level for the console (NO_MSG to skip it)
+ * @param format    The formatting string
+ * @param args      The printf-style subsitution arguments
+ */
+void Logger::post(Level file, Level console, const char* format, va_list args) {
+    if (file == Level::NO_MSG && console == Level::NO_MSG) {
+        return;
+    }
+
+    thread_local LogRingHandle handle;
+    LogRecord* record = handle.ring->reserve();
+    if (record == nullptr) {
+        _dropped++;
+        return;
+    }
+
+    record->logger  = this;
+    record->file    = file;
+    record->console = console;
+    record->time    = now_micros();
+    record->overflow = nullptr;
+
+    size_t off = _name.size()+3;
+    va_list copy;
+    va_copy(copy, args);
+    int size = -1;
+    if (off < RECORD_TEXT) {
+        size = vsnprintf(record->text+off, RECORD_TEXT-off, format, copy);
+    }
+    va_end(copy);
+
+    char* buffer = record->text;
+    if (size < 0 || off+size >= RECORD_TEXT) {
+        // Too long to store inline
+        va_copy(copy, args);
+        size = vsnprintf(nullptr, 0, format, copy);
+        va_end(copy);
+        buffer = (char*)std::malloc(off+std::max(size,0)+1);
+        if (buffer == nullptr) {
+            _dropped++;
+            return;
+        }
+        vsnprintf(buffer+off, std::max(size,0)+1, format, args);
+        record->overflow = buffer;
+    }
+    buffer[0] = '[';
+    std::memcpy(buffer+1, _name.c_str(), _name.size());
+    buffer[_name.size()+1] = ']';
+    buffer[_name.size()+2] = ' ';
+    if (handle.ring->commit() >= RING_CAPACITY/4) {
+        backend.wake();
+    }
+}
+
 /**
  * Sends a message to this logger.
  *
@@ -417,7 +927,15 @@ void Logger::log(const std::string format, ...) {
         CUAssertLog(_open, "Channel '%s' is closed.",_name.c_str());
         return;
     }
-    
+
+    if (_async) {
+        va_list args;
+        va_start (args, format);
+        post(_fileLevel, _consLevel, format.c_str(), args);
+        va_end(args);
+        return;
+    }
+
     va_list args;
     va_start (args, format);
     size_t size = vsnprintf(nullptr, 0, format.c_str(), args)+1;
@@ -474,6 +992,14 @@ void Logger::log(const char* format, ...) {
         return;
     }
 
+    if (_async) {
+        va_list args;
+        va_start (args, format);
+        post(_fileLevel, _consLevel, format, args);
+        va_end(args);
+        return;
+    }
+
     va_list args;
     va_start (args, format);
     size_t size = vsnprintf(nullptr, 0, format, args)+1;
@@ -530,6 +1056,20 @@ void Logger::log(Level level, const std::string format, ...) {
         return;
     }
 
+    if (_async) {
+        bool tofile = ((int)_fileLevel > (int)Level::NO_MSG &&
+                       (int)level > (int)Level::NO_MSG &&
+                       (int)level <= (int)_fileLevel);
+        bool tocons = ((int)_consLevel > (int)Level::NO_MSG &&
+                       (int)level > (int)Level::NO_MSG);
+        va_list args;
+        va_start (args, format);
+        post(tofile ? level : Level::NO_MSG, tocons ? level : Level::NO_MSG,
+             format.c_str(), args);
+        va_end(args);
+        return;
+    }
+
     va_list args;
     va_start (args, format);
     size_t size = vsnprintf(nullptr, 0, format.c_str(), args)+_name.size()+4;
@@ -589,6 +1129,20 @@ void Logger::log(Level level, const char* format, ...) {
         return;
     }
 
+    if (_async) {
+        bool tofile = ((int)_fileLevel > (int)Level::NO_MSG &&
+                       (int)level > (int)Level::NO_MSG &&
+                       (int)level <= (int)_fileLevel);
+        bool tocons = ((int)_consLevel > (int)Level::NO_MSG &&
+                       (int)level > (int)Level::NO_MSG);
+        va_list args;
+        va_start (args, format);
+        post(tofile ? level : Level::NO_MSG, tocons ? level : Level::NO_MSG,
+             format, args);
+        va_end(args);
+        return;
+    }
+
     va_list args;
     va_start (args, format);
     size_t size = vsnprintf(nullptr, 0, format, args)+_name.size()+4;
@@ -635,9 +1189,14 @@ void Logger::log(Level level, const char* format, ...) {
  * Otherwise, the file is written after every message. To improve
  * performance, you may wish to disable auto flush if you are writting a
  * large number of messages per animation frame.
+ *
+ * If this logger is asynchronous, this method blocks until the background
+ * thread has written every message logged before this call.
  */
 void Logger::flush() {
-    if (_open) {
+    if (_open && _async) {
+        backend.flush();
+    } else if (_open) {
         _writer->flush();
     }
 }
@@ -0,0 +1,55 @@
+//
+//  CUSimd.h
+//  Cornell University Game Library (CUGL)
+//
+//  This is an internal header for the modules with vector kernels. It is not
+//  part of the public API, and is only included by the source files.
+//
+//  The kernels are only compiled on x86, and are selected at runtime with
+//  SDL_cpuinfo. Hence each kernel is compiled for its instruction set with a
+//  function attribute, so that the rest of the module does not require any
+//  special compiler flags. MSVC does not need (or support) these attributes,
+//  as it always allows intrinsics.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+//
+#ifndef __CU_SIMD_H__
+#define __CU_SIMD_H__
+
+// Vector kernels are only available on x86 (with runtime detection)
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define CU_SIMD_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define CU_SIMD_SSE2
+        #define CU_SIMD_SSE4
+        #define CU_SIMD_AVX2
+    #else
+        #define CU_SIMD_SSE2 __attribute__((target("sse2")))
+        #define CU_SIMD_SSE4 __attribute__((target("sse4.1")))
+        #define CU_SIMD_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+#endif /* __CU_SIMD_H__ */
@@ -33,6 +33,9 @@
 //  Version: 7/3/24 (CUGL 3.0 reorganization)
 //
 #include <cugl/core/util/CUThreadPool.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 
 using namespace cugl;
 
@@ -160,6 +163,74 @@ void ThreadPool::addTask(const std::function<void()> &task){
     _taskCondition.notify_one();
 }
 
+/**
+ * Executes the given task over a range of indices, blocking until done.
+ *
+ * The range [0,size) is split into chunks of at least grain indices,
+ * and each chunk is passed to task as a half-open range [begin,end).
+ * The chunks are shared between the worker threads and the calling
+ * thread. As the calling thread also processes chunks, this method
+ * completes even if all of the workers are busy with other tasks.
+ *
+ * The task must be safe to execute concurrently on disjoint ranges.
+ * This method must not be called from a task of this same pool.
+ *
+ * @param size  The number of indices to process
+ * @param task  The function to process a range of indices
+ * @param grain The minimum number of indices per chunk
+ */
+void ThreadPool::parallelFor(size_t size, const std::function<void(size_t,size_t)>& task,
+                             size_t grain) {
+    if (size == 0) {
+        return;
+    }
+    grain = std::max(grain,(size_t)1);
+    size_t chunks = std::min((size+grain-1)/grain,_workers.size()+1);
+    if (chunks <= 1 || _stop) {
+        task(0,size);
+        return;
+    }
+    
+    // Shared state must outlive any helper still in the queue
+    struct Range {
+        std::atomic<size_t> next;
+        std::atomic<size_t> done;
+        size_t total;
+        size_t step;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto state = std::make_shared<Range>();
+    state->next  = 0;
+    state->done  = 0;
+    state->total = chunks;
+    state->step  = (size+chunks-1)/chunks;
+    
+    // Claims chunks until none are left
+    auto work = [state,task,size]() {
+        size_t chunk;
+        while ((chunk = state->next.fetch_add(1)) < state->total) {
+            size_t begin = chunk*state->step;
+            size_t end = std::min(begin+state->step,size);
+            if (begin < end) {
+                task(begin,end);
+            }
+            if (state->done.fetch_add(1)+1 == state->total) {
+                std::unique_lock<std::mutex> lk(state->mutex);
+                state->finished.notify_all();
+            }
+        }
+    };
+    
+    for(size_t ii = 1; ii < chunks; ii++) {
+        addTask(work);
+    }
+    work();
+    
+    std::unique_lock<std::mutex> lk(state->mutex);
+    state->finished.wait(lk, [&] { return state->done.load() == state->total; });
+}
+
 /**
  * Stops the thread pool, marking it for shut down.
  *
@@ -62,10 +62,17 @@
 //
 #include <cugl/graphics/CUParticleSystem.h>
 #include <cugl/graphics/CUInstanceBuffer.h>
+#include <cugl/core/util/CUThreadPool.h>
+#include <algorithm>
+#include <cstring>
+#include "../core/util/CUSimd.h"
 
 using namespace cugl;
 using namespace cugl::graphics;
 
+/** The minimum number of particles in a parallel batch slice */
+#define BATCH_GRAIN 8192
+
 #pragma mark Particle Vertex
 /**
  * Creates a new ParticleVertex from the given JSON value.
@@ -201,8 +208,359 @@ ParticleEmitter::ParticleEmitter(const std::shared_ptr<JsonValue>& data) {
     if (interval < 0) { interval = 0; }
 }
 
+#pragma mark -
+#pragma mark Particle Batch
+/**
+ * Returns true if this CPU supports AVX2
+ *
+ * @return true if this CPU supports AVX2
+ */
+static bool has_avx2() {
+    static const bool result = SDL_HasAVX2();
+    return result;
+}
+
+/**
+ * Returns the normalized age of a particle
+ *
+ * @param life  The remaining particle life
+ * @param inv   The reciprocal of the particle lifespan (or 0)
+ *
+ * @return the normalized age of a particle
+ */
+static inline float particle_age(float life, float inv) {
+    float t = 1.0f-life*inv;
+    return t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+}
+
+#if CU_SIMD_X86
+/**
+ * Applies gravity and drag to a batch with AVX2, eight particles at a time
+ *
+ * @param batch     The particle batch
+ * @param gravity   The gravitational acceleration
+ * @param drag      The drag coefficient (per second)
+ *
+ * @return the number of particles processed
+ */
+CU_SIMD_AVX2 static size_t integrate_avx2(const ParticleBatch& batch, const Vec3& gravity, float drag) {
+    const __m256 gx = _mm256_set1_ps(gravity.x);
+    const __m256 gy = _mm256_set1_ps(gravity.y);
+    const __m256 gz = _mm256_set1_ps(gravity.z);
+    const __m256 kd = _mm256_set1_ps(drag);
+    const __m256 one  = _mm256_set1_ps(1.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    
+    size_t last = batch.count & ~(size_t)7;
+    for(size_t ii = 0; ii < last; ii += 8) {
+        __m256 dt = _mm256_loadu_ps(batch.step+ii);
+        __m256 damp = _mm256_max_ps(_mm256_sub_ps(one, _mm256_mul_ps(kd, dt)), zero);
+        
+        __m256 vel = _mm256_loadu_ps(batch.vx+ii);
+        vel = _mm256_add_ps(_mm256_mul_ps(vel, damp), _mm256_mul_ps(gx, dt));
+        _mm256_storeu_ps(batch.vx+ii, vel);
+        _mm256_storeu_ps(batch.px+ii, _mm256_add_ps(_mm256_loadu_ps(batch.px+ii), _mm256_mul_ps(vel, dt)));
+        
+        vel = _mm256_loadu_ps(batch.vy+ii);
+        vel = _mm256_add_ps(_mm256_mul_ps(vel, damp), _mm256_mul_ps(gy, dt));
+        _mm256_storeu_ps(batch.vy+ii, vel);
+        _mm256_storeu_ps(batch.py+ii, _mm256_add_ps(_mm256_loadu_ps(batch.py+ii), _mm256_mul_ps(vel, dt)));
+        
+        vel = _mm256_loadu_ps(batch.vz+ii);
+        vel = _mm256_add_ps(_mm256_mul_ps(vel, damp), _mm256_mul_ps(gz, dt));
+        _mm256_storeu_ps(batch.vz+ii, vel);
+        _mm256_storeu_ps(batch.pz+ii, _mm256_add_ps(_mm256_loadu_ps(batch.pz+ii), _mm256_mul_ps(vel, dt)));
+    }
+    return last;
+}
+
+/**
+ * Returns the normalized ages of eight particles
+ *
+ * @param life  The remaining particle lives
+ * @param inv   The reciprocal of the particle lifespan (or 0)
+ *
+ * @return the normalized ages of eight particles
+ */
+CU_SIMD_AVX2 static inline __m256 particle_age_avx2(__m256 life, __m256 inv) {
+    __m256 t = _mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(life, inv));
+    return _mm256_min_ps(_mm256_max_ps(t, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+}
+
+/**
+ * Interpolates the particle sizes with AVX2, eight particles at a time
+ *
+ * @param batch The particle batch
+ * @param start The size of a newly emitted particle
+ * @param end   The size of an expiring particle
+ * @param inv   The reciprocal of the particle lifespan (or 0)
+ *
+ * @return the number of particles processed
+ */
+CU_SIMD_AVX2 static size_t scale_avx2(const ParticleBatch& batch, float start, float end, float inv) {
+    const __m256 base = _mm256_set1_ps(start);
+    const __m256 diff = _mm256_set1_ps(end-start);
+    const __m256 vinv = _mm256_set1_ps(inv);
+    
+    size_t last = batch.count & ~(size_t)7;
+    for(size_t ii = 0; ii < last; ii += 8) {
+        __m256 t = particle_age_avx2(_mm256_loadu_ps(batch.life+ii), vinv);
+        _mm256_storeu_ps(batch.size+ii, _mm256_add_ps(base, _mm256_mul_ps(diff, t)));
+    }
+    return last;
+}
+
+/**
+ * Interpolates the particle colors with AVX2, eight particles at a time
+ *
+ * @param batch The particle batch
+ * @param start The color of a newly emitted particle
+ * @param end   The color of an expiring particle
+ * @param inv   The reciprocal of the particle lifespan (or 0)
+ *
+ * @return the number of particles processed
+ */
+CU_SIMD_AVX2 static size_t fade_avx2(const ParticleBatch& batch, Color4 start, Color4 end, float inv) {
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 vinv = _mm256_set1_ps(inv);
+    const __m256 sr = _mm256_set1_ps(start.r);
+    const __m256 sg = _mm256_set1_ps(start.g);
+    const __m256 sb = _mm256_set1_ps(start.b);
+    const __m256 sa = _mm256_set1_ps(start.a);
+    const __m256 dr = _mm256_set1_ps((float)end.r-(float)start.r);
+    const __m256 dg = _mm256_set1_ps((float)end.g-(float)start.g);
+    const __m256 db = _mm256_set1_ps((float)end.b-(float)start.b);
+    const __m256 da = _mm256_set1_ps((float)end.a-(float)start.a);
+    
+    // Color4 is laid out r, g, b, a in memory
+    size_t last = batch.count & ~(size_t)7;
+    for(size_t ii = 0; ii < last; ii += 8) {
+        __m256 t = particle_age_avx2(_mm256_loadu_ps(batch.life+ii), vinv);
+        __m256i r = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_add_ps(sr, _mm256_mul_ps(dr, t)), half));
+        __m256i g = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_add_ps(sg, _mm256_mul_ps(dg, t)), half));
+        __m256i b = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_add_ps(sb, _mm256_mul_ps(db, t)), half));
+        __m256i a = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_add_ps(sa, _mm256_mul_ps(da, t)), half));
+        __m256i packed = _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(g, 8)),
+                                         _mm256_or_si256(_mm256_slli_epi32(b, 16), _mm256_slli_epi32(a, 24)));
+        _mm256_storeu_si256((__m256i*)(batch.color+ii), packed);
+    }
+    return last;
+}
+#endif
+
+/**
+ * Returns a view of the particles in the range [begin,end)
+ *
+ * @param begin The first particle of the view
+ * @param end   The particle after the last one in the view
+ *
+ * @return a view of the particles in the range [begin,end)
+ */
+ParticleBatch ParticleBatch::slice(size_t begin, size_t end) const {
+    CUAssertLog(begin <= end && end <= count, "Slice [%zu,%zu) is out of range", begin, end);
+    ParticleBatch result;
+    result.px = px+begin;
+    result.py = py+begin;
+    result.pz = pz+begin;
+    result.vx = vx+begin;
+    result.vy = vy+begin;
+    result.vz = vz+begin;
+    result.size = size+begin;
+    result.life = life+begin;
+    result.step = step+begin;
+    result.color = color+begin;
+    result.texOffset = texOffset+begin;
+    result.count = end-begin;
+    return result;
+}
+
+/**
+ * Applies gravity and drag to the particles, and moves them.
+ *
+ * Each particle velocity is first scaled by (1-drag*step), clamped at 0,
+ * and then accelerated by gravity*step. The position then moves by the
+ * new velocity times the time step.
+ *
+ * @param gravity   The gravitational acceleration
+ * @param drag      The drag coefficient (per second)
+ */
+void ParticleBatch::integrate(const Vec3 gravity, float drag) const {
+    size_t ii = 0;
+#if CU_SIMD_X86
+    if (has_avx2()) {
+        ii = integrate_avx2(*this, gravity, drag);
+    }
+#endif
+    for(; ii < count; ii++) {
+        float dt = step[ii];
+        float damp = 1.0f-drag*dt;
+        damp = damp < 0.0f ? 0.0f : damp;
+        vx[ii] = vx[ii]*damp+gravity.x*dt;
+        vy[ii] = vy[ii]*damp+gravity.y*dt;
+        vz[ii] = vz[ii]*damp+gravity.z*dt;
+        px[ii] += vx[ii]*dt;
+        py[ii] += vy[ii]*dt;
+        pz[ii] += vz[ii]*dt;
+    }
+}
+
+/**
+ * Sets the size of each particle to interpolate over its life.
+ *
+ * The particle age is 1-life/lifespan, clamped to [0,1]. A particle of
+ * age 0 has size start, while a particle of age 1 has size end. If the
+ * lifespan is not positive, all particles are treated as age 1.
+ *
+ * @param start     The size of a newly emitted particle
+ * @param end       The size of an expiring particle
+ * @param lifespan  The particle lifespan in seconds
+ */
+void ParticleBatch::scaleSize(float start, float end, float lifespan) const {
+    float inv = lifespan > 0.0f ? 1.0f/lifespan : 0.0f;
+    size_t ii = 0;
+#if CU_SIMD_X86
+    if (has_avx2()) {
+        ii = scale_avx2(*this, start, end, inv);
+    }
+#endif
+    for(; ii < count; ii++) {
+        size[ii] = start+(end-start)*particle_age(life[ii], inv);
+    }
+}
+
+/**
+ * Sets the color of each particle to interpolate over its life.
+ *
+ * The particle age is 1-life/lifespan, clamped to [0,1]. A particle of
+ * age 0 has color start, while a particle of age 1 has color end. If the
+ * lifespan is not positive, all particles are treated as age 1.
+ *
+ * @param start     The color of a newly emitted particle
+ * @param end       The color of an expiring particle
+ * @param lifespan  The particle lifespan in seconds
+ */
+void ParticleBatch::fadeColor(Color4 start, Color4 end, float lifespan) const {
+    float inv = lifespan > 0.0f ? 1.0f/lifespan : 0.0f;
+    size_t ii = 0;
+#if CU_SIMD_X86
+    if (has_avx2()) {
+        ii = fade_avx2(*this, start, end, inv);
+    }
+#endif
+    float dr = (float)end.r-(float)start.r;
+    float dg = (float)end.g-(float)start.g;
+    float db = (float)end.b-(float)start.b;
+    float da = (float)end.a-(float)start.a;
+    for(; ii < count; ii++) {
+        float t = particle_age(life[ii], inv);
+        color[ii].r = (Uint8)(start.r+dr*t+0.5f);
+        color[ii].g = (Uint8)(start.g+dg*t+0.5f);
+        color[ii].b = (Uint8)(start.b+db*t+0.5f);
+        color[ii].a = (Uint8)(start.a+da*t+0.5f);
+    }
+}
+
 #pragma mark -
 #pragma mark Particle System
+/**
+ * Returns the depth sort key for a particle
+ *
+ * Distances are non-negative, so their bits sort like integers. We flip
+ * them for back-to-front order, and pack the particle index in the low word.
+ *
+ * @param distance  The squared camera distance
+ * @param index     The particle index
+ *
+ * @return the depth sort key for a particle
+ */
+static inline Uint64 depth_key(float distance, size_t index) {
+    Uint32 bits;
+    std::memcpy(&bits, &distance, sizeof(Uint32));
+    return ((Uint64)(~bits) << 32) | index;
+}
+
+/**
+ * Returns the keys sorted by their high word
+ *
+ * This is a stable LSD radix sort, which skips any digit shared by every
+ * key. The result is either keys or back, depending on the number of passes.
+ *
+ * @param keys  The keys to sort
+ * @param back  A scratch buffer with at least size elements
+ * @param size  The number of keys
+ *
+ * @return the keys sorted by their high word
+ */
+static Uint64* radix_sort(Uint64* keys, Uint64* back, size_t size) {
+    const int RADIX_BITS = 11;
+    const Uint32 RADIX_SIZE = 1 << RADIX_BITS;
+    const Uint32 RADIX_MASK = RADIX_SIZE-1;
+    Uint32 counts[3][RADIX_SIZE];
+    std::memset(counts, 0, sizeof(counts));
+    
+    for(size_t ii = 0; ii < size; ii++) {
+        Uint32 bits = (Uint32)(keys[ii] >> 32);
+        counts[0][bits & RADIX_MASK]++;
+        counts[1][(bits >> RADIX_BITS) & RADIX_MASK]++;
+        counts[2][bits >> (2*RADIX_BITS)]++;
+    }
+    
+    for(int pass = 0; pass < 3; pass++) {
+        int shift = 32+pass*RADIX_BITS;
+        Uint32* count = counts[pass];
+        if (count[(keys[0] >> shift) & RADIX_MASK] == size) {
+            continue;
+        }
+        
+        Uint32 total = 0;
+        for(Uint32 ii = 0; ii < RADIX_SIZE; ii++) {
+            Uint32 amt = count[ii];
+            count[ii] = total;
+            total += amt;
+        }
+        for(size_t ii = 0; ii < size; ii++) {
+            back[count[(keys[ii] >> shift) & RADIX_MASK]++] = keys[ii];
+        }
+        std::swap(keys, back);
+    }
+    return keys;
+}
+
+/**
+ * Copies a particle into the given slot of a batch
+ *
+ * @param batch The particle batch
+ * @param index The batch slot
+ * @param part  The particle to copy
+ */
+static void write_batch(const ParticleBatch& batch, size_t index, const Particle3& part) {
+    batch.px[index] = part.position.x;
+    batch.py[index] = part.position.y;
+    batch.pz[index] = part.position.z;
+    batch.vx[index] = part.velocity.x;
+    batch.vy[index] = part.velocity.y;
+    batch.vz[index] = part.velocity.z;
+    batch.size[index] = part.size;
+    batch.life[index] = part.life;
+    batch.color[index] = part.color;
+    batch.texOffset[index] = Vec2::ZERO;
+}
+
+/**
+ * Copies the given slot of a batch into a particle
+ *
+ * @param batch The particle batch
+ * @param index The batch slot
+ * @param part  The particle to update
+ */
+static void read_batch(const ParticleBatch& batch, size_t index, Particle3& part) {
+    part.position.set(batch.px[index], batch.py[index], batch.pz[index]);
+    part.velocity.set(batch.vx[index], batch.vy[index], batch.vz[index]);
+    part.size = batch.size[index];
+    part.life = batch.life[index];
+    part.color = batch.color[index];
+}
+
 
 /**
  * Creates a new unitialized particle system.
@@ -213,12 +571,15 @@ ParticleEmitter::ParticleEmitter(const std::shared_ptr<JsonValue>& data) {
 ParticleSystem::ParticleSystem() :
 _instances(nullptr),
 _particles(nullptr),
+_ordering(nullptr),
 _duration(0),
 _capacity(0),
 _allocated(0),
 _greedy(false),
 _oldest(0),
-_is2d(false) {}
+_is2d(false),
+_distances(nullptr),
+_batched(false) {}
 
 /**
  * Disposes the emitters and allocation lists for this particle system.
@@ -229,8 +590,17 @@ void ParticleSystem::dispose() {
     if (_instances != nullptr) {
         delete[] _instances;
         delete[] _particles;
+        delete[] _ordering;
         _particles = nullptr;
         _instances = nullptr;
+        _ordering = nullptr;
+        delete[] _batch.px;
+        delete[] _batch.color;
+        delete[] _batch.texOffset;
+        _batch = ParticleBatch();
+        _distances = nullptr;
+        _batched = false;
+        _pool = nullptr;
         _renderBuffer = nullptr;
         _emitters.clear();
         _duration = 0;
@@ -256,9 +626,10 @@ void ParticleSystem::dispose() {
 bool ParticleSystem::init(size_t capacity) {
     _particles = new Particle3[capacity];
     _instances = new ParticleInstance[capacity];
+    _ordering  = new Uint64[2*capacity];
     _capacity = capacity;
     
-    if (capacity == 0 || _particles == nullptr || _instances == nullptr) {
+    if (capacity == 0 || _particles == nullptr || _instances == nullptr || _ordering == nullptr) {
         return false;
     }
     
@@ -284,9 +655,10 @@ bool ParticleSystem::init(size_t capacity) {
 bool ParticleSystem::initWithMesh(size_t capacity, const Mesh<ParticleVertex>& mesh) {
     _particles = new Particle3[capacity];
     _instances = new ParticleInstance[capacity];
+    _ordering  = new Uint64[2*capacity];
     _capacity = capacity;
     
-    if (capacity == 0 || _particles == nullptr || _instances == nullptr) {
+    if (capacity == 0 || _particles == nullptr || _instances == nullptr || _ordering == nullptr) {
         return false;
     }
     
@@ -316,9 +688,10 @@ bool ParticleSystem::initWithMesh(size_t capacity, const Mesh<ParticleVertex>& m
 bool ParticleSystem::initWithMesh(size_t capacity, Mesh<ParticleVertex>&& mesh) {
     _particles = new Particle3[capacity];
     _instances = new ParticleInstance[capacity];
+    _ordering  = new Uint64[2*capacity];
     _capacity = capacity;
     
-    if (capacity == 0 || _particles == nullptr || _instances == nullptr) {
+    if (capacity == 0 || _particles == nullptr || _instances == nullptr || _ordering == nullptr) {
         return false;
     }
     
@@ -402,7 +775,8 @@ bool ParticleSystem::initWithData(const std::shared_ptr<JsonValue> data, bool bu
     if (success) {
         _particles = new Particle3[_capacity];
         _instances = new ParticleInstance[_capacity];
-        if (_particles == nullptr || _instances == nullptr) {
+        _ordering  = new Uint64[2*_capacity];
+        if (_particles == nullptr || _instances == nullptr || _ordering == nullptr) {
             return false;
         }
     }
@@ -483,17 +857,37 @@ void ParticleSystem::removeEmitter(const std::string key) {
  * Most of the work of this method is implemented by the particle class.
  * This method manages particle emission (with delay) and camera distance.
  *
+ * Dead particles are removed with a stable, linear-time compaction, so
+ * the surviving particles keep their relative order from frame to frame.
+ * Unless this system is {@link #is2d}, the particles (and their instances)
+ * are then sorted back-to-front with a radix sort on the camera distance.
+ * This sort is skipped entirely if the particles are still in order from
+ * the previous frame.
+ *
+ * If this system has a {@link ParticleBatchUpdater}, it replaces the
+ * per-particle {@link ParticleUpdater}. The system then creates the
+ * instance data itself from the structure-of-arrays batch.
+ *
  * @param delta     The time passed in the simulation
  * @param camera    The camera position in world space
  */
 void ParticleSystem::update(float delta, const Vec3 camera) {
+    // Move the particles if the updater changed
+    if ((_batchUpdater != nullptr) != _batched && !convertBatch(!_batched)) {
+        return;
+    }
+    if (_batched) {
+        updateBatch(delta, camera);
+        return;
+    }
+    
     // Compute the camera location with respect to this system
     float step;
 
     _duration += delta;
     emit(delta);
     
-    // Now update the particles
+    // Now update the particles, compacting the survivors to the front
     size_t offset = 0;
     for(size_t pos = 0; pos < _allocated; pos++) {
         Particle3& curr = _particles[pos];
@@ -501,6 +895,7 @@ void ParticleSystem::update(float delta, const Vec3 camera) {
         // Step forward in time
         step = delta-curr.delay;
         curr.life -= step;
+        curr.delay = 0;
         
         bool dispose = curr.life <= 0.0f;
         if (!dispose && _updater != nullptr) {
@@ -509,32 +904,24 @@ void ParticleSystem::update(float delta, const Vec3 camera) {
                 Vec4 vector = _instances[offset].position;
                 Vec3 position(vector.x,vector.y,vector.z);
                 curr.distance = (position-camera).lengthSquared();
-                _instances[offset++].distance = curr.distance;
+                _instances[offset].distance = curr.distance;
+                if (offset != pos) {
+                    _particles[offset] = curr;
+                }
+                offset++;
             } else {
                 dispose = true;
             }
         }
         
-        if (dispose) {
-            if (_deallocator) {
-                _deallocator(&curr);
-            }
-            // Put the particle at the end
-            curr.distance = -1.0f;
+        if (dispose && _deallocator) {
+            _deallocator(&curr);
         }
-
-        curr.delay = 0;
     }
-        
-    std::sort(_particles,_particles+_allocated,[](const Particle3 &a, const Particle3 &b) {
-        return a.distance > b.distance;
-    });
-
-    // Only sort the instances if not 2d
+    
+    // Only sort if not 2d
     if (!_is2d) {
-        std::sort(_instances,_instances+offset,[](const ParticleInstance &a, const ParticleInstance &b) {
-            return a.distance > b.distance;
-        });
+        depthSort(offset);
     }
     
     // Reset any changes used for greedy allocation
@@ -582,6 +969,12 @@ void ParticleSystem::emit(float delta) {
             }
             particle.delay = delta-(_duration-source.remainder);
             source.remainder += source.interval;
+            if (_batched) {
+                size_t index = &particle-_particles;
+                write_batch(_batch, index, particle);
+                _batch.step[index] = delta-particle.delay;
+                particle.delay = 0;
+            }
         }
         source.duration += delta;
     }
@@ -592,34 +985,255 @@ void ParticleSystem::emit(float delta) {
  *
  * Particles are allocated from internal memory. If the maximum number of
  * particles has been reached, this will recycle the oldest particle.
- * However, behavior is undefined if more than {@link #getCapacity}
- * particles must be recycled.
+ * The oldest particles are tracked with a min-heap on the remaining life,
+ * which is built the first time a frame needs to recycle. However,
+ * behavior is undefined if more than {@link #getCapacity} particles must
+ * be recycled.
  *
  * @return a reference to a newly allocated particle.
  */
 Particle3& ParticleSystem::allocate() {
-    // Because of sort this is sufficient
+    // Because of compaction this is sufficient
     if (_allocated < _capacity) {
         return _particles[_allocated++];
     }
     
-    // If we only just learned we are full, sort by age
+    // Heap order puts the least remaining life on top
+    Particle3* particles = _particles;
+    const float* lives = _batch.life;
+    auto younger = [particles](Uint64 a, Uint64 b) {
+        return particles[a].life > particles[b].life;
+    };
+    auto batchYounger = [lives](Uint64 a, Uint64 b) {
+        return lives[a] > lives[b];
+    };
+    
+    // If we only just learned we are full, heapify by age
     if (!_greedy) {
-        std::sort(_particles,_particles+_capacity,[](const Particle3 &a, const Particle3 &b) {
-            return a.life < b.life;
-        });
+        for(size_t ii = 0; ii < _capacity; ii++) {
+            _ordering[ii] = ii;
+        }
+        if (_batched) {
+            std::make_heap(_ordering, _ordering+_capacity, batchYounger);
+        } else {
+            std::make_heap(_ordering, _ordering+_capacity, younger);
+        }
         _greedy = true;
-        _oldest = 0;
+        _oldest = (int)_capacity;
     }
     
-    if (_oldest < _capacity) {
-        return _particles[_oldest++];
+    if (_oldest > 0) {
+        if (_batched) {
+            std::pop_heap(_ordering, _ordering+_oldest, batchYounger);
+        } else {
+            std::pop_heap(_ordering, _ordering+_oldest, younger);
+        }
+        _oldest--;
+        return _particles[_ordering[_oldest]];
     }
     
     // Buffer overflow; reset the first one
     return _particles[0];
 }
 
+/**
+ * Sorts the first size particles and instances back-to-front.
+ *
+ * The particles and instances must be in correspondence, with instance i
+ * belonging to particle i. This method uses a stable radix sort on the
+ * camera distance, and permutes both arrays in place. If the arrays are
+ * already in order (which is common when the camera is still), this
+ * method does nothing.
+ *
+ * @param size  The number of particles to sort
+ */
+void ParticleSystem::depthSort(size_t size) {
+    // Temporal coherence means we are often done already
+    bool sorted = true;
+    for(size_t ii = 1; sorted && ii < size; ii++) {
+        sorted = _instances[ii-1].distance >= _instances[ii].distance;
+    }
+    if (sorted) {
+        return;
+    }
+    
+    Uint64* keys = _ordering;
+    for(size_t ii = 0; ii < size; ii++) {
+        keys[ii] = depth_key(_instances[ii].distance, ii);
+    }
+    keys = radix_sort(keys, _ordering+_capacity, size);
+    
+    // Reduce the keys to a permutation; destination ii takes source perm[ii]
+    Uint64* perm = keys;
+    for(size_t ii = 0; ii < size; ii++) {
+        perm[ii] &= 0xffffffff;
+    }
+    
+    // Apply the permutation in place by following cycles
+    for(size_t ii = 0; ii < size; ii++) {
+        if (perm[ii] == ii) {
+            continue;
+        }
+        Particle3 ptemp = _particles[ii];
+        ParticleInstance itemp = _instances[ii];
+        size_t dst = ii;
+        size_t src = perm[ii];
+        while (src != ii) {
+            _particles[dst] = _particles[src];
+            _instances[dst] = _instances[src];
+            perm[dst] = dst;
+            dst = src;
+            src = perm[src];
+        }
+        _particles[dst] = ptemp;
+        _instances[dst] = itemp;
+        perm[dst] = dst;
+    }
+}
+
+/**
+ * Updates the simulation using the batch updater.
+ *
+ * This is the structure-of-arrays version of {@link #update}. It compacts
+ * the live particles in the batch, and then writes the instance data in
+ * back-to-front order (unless this system is {@link #is2d}).
+ *
+ * @param delta     The time passed in the simulation
+ * @param camera    The camera position in world space
+ */
+void ParticleSystem::updateBatch(float delta, const Vec3 camera) {
+    _duration += delta;
+    
+    // Existing particles take a full step; emission adjusts for delay
+    std::fill(_batch.step, _batch.step+_allocated, delta);
+    emit(delta);
+    
+    size_t count = _allocated;
+    for(size_t ii = 0; ii < count; ii++) {
+        _batch.life[ii] -= _batch.step[ii];
+    }
+    
+    _batch.count = count;
+    if (_pool != nullptr && count > BATCH_GRAIN) {
+        ParticleBatch batch = _batch;
+        _pool->parallelFor(count, [this,&batch](size_t begin, size_t end) {
+            _batchUpdater(batch.slice(begin,end));
+        }, BATCH_GRAIN);
+    } else {
+        _batchUpdater(_batch);
+    }
+    
+    // Compact the survivors to the front
+    size_t offset = 0;
+    for(size_t pos = 0; pos < count; pos++) {
+        if (_batch.life[pos] > 0.0f) {
+            if (offset != pos) {
+                _batch.px[offset] = _batch.px[pos];
+                _batch.py[offset] = _batch.py[pos];
+                _batch.pz[offset] = _batch.pz[pos];
+                _batch.vx[offset] = _batch.vx[pos];
+                _batch.vy[offset] = _batch.vy[pos];
+                _batch.vz[offset] = _batch.vz[pos];
+                _batch.size[offset] = _batch.size[pos];
+                _batch.life[offset] = _batch.life[pos];
+                _batch.color[offset] = _batch.color[pos];
+                _batch.texOffset[offset] = _batch.texOffset[pos];
+                _particles[offset].userdata = _particles[pos].userdata;
+            }
+            offset++;
+        } else if (_deallocator) {
+            Particle3& curr = _particles[pos];
+            read_batch(_batch, pos, curr);
+            _deallocator(&curr);
+        }
+    }
+    
+    // Reset any changes used for greedy allocation
+    _allocated = offset;
+    _batch.count = offset;
+    _greedy = false;
+    _oldest = 0;
+    
+    for(size_t ii = 0; ii < offset; ii++) {
+        float dx = _batch.px[ii]-camera.x;
+        float dy = _batch.py[ii]-camera.y;
+        float dz = _batch.pz[ii]-camera.z;
+        _distances[ii] = dx*dx+dy*dy+dz*dz;
+    }
+    
+    // The batch stays put; only the instances are written in depth order
+    Uint64* keys = nullptr;
+    if (!_is2d && offset > 1) {
+        keys = _ordering;
+        for(size_t ii = 0; ii < offset; ii++) {
+            keys[ii] = depth_key(_distances[ii], ii);
+        }
+        keys = radix_sort(keys, _ordering+_capacity, offset);
+    }
+    
+    for(size_t ii = 0; ii < offset; ii++) {
+        size_t src = keys == nullptr ? ii : (size_t)(keys[ii] & 0xffffffff);
+        ParticleInstance& inst = _instances[ii];
+        inst.position.set(_batch.px[src], _batch.py[src], _batch.pz[src], _batch.size[src]);
+        inst.color = _batch.color[src];
+        inst.texOffset = _batch.texOffset[src];
+        inst.distance = _distances[src];
+    }
+    
+    // Update the buffer
+    if (_renderBuffer != nullptr) {
+        _renderBuffer->loadInstanceData(_instances, (GLsizei)_allocated, GL_STREAM_DRAW);
+    }
+}
+
+/**
+ * Converts the live particles to or from the batch storage.
+ *
+ * This method allocates the batch storage if necessary. It is called
+ * whenever a batch updater is added to or removed from this system.
+ *
+ * @param batched   Whether to convert the particles to the batch
+ *
+ * @return true if the conversion was successful
+ */
+bool ParticleSystem::convertBatch(bool batched) {
+    if (!batched) {
+        for(size_t ii = 0; ii < _allocated; ii++) {
+            read_batch(_batch, ii, _particles[ii]);
+        }
+        _batch.count = 0;
+        _batched = false;
+        return true;
+    }
+    
+    if (_batch.px == nullptr) {
+        if (_capacity == 0) {
+            return false;
+        }
+        float* block = new float[10*_capacity];
+        _batch.color = new Color4[_capacity];
+        _batch.texOffset = new Vec2[_capacity];
+        _batch.px = block;
+        _batch.py = block+_capacity;
+        _batch.pz = block+2*_capacity;
+        _batch.vx = block+3*_capacity;
+        _batch.vy = block+4*_capacity;
+        _batch.vz = block+5*_capacity;
+        _batch.size = block+6*_capacity;
+        _batch.life = block+7*_capacity;
+        _batch.step = block+8*_capacity;
+        _distances  = block+9*_capacity;
+    }
+    
+    // The instances still match the particles from the last update
+    for(size_t ii = 0; ii < _allocated; ii++) {
+        write_batch(_batch, ii, _particles[ii]);
+        _batch.texOffset[ii] = _instances[ii].texOffset;
+    }
+    _batch.count = _allocated;
+    _batched = true;
+    return true;
+}
 
 /**
  * Allocates the instance buffer for this particle system
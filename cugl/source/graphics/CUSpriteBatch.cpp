@@ -325,7 +325,15 @@ _vertSize(0),
 _indxMax(0),
 _indxSize(0),
 _vertTotal(0),
-_callTotal(0) {
+_callTotal(0),
+_byteTotal(0),
+_skipTotal(0),
+_typeLocale(-1),
+_perspLocale(-1),
+_blurLocale(-1),
+_stateKnown(0),
+_stateType(0) {
+    _stateBlur[0] = _stateBlur[1] = 0;
     _shader = nullptr;
     _vertbuff = nullptr;
     _unifbuff = nullptr;
@@ -362,6 +370,13 @@ void SpriteBatch::dispose() {
     
     _vertTotal = 0;
     _callTotal = 0;
+    _byteTotal = 0;
+    _skipTotal = 0;
+    
+    _typeLocale  = -1;
+    _perspLocale = -1;
+    _blurLocale  = -1;
+    _stateKnown  = 0;
     
     _initialized = false;
     _inflight = false;
@@ -483,6 +498,7 @@ bool SpriteBatch::init(unsigned int capacity, const std::shared_ptr<Shader>& sha
     _unifbuff->setOffset("gdFeathr", 156);
 
     _shader->setUniformBlock("uContext",_unifbuff);
+    cacheLocations();
     
     _context = new Context();
     _context->dirty = DIRTY_ALL_VALS;
@@ -521,6 +537,38 @@ void SpriteBatch::setShader(const std::shared_ptr<Shader>& shader) {
     _shader = shader;
     _vertbuff->attach(_shader);
     _shader->setUniformBlock("uContext", _unifbuff);
+    cacheLocations();
+}
+
+/**
+ * Sets the number of ring segments for streaming vertex data.
+ *
+ * By default, the sprite batch reloads its vertex buffer with buffer
+ * orphaning on each flush. With more than one segment, each flush instead
+ * writes to the next segment of a fenced ring (see
+ * {@link VertexBuffer#setStreamSegments}), so that the CPU never writes to
+ * data that the GPU is still reading. This is useful for sprite batches
+ * that flush many times per frame. A value of 1 restores the default.
+ *
+ * This value may NOT be changed during a drawing pass.
+ *
+ * @param segments  The number of ring segments
+ */
+void SpriteBatch::setStreamSegments(unsigned int segments) {
+    CUAssertLog(!_active, "Attempt to reassign segments while drawing is active");
+    _vertbuff->setStreamSegments(segments);
+}
+
+/**
+ * Returns the number of ring segments for streaming vertex data.
+ *
+ * A value of 1 means that the sprite batch reloads its vertex buffer
+ * with buffer orphaning on each flush.
+ *
+ * @return the number of ring segments for streaming vertex data.
+ */
+unsigned int SpriteBatch::getStreamSegments() const {
+    return _vertbuff->getStreamSegments();
 }
 
 
@@ -1060,6 +1108,11 @@ void SpriteBatch::begin() {
     _active = true;
     _callTotal = 0;
     _vertTotal = 0;
+    _byteTotal = 0;
+    _skipTotal = 0;
+    
+    // Uniforms may have been changed outside of this sprite batch
+    _stateKnown = 0;
 }
 
 /**
@@ -1103,8 +1156,8 @@ void SpriteBatch::flush() {
     
     // Load all the vertex data at once
     _vertbuff->bind();
-    _vertbuff->loadVertexData(_vertData, _vertSize);
-    _vertbuff->loadIndexData(_indxData, _indxSize);
+    _vertbuff->streamData(_vertData, _vertSize, _indxData, _indxSize);
+    _byteTotal += _vertSize*sizeof(SpriteVertex)+_indxSize*sizeof(GLuint);
     _unifbuff->activate();
     _unifbuff->flush();
     
@@ -1124,10 +1177,22 @@ void SpriteBatch::flush() {
             }
         }
         if (next->dirty & DIRTY_DRAWTYPE) {
-             _shader->setUniform1i("uType", next->type);
+            if ((_stateKnown & DIRTY_DRAWTYPE) && _stateType == next->type) {
+                _skipTotal++;
+            } else {
+                _shader->setUniform1i(_typeLocale, next->type);
+                _stateType = next->type;
+                _stateKnown |= DIRTY_DRAWTYPE;
+            }
         }
         if (next->dirty & DIRTY_PERSPECTIVE) {
-            _shader->setUniformMat4("uPerspective",*(next->perspective.get()));
+            if ((_stateKnown & DIRTY_PERSPECTIVE) && _statePersp == *(next->perspective.get())) {
+                _skipTotal++;
+            } else {
+                _shader->setUniformMat4(_perspLocale,*(next->perspective.get()));
+                _statePersp = *(next->perspective.get());
+                _stateKnown |= DIRTY_PERSPECTIVE;
+            }
         }
         if (next->dirty & DIRTY_TEXTURE) {
             previous = next->texture;
@@ -2474,14 +2539,33 @@ void SpriteBatch::setUniformBlock(Context* context) {
  * @param step      The blur step in pixels
  */
 void SpriteBatch::blurTexture(const std::shared_ptr<Texture>& texture, GLfloat step) {
-    if (texture == nullptr) {
-        _shader->setUniform2f("uBlur", 0, 0);
+    Size size;
+    if (texture != nullptr) {
+        size = texture->getSize();
+        size.width  = step/size.width;
+        size.height = step/size.height;
+    }
+    if ((_stateKnown & DIRTY_BLURSTEP) && _stateBlur[0] == size.width && _stateBlur[1] == size.height) {
+        _skipTotal++;
         return;
     }
-    Size size = texture->getSize();
-    size.width  = step/size.width;
-    size.height = step/size.height;
-    _shader->setUniform2f("uBlur",size.width,size.height);
+    _shader->setUniform2f(_blurLocale,size.width,size.height);
+    _stateBlur[0] = size.width;
+    _stateBlur[1] = size.height;
+    _stateKnown |= DIRTY_BLURSTEP;
+}
+
+/**
+ * Caches the uniform locations of the active shader.
+ *
+ * This method also invalidates the cached uniform values, as they
+ * may not agree with the new shader.
+ */
+void SpriteBatch::cacheLocations() {
+    _typeLocale  = _shader->getUniformLocation("uType");
+    _perspLocale = _shader->getUniformLocation("uPerspective");
+    _blurLocale  = _shader->getUniformLocation("uBlur");
+    _stateKnown  = 0;
 }
 
 /**
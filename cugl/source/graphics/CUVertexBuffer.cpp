@@ -47,6 +47,7 @@
 //  Author: Walker White
 //  Version: 7/3/24 (CUGL 3.0 reorganization)
 //
+#include <cstring>
 #include <cugl/core/util/CUDebug.h>
 #include <cugl/graphics/CUVertexBuffer.h>
 #include <cugl/graphics/CUShader.h>
@@ -65,7 +66,11 @@ VertexBuffer::VertexBuffer() :
 _vertArray(0),
 _vertBuffer(0),
 _indxBuffer(0),
-_stride(0) {
+_stride(0),
+_segments(1),
+_segment(-1),
+_vertBase(0),
+_indxBase(0) {
     _shader = nullptr;
 }
 
@@ -137,8 +142,15 @@ void VertexBuffer::dispose() {
     if (!_vertArray) {
         return;
     }
+    for(auto it = _fences.begin(); it != _fences.end(); ++it) {
+        if (*it) {
+            glDeleteSync(*it);
+        }
+    }
+    _fences.clear();
     _enabled.clear();
     _attributes.clear();
+    _locations.clear();
     glDeleteBuffers(1,&_indxBuffer);
     glDeleteBuffers(1,&_vertBuffer);
     glDeleteVertexArrays(1,&_vertArray);
@@ -147,6 +159,10 @@ void VertexBuffer::dispose() {
     _vertArray  = 0;
     _shader = nullptr;
     _stride = 0;
+    _segments = 1;
+    _segment  = -1;
+    _vertBase = 0;
+    _indxBase = 0;
 }
 
 
@@ -211,13 +227,14 @@ void VertexBuffer::attach(const std::shared_ptr<Shader>& shader) {
         for(auto it = _attributes.begin(); it != _attributes.end(); ++it) {
             std::string name = it->first;
 			GLint pos = glGetAttribLocation(_shader->getProgram(), name.c_str());
+			_locations[name] = pos;
 			if (pos == -1) {
 				CUWarn("Active shader has no attribute %s", name.c_str());
 			} else if (_enabled[name]) {
 				glEnableVertexAttribArray(pos);
 				glVertexAttribPointer(pos,it->second.size,it->second.type,
 									  it->second.norm,_stride,
-									  reinterpret_cast<void*>(it->second.offset));
+									  reinterpret_cast<void*>(it->second.offset+_vertBase));
                 glVertexAttribDivisor(pos,0);
 			} else {
 				glDisableVertexAttribArray(pos);
@@ -291,12 +308,15 @@ void VertexBuffer::loadVertexData(const void * data, GLsizei size, GLenum usage)
     glBindBuffer( GL_ARRAY_BUFFER, _vertBuffer );
     GLenum error = glGetError();
     CUAssertLog(error == GL_NO_ERROR, "VertexBuffer: %s", gl_error_name(error).c_str());
+    if (_vertBase != 0) {
+        rebaseAttributes(0);
+    }
 
     if (usage == GL_STATIC_DRAW) {
         glBufferData( GL_ARRAY_BUFFER, _stride * size, data, usage );
     } else {
-        // Buffer orphaning
-        glBufferData(GL_ARRAY_BUFFER, _stride*_size, NULL, usage);
+        // Buffer orphaning (of the entire ring, if streaming)
+        glBufferData(GL_ARRAY_BUFFER, _stride*_size*_segments, NULL, usage);
         error = glGetError();
         CUAssertLog(error == GL_NO_ERROR, "VertexBuffer: %s", gl_error_name(error).c_str());
         glBufferSubData(GL_ARRAY_BUFFER, 0, _stride*size, data);
@@ -339,11 +359,12 @@ void VertexBuffer::loadIndexData(const void * data, GLsizei size, GLenum usage)
     //CUAssertLog(isBound(), "Vertex buffer is not bound");
     CUAssertLog(size <= _size, "Data exceeds maximum capacity: %d > %d",size,_size);
     glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, _indxBuffer );
+    _indxBase = 0;
     if (usage == GL_STATIC_DRAW) {
         glBufferData( GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*size, data, usage );
     } else {
-        // Buffer orphaning
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*_size, NULL, usage);
+        // Buffer orphaning (of the entire ring, if streaming)
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*_size*_segments, NULL, usage);
         glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, sizeof(GLuint)*size, data);
     }
 
@@ -351,6 +372,121 @@ void VertexBuffer::loadIndexData(const void * data, GLsizei size, GLenum usage)
     CUAssertLog(error == GL_NO_ERROR, "VertexBuffer: %s", gl_error_name(error).c_str());
 }
 
+/**
+ * Sets the number of ring segments used by {@link #streamData}.
+ *
+ * A streaming vertex buffer allocates its storage as a ring of segments,
+ * each of which has the full capacity of this buffer. Every call to
+ * {@link #streamData} writes to the next segment in the ring, so that the
+ * CPU never writes to memory that the GPU may still be reading. Each
+ * segment is guarded by a fence. If the GPU has not yet released the next
+ * segment, the buffer is orphaned instead of waiting on the fence.
+ *
+ * A value of 1 disables the ring. In that case {@link #streamData} is the
+ * same as a call to {@link #loadVertexData} and {@link #loadIndexData}.
+ *
+ * This method reallocates the graphics card storage, discarding any data
+ * previously loaded. It will bind this vertex buffer.
+ *
+ * @param segments  The number of ring segments
+ */
+void VertexBuffer::setStreamSegments(GLsizei segments) {
+    CUAssertLog(_vertBuffer, "VertexBuffer has not be initialized.");
+    CUAssertLog(segments > 0, "The number of segments must be positive");
+    for(auto it = _fences.begin(); it != _fences.end(); ++it) {
+        if (*it) {
+            glDeleteSync(*it);
+        }
+    }
+    _segments = segments;
+    _segment  = -1;
+    _fences.assign(segments, 0);
+    
+    glBindVertexArray(_vertArray);
+    glBindBuffer( GL_ARRAY_BUFFER, _vertBuffer );
+    glBufferData(GL_ARRAY_BUFFER, _stride*_size*_segments, NULL, GL_STREAM_DRAW);
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, _indxBuffer );
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*_size*_segments, NULL, GL_STREAM_DRAW);
+    _indxBase = 0;
+    if (_vertBase != 0) {
+        rebaseAttributes(0);
+    }
+    
+    GLenum error = glGetError();
+    CUAssertLog(error == GL_NO_ERROR, "VertexBuffer: %s", gl_error_name(error).c_str());
+}
+
+/**
+ * Streams the given vertices and indices to the next ring segment.
+ *
+ * This method is an alternative to {@link #loadVertexData} and
+ * {@link #loadIndexData} for data that changes every frame. The data is
+ * written to the next segment in the ring (see {@link #setStreamSegments})
+ * with an unsynchronized map. All subsequent calls to {@link #draw} and
+ * {@link #drawDirect} will refer to this segment, so draw offsets remain
+ * relative to the start of the data streamed.
+ *
+ * The indices should be relative to the vertices in this call, exactly
+ * as they would be for {@link #loadIndexData}.
+ *
+ * This method will only succeed if this buffer is actively bound.
+ *
+ * @param verts The vertices to load
+ * @param vsize The number of vertices to load
+ * @param indx  The indices to load
+ * @param isize The number of indices to load
+ */
+void VertexBuffer::streamData(const void* verts, GLsizei vsize, const void* indx, GLsizei isize) {
+    if (_segments <= 1) {
+        loadVertexData(verts, vsize);
+        loadIndexData(indx, isize);
+        return;
+    }
+    CUAssertLog(vsize <= _size, "Data exceeds maximum capacity: %d > %d",vsize,_size);
+    CUAssertLog(isize <= _size, "Data exceeds maximum capacity: %d > %d",isize,_size);
+
+    // Everything drawn so far used the current segment
+    if (_segment >= 0) {
+        if (_fences[_segment]) {
+            glDeleteSync(_fences[_segment]);
+        }
+        _fences[_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    _segment = (_segment+1) % _segments;
+    
+    glBindBuffer( GL_ARRAY_BUFFER, _vertBuffer );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, _indxBuffer );
+    
+    // Never wait on the GPU. Orphan the ring if it is still reading.
+    GLsync fence = _fences[_segment];
+    if (fence) {
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED) {
+            for(auto it = _fences.begin(); it != _fences.end(); ++it) {
+                if (*it) {
+                    glDeleteSync(*it);
+                    *it = 0;
+                }
+            }
+            glBufferData(GL_ARRAY_BUFFER, _stride*_size*_segments, NULL, GL_STREAM_DRAW);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*_size*_segments, NULL, GL_STREAM_DRAW);
+        } else {
+            glDeleteSync(fence);
+            _fences[_segment] = 0;
+        }
+    }
+    
+    GLsizeiptr vbase = (GLsizeiptr)_segment*_size*_stride;
+    writeRange(GL_ARRAY_BUFFER, vbase, (GLsizeiptr)vsize*_stride, verts);
+    writeRange(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)_segment*_size*sizeof(GLuint),
+               (GLsizeiptr)isize*sizeof(GLuint), indx);
+    _indxBase = _segment*_size;
+    rebaseAttributes(vbase);
+    
+    GLenum error = glGetError();
+    CUAssertLog(error == GL_NO_ERROR, "VertexBuffer: %s", gl_error_name(error).c_str());
+}
+
 /**
  * Draws to the active framebuffer using this vertex buffer
  *
@@ -377,7 +513,7 @@ void VertexBuffer::draw(GLenum mode, GLsizei count, GLsizei offset) {
     // Assert causes problems on android emulator for now
     //CUAssertLog(isBound(), "Vertex buffer is not bound");
     if (count == 0) { return; }
-    glDrawElements(mode, count, GL_UNSIGNED_INT, (void*)(offset * sizeof(GLuint)));
+    glDrawElements(mode, count, GL_UNSIGNED_INT, (void*)((offset+_indxBase) * sizeof(GLuint)));
     GLenum error = glGetError();
     CUAssertLog(error == GL_NO_ERROR, "VertexBuffer: %s", gl_error_name(error).c_str());
 }
@@ -460,12 +596,13 @@ void VertexBuffer::setupAttribute(const std::string name, GLint size, GLenum typ
     if (_shader != nullptr) {
         _shader->bind();
         GLint pos = glGetAttribLocation(_shader->getProgram(), name.c_str());
+        _locations[name] = pos;
         if (pos == -1) {
             CUWarn("Active shader has no attribute %s", name.c_str());
         } else {
             glEnableVertexAttribArray(pos);
             glVertexAttribPointer(pos,data.size,data.type,data.norm,_stride,
-                                  reinterpret_cast<GLvoid*>(data.offset));
+                                  reinterpret_cast<GLvoid*>(data.offset+_vertBase));
             glVertexAttribDivisor(pos,0);
         }
         
@@ -517,3 +654,66 @@ void VertexBuffer::disableAttribute(const std::string name) {
 		}
 	}    
 }
+
+#pragma mark -
+#pragma mark Internal Helpers
+/**
+ * Repositions all enabled attributes to start at the given byte offset.
+ *
+ * This method is used to point the shader at the active ring segment
+ * without having to rewrite the indices. It assumes that the vertex
+ * buffer is bound.
+ *
+ * @param base  The byte offset of the vertex data
+ */
+void VertexBuffer::rebaseAttributes(GLsizeiptr base) {
+    _vertBase = base;
+    if (_shader == nullptr) {
+        return;
+    }
+    
+    glBindBuffer( GL_ARRAY_BUFFER, _vertBuffer );
+    for(auto it = _attributes.begin(); it != _attributes.end(); ++it) {
+        auto jt = _locations.find(it->first);
+        GLint pos = -1;
+        if (jt == _locations.end()) {
+            pos = glGetAttribLocation(_shader->getProgram(), it->first.c_str());
+            _locations[it->first] = pos;
+        } else {
+            pos = jt->second;
+        }
+        if (pos != -1 && _enabled[it->first]) {
+            glVertexAttribPointer(pos,it->second.size,it->second.type,
+                                  it->second.norm,_stride,
+                                  reinterpret_cast<void*>(it->second.offset+base));
+        }
+    }
+}
+
+/**
+ * Writes the data to the given range of the currently bound buffer.
+ *
+ * The range is mapped without synchronization, as the ring fences
+ * guarantee that the GPU is no longer reading from it. If the map
+ * fails, this method falls back to a standard buffer update.
+ *
+ * @param target    The buffer binding target
+ * @param offset    The byte offset of the range
+ * @param length    The byte length of the range
+ * @param data      The data to write
+ */
+void VertexBuffer::writeRange(GLenum target, GLintptr offset, GLsizeiptr length, const void* data) {
+    if (length == 0) {
+        return;
+    }
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+    void* dst = glMapBufferRange(target, offset, length, access);
+    if (dst != nullptr) {
+        std::memcpy(dst, data, length);
+        if (glUnmapBuffer(target) == GL_TRUE) {
+            return;
+        }
+    }
+    // The map failed or the data store was corrupted
+    glBufferSubData(target, offset, length, data);
+}
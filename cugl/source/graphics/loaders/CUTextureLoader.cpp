@@ -11,6 +11,10 @@
 //  asset manager.  In addition, this class uses our standard shared-pointer
 //  architecture.
 //
+//  Decoded images may optionally be cached on disk as raw pixels in the
+//  OpenGL memory order. This allows later runs to skip image decoding
+//  entirely, which is the bulk of the cost of texture loading.
+//
 //  1. The constructor does not perform any initialization; it just sets all
 //     attributes to their defaults.
 //
@@ -47,6 +51,9 @@
 #include <cugl/core/util/CUFiletools.h>
 #include <cugl/core/CUApplication.h>
 #include <SDL_image.h>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
 
 using namespace cugl;
 using namespace cugl::graphics;
@@ -54,6 +61,64 @@ using namespace cugl::graphics;
 /** What the source name is if we do not know it */
 #define UNKNOWN_SOURCE  "<unknown>"
 
+/** The magic number identifying a cache entry ("CUTX") */
+#define CACHE_MAGIC     0x58545543
+/** The version of the cache entry format */
+#define CACHE_VERSION   1
+/** The file extension for cache entries */
+#define CACHE_EXTENSION ".cutx"
+
+/** The pixel format of the decoded images */
+#if CU_MEMORY_ORDER == CU_ORDER_REVERSED
+    #define CACHE_FORMAT    SDL_PIXELFORMAT_ABGR8888
+#else
+    #define CACHE_FORMAT    SDL_PIXELFORMAT_RGBA8888
+#endif
+
+/**
+ * Returns the 64-bit FNV-1a hash of the given data
+ *
+ * @param data  The data to hash
+ * @param size  The number of bytes to hash
+ * @param seed  The hash to continue from
+ *
+ * @return the 64-bit FNV-1a hash of the given data
+ */
+static Uint64 fnv1a(const void* data, size_t size, Uint64 seed=0xcbf29ce484222325ULL) {
+    const Uint8* bytes = (const Uint8*)data;
+    Uint64 hash = seed;
+    for(size_t ii = 0; ii < size; ii++) {
+        hash ^= bytes[ii];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * Returns the hash of the contents of the given file
+ *
+ * If the file cannot be read, this function returns 0.
+ *
+ * @param path  The full path to the file
+ *
+ * @return the hash of the contents of the given file
+ */
+static Uint64 content_hash(const std::string path) {
+    SDL_RWops* file = SDL_RWFromFile(path.c_str(), "rb");
+    if (file == nullptr) {
+        return 0;
+    }
+
+    Uint8 buffer[16384];
+    Uint64 hash = fnv1a(nullptr,0);
+    size_t amt;
+    while ((amt = SDL_RWread(file, buffer, 1, sizeof(buffer))) > 0) {
+        hash = fnv1a(buffer,amt,hash);
+    }
+    SDL_RWclose(file);
+    return hash;
+}
+
 #pragma mark -
 #pragma mark Constructor
 
@@ -68,12 +133,165 @@ _minfilter(GL_LINEAR),
 _magfilter(GL_LINEAR),
 _wraps(GL_CLAMP_TO_EDGE),
 _wrapt(GL_CLAMP_TO_EDGE),
-_mipmaps(false) {
+_mipmaps(false),
+_cacheHits(0),
+_cacheMisses(0) {
     _jsonKey  = "textures";
     _priority = 0;
 }
 
 
+#pragma mark -
+#pragma mark Image Cache
+/**
+ * Sets the directory for cached decoded images.
+ *
+ * When this value is not empty, every decoded image is written to this
+ * directory as raw pixels. Later loads of the same image read the pixels
+ * directly, skipping both image decoding and format conversion. An entry
+ * is invalidated if the image file changes size, or if it changes both
+ * modification time and contents. The directory should be writable, so
+ * the save directory ({@link Application#getSaveDirectory}) is a good
+ * choice. It is created if it does not exist.
+ *
+ * Cache entries are uncompressed, so they use more disk space than
+ * the original images. Setting this value to the empty string disables
+ * the cache. It is not safe to change this value while loading assets.
+ *
+ * @param path  The directory for cached decoded images.
+ */
+void TextureLoader::setCacheDirectory(const std::string path) {
+    _cacheDir = path;
+    if (path.empty()) {
+        return;
+    }
+
+    if (_cacheDir.back() != filetool::path_sep) {
+        _cacheDir.push_back(filetool::path_sep);
+    }
+    if (!filetool::is_dir(_cacheDir) && !filetool::dir_create(_cacheDir)) {
+        CULogError("Unable to create texture cache '%s'",_cacheDir.c_str());
+        _cacheDir.clear();
+    }
+}
+
+/**
+ * Returns the cache file for the given source image
+ *
+ * @param source    The pathname to the asset
+ *
+ * @return the cache file for the given source image
+ */
+std::string TextureLoader::getCachePath(const std::string source) const {
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0');
+    ss << fnv1a(source.data(),source.size());
+    return _cacheDir+ss.str()+CACHE_EXTENSION;
+}
+
+/**
+ * Returns the decoded image for the given source, if it is cached.
+ *
+ * The cache entry is only used if it matches the source file. It must
+ * have the same size and either the same modification time or the same
+ * content hash. Otherwise this method returns nullptr.
+ *
+ * @param source    The pathname to the asset
+ * @param path      The full path to the source image
+ *
+ * @return the decoded image for the given source, if it is cached.
+ */
+SDL_Surface* TextureLoader::readCache(const std::string source, const std::string path) {
+    std::string cache = getCachePath(source);
+    SDL_RWops* file = SDL_RWFromFile(cache.c_str(), "rb");
+    if (file == nullptr) {
+        return nullptr;
+    }
+
+    Uint32 magic   = SDL_ReadLE32(file);
+    Uint32 version = SDL_ReadLE32(file);
+    Uint32 width   = SDL_ReadLE32(file);
+    Uint32 height  = SDL_ReadLE32(file);
+    Uint32 format  = SDL_ReadLE32(file);
+    Uint32 pitch   = SDL_ReadLE32(file);
+    Uint64 size    = SDL_ReadLE64(file);
+    Uint64 stamp   = SDL_ReadLE64(file);
+    Uint64 hash    = SDL_ReadLE64(file);
+
+    bool valid = (magic == CACHE_MAGIC && version == CACHE_VERSION);
+    valid = valid && format == CACHE_FORMAT && width > 0 && height > 0;
+    valid = valid && size == (Uint64)filetool::file_size(path);
+    if (valid && (stamp == 0 || stamp != filetool::file_timestamp(path))) {
+        // Timestamps are unreliable on some filesystems (and in APKs)
+        valid = (hash == content_hash(path));
+    }
+
+    SDL_Surface* surface = nullptr;
+    if (valid) {
+        surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, CACHE_FORMAT);
+    }
+    if (surface != nullptr) {
+        size_t amount = (size_t)pitch*height;
+        if ((Uint32)surface->pitch != pitch ||
+            SDL_RWread(file, surface->pixels, 1, amount) != amount) {
+            SDL_FreeSurface(surface);
+            surface = nullptr;
+        }
+    }
+
+    SDL_RWclose(file);
+    return surface;
+}
+
+/**
+ * Writes the decoded image for the given source to the cache.
+ *
+ * This method is safe to call from any thread. The entry is written to
+ * a temporary file first, so other threads never read a partial entry.
+ *
+ * @param source    The pathname to the asset
+ * @param path      The full path to the source image
+ * @param surface   The decoded image
+ *
+ * @return true if the image was successfully cached
+ */
+bool TextureLoader::writeCache(const std::string source, const std::string path,
+                               SDL_Surface* surface) {
+    if (surface == nullptr || surface->format->format != CACHE_FORMAT) {
+        return false;
+    }
+
+    std::string cache = getCachePath(source);
+    std::string temp  = cache+"."+std::to_string(SDL_ThreadID());
+    SDL_RWops* file = SDL_RWFromFile(temp.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    size_t amount = (size_t)surface->pitch*surface->h;
+    bool success = true;
+    success = SDL_WriteLE32(file, CACHE_MAGIC) && success;
+    success = SDL_WriteLE32(file, CACHE_VERSION) && success;
+    success = SDL_WriteLE32(file, surface->w) && success;
+    success = SDL_WriteLE32(file, surface->h) && success;
+    success = SDL_WriteLE32(file, CACHE_FORMAT) && success;
+    success = SDL_WriteLE32(file, surface->pitch) && success;
+    success = SDL_WriteLE64(file, filetool::file_size(path)) && success;
+    success = SDL_WriteLE64(file, filetool::file_timestamp(path)) && success;
+    success = SDL_WriteLE64(file, content_hash(path)) && success;
+    success = success && SDL_RWwrite(file, surface->pixels, 1, amount) == amount;
+    SDL_RWclose(file);
+
+    if (success) {
+        std::remove(cache.c_str());
+        success = (std::rename(temp.c_str(), cache.c_str()) == 0);
+    }
+    if (!success) {
+        std::remove(temp.c_str());
+    }
+    return success;
+}
+
 #pragma mark -
 #pragma mark Asset Loading
 /**
@@ -84,6 +302,9 @@ _mipmaps(false) {
  * we need to create an OpenGL texture.  Hence this method does the maximum
  * amount of work that can be done in asynchronous texture loading.
  *
+ * If there is a cache directory, this method reads the image from the
+ * cache when possible. Otherwise, it writes the decoded image to the cache.
+ *
  * @param source    The pathname to the asset
  *
  * @return the SDL_Surface with the texture information
@@ -96,18 +317,25 @@ SDL_Surface* TextureLoader::preload(const std::string source) {
     std::string root = Application::get()->getAssetDirectory();
     std::string path = root+source;
 
+    if (!_cacheDir.empty()) {
+        SDL_Surface* cached = readCache(source, path);
+        if (cached != nullptr) {
+            _cacheHits++;
+            return cached;
+        }
+        _cacheMisses++;
+    }
+
     SDL_Surface* surface = IMG_Load(path.c_str());
     if (surface == nullptr) {
         return nullptr;
     }
-    
-    SDL_Surface* normal;
-#if CU_MEMORY_ORDER == CU_ORDER_REVERSED
-    normal = SDL_ConvertSurfaceFormat(surface,SDL_PIXELFORMAT_ABGR8888,0);
-#else
-    normal = SDL_ConvertSurfaceFormat(surface,SDL_PIXELFORMAT_RGBA8888,0);
-#endif
+
+    SDL_Surface* normal = SDL_ConvertSurfaceFormat(surface,CACHE_FORMAT,0);
     SDL_FreeSurface(surface);
+    if (!_cacheDir.empty()) {
+        writeCache(source, path, normal);
+    }
     return normal;
 }
 
@@ -129,7 +357,10 @@ SDL_Surface* TextureLoader::preload(const std::string source) {
  * @param callback  An optional callback for asynchronous loading
  */
 void TextureLoader::materialize(const std::string key, SDL_Surface* surface, LoaderCallback callback) {
-    std::shared_ptr<Texture> texture = Texture::allocWithData(surface->pixels, surface->w, surface->h, _mipmaps);
+    std::shared_ptr<Texture> texture = nullptr;
+    if (surface != nullptr) {
+        texture = Texture::allocWithData(surface->pixels, surface->w, surface->h, _mipmaps);
+    }
     
     bool success = false;
     if (texture != nullptr) {
@@ -179,7 +410,10 @@ void TextureLoader::materialize(const std::string key, SDL_Surface* surface, Loa
  * @param callback  An optional callback for asynchronous loading
  */
 void TextureLoader::materialize(const std::shared_ptr<JsonValue>& json, SDL_Surface* surface, LoaderCallback callback) {
-    std::shared_ptr<Texture> texture = Texture::allocWithData(surface->pixels, surface->w, surface->h);
+    std::shared_ptr<Texture> texture = nullptr;
+    if (surface != nullptr) {
+        texture = Texture::allocWithData(surface->pixels, surface->w, surface->h);
+    }
     std::string key = json->key();
 
     bool success = false;
@@ -191,6 +425,7 @@ void TextureLoader::materialize(const std::shared_ptr<JsonValue>& json, SDL_Surf
         bool mipmaps = json->getBool("mipmaps",false);
 
         _assets[key] = texture;
+        texture->setName(json->getString("file",UNKNOWN_SOURCE));
         texture->bind();
         if (mipmaps) { texture->buildMipMaps(); }
         texture->setMinFilter(minflt);
@@ -234,7 +469,15 @@ bool TextureLoader::read(const std::string key, const std::string source, Loader
     }
     
     bool success = false;
-    if (_loader == nullptr || !async) {
+    if ((_loader == nullptr || !async) && !_cacheDir.empty()) {
+        // Go through the cache instead of decoding directly
+        enqueue(key);
+        materialize(key,preload(source),nullptr);
+        success = (_assets.find(key) != _assets.end());
+        if (success) {
+            _assets[key]->setName(source);
+        }
+    } else if (_loader == nullptr || !async) {
         enqueue(key);
         std::shared_ptr<Texture> texture = Texture::allocWithFile(source);
         success = (texture != nullptr);
@@ -243,8 +486,10 @@ bool TextureLoader::read(const std::string key, const std::string source, Loader
 		}
         _queue.erase(key);
     } else {
-        _loader->addTask([=,this](void) {
-            this->enqueue(key);
+        // Decoding is thread-safe, so it can use the decoder pool
+        enqueue(key);
+        std::shared_ptr<ThreadPool> pool = (_decoders == nullptr ? _loader : _decoders);
+        pool->addTask([=,this](void) {
             SDL_Surface* surface = this->preload(source);
             Application::get()->schedule([=,this](void){
                 this->materialize(key,surface,callback);
@@ -304,7 +549,13 @@ bool TextureLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback
     
     std::string source = json->getString("file",UNKNOWN_SOURCE);
     bool success = false;
-    if (_loader == nullptr || !async) {
+    if ((_loader == nullptr || !async) && !_cacheDir.empty()) {
+        // Go through the cache instead of decoding directly (materialize
+        // applies all of the settings)
+        enqueue(key);
+        materialize(json,preload(source),nullptr);
+        return _assets.find(key) != _assets.end();
+    } else if (_loader == nullptr || !async) {
         enqueue(key);
         std::shared_ptr<Texture> texture = Texture::allocWithFile(source);
         success = (texture != nullptr);
@@ -313,8 +564,10 @@ bool TextureLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback
 		}
         _queue.erase(key);
     } else {
-        _loader->addTask([=,this](void) {
-            this->enqueue(key);
+        // Decoding is thread-safe, so it can use the decoder pool
+        enqueue(key);
+        std::shared_ptr<ThreadPool> pool = (_decoders == nullptr ? _loader : _decoders);
+        pool->addTask([=,this](void) {
             SDL_Surface* surface = this->preload(source);
             Application::get()->schedule([=,this](void){
                 this->materialize(json,surface,callback);
@@ -384,6 +637,59 @@ bool TextureLoader::purgeJson(const std::shared_ptr<JsonValue>& json) {
     return success;
 }
 
+/**
+ * Synchronously loads all of the assets in the given JSON category.
+ *
+ * The JSON value should be the child of an asset directory for the
+ * JSON key of this loader. Each child of that value is loaded as
+ * with {@link #load}. The main CUGL thread will block until loading
+ * is complete.
+ *
+ * If there is a decoder pool, the images are decoded in parallel by the
+ * decoder threads (with this thread participating). The OpenGL textures
+ * are then created on this thread, in directory order.
+ *
+ * @param json      The asset directory entries for this loader
+ *
+ * @return true if all of the assets were successfully loaded
+ */
+bool TextureLoader::loadCategory(const std::shared_ptr<JsonValue>& json) {
+    if (_decoders == nullptr || json->size() < 2) {
+        return Loader<Texture>::loadCategory(json);
+    }
+    
+    bool success = true;
+    std::vector<std::shared_ptr<JsonValue>> entries;
+    std::vector<std::string> sources;
+    for(size_t ii = 0; ii < json->size(); ii++) {
+        std::shared_ptr<JsonValue> child = json->get((int)ii);
+        std::string key = child->key();
+        if (_assets.find(key) != _assets.end() || _queue.find(key) != _queue.end()) {
+            success = false;
+        } else {
+            enqueue(key);
+            entries.push_back(child);
+            sources.push_back(child->getString("file",UNKNOWN_SOURCE));
+        }
+    }
+    
+    std::vector<SDL_Surface*> surfaces(entries.size(),nullptr);
+    _decoders->parallelFor(entries.size(), [&](size_t begin, size_t end) {
+        for(size_t ii = begin; ii < end; ii++) {
+            surfaces[ii] = preload(sources[ii]);
+        }
+    });
+    
+    for(size_t ii = 0; ii < entries.size(); ii++) {
+        if (surfaces[ii] == nullptr) {
+            CULogError("Could not load file %s. %s", sources[ii].c_str(), SDL_GetError());
+        }
+        materialize(entries[ii],surfaces[ii],nullptr);
+        success = (_assets.find(entries[ii]->key()) != _assets.end()) && success;
+    }
+    return success;
+}
+
 #pragma mark -
 #pragma mark Atlas Support
 /**
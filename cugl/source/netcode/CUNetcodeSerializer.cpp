@@ -49,11 +49,141 @@
 #include <cugl/core/util/CUHashtools.h>
 
 #include <stdexcept>
-#include <sstream>
+#include <cstring>
 
 using namespace cugl;
 using namespace cugl::netcode;
 
+#pragma mark -
+#pragma mark Encoding Helpers
+/**
+ * Appends a single tagged value to the given buffer
+ *
+ * The value is converted to network order and copied after its type tag
+ * in one step, rather than byte-by-byte.
+ *
+ * @param data  The buffer to append to
+ * @param type  The type tag of the value
+ * @param value The value to append
+ */
+template <typename T>
+static void append_value(std::vector<std::byte>& data, NetcodeType type, T value) {
+    size_t pos = data.size();
+    data.resize(pos+1+sizeof(T));
+    std::byte* dst = data.data()+pos;
+    T swap = (T)marshall(value);
+    dst[0] = static_cast<std::byte>(type);
+    std::memcpy(dst+1, &swap, sizeof(T));
+}
+
+/**
+ * Appends a string (with its tag and length) to the given buffer
+ *
+ * @param data  The buffer to append to
+ * @param chars The characters of the string
+ * @param size  The number of characters
+ */
+static void append_string(std::vector<std::byte>& data, const char* chars, size_t size) {
+    data.push_back(static_cast<std::byte>(StringType));
+    append_value(data, UInt64Type, (Uint64)size);
+    size_t pos = data.size();
+    data.resize(pos+size);
+    std::memcpy(data.data()+pos, chars, size);
+}
+
+/**
+ * Appends an array of tagged values to the given buffer
+ *
+ * The wire format tags every element of an array, so each element takes
+ * sizeof(T)+1 bytes. The buffer is grown once for the entire array, and
+ * the elements are written in a tight loop with no reallocation checks.
+ * This allows the compiler to unroll (and vectorize) the byte swaps.
+ *
+ * @param data      The buffer to append to
+ * @param type      The type tag of the elements
+ * @param values    The elements to append
+ * @param size      The number of elements
+ */
+template <typename T>
+static void append_array(std::vector<std::byte>& data, NetcodeType type,
+                         const T* values, size_t size) {
+    data.push_back(static_cast<std::byte>(ArrayType + type));
+    append_value(data, UInt64Type, (Uint64)size);
+
+    const size_t stride = 1+sizeof(T);
+    size_t pos = data.size();
+    data.resize(pos+size*stride);
+    std::byte* dst = data.data()+pos;
+    const std::byte tag = static_cast<std::byte>(type);
+    for(size_t ii = 0; ii < size; ii++, dst += stride) {
+        T swap = (T)marshall(values[ii]);
+        dst[0] = tag;
+        std::memcpy(dst+1, &swap, sizeof(T));
+    }
+}
+
+/**
+ * Returns a single tagged value read from the given buffer
+ *
+ * The read position is advanced past the value. If the value extends
+ * past the end of the buffer, the position is moved to the end and this
+ * function returns 0.
+ *
+ * @param buffer    The buffer to read from
+ * @param size      The size of the buffer
+ * @param pos       The read position
+ *
+ * @return a single tagged value read from the given buffer
+ */
+template <typename T>
+static T read_value(const std::byte* buffer, size_t size, size_t& pos) {
+    if (pos >= size || size-pos < 1+sizeof(T)) {
+        pos = size;
+        return 0;
+    }
+
+    // Memcopy necessary for possible alignment issues
+    T value;
+    std::memcpy(&value, buffer+pos+1, sizeof(T));
+    pos += 1+sizeof(T);
+    return (T)marshall(value);
+}
+
+/**
+ * Reads an array of tagged values from the given buffer
+ *
+ * The read position should be at the array tag, and is advanced past the
+ * array. The elements are decoded directly, rather than as individual
+ * messages. If the array is truncated, only the complete elements are read.
+ *
+ * @param buffer    The buffer to read from
+ * @param size      The size of the buffer
+ * @param pos       The read position
+ * @param result    The vector to store the elements
+ */
+template <typename T>
+static void read_array(const std::byte* buffer, size_t size, size_t& pos,
+                       std::vector<T>& result) {
+    if (pos >= size) {
+        return;
+    }
+    pos++;
+    Uint64 count = read_value<Uint64>(buffer, size, pos);
+
+    const size_t stride = 1+sizeof(T);
+    if (count > (size-pos)/stride) {
+        count = (size-pos)/stride;
+    }
+    result.resize((size_t)count);
+    const std::byte* src = buffer+pos+1;
+    for(size_t ii = 0; ii < count; ii++, src += stride) {
+        T value;
+        std::memcpy(&value, src, sizeof(T));
+        result[ii] = (T)marshall(value);
+    }
+    pos += (size_t)count*stride;
+}
+
 #pragma mark -
 #pragma mark NetcodeSerializer
 /**
@@ -79,12 +209,7 @@ void NetcodeSerializer::writeBool(bool b) {
  * @param f The value to write
  */
 void NetcodeSerializer::writeFloat(float f) {
-    float ii = marshall(f);
-    const std::byte* bytes = reinterpret_cast<const std::byte*>(&ii);
-    _data.push_back(static_cast<std::byte>(FloatType));
-    for (size_t j = 0; j < sizeof(float); j++) {
-        _data.push_back(bytes[j]);
-    }
+    append_value(_data, FloatType, f);
 }
 
 /**
@@ -97,12 +222,7 @@ void NetcodeSerializer::writeFloat(float f) {
  * @param d The value to write
  */
 void NetcodeSerializer::writeDouble(double d) {
-    double ii = marshall(d);
-    const std::byte* bytes = reinterpret_cast<const std::byte*>(&ii);
-    _data.push_back(static_cast<std::byte>(DoubleType));
-    for (size_t j = 0; j < sizeof(double); j++) {
-        _data.push_back(bytes[j]);
-    }
+    append_value(_data, DoubleType, d);
 }
 
 /**
@@ -115,12 +235,7 @@ void NetcodeSerializer::writeDouble(double d) {
  * @param i The value to write
  */
 void NetcodeSerializer::writeUint32(Uint32 i) {
-    Uint32 ii = marshall(i);
-    const std::byte* bytes = reinterpret_cast<const std::byte*>(&ii);
-    _data.push_back(static_cast<std::byte>(UInt32Type));
-    for (size_t j = 0; j < sizeof(Uint32); j++) {
-        _data.push_back(bytes[j]);
-    }
+    append_value(_data, UInt32Type, i);
 }
 
 /**
@@ -133,12 +248,7 @@ void NetcodeSerializer::writeUint32(Uint32 i) {
  * @param i The value to write
  */
 void NetcodeSerializer::writeUint64(Uint64 i) {
-    Uint64 ii = marshall(i);
-    const std::byte* bytes = reinterpret_cast<const std::byte*>(&ii);
-    _data.push_back(static_cast<std::byte>(UInt64Type));
-    for (size_t j = 0; j < sizeof(Uint64); j++) {
-        _data.push_back(bytes[j]);
-    }
+    append_value(_data, UInt64Type, i);
 }
 
 /**
@@ -151,12 +261,7 @@ void NetcodeSerializer::writeUint64(Uint64 i) {
  * @param i The value to write
  */
 void NetcodeSerializer::writeSint32(Sint32 i) {
-    Sint32 ii = marshall(i);
-    const std::byte* bytes = reinterpret_cast<const std::byte*>(&ii);
-    _data.push_back(static_cast<std::byte>(SInt32Type));
-    for (size_t j = 0; j < sizeof(Sint32); j++) {
-        _data.push_back(bytes[j]);
-    }
+    append_value(_data, SInt32Type, i);
 }
 
 /**
@@ -169,12 +274,7 @@ void NetcodeSerializer::writeSint32(Sint32 i) {
  * @param i The value to write
  */
 void NetcodeSerializer::writeSint64(Sint64 i) {
-    Sint64 ii = marshall(i);
-    const std::byte* bytes = reinterpret_cast<const std::byte*>(&ii);
-    _data.push_back(static_cast<std::byte>(SInt64Type));
-    for (size_t j = 0; j < sizeof(Sint64); j++) {
-        _data.push_back(bytes[j]);
-    }
+    append_value(_data, SInt64Type, i);
 }
 
 /**
@@ -186,12 +286,8 @@ void NetcodeSerializer::writeSint64(Sint64 i) {
  *
  * @param s The value to write
  */
-void NetcodeSerializer::writeString(std::string s) {
-    _data.push_back(static_cast<std::byte>(StringType));
-    writeUint64((Uint64)(s.size()));
-    for (char& c : s) {
-        _data.push_back(static_cast<std::byte>(c));
-    }
+void NetcodeSerializer::writeString(const std::string& s) {
+    append_string(_data, s.data(), s.size());
 }
 /**
  * Writes a single string value.
@@ -206,7 +302,7 @@ void NetcodeSerializer::writeString(std::string s) {
  * @param s The value to write
  */
 void NetcodeSerializer::writeChars(char* s) {
-    writeString(std::string(s));
+    append_string(_data, s, std::strlen(s));
 }
 
 /**
@@ -261,11 +357,13 @@ void NetcodeSerializer::writeJson(const std::shared_ptr<JsonValue>& j) {
  *
  * @param v The vector to write
  */
-void NetcodeSerializer::writeBoolVector(std::vector<bool> v) {
+void NetcodeSerializer::writeBoolVector(const std::vector<bool>& v) {
     _data.push_back(static_cast<std::byte>(ArrayType + BooleanTrue));
-    writeUint64((Uint64)(v.size()));
+    append_value(_data, UInt64Type, (Uint64)(v.size()));
+    size_t pos = _data.size();
+    _data.resize(pos+v.size());
     for (size_t i = 0; i < v.size(); i++) {
-        writeBool(v[i]);
+        _data[pos+i] = static_cast<std::byte>(v[i] ? BooleanTrue : BooleanFalse);
     }
 }
 
@@ -276,14 +374,13 @@ void NetcodeSerializer::writeBoolVector(std::vector<bool> v) {
  * written in. You should pass the result of {@link #serialize} to the
  * {@link NetcodeConnection} to send all values buffered up to this point.
  *
+ * Any contiguous sequence (such as a vector or an array) may be passed
+ * to this method without copying it.
+ *
  * @param v The vector to write
  */
-void NetcodeSerializer::writeFloatVector(std::vector<float> v) {
-    _data.push_back(static_cast<std::byte>(ArrayType + FloatType));
-    writeUint64((Uint64)(v.size()));
-    for (size_t i = 0; i < v.size(); i++) {
-        writeFloat(v[i]);
-    }
+void NetcodeSerializer::writeFloatVector(std::span<const float> v) {
+    append_array(_data, FloatType, v.data(), v.size());
 }
 
 /**
@@ -293,14 +390,13 @@ void NetcodeSerializer::writeFloatVector(std::vector<float> v) {
  * written in. You should pass the result of {@link #serialize} to the
  * {@link NetcodeConnection} to send all values buffered up to this point.
  *
+ * Any contiguous sequence (such as a vector or an array) may be passed
+ * to this method without copying it.
+ *
  * @param v The vector to write
  */
-void NetcodeSerializer::writeDoubleVector(std::vector<double> v) {
-    _data.push_back((std::byte)(ArrayType + DoubleType));
-    writeUint64((Uint64)(v.size()));
-    for (size_t i = 0; i < v.size(); i++) {
-        writeDouble(v[i]);
-    }
+void NetcodeSerializer::writeDoubleVector(std::span<const double> v) {
+    append_array(_data, DoubleType, v.data(), v.size());
 }
 
 /**
@@ -310,14 +406,13 @@ void NetcodeSerializer::writeDoubleVector(std::vector<double> v) {
  * written in. You should pass the result of {@link #serialize} to the
  * {@link NetcodeConnection} to send all values buffered up to this point.
  *
+ * Any contiguous sequence (such as a vector or an array) may be passed
+ * to this method without copying it.
+ *
  * @param v The vector to write
  */
-void NetcodeSerializer::writeUint32Vector(std::vector<Uint32> v) {
-    _data.push_back(static_cast<std::byte>(ArrayType + UInt32Type));
-    writeUint64((Uint64)(v.size()));
-    for (size_t i = 0; i < v.size(); i++) {
-            writeUint32(v[i]);
-    }
+void NetcodeSerializer::writeUint32Vector(std::span<const Uint32> v) {
+    append_array(_data, UInt32Type, v.data(), v.size());
 }
 
 /**
@@ -327,14 +422,13 @@ void NetcodeSerializer::writeUint32Vector(std::vector<Uint32> v) {
  * written in. You should pass the result of {@link #serialize} to the
  * {@link NetcodeConnection} to send all values buffered up to this point.
  *
+ * Any contiguous sequence (such as a vector or an array) may be passed
+ * to this method without copying it.
+ *
  * @param v The vector to write
  */
-void NetcodeSerializer::writeUint64Vector(std::vector<Uint64> v) {
-    _data.push_back(static_cast<std::byte>(ArrayType + UInt64Type));
-    writeUint64((Uint64)(v.size()));
-    for (size_t i = 0; i < v.size(); i++) {
-            writeUint64(v[i]);
-    }
+void NetcodeSerializer::writeUint64Vector(std::span<const Uint64> v) {
+    append_array(_data, UInt64Type, v.data(), v.size());
 }
 
 /**
@@ -344,13 +438,13 @@ void NetcodeSerializer::writeUint64Vector(std::vector<Uint64> v) {
  * written in. You should pass the result of {@link #serialize} to the
  * {@link NetcodeConnection} to send all values buffered up to this point.
  *
+ * Any contiguous sequence (such as a vector or an array) may be passed
+ * to this method without copying it.
+ *
  * @param v The vector to write
- */void NetcodeSerializer::writeSint32Vector(std::vector<Sint32> v) {
-    _data.push_back(static_cast<std::byte>(ArrayType + SInt32Type));
-    writeUint64((Uint64)(v.size()));
-    for (size_t i = 0; i < v.size(); i++) {
-        writeSint32(v[i]);
-    }
+ */
+void NetcodeSerializer::writeSint32Vector(std::span<const Sint32> v) {
+    append_array(_data, SInt32Type, v.data(), v.size());
 }
 
 /**
@@ -360,14 +454,13 @@ void NetcodeSerializer::writeUint64Vector(std::vector<Uint64> v) {
  * written in. You should pass the result of {@link #serialize} to the
  * {@link NetcodeConnection} to send all values buffered up to this point.
  *
+ * Any contiguous sequence (such as a vector or an array) may be passed
+ * to this method without copying it.
+ *
  * @param v The vector to write
  */
-void NetcodeSerializer::writeSint64Vector(std::vector<Sint64> v) {
-    _data.push_back(static_cast<std::byte>(ArrayType + SInt64Type));
-    writeUint64((Uint64)(v.size()));
-    for (size_t i = 0; i < v.size(); i++) {
-        writeSint64(v[i]);
-    }
+void NetcodeSerializer::writeSint64Vector(std::span<const Sint64> v) {
+    append_array(_data, SInt64Type, v.data(), v.size());
 }
 
 /**
@@ -379,11 +472,17 @@ void NetcodeSerializer::writeSint64Vector(std::vector<Sint64> v) {
  *
  * @param v The vector to write
  */
-void NetcodeSerializer::writeStringVector(std::vector<std::string> v) {
+void NetcodeSerializer::writeStringVector(const std::vector<std::string>& v) {
+    size_t total = _data.size()+10;
+    for (size_t i = 0; i < v.size(); i++) {
+        total += v[i].size()+10;
+    }
+    _data.reserve(total);
+
     _data.push_back(static_cast<std::byte>(ArrayType + StringType));
-    writeUint64((Uint64)(v.size()));
+    append_value(_data, UInt64Type, (Uint64)(v.size()));
     for (size_t i = 0; i < v.size(); i++) {
-        writeString(v[i]);
+        append_string(_data, v[i].data(), v[i].size());
     }
 }
 
@@ -399,11 +498,11 @@ void NetcodeSerializer::writeStringVector(std::vector<std::string> v) {
  *
  * @param v The vector to write
  */
-void NetcodeSerializer::writeCharsVector(std::vector<char*> v) {
+void NetcodeSerializer::writeCharsVector(const std::vector<char*>& v) {
     _data.push_back(static_cast<std::byte>(ArrayType + StringType));
-    writeUint64((Uint64)(v.size()));
+    append_value(_data, UInt64Type, (Uint64)(v.size()));
     for (size_t i = 0; i < v.size(); i++) {
-        writeChars(v[i]);
+        append_string(_data, v[i], std::strlen(v[i]));
     }
 }
 
@@ -416,9 +515,9 @@ void NetcodeSerializer::writeCharsVector(std::vector<char*> v) {
  *
  * @param v The vector to write
  */
-void NetcodeSerializer::writeJsonVector(std::vector<std::shared_ptr<JsonValue>> v) {
+void NetcodeSerializer::writeJsonVector(const std::vector<std::shared_ptr<JsonValue>>& v) {
     _data.push_back(static_cast<std::byte>(ArrayType + JsonType));
-    writeUint64((Uint64)(v.size()));
+    append_value(_data, UInt64Type, (Uint64)(v.size()));
     for (size_t i = 0; i < v.size(); i++) {
         writeJson(v[i]);
     }
@@ -470,6 +569,8 @@ const std::string NetcodeSerializer::serialize64() {
 
 /**
  * Clears the input buffer.
+ *
+ * The memory of the buffer is retained for the next message.
  */
 void NetcodeSerializer::reset() {
 	_data.clear();
@@ -497,8 +598,44 @@ void NetcodeSerializer::reset() {
  * @param msg The byte vector serialized by {@link NetcodeSerializer}
  */
 void NetcodeDeserializer::receive(const std::vector<std::byte>& msg) {
-	_data = msg;
-	_pos = 0;
+    _data.assign(msg.begin(), msg.end());
+    _buffer = _data.data();
+    _size = _data.size();
+    _pos = 0;
+}
+
+/**
+ * Loads a new message to be read, taking ownership of it.
+ *
+ * This method is identical to {@link #receive}, except that the message
+ * is moved into this deserializer instead of copied.
+ *
+ * @param msg The byte vector serialized by {@link NetcodeSerializer}
+ */
+void NetcodeDeserializer::receive(std::vector<std::byte>&& msg) {
+    _data = std::move(msg);
+    _buffer = _data.data();
+    _size = _data.size();
+    _pos = 0;
+}
+
+/**
+ * Loads a new message to be read in place.
+ *
+ * This method is identical to {@link #receive}, except that the message
+ * is not copied. Values are read directly from the given buffer, which
+ * is owned by the caller. The buffer must remain valid (and unchanged)
+ * until the next message is loaded or this deserializer is reset. This
+ * is typically the case for the message in a {@link NetcodeConnection}
+ * callback, provided all values are read within the callback.
+ *
+ * @param msg The bytes serialized by {@link NetcodeSerializer}
+ */
+void NetcodeDeserializer::receiveView(std::span<const std::byte> msg) {
+    _data.clear();
+    _buffer = msg.data();
+    _size = msg.size();
+    _pos = 0;
 }
 
 /**
@@ -522,7 +659,11 @@ void NetcodeDeserializer::receive(const std::vector<std::byte>& msg) {
  * @param msg The byte vector serialized by {@link NetcodeSerializer}
  */
 void NetcodeDeserializer::receive64(const std::string msg) {
-    _data = hashtool::b64_decode(msg);
+    // Decode in place to reuse the capacity of the previous message
+    _data.resize(hashtool::b64_decode_size(msg.size()));
+    _data.resize(hashtool::b64_decode(msg.data(), msg.size(), _data.data()));
+    _buffer = _data.data();
+    _size = _data.size();
     _pos = 0;
 }
 
@@ -543,11 +684,11 @@ void NetcodeDeserializer::receive64(const std::string msg) {
  * the other read methods).
  */
 NetcodeDeserializer::Message NetcodeDeserializer::read() {
-	if (_pos >= _data.size()) {
+	if (_pos >= _size) {
 		return {};
 	}
 
-    uint8_t value = static_cast<uint8_t>(_data[_pos]);
+    uint8_t value = static_cast<uint8_t>(_buffer[_pos]);
     switch (value) {
 	case NoneType:
 		_pos++;
@@ -606,11 +747,11 @@ NetcodeDeserializer::Message NetcodeDeserializer::read() {
  * @return the type of the next data value to be read.
  */
 NetcodeType NetcodeDeserializer::nextType() const {
-    if (_pos >= _data.size()) {
+    if (_pos >= _size) {
         return InvalidType;
     }
     
-    uint8_t value = static_cast<uint8_t>(_data[_pos]);
+    uint8_t value = static_cast<uint8_t>(_buffer[_pos]);
     switch (value) {
     case NoneType:
     case BooleanTrue:
@@ -651,10 +792,10 @@ NetcodeType NetcodeDeserializer::nextType() const {
  * @return a single boolean value.
  */
 bool NetcodeDeserializer::readBool() {
-    if (_pos >= _data.size()) {
+    if (_pos >= _size) {
         return false;
     }
-    uint8_t value = static_cast<uint8_t>(_data[_pos++]);
+    uint8_t value = static_cast<uint8_t>(_buffer[_pos++]);
     return value == BooleanTrue;
 }
 
@@ -670,16 +811,7 @@ bool NetcodeDeserializer::readBool() {
  * @return a single float value.
  */
 float NetcodeDeserializer::readFloat() {
-    if (_pos >= _data.size()) {
-        return 0.0f;
-    }
-    _pos++;
-    
-    // Memcopy necessary for possible alignment issues
-    float value;
-    std::memcpy(&value, _data.data() + _pos, sizeof(float));
-    _pos += sizeof(float);
-    return marshall(value);
+    return read_value<float>(_buffer, _size, _pos);
 }
 
 /**
@@ -694,16 +826,7 @@ float NetcodeDeserializer::readFloat() {
  * @return a single double value.
  */
 double NetcodeDeserializer::readDouble() {
-    if (_pos >= _data.size()) {
-        return 0.0;
-    }
-    _pos++;
-    
-    // Memcopy necessary for possible alignment issues
-    double value;
-    std::memcpy(&value, _data.data() + _pos, sizeof(double));
-    _pos += sizeof(double);
-    return marshall(value);
+    return read_value<double>(_buffer, _size, _pos);
 }
 
 /**
@@ -718,16 +841,7 @@ double NetcodeDeserializer::readDouble() {
  * @return a single unsigned (32 bit) int value.
  */
 Uint32 NetcodeDeserializer::readUint32() {
-    if (_pos >= _data.size()) {
-        return 0;
-    }
-    _pos++;
-    
-    // Memcopy necessary for possible alignment issues
-    Uint32 value;
-    std::memcpy(&value, _data.data() + _pos, sizeof(Uint32));
-    _pos += sizeof(Uint32);
-    return marshall(value);
+    return read_value<Uint32>(_buffer, _size, _pos);
 }
 
 /**
@@ -742,16 +856,7 @@ Uint32 NetcodeDeserializer::readUint32() {
  * @return a single signed (32 bit) int value.
  */
 Sint32 NetcodeDeserializer::readSint32() {
-    if (_pos >= _data.size()) {
-        return 0;
-    }
-    _pos++;
-    
-    // Memcopy necessary for possible alignment issues
-    Sint32 value;
-    std::memcpy(&value, _data.data() + _pos, sizeof(Sint32));
-    _pos += sizeof(Sint32);
-    return marshall(value);
+    return read_value<Sint32>(_buffer, _size, _pos);
 }
 
 /**
@@ -765,16 +870,7 @@ Sint32 NetcodeDeserializer::readSint32() {
  *
  * @return a single unsigned (64 bit) int value.
  */Uint64 NetcodeDeserializer::readUint64() {
-    if (_pos >= _data.size()) {
-        return 0;
-    }
-    _pos++;
-    
-    // Memcopy necessary for possible alignment issues
-    Uint64 value;
-    std::memcpy(&value, _data.data() + _pos, sizeof(Uint64));
-    _pos += sizeof(Uint64);
-    return marshall(value);
+    return read_value<Uint64>(_buffer, _size, _pos);
 }
 
 /**
@@ -789,16 +885,7 @@ Sint32 NetcodeDeserializer::readSint32() {
  * @return a single signed (64 bit) int value.
  */
 Sint64 NetcodeDeserializer::readSint64() {
-    if (_pos >= _data.size()) {
-        return 0;
-    }
-    _pos++;
-    
-    // Memcopy necessary for possible alignment issues
-    Sint64 value;
-    std::memcpy(&value, _data.data() + _pos, sizeof(Sint64));
-    _pos += sizeof(Sint64);
-    return marshall(value);
+    return read_value<Sint64>(_buffer, _size, _pos);
 }
 
 /**
@@ -813,16 +900,17 @@ Sint64 NetcodeDeserializer::readSint64() {
  * @return a single string.
  */
 std::string NetcodeDeserializer::readString() {
-    if (_pos >= _data.size()) {
+    if (_pos >= _size) {
         return std::string();
     }
     _pos++;
-    Uint64 size = std::get<Uint64>(read());
-    std::ostringstream disp;
-    for (size_t i = 0; i < size; i++, _pos++) {
-        disp << static_cast<char>(_data[_pos]);
+    Uint64 size = read_value<Uint64>(_buffer, _size, _pos);
+    if (size > _size-_pos) {
+        size = _size-_pos;
     }
-    return disp.str();
+    std::string result(reinterpret_cast<const char*>(_buffer+_pos), (size_t)size);
+    _pos += (size_t)size;
+    return result;
 }
 
 /**
@@ -837,11 +925,11 @@ std::string NetcodeDeserializer::readString() {
  * @return a single {@link JsonValue} object.
  */
 std::shared_ptr<JsonValue> NetcodeDeserializer::readJson() {
-    if (_pos >= _data.size()) {
+    if (_pos >= _size) {
         return nullptr;
     }
     _pos++;
-    uint8_t value = static_cast<uint8_t>(_data[_pos]);
+    uint8_t value = static_cast<uint8_t>(_buffer[_pos]);
     switch (value) {
     case NoneType:
         _pos++;
@@ -892,12 +980,19 @@ std::shared_ptr<JsonValue> NetcodeDeserializer::readJson() {
  *
  * @return a vector of boolean values.
  */
-std::vector<bool> NetcodeDeserializer::readBoolVector()  {
-    _pos++;
-    Uint64 size = std::get<Uint64>(read());
+std::vector<bool> NetcodeDeserializer::readBoolVector() {
     std::vector<bool> vv;
-    for (size_t i = 0; i < size; i++) {
-        vv.push_back(std::get<bool>(read()));
+    if (_pos >= _size) {
+        return vv;
+    }
+    _pos++;
+    Uint64 size = read_value<Uint64>(_buffer, _size, _pos);
+    if (size > _size-_pos) {
+        size = _size-_pos;
+    }
+    vv.resize((size_t)size);
+    for (size_t i = 0; i < size; i++, _pos++) {
+        vv[i] = (static_cast<uint8_t>(_buffer[_pos]) == BooleanTrue);
     }
     return vv;
 }
@@ -916,14 +1011,7 @@ std::vector<bool> NetcodeDeserializer::readBoolVector()  {
  */
 std::vector<float> NetcodeDeserializer::readFloatVector() {
     std::vector<float> vv;
-    if (_pos >= _data.size()) {
-        return vv;
-    }
-    _pos++;
-    Uint64 size = std::get<Uint64>(read());
-    for (size_t i = 0; i < size; i++) {
-        vv.push_back(std::get<float>(read()));
-    }
+    read_array(_buffer, _size, _pos, vv);
     return vv;
 }
 
@@ -939,16 +1027,9 @@ std::vector<float> NetcodeDeserializer::readFloatVector() {
  *
  * @return a vector of double values.
  */
-std::vector<double> NetcodeDeserializer::readDoubleVector()     {
+std::vector<double> NetcodeDeserializer::readDoubleVector() {
     std::vector<double> vv;
-    if (_pos >= _data.size()) {
-        return vv;
-    }
-    _pos++;
-    Uint64 size = std::get<Uint64>(read());
-    for (size_t i = 0; i < size; i++) {
-        vv.push_back(std::get<double>(read()));
-    }
+    read_array(_buffer, _size, _pos, vv);
     return vv;
 }
 
@@ -966,14 +1047,7 @@ std::vector<double> NetcodeDeserializer::readDoubleVector()     {
  */
 std::vector<Uint32> NetcodeDeserializer::readUint32Vector() {
     std::vector<Uint32> vv;
-    if (_pos >= _data.size()) {
-        return vv;
-    }
-    _pos++;
-    Uint64 size = std::get<Uint64>(read());
-    for (size_t i = 0; i < size; i++) {
-        vv.push_back(std::get<Uint32>(read()));
-    }
+    read_array(_buffer, _size, _pos, vv);
     return vv;
 }
 
@@ -989,16 +1063,9 @@ std::vector<Uint32> NetcodeDeserializer::readUint32Vector() {
  *
  * @return a vector of signed (32 bit) int values.
  */
-std::vector<Sint32> NetcodeDeserializer::readSint32Vector()  {
+std::vector<Sint32> NetcodeDeserializer::readSint32Vector() {
     std::vector<Sint32> vv;
-    if (_pos >= _data.size()) {
-        return vv;
-    }
-    _pos++;
-    Uint64 size = std::get<Uint64>(read());
-    for (size_t i = 0; i < size; i++) {
-        vv.push_back(std::get<Sint32>(read()));
-    }
+    read_array(_buffer, _size, _pos, vv);
     return vv;
 }
 
@@ -1016,14 +1083,7 @@ std::vector<Sint32> NetcodeDeserializer::readSint32Vector()  {
  */
 std::vector<Uint64> NetcodeDeserializer::readUint64Vector() {
     std::vector<Uint64> vv;
-    if (_pos >= _data.size()) {
-        return vv;
-    }
-    _pos++;
-    Uint64 size = std::get<Uint64>(read());
-    for (size_t i = 0; i < size; i++) {
-        vv.push_back(std::get<Uint64>(read()));
-    }
+    read_array(_buffer, _size, _pos, vv);
     return vv;
 }
 
@@ -1041,14 +1101,7 @@ std::vector<Uint64> NetcodeDeserializer::readUint64Vector() {
  */
 std::vector<Sint64> NetcodeDeserializer::readSint64Vector() {
     std::vector<Sint64> vv;
-    if (_pos >= _data.size()) {
-        return vv;
-    }
-    _pos++;
-    Uint64 size = std::get<Uint64>(read());
-    for (size_t i = 0; i < size; i++) {
-        vv.push_back(std::get<Sint64>(read()));
-    }
+    read_array(_buffer, _size, _pos, vv);
     return vv;
 }
 
@@ -1066,13 +1119,15 @@ std::vector<Sint64> NetcodeDeserializer::readSint64Vector() {
  */
 std::vector<std::string> NetcodeDeserializer::readStringVector() {
     std::vector<std::string> vv;
-    if (_pos >= _data.size()) {
+    if (_pos >= _size) {
         return vv;
     }
     _pos++;
-    Uint64 size = std::get<Uint64>(read());
-    for (size_t i = 0; i < size; i++) {
-        vv.push_back(std::get<std::string>(read()));
+    Uint64 size = read_value<Uint64>(_buffer, _size, _pos);
+    vv.reserve((size_t)std::min<Uint64>(size, _size-_pos));
+    // The count is untrusted, so stop at the end of the data or a non-string
+    for(size_t i = 0; i < size && nextType() == StringType; i++) {
+        vv.push_back(readString());
     }
     return vv;
 }
@@ -1091,7 +1146,7 @@ std::vector<std::string> NetcodeDeserializer::readStringVector() {
  */
 std::vector<std::shared_ptr<JsonValue>> NetcodeDeserializer::readJsonVector() {
     std::vector<std::shared_ptr<JsonValue>> vv;
-    if (_pos >= _data.size()) {
+    if (_pos >= _size) {
         return vv;
     }
     _pos++;
@@ -1106,6 +1161,8 @@ std::vector<std::shared_ptr<JsonValue>> NetcodeDeserializer::readJsonVector() {
  * Clears the buffer and ignore any remaining data in it.
  */
 void NetcodeDeserializer::reset() {
-	_pos = 0;
-	_data.clear();
+    _pos = 0;
+    _size = 0;
+    _buffer = nullptr;
+    _data.clear();
 }
@@ -497,6 +497,7 @@ void Button::setColor(Color4 color) {
     if (!_down || _downnode) {
         _tintColor = color;
     }
+    markChanged();
 }
 
 /**
@@ -0,0 +1,337 @@
+//
+//  CUCachedNode.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a scene graph node that caches the rendering of its
+//  children in a texture. It is designed for static scenery, like terrain
+//  and buildings, that is made of many nodes but seldom changes. Instead of
+//  traversing, transforming and submitting every node each frame, the
+//  subtree is drawn to a render target once. Afterwards the subtree is a
+//  single textured quad, no matter how complex it is.
+//
+//  The cache is invalidated automatically whenever a descendant changes (see
+//  SceneNode#markChanged), and is rebuilt the next time the node is drawn.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+//
+#include <cugl/scene2/CUCachedNode.h>
+#include <cugl/graphics/CUStencilEffect.h>
+#include <cugl/graphics/CUScissor.h>
+#include <cugl/core/assets/CUJsonValue.h>
+#include <cugl/core/CUDisplay.h>
+#include <cmath>
+
+using namespace cugl;
+using namespace cugl::scene2;
+using namespace cugl::graphics;
+
+/** Whether any cache is currently being built (nested caches are part of it) */
+static bool baking = false;
+
+#pragma mark Constructors
+/**
+ * Creates an uninitialized cached node.
+ *
+ * You must initialize this CachedNode before use.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a CachedNode
+ * on the heap, use one of the static constructors instead.
+ */
+CachedNode::CachedNode() :
+_target(nullptr),
+_caching(true),
+_stale(true),
+_density(1.0f),
+_bakeTotal(0) {
+    _classname = "CachedNode";
+    Display* display = Display::get();
+    if (display != nullptr) {
+        _density = display->getPixelDensity();
+    }
+}
+
+/**
+ * Disposes all of the resources used by this node.
+ *
+ * A disposed CachedNode can be safely reinitialized. Any children owned by
+ * this node will be released. They will be deleted if no other object owns
+ * them.
+ *
+ * It is unsafe to call this on a CachedNode that is still currently inside
+ * of a scene graph.
+ */
+void CachedNode::dispose() {
+    _target = nullptr;
+    _caching = true;
+    _stale = true;
+    _bakeTotal = 0;
+    SceneNode::dispose();
+}
+
+/**
+ * Initializes a node with the given JSON specificaton.
+ *
+ * This initializer is designed to receive the "data" object from the
+ * JSON passed to {@link Scene2Loader}. This JSON format supports all
+ * of the attribute values of its parent class. In addition, it supports
+ * the following additional attributes:
+ *
+ *      "caching":  A boolean indicating whether to cache the children
+ *      "density":  The number of texture pixels per unit of content size
+ *
+ * All attributes are optional. There are no required attributes. By
+ * default, caching is enabled and the density is the pixel density of
+ * the display.
+ *
+ * @param manager   The asset manager handling this asset
+ * @param data      The JSON object specifying the node
+ *
+ * @return true if initialization was successful.
+ */
+bool CachedNode::initWithData(const AssetManager* manager,
+                              const std::shared_ptr<JsonValue>& data) {
+    if (SceneNode::initWithData(manager, data)) {
+        _caching = data->getBool("caching", true);
+        if (data->has("density")) {
+            setDensity(data->getFloat("density", _density));
+        }
+        return true;
+    }
+    return false;
+}
+
+#pragma mark -
+#pragma mark Attributes
+/**
+ * Sets whether this node caches its children.
+ *
+ * If this value is false, this node renders like a normal {@link SceneNode}.
+ * Disabling the cache releases the render target. The default value is
+ * true.
+ *
+ * @param value Whether this node caches its children.
+ */
+void CachedNode::setCaching(bool value) {
+    _caching = value;
+    _stale = true;
+    if (!value) {
+        _target = nullptr;
+    }
+}
+
+/**
+ * Sets the number of texture pixels per unit of content size.
+ *
+ * This value determines the resolution of the cache. If this node is
+ * scaled up (either directly or by the camera), the density should be
+ * increased to prevent blurring. The default value is the pixel density
+ * of the display.
+ *
+ * @param density   The number of texture pixels per unit of content size.
+ */
+void CachedNode::setDensity(float density) {
+    CUAssertLog(density > 0, "Pixel density %f is not positive", density);
+    _density = density;
+    _stale = true;
+}
+
+/**
+ * Sets the untransformed size of the node.
+ *
+ * The content size remains the same no matter how the node is scaled or
+ * rotated. All nodes must have a size, though it may be degenerate (0,0).
+ *
+ * As only the content bounds are cached, this will invalidate the cache.
+ *
+ * @param size  The untransformed size of the node.
+ */
+void CachedNode::setContentSize(const Size size) {
+    SceneNode::setContentSize(size);
+    _stale = true;
+}
+
+#pragma mark -
+#pragma mark Rendering
+/**
+ * Draws this node and all of its children with the given SpriteBatch.
+ *
+ * If caching is enabled, this draws the cached texture of the children,
+ * rebuilding the cache first if it is out of date. The cache is rebuilt
+ * within the current pass of the sprite batch. The framebuffer that is
+ * active when this method is called (the screen or another render target)
+ * is restored afterwards, as are the perspective, blending, scissor,
+ * stencil and blur state of the sprite batch and its counters.
+ *
+ * @param batch     The SpriteBatch to draw with.
+ * @param transform The global transformation matrix.
+ * @param tint      The tint to blend with the Node color.
+ */
+void CachedNode::render(const std::shared_ptr<SpriteBatch>& batch,
+                        const Affine2& transform, Color4 tint) {
+    if (!_isVisible) { return; }
+
+    // A cache inside of another cache is part of that cache
+    if (!_caching || baking) {
+        SceneNode::render(batch, transform, tint);
+        return;
+    }
+
+    if ((_stale || _target == nullptr) && !bake(batch)) {
+        SceneNode::render(batch, transform, tint);
+        return;
+    }
+
+    Affine2 matrix;
+    Affine2::multiply(_combined,transform,&matrix);
+    Color4 color = _tintColor;
+    if (_hasParentColor) {
+        color *= tint;
+    }
+
+    std::shared_ptr<Scissor> active = batch->getScissor();
+    if (_scissor) {
+        std::shared_ptr<Scissor> local = Scissor::alloc(_scissor);
+        local->multiply(matrix);
+        if (active) {
+            local->intersect(active);
+        }
+        batch->setScissor(local);
+    }
+
+    // The cache is premultiplied
+    GLenum srcRGB = batch->getSrcBlendRGB();
+    GLenum srcAlpha = batch->getSrcBlendAlpha();
+    batch->setSrcBlendFunc(GL_ONE, GL_ONE);
+    batch->draw(_target->getTexture(), color.getPremultiplied(),
+                Rect(Vec2::ZERO,getContentSize()), Vec2::ZERO, matrix);
+    batch->setSrcBlendFunc(srcRGB, srcAlpha);
+
+    if (_scissor) {
+        batch->setScissor(active);
+    }
+}
+
+/**
+ * Renders the children of this node to the cache render target.
+ *
+ * The sprite batch must be actively drawing. It will be actively drawing
+ * with the same state when this method returns. The pass is not ended, so
+ * the counters of the sprite batch are preserved. The framebuffer that was
+ * bound when this method is called is bound again when it returns.
+ *
+ * @param batch     The SpriteBatch to draw with.
+ *
+ * @return true if the children were successfully cached
+ */
+bool CachedNode::bake(const std::shared_ptr<SpriteBatch>& batch) {
+    Size size = getContentSize();
+    int width  = (int)std::ceil(size.width*_density);
+    int height = (int)std::ceil(size.height*_density);
+    if (width <= 0 || height <= 0) {
+        _target = nullptr;
+        return false;
+    }
+
+    if (_target == nullptr || _target->getWidth() != width || _target->getHeight() != height) {
+        _target = RenderTarget::alloc(width, height);
+        if (_target == nullptr) {
+            return false;
+        }
+        _target->setClearColor(Color4::CLEAR);
+    }
+
+    // Draw everything so far to the current framebuffer
+    batch->flush();
+    GLint framebuffer  = 0;
+    GLint renderbuffer = 0;
+    GLint viewport[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+    glGetIntegerv(GL_RENDERBUFFER_BINDING, &renderbuffer);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    // Capture the sprite batch state
+    Mat4 perspective = batch->getPerspective();
+    std::shared_ptr<Scissor> scissor = batch->getScissor();
+    GLenum srcRGB   = batch->getSrcBlendRGB();
+    GLenum srcAlpha = batch->getSrcBlendAlpha();
+    GLenum dstRGB   = batch->getDstBlendRGB();
+    GLenum dstAlpha = batch->getDstBlendAlpha();
+    GLenum equation = batch->getBlendEquation();
+    StencilEffect stencil = batch->getStencilEffect();
+    GLfloat blur = batch->getBlur();
+
+    // The render target clear must not be masked by a stencil effect
+    stencil::applyEffect(StencilEffect::NONE, batch->getShader());
+    glStencilMask(0xff);
+
+    // Flip the y axis for texture write
+    Mat4 matrix;
+    Mat4::createOrthographicOffCenter(0, size.width, 0, size.height, -1, 1, &matrix);
+    matrix.scale(1, -1, 1);
+
+    baking = true;
+    _target->begin();
+    batch->setPerspective(matrix);
+    batch->setScissor(nullptr);
+    batch->setStencilEffect(StencilEffect::NONE);
+    batch->setBlur(0);
+    // Accumulate premultiplied color into the transparent target
+    batch->setSrcBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    batch->setDstBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    batch->setBlendEquation(GL_FUNC_ADD);
+    for(auto it = _children.begin(); it != _children.end(); ++it) {
+        (*it)->render(batch, Affine2::IDENTITY, Color4::WHITE);
+    }
+    batch->flush();
+    _target->end();
+    baking = false;
+
+    // Restore the original framebuffer (which may not be the screen)
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+    // Restore the sprite batch state
+    batch->setPerspective(perspective);
+    batch->setSrcBlendFunc(srcRGB, srcAlpha);
+    batch->setDstBlendFunc(dstRGB, dstAlpha);
+    batch->setBlendEquation(equation);
+    batch->setScissor(scissor);
+    batch->setStencilEffect(stencil);
+    batch->setBlur(blur);
+
+    _stale = false;
+    _bakeTotal++;
+    return true;
+}
@@ -1072,6 +1072,7 @@ void Label::generateRenderData() {
 void Label::clearRenderData() {
     _glyphrun.clear();
     _rendered = false;
+    markChanged();
 }
 
 /**
@@ -363,6 +363,7 @@ void NinePatch::clearRenderData() {
     _mesh.clear();
     _indices.clear();
     _rendered = false;
+    markChanged();
 }
 
 /**
@@ -99,39 +99,7 @@ OrderedNode::Context::~Context() {
  * @return the value *a < *b
  */
 bool OrderedNode::Context::sortCompare(Context* a, Context* b) {
-    // NOTE: Pre or post is determined by canonical order
-    switch (a->parent->_order) {
-        case Order::PRE_ORDER:
-        case Order::POST_ORDER:
-            return a->canonical < b->canonical;
-        case Order::ASCEND:
-            if (a->node->getPriority() == b->node->getPriority()) {
-                return a->canonical < b->canonical;
-            }
-            return a->node->getPriority() < b->node->getPriority();
-        case Order::PRE_ASCEND:
-        case Order::POST_ASCEND:
-            if (a->node->getParent() != b->node->getParent()) {
-                return a->canonical < b->canonical;
-            } else if (a->node->getPriority() == b->node->getPriority()) {
-                return a->canonical < b->canonical;
-            }
-            return a->node->getPriority() < b->node->getPriority();
-        case Order::DESCEND:
-            if (a->node->getPriority() == b->node->getPriority()) {
-                return a->canonical < b->canonical;
-            }
-            return a->node->getPriority() > b->node->getPriority();
-        case Order::PRE_DESCEND:
-        case Order::POST_DESCEND:
-            if (a->node->getParent() != b->node->getParent()) {
-                return a->canonical < b->canonical;
-            } else if (a->node->getPriority() == b->node->getPriority()) {
-                return a->canonical < b->canonical;
-            }
-            return a->node->getPriority() > b->node->getPriority();
-    }
-    return false;
+    return a->parent->precedes(a->node.get(), a->canonical, b->node.get(), b->canonical);
 }
 
 #pragma mark -
@@ -313,8 +281,8 @@ void OrderedNode::visit(const std::shared_ptr<SceneNode>& node, const Affine2& t
     }
     
     // Identify pre or post. Block at child ordered nodes
-    bool ispost = (_order == Order::POST_ORDER || _order == Order::POST_ASCEND || _order == Order::POST_DESCEND);
-    bool barrier = node->getClassName() == getClassName();
+    bool ispost = isPostOrder();
+    bool barrier = node->getClassName() == getClassName() || !node->isFlattenable();
     if (ispost && !barrier) {
         auto children = node->getChildren();
         for(auto it = children.begin(); it != children.end(); ++it) {
@@ -343,6 +311,58 @@ void OrderedNode::visit(const std::shared_ptr<SceneNode>& node, const Affine2& t
     _viewport = previous;
 }
 
+/**
+ * Returns true if node a should be drawn before node b.
+ *
+ * This method implements the render order of this node. The canonical
+ * positions are the positions of each node in a pre-order traversal
+ * (or a post-order traversal if {@link #isPostOrder} is true). They are
+ * used to break ties between nodes of the same priority.
+ *
+ * @param a         The first node to compare
+ * @param acanon    The canonical position of the first node
+ * @param b         The second node to compare
+ * @param bcanon    The canonical position of the second node
+ *
+ * @return true if node a should be drawn before node b.
+ */
+bool OrderedNode::precedes(const SceneNode* a, Uint32 acanon,
+                           const SceneNode* b, Uint32 bcanon) const {
+    // NOTE: Pre or post is determined by canonical order
+    switch (_order) {
+        case Order::PRE_ORDER:
+        case Order::POST_ORDER:
+            return acanon < bcanon;
+        case Order::ASCEND:
+            if (a->getPriority() == b->getPriority()) {
+                return acanon < bcanon;
+            }
+            return a->getPriority() < b->getPriority();
+        case Order::PRE_ASCEND:
+        case Order::POST_ASCEND:
+            if (a->getParent() != b->getParent()) {
+                return acanon < bcanon;
+            } else if (a->getPriority() == b->getPriority()) {
+                return acanon < bcanon;
+            }
+            return a->getPriority() < b->getPriority();
+        case Order::DESCEND:
+            if (a->getPriority() == b->getPriority()) {
+                return acanon < bcanon;
+            }
+            return a->getPriority() > b->getPriority();
+        case Order::PRE_DESCEND:
+        case Order::POST_DESCEND:
+            if (a->getParent() != b->getParent()) {
+                return acanon < bcanon;
+            } else if (a->getPriority() == b->getPriority()) {
+                return acanon < bcanon;
+            }
+            return a->getPriority() > b->getPriority();
+    }
+    return false;
+}
+
 /**
  * Draws this node and all of its children with the given SpriteBatch.
  *
@@ -392,8 +412,8 @@ void OrderedNode::render(const std::shared_ptr<SpriteBatch>& batch, const Affine
         for(auto it = _entries.begin(); it != _entries.end(); ++it) {
             Context* context = *it;
             batch->setScissor(context->scissor); // This is in render, so must be applied
-            if (context->node->getClassName() == getClassName()) {
-                // Render barrier at an ordered node
+            if (context->node->getClassName() == getClassName() || !context->node->isFlattenable()) {
+                // Render barrier at an ordered node (or custom render)
                 context->node->render(batch, context->transform, context->tint);
             } else {
                 context->node->draw(batch, context->transform, context->tint);
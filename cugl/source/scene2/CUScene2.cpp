@@ -40,12 +40,18 @@
 //  Version: 7/3/24 (CUGL 3.0 reorganization)
 //
 #include <cugl/scene2/CUScene2.h>
+#include <cugl/scene2/CUOrderedNode.h>
+#include <cugl/graphics/CUScissor.h>
 #include <cugl/core/util/CUStringTools.h>
 #include <sstream>
 #include <algorithm>
 
 using namespace cugl;
 using namespace cugl::scene2;
+using namespace cugl::graphics;
+
+/** The minimum number of nodes for each thread when computing transforms */
+#define TRANSFORM_GRAIN 256
 
 /**
  * Creates a new degenerate Scene on the stack.
@@ -59,7 +65,9 @@ Scene2::Scene2() : Scene(),
 _color(Color4::WHITE),
 _blendEquation(GL_FUNC_ADD),
 _srcFactor(GL_SRC_ALPHA),
-_dstFactor(GL_ONE_MINUS_SRC_ALPHA)
+_dstFactor(GL_ONE_MINUS_SRC_ALPHA),
+_culling(false),
+_culledTotal(0)
 {}
 
 /**
@@ -72,6 +80,9 @@ void Scene2::dispose() {
     Scene::dispose();
     removeAllChildren();
     _color = Color4::WHITE;
+    _entries.clear();
+    _workers = nullptr;
+    _culling = false;
 }
 
 
@@ -371,9 +382,266 @@ void Scene2::render() {
     _batch->setDstBlendFunc(_dstFactor);
     _batch->setBlendEquation(_blendEquation);
 
+    renderChildren();
+
+    _batch->end();
+}
+
+/**
+ * Draws all of the children of this scene with the active sprite batch.
+ *
+ * This method assumes that the sprite batch is actively drawing. It uses
+ * the two-phase renderer if either culling or a thread pool is active.
+ * Otherwise it calls {@link SceneNode#render} on each child.
+ */
+void Scene2::renderChildren() {
+    _culledTotal = 0;
+    if (!_culling && _workers == nullptr) {
+        for(auto it = _children.begin(); it != _children.end(); ++it) {
+            (*it)->render(_batch, Affine2::IDENTITY, _color);
+        }
+        return;
+    }
+    
+    // Phase one: flatten the scene graph
+    _entries.clear();
+    Uint32 counter = 0;
     for(auto it = _children.begin(); it != _children.end(); ++it) {
-        (*it)->render(_batch, Affine2::IDENTITY, _color);
+        flatten(it->get(), -1, 0, counter);
+    }
+    if (_entries.empty()) {
+        return;
+    }
+    
+    // Group the entries by depth
+    Uint32 depths = 0;
+    for(auto it = _entries.begin(); it != _entries.end(); ++it) {
+        depths = std::max(depths,it->depth+1);
+    }
+    _levelStart.assign(depths+1, 0);
+    for(auto it = _entries.begin(); it != _entries.end(); ++it) {
+        _levelStart[it->depth+1]++;
+    }
+    for(Uint32 ii = 1; ii <= depths; ii++) {
+        _levelStart[ii] += _levelStart[ii-1];
+    }
+    std::vector<Uint32> fill(_levelStart.begin(),_levelStart.end()-1);
+    _levels.resize(_entries.size());
+    for(Uint32 ii = 0; ii < _entries.size(); ii++) {
+        _levels[fill[_entries[ii].depth]++] = ii;
+    }
+    
+    // Compute transforms, one depth at a time
+    _viewport = _camera->getInverseProjectView().transform(Rect(-1,-1,2,2));
+    if (_workers == nullptr) {
+        computeRange(0, _levels.size());
+    } else {
+        for(Uint32 ii = 0; ii < depths; ii++) {
+            size_t start = _levelStart[ii];
+            _workers->parallelFor(_levelStart[ii+1]-start, [&](size_t begin, size_t end) {
+                computeRange(start+begin,start+end);
+            }, TRANSFORM_GRAIN);
+        }
+    }
+    
+    // Scissors are allocated, so compute them on this thread
+    std::shared_ptr<Scissor> initial = _batch->getScissor();
+    for(auto it = _entries.begin(); it != _entries.end(); ++it) {
+        std::shared_ptr<Scissor> parent = it->parent < 0 ? initial : _entries[it->parent].scissor;
+        if (!it->opaque && it->node->getScissor()) {
+            std::shared_ptr<Scissor> local = Scissor::alloc(it->node->getScissor());
+            local->multiply(it->transform);
+            if (parent) {
+                local->intersect(parent);
+            }
+            it->scissor = local;
+        } else {
+            it->scissor = parent;
+        }
+        if (it->culled) {
+            _culledTotal++;
+        }
+    }
+    
+    // Phase two: submit to the sprite batch
+    _activeScissor = initial;
+    submitRange(0, (Uint32)_entries.size());
+    if (_activeScissor != initial) {
+        _batch->setScissor(initial);
     }
+    _activeScissor = nullptr;
+    _entries.clear();
+}
 
-    _batch->end();
+#pragma mark -
+#pragma mark Internal Helpers
+/**
+ * Appends the given node and its descendants to the flattened scene graph.
+ *
+ * Invisible nodes (and their descendants) are skipped.
+ *
+ * @param node      The node to flatten
+ * @param parent    The index of the parent entry
+ * @param depth     The depth of the node
+ * @param counter   The post-order counter
+ */
+void Scene2::flatten(SceneNode* node, Sint32 parent, Uint32 depth, Uint32& counter) {
+    if (!node->isVisible()) {
+        return;
+    }
+    
+    Uint32 index = (Uint32)_entries.size();
+    _entries.emplace_back();
+    RenderEntry& entry = _entries.back();
+    entry.node = node;
+    entry.parent = parent;
+    entry.depth  = depth;
+    entry.culled = false;
+    entry.ordered = dynamic_cast<OrderedNode*>(node) != nullptr;
+    entry.opaque  = !node->isFlattenable();
+    
+    // entry is not safe after recursion
+    if (!entry.opaque) {
+        const SceneNode* cnode = node;
+        for(auto it = cnode->getChildren().begin(); it != cnode->getChildren().end(); ++it) {
+            flatten(it->get(), index, depth+1, counter);
+        }
+    }
+    _entries[index].last = (Uint32)_entries.size()-1;
+    _entries[index].postorder = counter++;
+}
+
+/**
+ * Computes the transform, tint and culling state of the given entries.
+ *
+ * All of the parents of these entries must already be computed. This
+ * method is safe to call concurrently on disjoint ranges of the same depth.
+ *
+ * @param begin The first position in _levels to compute
+ * @param end   The position after the last in _levels to compute
+ */
+void Scene2::computeRange(size_t begin, size_t end) {
+    for(size_t ii = begin; ii < end; ii++) {
+        RenderEntry& entry = _entries[_levels[ii]];
+        const SceneNode* node = entry.node;
+        if (entry.parent < 0) {
+            Affine2::multiply(node->getTransform(),Affine2::IDENTITY,&entry.transform);
+            entry.tint = node->getColor();
+            if (node->hasRelativeColor()) {
+                entry.tint *= _color;
+            }
+        } else {
+            const RenderEntry& parent = _entries[entry.parent];
+            Affine2::multiply(node->getTransform(),parent.transform,&entry.transform);
+            entry.tint = node->getColor();
+            if (node->hasRelativeColor()) {
+                entry.tint *= parent.tint;
+            }
+        }
+        
+        if (_culling && !entry.opaque && !entry.ordered) {
+            Size size = node->getContentSize();
+            if (size.width > 0 && size.height > 0) {
+                Rect bounds = entry.transform.transform(Rect(Vec2::ZERO,size));
+                entry.culled = !bounds.doesIntersect(_viewport);
+            }
+        }
+    }
+}
+
+/**
+ * Submits the given range of flattened entries in pre-order.
+ *
+ * The range must consist of complete subtrees.
+ *
+ * @param begin The first entry to submit
+ * @param end   The entry after the last to submit
+ */
+void Scene2::submitRange(Uint32 begin, Uint32 end) {
+    Uint32 ii = begin;
+    while (ii < end) {
+        RenderEntry& entry = _entries[ii];
+        if (entry.opaque ||
+            (entry.ordered && static_cast<OrderedNode*>(entry.node)->getOrder() != OrderedNode::Order::PRE_ORDER)) {
+            submitEntry(ii);
+            ii = entry.last+1;
+        } else {
+            if (!entry.culled) {
+                if (_activeScissor != entry.scissor) {
+                    _batch->setScissor(entry.scissor);
+                    _activeScissor = entry.scissor;
+                }
+                entry.node->draw(_batch, entry.transform, entry.tint);
+            }
+            ii++;
+        }
+    }
+}
+
+/**
+ * Submits the descendants of an OrderedNode in its render order.
+ *
+ * Other ordered nodes among the descendants are render boundaries.
+ * They are sorted as a single unit, with their own descendants
+ * submitted according to their own render order.
+ *
+ * @param index The entry for the OrderedNode
+ */
+void Scene2::submitOrdered(Uint32 index) {
+    const RenderEntry& entry = _entries[index];
+    const OrderedNode* node = static_cast<const OrderedNode*>(entry.node);
+    bool post = node->isPostOrder();
+    
+    std::vector<Uint32> queue;
+    Uint32 ii = index+1;
+    while (ii <= entry.last) {
+        queue.push_back(ii);
+        const RenderEntry& child = _entries[ii];
+        ii = (child.ordered || child.opaque) ? child.last+1 : ii+1;
+    }
+    
+    std::sort(queue.begin(), queue.end(), [&](Uint32 a, Uint32 b) {
+        Uint32 acanon = post ? _entries[a].postorder : a;
+        Uint32 bcanon = post ? _entries[b].postorder : b;
+        return node->precedes(_entries[a].node, acanon, _entries[b].node, bcanon);
+    });
+    for(auto it = queue.begin(); it != queue.end(); ++it) {
+        submitEntry(*it);
+    }
+}
+
+/**
+ * Submits a single entry (and its subtree if it is a boundary).
+ *
+ * This method is used by {@link #submitOrdered}.
+ *
+ * @param index The entry to submit
+ */
+void Scene2::submitEntry(Uint32 index) {
+    RenderEntry& entry = _entries[index];
+    if (entry.opaque) {
+        // Node computes its own transform and scissor
+        if (_activeScissor != entry.scissor) {
+            _batch->setScissor(entry.scissor);
+            _activeScissor = entry.scissor;
+        }
+        if (entry.parent < 0) {
+            entry.node->render(_batch, Affine2::IDENTITY, _color);
+        } else {
+            const RenderEntry& parent = _entries[entry.parent];
+            entry.node->render(_batch, parent.transform, parent.tint);
+        }
+    } else if (entry.ordered) {
+        if (static_cast<OrderedNode*>(entry.node)->getOrder() == OrderedNode::Order::PRE_ORDER) {
+            submitRange(index, entry.last+1);
+        } else {
+            submitOrdered(index);
+        }
+    } else if (!entry.culled) {
+        if (_activeScissor != entry.scissor) {
+            _batch->setScissor(entry.scissor);
+            _activeScissor = entry.scissor;
+        }
+        entry.node->draw(_batch, entry.transform, entry.tint);
+    }
 }
@@ -7,6 +7,11 @@
 //  is constantly evolving, as we continue to add new node types and layout
 //  managers.
 //
+//  Scene files may either be JSON text or compiled JSON (with the extension
+//  .cubj). Compiled JSON is memory mapped and decoded without string parsing,
+//  which is much faster for large scenes. Use scripts/jsoncompile.py to
+//  compile a scene file ahead of time.
+//
 //  As with all of our loaders, this loader is designed to be attached to an
 //  asset manager.  In addition, this class uses our standard shared-pointer
 //  architecture.
@@ -47,6 +52,7 @@
 #include <cugl/core/assets/CUWidgetValue.h>
 #include <cugl/scene2/cu_scene2.h>
 #include <cugl/core/io/CUJsonReader.h>
+#include <cugl/core/io/CUBinaryReader.h>
 #include <cugl/core/util/CUStringTools.h>
 #include <cugl/core/util/CUFiletools.h>
 #include <cugl/core/CUApplication.h>
@@ -61,6 +67,29 @@ using namespace cugl::graphics;
 /** If the type is unknown */
 #define UNKNOWN_STR  "<unknown>"
 
+/** The file extension for compiled JSON */
+#define BINARY_EXT   ".cubj"
+
+/**
+ * Returns the JSON tree for the given asset file
+ *
+ * If the file has the extension ".cubj", it is assumed to be compiled JSON
+ * (see {@link JsonValue#toBinary}). Compiled JSON is memory mapped and
+ * decoded without any string parsing. Otherwise, the file is parsed as text.
+ *
+ * @param source    The relative path to the asset
+ *
+ * @return the JSON tree for the given asset file
+ */
+static std::shared_ptr<JsonValue> read_json(const std::string source) {
+    if (strtool::ends_with(source, BINARY_EXT)) {
+        std::shared_ptr<BinaryReader> reader = BinaryReader::allocWithMappedAsset(source);
+        return (reader == nullptr ? nullptr : reader->readJson());
+    }
+    std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
+    return (reader == nullptr ? nullptr : reader->readJson());
+}
+
 /**
  * Initializes a new asset loader.
  *
@@ -88,6 +117,7 @@ bool Scene2Loader::init(const std::shared_ptr<ThreadPool>& threads) {
     _types["wire frame"] = Widget::WIRE;
     _types["sprite"] = Widget::ANIMATE;
     _types["order"] = Widget::ORDER;
+    _types["cached"] = Widget::CACHED;
     _types["canvas"] = Widget::CANVAS;
     _types["ninepatch"] = Widget::NINE;
     _types["label"] = Widget::LABEL;
@@ -178,6 +208,9 @@ std::shared_ptr<scene2::SceneNode> Scene2Loader::build(const std::string key,
     case Widget::ORDER:
         node = scene2::OrderedNode::allocWithData(manager,data);
         break;
+    case Widget::CACHED:
+        node = scene2::CachedNode::allocWithData(manager,data);
+        break;
     case Widget::CANVAS:
         node = scene2::CanvasNode::allocWithData(manager,data);
         break;
@@ -397,6 +430,8 @@ bool Scene2Loader::materialize(const std::shared_ptr<scene2::SceneNode>& node, L
  * {@link materialize} methods.  This ensures that asynchronous loading
  * is safe.
  *
+ * If the source has the extension ".cubj", it is loaded as compiled JSON.
+ *
  * @param key       The key to access the asset after loading
  * @param source    The pathname to the asset
  * @param size      The font size (overriding the default)
@@ -415,22 +450,17 @@ bool Scene2Loader::read(const std::string key, const std::string source,
     bool absolute = cugl::filetool::is_absolute(source);
     CUAssertLog(!absolute, "This loader does not accept absolute paths for assets");
 
-    std::string root = Application::get()->getAssetDirectory();
-    std::string path = root+source;
-    
     bool success = false;
     if (_loader == nullptr || !async) {
         enqueue(key);
-        std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(path);
-        std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
+        std::shared_ptr<JsonValue> json = read_json(source);
         std::shared_ptr<scene2::SceneNode> node = build(key,json);
         node->doLayout();
         success = materialize(node, callback);
     } else {
         _loader->addTask([=,this](void) {
             this->enqueue(key);
-            std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(path);
-            std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
+            std::shared_ptr<JsonValue> json = read_json(source);
             std::shared_ptr<scene2::SceneNode> node = build(key,json);
             node->doLayout();
             Application::get()->schedule([=,this](void) {
@@ -314,9 +314,13 @@ std::shared_ptr<SceneNode> SceneNode::copy(const std::shared_ptr<SceneNode>& dst
  * @param  y    The x-coordinate of the node in its parent's coordinate system.
  */
 void SceneNode::setPosition(float x, float y) {
+    if (x == _position.x && y == _position.y) {
+        return;
+    }
     _combined.m[4] += (x-_position.x);
     _combined.m[5] += (y-_position.y);
     _position.set(x,y);
+    markChanged();
 }
 
 /**
@@ -339,6 +343,7 @@ void SceneNode::setContentSize(const Size size) {
     if (_layout) {
         doLayout();
     }
+    markChanged();
 }
 
 /**
@@ -482,9 +487,12 @@ Vec2 SceneNode::nodeToScreenCoords(const Vec2 nodePoint) const {
  * Updates the node to parent transform.
  *
  * This transform is defined by scaling, rotation, the post-rotation
- * transform, and positional translation, in that order.
+ * transform, and positional translation, in that order. The ancestors
+ * are only notified (see {@link #markChanged}) if the transform is
+ * actually different.
  */
 void SceneNode::updateTransform() {
+    Affine2 previous = _combined;
     Vec2 offset = _anchor*getContentSize();
     if (_useTransform) {
         Affine2::createTranslation(_position.x-offset.x, _position.y-offset.y, &_combined);
@@ -497,6 +505,9 @@ void SceneNode::updateTransform() {
         _combined.m[4] += _position.x-offset.x;
         _combined.m[5] += _position.y-offset.y;
      }
+    if (_combined != previous) {
+        markChanged();
+    }
 }
 
 /**
@@ -622,7 +633,8 @@ void SceneNode::addChild(const std::shared_ptr<SceneNode>& child) {
     _children.push_back(child);
     child->setParent(this);
     child->pushScene(_graph);
-    
+    descendantChanged();
+    markChanged();
 }
 
 /**
@@ -655,6 +667,8 @@ void SceneNode::swapChild(const std::shared_ptr<SceneNode>& child1,
             child2->addChild(*it);
         }
     }
+    descendantChanged();
+    markChanged();
 }
 
 /**
@@ -676,6 +690,8 @@ void SceneNode::removeChild(unsigned int pos) {
         _children[ii]->_childOffset = ii;
     }
     _children.resize(_children.size()-1);
+    descendantChanged();
+    markChanged();
 }
 
 /**
@@ -739,6 +755,8 @@ void SceneNode::removeAllChildren() {
         (*it)->pushScene(nullptr);
     }
     _children.clear();
+    descendantChanged();
+    markChanged();
 }
 
 /**
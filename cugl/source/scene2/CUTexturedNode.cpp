@@ -270,6 +270,7 @@ void TexturedNode::setTexture(const std::shared_ptr<Texture>& texture) {
     if (_texture != temp) {
         _texture = temp;
         updateTextureCoords();
+        markChanged();
     }
 }
 
@@ -305,6 +306,7 @@ void TexturedNode::shiftTexture(float dx, float dy) {
     _offset.x += dx;
     _offset.y += dy;
     updateTextureCoords();
+    markChanged();
 }
 
 /**
@@ -359,6 +361,7 @@ void TexturedNode::setContentSize(const Size size) {
 void TexturedNode::clearRenderData() {
     _mesh.clear();
     _rendered = false;
+    markChanged();
 }
 
 
@@ -37,11 +37,19 @@ void FarmvilleApp::onStartup()
 
     _root = OrderedNode::allocWithOrder(OrderedNode::Order::ASCEND);
     _scene->addChild(_root);
+
+    // Layer 0 never moves, so draw it from a single cached texture
+    _scenery = CachedNode::allocWithBounds(_scene->getSize());
+    _scenery->setPriority(0);
+    _root->addChild(_scenery);
     // Create an asset manager to load all assets
     _assets = AssetManager::alloc();
 
     // You have to attach the individual loaders for each asset type
-    _assets->attach<Texture>(TextureLoader::alloc()->getHook());
+    // Decoded images are cached so that later launches skip decoding
+    std::shared_ptr<TextureLoader> textures = TextureLoader::alloc();
+    textures->setCacheDirectory(getSaveDirectory()+"texcache");
+    _assets->attach<Texture>(textures->getHook());
     _assets->attach<Font>(FontLoader::alloc()->getHook());
 
     // This reads the given JSON file and uses it to load all other assets
@@ -96,6 +104,8 @@ void FarmvilleApp::onShutdown()
     // Delete all smart pointers
 
     // TODO: delete all elements
+    _scenery = nullptr;
+    _root = nullptr;
     _scene = nullptr;
     _batch = nullptr;
     _assets = nullptr;
@@ -157,16 +167,17 @@ void FarmvilleApp::update(float timestep)
             element->setPriority(value.layer);
             element->setScale(value.width / element->getWidth(), value.height / element->getHeight());
             element->setAnchor(Vec2::ANCHOR_CENTER);
-            _root->addChild(element);
+            if (value.layer == 0) {
+                _scenery->addChild(element);
+            } else {
+                _root->addChild(element);
+            }
             _elements[key] = element;
         }
     }
 
-    auto children = _root->getChildren();
-    for (int i = 0; i < children.size(); ++i) {
-        auto element = children[i];
-        auto id = element->getTag() - 1;
-        if (map.count(id) == 0){
+    for (const auto &[key, element] : _elements) {
+        if (map.count(key) == 0){
             element->setVisible(false);
         }
     }
@@ -50,6 +50,8 @@ protected:
 
 
     std::shared_ptr<cugl::scene2::SceneNode> _root;
+    /** The cached container for the static (layer 0) scenery */
+    std::shared_ptr<cugl::scene2::CachedNode> _scenery;
     std::unordered_map<int, std::shared_ptr<cugl::scene2::TexturedNode>> _elements;
     
     /**